@@ -21,6 +21,9 @@
 #include "hci_cmd_security.h"
 #include "hci_cmd_vendor.h"
 #include "log.h"
+#ifdef CONFIG_BLUETOOTH_LE_SERVICE_NOTIFY_QUEUE
+#include "ble_service_notify.h"
+#endif
 
 /**************************************************************************************************
  *    CONSTANTS AND DEFINES
@@ -1195,6 +1198,13 @@ ble_err_t ble_evt_gap_handler(void *p_param)
         break;
 
     case BLE_GAP_EVT_DISCONN_COMPLETE:
+#ifdef CONFIG_BLUETOOTH_LE_SERVICE_NOTIFY_QUEUE
+        // the queued notifications of the link are dropped, the services of a new link init the queue again
+        if (p_evt_param->event_param.ble_evt_gap.param.evt_disconn_complete.status == BLE_HCI_ERR_CODE_SUCCESS)
+        {
+            ble_svcs_notify_queue_reset(p_evt_param->event_param.ble_evt_gap.param.evt_disconn_complete.host_id);
+        }
+#endif
         // post to user
         status = g_ble_event_cb(p_evt_param);
         if (status == BLE_ERR_OK)
@@ -0,0 +1,134 @@
+/**************************************************************************//**
+ * @file     ble_service_common_bench.c
+ * @version
+ * @brief    Heap allocations and time of the ble service GATT send path
+ *
+ * Sends notifications by ble_svcs_data_send() to a stub BLE stack and counts
+ * the pvPortMalloc() calls and the time per 1000 notifications:
+ *
+ *   cc -O2 -DBLE_SUPPORT_NUM_CONN_MAX=1
+ *      -Inetwork/bluetooth/ble-host/ble-service/common/bench/host
+ *      -Inetwork/bluetooth/ble-host/ble-service/common/include
+ *      -Inetwork/bluetooth/ble-host/ble-cmd-api/include
+ *      network/bluetooth/ble-host/ble-service/common/src/ble_service_common.c
+ *      network/bluetooth/ble-host/ble-service/common/bench/ble_service_common_bench.c
+ *      -o ble_service_common_bench
+ *   ble_service_common_bench [-r rounds]
+ *
+ * The time is the best round, the host heap is faster than the FreeRTOS heap.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "ble_service_common.h"
+
+#define BENCH_NOTIFY_NUM        (1000)
+#define BENCH_NOTIFY_LEN        (20)
+#define BENCH_HANDLE_NUM        (0x10)
+
+static unsigned long g_alloc_num;
+static volatile uint32_t g_sink;
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+    g_alloc_num++;
+    return malloc(xWantedSize);
+}
+
+void vPortFree(void *pv)
+{
+    free(pv);
+}
+
+/* stub BLE stack, uses the parameters in the call only */
+#define BENCH_GATT_DATA_STUB(fn)                            \
+    ble_err_t fn(ble_gatt_data_param_t *p_param)            \
+    {                                                       \
+        g_sink += p_param->length + p_param->p_data[0];     \
+        return BLE_ERR_OK;                                  \
+    }
+
+BENCH_GATT_DATA_STUB(ble_cmd_gatt_read_rsp)
+BENCH_GATT_DATA_STUB(ble_cmd_gatt_read_by_type_rsp)
+BENCH_GATT_DATA_STUB(ble_cmd_gatt_read_blob_rsp)
+BENCH_GATT_DATA_STUB(ble_cmd_gatt_notification)
+BENCH_GATT_DATA_STUB(ble_cmd_gatt_indication)
+BENCH_GATT_DATA_STUB(ble_cmd_gatt_write_req)
+BENCH_GATT_DATA_STUB(ble_cmd_gatt_write_cmd)
+
+ble_err_t ble_cmd_gatt_error_rsp(ble_gatt_err_rsp_param_t *p_param)
+{
+    g_sink += p_param->err_rsp;
+    return BLE_ERR_OK;
+}
+
+ble_err_t ble_cmd_gatt_att_handle_mapping_get(ble_gatt_handle_table_param_t *p_param)
+{
+    g_sink += p_param->host_id;
+    return BLE_ERR_OK;
+}
+
+static double bench_us(const struct timespec *p_start, const struct timespec *p_end)
+{
+    return (p_end->tv_sec - p_start->tv_sec) * 1e6 + (p_end->tv_nsec - p_start->tv_nsec) / 1e3;
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t data[BENCH_NOTIFY_LEN];
+    ble_gatt_data_param_t param;
+    struct timespec start, end;
+    unsigned long alloc_num = 0;
+    double best_us = 0, us;
+    int rounds = 200;
+    int i, r;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-r") == 0) && (i + 1 < argc))
+        {
+            rounds = atoi(argv[++i]);
+        }
+        else
+        {
+            printf("usage: %s [-r rounds]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    memset(data, 0x5A, sizeof(data));
+    param.host_id = 0;
+    param.handle_num = BENCH_HANDLE_NUM;
+    param.length = BENCH_NOTIFY_LEN;
+    param.p_data = data;
+
+    for (r = 0; r < rounds; r++)
+    {
+        g_alloc_num = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < BENCH_NOTIFY_NUM; i++)
+        {
+            if (ble_svcs_data_send(TYPE_BLE_GATT_NOTIFICATION, &param) != BLE_ERR_OK)
+            {
+                printf("send fail at %d\n", i);
+                return 1;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        us = bench_us(&start, &end);
+        if ((r == 0) || (us < best_us))
+        {
+            best_us = us;
+        }
+        alloc_num = g_alloc_num;
+    }
+
+    printf("%d notifications: %lu allocs, %.1f us\n", BENCH_NOTIFY_NUM, alloc_num, best_us);
+
+    return 0;
+}
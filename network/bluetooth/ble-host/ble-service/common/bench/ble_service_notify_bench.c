@@ -0,0 +1,372 @@
+/**************************************************************************//**
+ * @file     ble_service_notify_bench.c
+ * @version
+ * @brief    Notifications per connection event, polled sends and the notification queue
+ *
+ * A mock BLE stack: ble_cmd_gatt_notification() does the bhc_att_req() part,
+ * the ACL data goes to a host queue of NUM_QUEUE_HOST_TO_HCI_ACL_DATA packets
+ * and then to the controller buffers, a connection event sends some buffers
+ * and gives them back by a Number of Completed Packets event.
+ *
+ * The application streams data in writes of a fixed size:
+ *   poll : ble_svcs_data_send() until BLE_BUSY, retried once per event.
+ *   queue: ble_svcs_notify_queue_write() until BLE_BUSY, written again on
+ *          BLE_SVCS_NOTIFY_EVT_READY. The completed packets go back by the
+ *          callback the queue sets by hci_bridge_completed_callback_set().
+ *
+ *   cc -O2 -DBLE_SUPPORT_NUM_CONN_MAX=1 -DCONFIG_BUILD_COMPONENT_BLUETOOTH_HCI_BRIDGE
+ *      -Inetwork/bluetooth/ble-host/ble-service/common/bench/host
+ *      -Inetwork/bluetooth/ble-host/ble-service/common/include
+ *      -Inetwork/bluetooth/ble-host/ble-cmd-api/include
+ *      -Inetwork/bluetooth/ble-host/hci/include
+ *      network/bluetooth/ble-host/ble-service/common/src/ble_service_common.c
+ *      network/bluetooth/ble-host/ble-service/common/src/ble_service_notify.c
+ *      network/bluetooth/ble-host/ble-service/common/bench/ble_service_notify_bench.c
+ *      -o ble_service_notify_bench
+ *   ble_service_notify_bench [-e events] [-k packets per event] [-b controller buffers]
+ *                            [-m mtu] [-w write size] [-q poll|queue]
+ *
+ * The exit status is not 0 if the received stream is not the written stream,
+ * if the queue takes a write that can never fit, or if the queue keeps data,
+ * credits or writes after the reset of the disconnection.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "ble_host_cmd.h"
+#include "ble_host_ref.h"
+#include "ble_service_common.h"
+#include "ble_service_notify.h"
+#include "hci_bridge.h"
+
+#define BENCH_HOST_ID           (0)
+#define BENCH_CONN_HANDLE       (0x0001)
+#define BENCH_HANDLE_NUM        (0x0010)
+#define BENCH_ACL_DATA_LEN      (251)
+#define BENCH_ACL_QUEUE_MAX     (64)
+
+typedef struct
+{
+    uint16_t length;
+    uint8_t  data[BLE_GATT_ATT_MTU_MAX];
+} bench_acl_t;
+
+typedef struct
+{
+    int events;
+    int pkts_per_event;
+    int ctrl_buf_num;
+    int mtu;
+    int write_len;
+    int use_queue;
+} bench_cfg_t;
+
+static bench_cfg_t g_cfg = {1000, 6, 8, BLE_GATT_ATT_MTU_MAX, 20, 1};
+
+/* host queue, then controller buffers */
+static bench_acl_t g_acl[BENCH_ACL_QUEUE_MAX];
+static int g_acl_head, g_host_num, g_ctrl_num;
+
+static uint32_t g_tx_seq, g_rx_seq, g_rx_err;
+static uint32_t g_att_num, g_busy_num, g_call_num;
+static int g_ready, g_credit;
+static hci_bridge_completed_cb_t g_completed_cb;
+
+
+/* mock BLE host */
+void *pvPortMalloc(size_t xWantedSize)
+{
+    return malloc(xWantedSize);
+}
+
+void vPortFree(void *pv)
+{
+    free(pv);
+}
+
+bool bhc_host_id_is_connected_check(uint8_t host_id, uint16_t *conn_id)
+{
+    (void)host_id;
+    *conn_id = BENCH_CONN_HANDLE;
+    return true;
+}
+
+void hci_bridge_completed_callback_set(hci_bridge_completed_cb_t pfn_callback)
+{
+    g_completed_cb = pfn_callback;
+}
+
+uint16_t bhc_gatt_att_mtu_get(uint8_t host_id)
+{
+    (void)host_id;
+    return (uint16_t)g_cfg.mtu;
+}
+
+/* bhc_att_req(): a packet in the host queue, BLE_BUSY if the queue is full */
+ble_err_t ble_cmd_gatt_notification(ble_gatt_data_param_t *p_param)
+{
+    bench_acl_t *p_acl;
+
+    g_call_num++;
+    if (p_param->length > g_cfg.mtu - 3)
+    {
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+    if (g_host_num >= NUM_QUEUE_HOST_TO_HCI_ACL_DATA)
+    {
+        g_busy_num++;
+        return BLE_BUSY;
+    }
+    p_acl = &g_acl[(g_acl_head + g_ctrl_num + g_host_num) % BENCH_ACL_QUEUE_MAX];
+    p_acl->length = p_param->length;
+    memcpy(p_acl->data, p_param->p_data, p_param->length);
+    g_host_num++;
+    return BLE_ERR_OK;
+}
+
+#define BENCH_GATT_DATA_UNUSED(fn)                          \
+    ble_err_t fn(ble_gatt_data_param_t *p_param)            \
+    {                                                       \
+        (void)p_param;                                      \
+        return BLE_ERR_CMD_NOT_SUPPORTED;                   \
+    }
+
+BENCH_GATT_DATA_UNUSED(ble_cmd_gatt_read_rsp)
+BENCH_GATT_DATA_UNUSED(ble_cmd_gatt_read_by_type_rsp)
+BENCH_GATT_DATA_UNUSED(ble_cmd_gatt_read_blob_rsp)
+BENCH_GATT_DATA_UNUSED(ble_cmd_gatt_indication)
+BENCH_GATT_DATA_UNUSED(ble_cmd_gatt_write_req)
+BENCH_GATT_DATA_UNUSED(ble_cmd_gatt_write_cmd)
+
+ble_err_t ble_cmd_gatt_error_rsp(ble_gatt_err_rsp_param_t *p_param)
+{
+    (void)p_param;
+    return BLE_ERR_CMD_NOT_SUPPORTED;
+}
+
+ble_err_t ble_cmd_gatt_att_handle_mapping_get(ble_gatt_handle_table_param_t *p_param)
+{
+    (void)p_param;
+    return BLE_ERR_CMD_NOT_SUPPORTED;
+}
+
+
+/* mock controller, one ACL packet per notification with the data length extension */
+static void bench_host_to_ctrl(void)
+{
+    while ((g_host_num != 0) && (g_ctrl_num < g_cfg.ctrl_buf_num))
+    {
+        g_host_num--;
+        g_ctrl_num++;
+    }
+}
+
+static int bench_conn_event(void)
+{
+    bench_acl_t *p_acl;
+    int num = 0;
+    int i;
+
+    while ((num < g_cfg.pkts_per_event) && (g_ctrl_num != 0))
+    {
+        p_acl = &g_acl[g_acl_head];
+        for (i = 0; i < p_acl->length; i++)
+        {
+            if (p_acl->data[i] != (uint8_t)g_rx_seq++)
+            {
+                g_rx_err++;
+            }
+        }
+        g_acl_head = (g_acl_head + 1) % BENCH_ACL_QUEUE_MAX;
+        g_ctrl_num--;
+        g_att_num++;
+        num++;
+    }
+    return num;
+}
+
+
+/* application */
+static void bench_evt_handler(uint8_t host_id, ble_svcs_notify_evt_t event)
+{
+    (void)host_id;
+    if (event == BLE_SVCS_NOTIFY_EVT_READY)
+    {
+        g_ready = 1;
+    }
+    else if (event == BLE_SVCS_NOTIFY_EVT_TX_CREDIT)
+    {
+        g_credit = 1;
+    }
+}
+
+static void bench_app_write(void)
+{
+    uint8_t data[BLE_GATT_ATT_MTU_MAX];
+    ble_gatt_data_param_t param;
+    ble_err_t status;
+    int i;
+
+    for (;;)
+    {
+        for (i = 0; i < g_cfg.write_len; i++)
+        {
+            data[i] = (uint8_t)(g_tx_seq + i);
+        }
+
+        if (g_cfg.use_queue)
+        {
+            status = ble_svcs_notify_queue_write(BENCH_HOST_ID, BENCH_HANDLE_NUM, data, (uint16_t)g_cfg.write_len);
+        }
+        else
+        {
+            param.host_id = BENCH_HOST_ID;
+            param.handle_num = BENCH_HANDLE_NUM;
+            param.length = (uint16_t)g_cfg.write_len;
+            param.p_data = data;
+            status = ble_svcs_data_send(TYPE_BLE_GATT_NOTIFICATION, &param);
+        }
+        if (status != BLE_ERR_OK)
+        {
+            return;
+        }
+        g_tx_seq += g_cfg.write_len;
+    }
+}
+
+static void bench_usage(const char *p_name)
+{
+    printf("usage: %s [-e events] [-k packets per event] [-b controller buffers] [-m mtu] [-w write size] [-q poll|queue]\n", p_name);
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t over[CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM * BLE_SVCS_NOTIFY_PACKET_MAX + 1];
+    ble_svcs_notify_stats_t stats;
+    int event, num, i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-e") == 0)
+        {
+            g_cfg.events = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-k") == 0)
+        {
+            g_cfg.pkts_per_event = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-b") == 0)
+        {
+            g_cfg.ctrl_buf_num = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-m") == 0)
+        {
+            g_cfg.mtu = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-w") == 0)
+        {
+            g_cfg.write_len = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            g_cfg.use_queue = (strcmp(argv[++i], "queue") == 0);
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if ((g_cfg.mtu < BLE_GATT_ATT_MTU_MIN) || (g_cfg.mtu > BLE_GATT_ATT_MTU_MAX) ||
+            (g_cfg.write_len < 1) || (g_cfg.write_len > g_cfg.mtu - 3) ||
+            (g_cfg.ctrl_buf_num < 1) || (g_cfg.ctrl_buf_num + NUM_QUEUE_HOST_TO_HCI_ACL_DATA > BENCH_ACL_QUEUE_MAX))
+    {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    if (g_cfg.use_queue &&
+            (ble_svcs_notify_queue_init(BENCH_HOST_ID, (uint8_t)g_cfg.ctrl_buf_num, BENCH_ACL_DATA_LEN, bench_evt_handler) != BLE_ERR_OK))
+    {
+        printf("queue init fail\n");
+        return 1;
+    }
+    if (g_cfg.use_queue &&
+            ((g_completed_cb != ble_svcs_notify_queue_tx_completed) ||
+             (ble_svcs_notify_queue_write(BENCH_HOST_ID, BENCH_HANDLE_NUM, over,
+                                          (uint16_t)(CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM * (g_cfg.mtu - 3) + 1)) != BLE_ERR_INVALID_PARAMETER)))
+    {
+        printf("queue completed callback or oversized write fail\n");
+        return 1;
+    }
+
+    bench_app_write();
+    for (event = 0; event < g_cfg.events; event++)
+    {
+        bench_host_to_ctrl();
+        num = bench_conn_event();
+
+        if (g_cfg.use_queue)
+        {
+            /* the completed packets event, then the writing task */
+            g_completed_cb(BENCH_CONN_HANDLE, (uint16_t)num);
+            if (g_credit)
+            {
+                g_credit = 0;
+                ble_svcs_notify_queue_process(BENCH_HOST_ID);
+            }
+            while (g_ready)
+            {
+                g_ready = 0;
+                bench_app_write();
+            }
+        }
+        else
+        {
+            bench_app_write();
+        }
+    }
+
+    printf("%-5s mtu %d, write %d B, %d pkts/event, %d buffers, %d events\n",
+           g_cfg.use_queue ? "queue" : "poll", g_cfg.mtu, g_cfg.write_len,
+           g_cfg.pkts_per_event, g_cfg.ctrl_buf_num, g_cfg.events);
+    printf("  notifications/event %.2f, bytes/event %.1f, stack calls/event %.2f, BLE_BUSY/event %.2f\n",
+           (double)g_att_num / g_cfg.events, (double)g_rx_seq / g_cfg.events,
+           (double)g_call_num / g_cfg.events, (double)g_busy_num / g_cfg.events);
+    if (g_cfg.use_queue)
+    {
+        ble_svcs_notify_queue_stats_get(BENCH_HOST_ID, &stats);
+        printf("  writes %u, busy writes %u, coalesced %u, tx %u, tx busy %u, drop %u\n",
+               (unsigned)stats.write_num, (unsigned)stats.write_busy_num, (unsigned)stats.coalesce_num,
+               (unsigned)stats.tx_num, (unsigned)stats.tx_busy_num, (unsigned)stats.drop_num);
+    }
+    if (g_rx_err != 0)
+    {
+        printf("  stream error %u\n", (unsigned)g_rx_err);
+        return 1;
+    }
+
+    if (g_cfg.use_queue)
+    {
+        /* the host resets the queue on the disconnection complete event, data may be queued */
+        bench_app_write();
+        ble_svcs_notify_queue_reset(BENCH_HOST_ID);
+        ble_svcs_notify_queue_stats_get(BENCH_HOST_ID, &stats);
+        g_completed_cb(BENCH_CONN_HANDLE, 1);
+        if ((stats.queued != 0) || (stats.credit != g_cfg.ctrl_buf_num) || (g_credit != 0) ||
+                (ble_svcs_notify_queue_write(BENCH_HOST_ID, BENCH_HANDLE_NUM, over, 1) != BLE_ERR_INVALID_STATE))
+        {
+            printf("  queue not reset on the disconnection\n");
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+/**************************************************************************//**
+ * @file     ble_service_tput_bench.c
+ * @version
+ * @brief    The throughput test of two loopback links on the host command API
+ *
+ * The host command API sources (ble_cmd_l2cap.c, ble_cmd_att_gatt.c) run on
+ * the in-process loopback of the host core, the HCI and hci_bridge, see
+ * host/ble_host_loopback.h. Host 0 streams test packets to host 1 on the
+ * throughput test L2CAP channel, host 2 streams them to host 3 as
+ * notifications, at the same time. A connection event is an interval of the
+ * test clock, the senders are called again after each connection event.
+ *
+ *   cc -O2 -DBLE_SUPPORT_NUM_CONN_MAX=4
+ *      -Inetwork/bluetooth/ble-host/ble-service/common/bench/host
+ *      -Inetwork/bluetooth/ble-host/ble-service/common/include
+ *      -Inetwork/bluetooth/ble-host/ble-cmd-api/include
+ *      -Inetwork/bluetooth/ble-host/hci/include
+ *      network/bluetooth/ble-host/ble-cmd-api/src/ble_cmd_l2cap.c
+ *      network/bluetooth/ble-host/ble-cmd-api/src/ble_cmd_att_gatt.c
+ *      network/bluetooth/ble-host/ble-service/common/bench/host/ble_host_loopback.c
+ *      network/bluetooth/ble-host/ble-service/common/src/ble_service_tput.c
+ *      network/bluetooth/ble-host/ble-service/common/bench/ble_service_tput_bench.c
+ *      -o ble_service_tput_bench
+ *   ble_service_tput_bench [-n packets] [-l packet length] [-m att mtu] [-p mps] [-c credits]
+ *                          [-q queue] [-k pdus per event] [-i interval us] [-x drop one of N]
+ *
+ * The exit status is not 0 if a link loses packets other than the dropped
+ * ones, gets a packet out of order or of a bad pattern, or does not finish.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ble_host_cmd.h"
+#include "ble_host_loopback.h"
+#include "ble_service_tput.h"
+
+#define BENCH_L2CAP_TX_ID       (0)
+#define BENCH_L2CAP_RX_ID       (1)
+#define BENCH_NOTIFY_TX_ID      (2)
+#define BENCH_NOTIFY_RX_ID      (3)
+#define BENCH_HANDLE_NUM        (0x0010)
+#define BENCH_EVENT_MAX         (100000000)
+
+typedef struct
+{
+    uint32_t packet_num;
+    int packet_len;
+    int interval_us;
+} bench_cfg_t;
+
+static bench_cfg_t g_cfg = {100000, 200, 7500};
+static ble_host_loopback_cfg_t g_loopback_cfg = {247, CONFIG_BLE_SVCS_TPUT_MTU, 247, 10, 8, 6, 0};
+static uint32_t g_now_us;
+
+
+/* the test clock, a connection interval per event */
+static uint32_t bench_time_us(void)
+{
+    return g_now_us;
+}
+
+static ble_err_t bench_service_cb(void *p_param)
+{
+    ble_svcs_tput_att_evt_handle((ble_evt_att_param_t *)p_param);
+    return BLE_ERR_OK;
+}
+
+static ble_err_t bench_l2cap_cb(void *p_param)
+{
+    ble_svcs_tput_l2cap_evt_handle((ble_l2cap_evt_param_t *)p_param);
+    return BLE_ERR_OK;
+}
+
+static double bench_elapsed_sec(struct timespec *p_start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - p_start->tv_sec) + (now.tv_nsec - p_start->tv_nsec) / 1e9;
+}
+
+static int bench_report(const char *p_name, uint8_t tx_id, uint8_t rx_id)
+{
+    ble_svcs_tput_stats_t tx, rx;
+    ble_host_loopback_stats_t link;
+    int err = 0;
+
+    ble_svcs_tput_stats_get(tx_id, &tx);
+    ble_svcs_tput_stats_get(rx_id, &rx);
+    ble_host_loopback_stats_get(tx_id, &link);
+
+    printf("%-6s host %u -> %u: tx %u, busy %u, stall %u | rx %u, lost %u (dropped %u), order %u, pattern %u\n",
+           p_name, tx_id, rx_id, (unsigned)tx.tx_packet_num, (unsigned)tx.tx_busy_num, (unsigned)tx.tx_stall_num,
+           (unsigned)rx.rx_packet_num, (unsigned)rx.rx_lost_num, (unsigned)link.drop_num,
+           (unsigned)rx.rx_order_err_num, (unsigned)rx.rx_pattern_err_num);
+    printf("       goodput %.1f kbps, latency p50 %u us, p90 %u us, p99 %u us, max %u us\n",
+           rx.goodput_bps / 1000.0, (unsigned)rx.latency_p50_us, (unsigned)rx.latency_p90_us,
+           (unsigned)rx.latency_p99_us, (unsigned)rx.latency_max_us);
+
+    // a dropped last packet is not seen as lost, no later sequence number comes
+    if ((tx.tx_packet_num != g_cfg.packet_num) || (rx.rx_order_err_num != 0) || (rx.rx_pattern_err_num != 0) ||
+            (rx.rx_packet_num + link.drop_num != g_cfg.packet_num) ||
+            (rx.rx_lost_num + 1 < link.drop_num) || (rx.rx_lost_num > link.drop_num) ||
+            (link.credit_err_num != 0) || (link.mps_err_num != 0))
+    {
+        printf("       stream error\n");
+        err = 1;
+    }
+    return err;
+}
+
+static void bench_usage(const char *p_name)
+{
+    printf("usage: %s [-n packets] [-l packet length] [-m att mtu] [-p mps] [-c credits] [-q queue] [-k pdus per event] [-i interval us] [-x drop one of N]\n", p_name);
+}
+
+int main(int argc, char **argv)
+{
+    ble_svcs_tput_cfg_t cfg;
+    struct timespec start;
+    double sec;
+    uint32_t pending;
+    int event, err, i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-n") == 0)
+        {
+            g_cfg.packet_num = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-l") == 0)
+        {
+            g_cfg.packet_len = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-m") == 0)
+        {
+            g_loopback_cfg.att_mtu = (uint16_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-p") == 0)
+        {
+            g_loopback_cfg.l2cap_mps = (uint16_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            g_loopback_cfg.l2cap_credits = (uint16_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            g_loopback_cfg.queue_num = (uint8_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-k") == 0)
+        {
+            g_loopback_cfg.pdus_per_event = (uint8_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-i") == 0)
+        {
+            g_cfg.interval_us = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-x") == 0)
+        {
+            g_loopback_cfg.drop_every = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if ((g_cfg.packet_num == 0) || (g_cfg.interval_us < 1) ||
+            (g_loopback_cfg.att_mtu < BLE_GATT_ATT_MTU_MIN) || (g_loopback_cfg.att_mtu > BLE_GATT_ATT_MTU_MAX) ||
+            (g_loopback_cfg.l2cap_mps < BLE_GATT_ATT_MTU_MIN) || (g_loopback_cfg.l2cap_mps > BLE_HOST_LOOPBACK_PDU_MAX) ||
+            (g_loopback_cfg.l2cap_credits < 1) || (g_loopback_cfg.queue_num < 1) ||
+            (g_loopback_cfg.queue_num > BLE_HOST_LOOPBACK_QUEUE_MAX) || (g_loopback_cfg.pdus_per_event < 1))
+    {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    ble_host_loopback_init(&g_loopback_cfg);
+    ble_host_callback_set(APP_SERVICE_EVENT, bench_service_cb);
+    ble_host_callback_set(APP_L2CAP_DATA_EVENT, bench_l2cap_cb);
+
+    cfg.handle_num = BENCH_HANDLE_NUM;
+    cfg.packet_len = (uint16_t)g_cfg.packet_len;
+    cfg.packet_num = g_cfg.packet_num;
+    cfg.time_us = bench_time_us;
+    cfg.path = BLE_SVCS_TPUT_PATH_L2CAP;
+    if ((ble_svcs_tput_init(BENCH_L2CAP_TX_ID, &cfg) != BLE_ERR_OK) || (ble_svcs_tput_init(BENCH_L2CAP_RX_ID, &cfg) != BLE_ERR_OK))
+    {
+        printf("l2cap init fail\n");
+        return 1;
+    }
+    cfg.path = BLE_SVCS_TPUT_PATH_NOTIFY;
+    if ((ble_svcs_tput_init(BENCH_NOTIFY_TX_ID, &cfg) != BLE_ERR_OK) || (ble_svcs_tput_init(BENCH_NOTIFY_RX_ID, &cfg) != BLE_ERR_OK))
+    {
+        printf("notify init fail\n");
+        return 1;
+    }
+
+    if (ble_svcs_tput_connect(BENCH_L2CAP_TX_ID) != BLE_ERR_OK)
+    {
+        printf("l2cap connect fail\n");
+        return 1;
+    }
+    ble_host_loopback_conn_event();
+    if ((ble_svcs_tput_start(BENCH_L2CAP_TX_ID) != BLE_ERR_OK) || (ble_svcs_tput_start(BENCH_NOTIFY_TX_ID) != BLE_ERR_OK))
+    {
+        printf("start fail, packet length %d\n", g_cfg.packet_len);
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (event = 0; event < BENCH_EVENT_MAX; event++)
+    {
+        g_now_us += (uint32_t)g_cfg.interval_us;
+        pending = ble_host_loopback_conn_event();
+
+        // the L2CAP sender also runs on the credit events
+        pending += ble_svcs_tput_process(BENCH_L2CAP_TX_ID);
+        pending += ble_svcs_tput_process(BENCH_NOTIFY_TX_ID);
+        if (pending == 0)
+        {
+            break;
+        }
+    }
+    sec = bench_elapsed_sec(&start);
+
+    printf("%u packets of %d B, att mtu %u, mps %u, %u credits, queue %u, %u pdus/event, interval %d us, drop 1/%u\n",
+           (unsigned)g_cfg.packet_num, g_cfg.packet_len, g_loopback_cfg.att_mtu, g_loopback_cfg.l2cap_mps,
+           g_loopback_cfg.l2cap_credits, g_loopback_cfg.queue_num, g_loopback_cfg.pdus_per_event,
+           g_cfg.interval_us, (unsigned)g_loopback_cfg.drop_every);
+    err = bench_report("l2cap", BENCH_L2CAP_TX_ID, BENCH_L2CAP_RX_ID);
+    err |= bench_report("notify", BENCH_NOTIFY_TX_ID, BENCH_NOTIFY_RX_ID);
+    printf("%d events, host time %.1f ns/packet\n", event + 1, sec * 1e9 / (2.0 * g_cfg.packet_num));
+    if (event >= BENCH_EVENT_MAX)
+    {
+        printf("not finished\n");
+        err = 1;
+    }
+    return err;
+}
@@ -0,0 +1,27 @@
+/**************************************************************************//**
+ * @file     FreeRTOS.h
+ * @version
+ * @brief    the FreeRTOS heap used by the ble service headers in a host build
+ *
+ * Only for the host build of the ble service benchmarks, the benchmarks count
+ * the calls of pvPortMalloc().
+ *
+ ******************************************************************************/
+
+#ifndef __BLE_SVCS_BENCH_HOST_FREERTOS_H__
+#define __BLE_SVCS_BENCH_HOST_FREERTOS_H__
+
+#include <stddef.h>
+
+// the MCU headers of the target define them for the host command API sources
+#ifndef TRUE
+#define TRUE    1
+#endif
+#ifndef FALSE
+#define FALSE   0
+#endif
+
+void *pvPortMalloc(size_t xWantedSize);
+void vPortFree(void *pv);
+
+#endif /* __BLE_SVCS_BENCH_HOST_FREERTOS_H__ */
@@ -0,0 +1,406 @@
+/**************************************************************************//**
+ * @file     ble_host_loopback.c
+ * @version
+ * @brief    an in-process loopback of the BLE host core for a host build
+ *
+ * The bhc_*() and hci_*() functions called by the host command API sources,
+ * see ble_host_loopback.h.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "ble_host_cmd.h"
+#include "ble_l2cap.h"
+#include "ble_profile.h"
+#include "hci_cmd_connect.h"
+#include "ble_host_loopback.h"
+
+#define LOOPBACK_CONN_HANDLE_BASE   (0x0001)
+#define LOOPBACK_PDU_ATT            (0x01)
+#define LOOPBACK_PDU_L2CAP          (0x02)
+
+typedef struct
+{
+    uint8_t  type;
+    uint16_t handle_num;
+    uint16_t length;
+    uint8_t  data[BLE_HOST_LOOPBACK_PDU_MAX];
+} loopback_pdu_t;
+
+typedef struct
+{
+    uint8_t  chan_connected;
+    uint8_t  chan_rsp_pending;      // the connect response is given in the next connection event
+    uint16_t chan_psm;
+    uint16_t credit;                // credits of the peer
+    uint16_t head;
+    uint16_t count;
+    uint32_t pdu_num;               // PDUs delivered or lost
+    ble_host_loopback_stats_t stats;
+    loopback_pdu_t pdu[BLE_HOST_LOOPBACK_QUEUE_MAX];
+} loopback_link_t;
+
+static ble_host_loopback_cfg_t g_loopback_cfg;
+static loopback_link_t g_loopback_link[BLE_SUPPORT_NUM_CONN_MAX];
+static ble_host_callback_t g_service_cb, g_l2cap_cb;
+
+/* an event of the biggest PDU */
+static union
+{
+    ble_evt_att_param_t att;
+    ble_l2cap_evt_param_t l2cap;
+    uint8_t buf[sizeof(ble_l2cap_evt_param_t) + BLE_HOST_LOOPBACK_PDU_MAX];
+} g_loopback_evt;
+
+ble_host_callback_t g_ble_event_cb;
+
+/* the attribute databases of the application profile, any handle of the server */
+const ble_att_role_by_id_t att_db_link[BLE_SUPPORT_NUM_CONN_MAX];
+ble_att_db_mapping_by_id_size_t att_db_mapping_size[BLE_SUPPORT_NUM_CONN_MAX];
+
+
+static uint8_t loopback_peer(uint8_t host_id)
+{
+    return (uint8_t)(host_id ^ 1);
+}
+
+static bool loopback_host_id_get(uint16_t conn_id, uint8_t *p_host_id)
+{
+    if ((conn_id < LOOPBACK_CONN_HANDLE_BASE) || (conn_id - LOOPBACK_CONN_HANDLE_BASE >= BLE_SUPPORT_NUM_CONN_MAX))
+    {
+        return false;
+    }
+    *p_host_id = (uint8_t)(conn_id - LOOPBACK_CONN_HANDLE_BASE);
+    return true;
+}
+
+static int8_t loopback_pdu_put(uint8_t host_id, uint8_t type, uint16_t handle_num, const uint8_t *p_data, uint16_t length)
+{
+    loopback_link_t *p_link = &g_loopback_link[host_id];
+    loopback_pdu_t *p_pdu;
+
+    if (p_link->count >= g_loopback_cfg.queue_num)
+    {
+        p_link->stats.tx_busy_num++;
+        return BLE_BUSY;
+    }
+    p_pdu = &p_link->pdu[(p_link->head + p_link->count) % BLE_HOST_LOOPBACK_QUEUE_MAX];
+    p_pdu->type = type;
+    p_pdu->handle_num = handle_num;
+    p_pdu->length = length;
+    memcpy(p_pdu->data, p_data, length);
+    p_link->count++;
+    p_link->stats.tx_pdu_num++;
+    return BLE_ERR_OK;
+}
+
+static void loopback_l2cap_evt_post(ble_l2cap_evt_t event, uint16_t length)
+{
+    g_loopback_evt.l2cap.event = event;
+    g_loopback_evt.l2cap.length = length;
+    if (g_l2cap_cb != NULL)
+    {
+        g_l2cap_cb(&g_loopback_evt.l2cap);
+    }
+}
+
+static void loopback_pdu_deliver(uint8_t host_id, loopback_link_t *p_link, loopback_pdu_t *p_pdu)
+{
+    uint8_t peer_id = loopback_peer(host_id);
+
+    if (p_pdu->type == LOOPBACK_PDU_ATT)
+    {
+        g_loopback_evt.att.host_id = peer_id;
+        g_loopback_evt.att.gatt_role = BLE_GATT_ROLE_CLIENT;
+        g_loopback_evt.att.cb_index = 0;
+        g_loopback_evt.att.handle_num = p_pdu->handle_num;
+        g_loopback_evt.att.opcode = OPCODE_ATT_HANDLE_VALUE_NOTIFICATION;
+        g_loopback_evt.att.event = 0;
+        g_loopback_evt.att.length = p_pdu->length;
+        memcpy(g_loopback_evt.att.data, p_pdu->data, p_pdu->length);
+        if (g_service_cb != NULL)
+        {
+            g_service_cb(&g_loopback_evt.att);
+        }
+        return;
+    }
+
+    g_loopback_evt.l2cap.evt_param.l2cap_data_param.host_id = peer_id;
+    g_loopback_evt.l2cap.evt_param.l2cap_data_param.psm = p_link->chan_psm;
+    g_loopback_evt.l2cap.evt_param.l2cap_data_param.length = p_pdu->length;
+    memcpy(g_loopback_evt.l2cap.evt_param.l2cap_data_param.data, p_pdu->data, p_pdu->length);
+    loopback_l2cap_evt_post(LE_L2CAP_EVT_DATA_RECEIVED, sizeof(ble_l2cap_data_param_t) + p_pdu->length);
+}
+
+
+/* the loopback */
+void ble_host_loopback_init(const ble_host_loopback_cfg_t *p_cfg)
+{
+    uint8_t host_id;
+
+    g_loopback_cfg = *p_cfg;
+    if (g_loopback_cfg.queue_num > BLE_HOST_LOOPBACK_QUEUE_MAX)
+    {
+        g_loopback_cfg.queue_num = BLE_HOST_LOOPBACK_QUEUE_MAX;
+    }
+    if (g_loopback_cfg.l2cap_mps > BLE_HOST_LOOPBACK_PDU_MAX)
+    {
+        g_loopback_cfg.l2cap_mps = BLE_HOST_LOOPBACK_PDU_MAX;
+    }
+    for (host_id = 0; host_id < BLE_SUPPORT_NUM_CONN_MAX; host_id++)
+    {
+        memset(&g_loopback_link[host_id], 0, offsetof(loopback_link_t, pdu));
+        att_db_mapping_size[host_id].size_map_client_db = 0xFFFF;
+        att_db_mapping_size[host_id].size_map_server_db = 0xFFFF;
+    }
+}
+
+uint32_t ble_host_loopback_conn_event(void)
+{
+    loopback_link_t *p_link;
+    loopback_pdu_t *p_pdu;
+    uint32_t pending = 0;
+    uint16_t credits;
+    uint8_t host_id;
+    int num;
+
+    for (host_id = 0; host_id < BLE_SUPPORT_NUM_CONN_MAX; host_id++)
+    {
+        p_link = &g_loopback_link[host_id];
+        if (p_link->chan_rsp_pending != 0)
+        {
+            p_link->chan_rsp_pending = 0;
+            p_link->chan_connected = 1;
+            p_link->credit = g_loopback_cfg.l2cap_credits;
+            g_loopback_evt.l2cap.evt_param.l2cap_conn_req_rsp.host_id = host_id;
+            g_loopback_evt.l2cap.evt_param.l2cap_conn_req_rsp.dest_id = BLE_HOST_LOOPBACK_CID;
+            g_loopback_evt.l2cap.evt_param.l2cap_conn_req_rsp.mtu = g_loopback_cfg.l2cap_mtu;
+            g_loopback_evt.l2cap.evt_param.l2cap_conn_req_rsp.mps = g_loopback_cfg.l2cap_mps;
+            g_loopback_evt.l2cap.evt_param.l2cap_conn_req_rsp.init_credits = g_loopback_cfg.l2cap_credits;
+            g_loopback_evt.l2cap.evt_param.l2cap_conn_req_rsp.result = 0;
+            loopback_l2cap_evt_post(LE_L2CAP_EVT_CREDIT_BASED_CONNECT_REQ_RSP, sizeof(ble_l2cap_credit_based_conn_req_rsp_t));
+        }
+
+        credits = 0;
+        for (num = 0; (num < g_loopback_cfg.pdus_per_event) && (p_link->count != 0); num++)
+        {
+            p_pdu = &p_link->pdu[p_link->head];
+            p_link->pdu_num++;
+            if ((g_loopback_cfg.drop_every != 0) && ((p_link->pdu_num % g_loopback_cfg.drop_every) == 0))
+            {
+                p_link->stats.drop_num++;
+            }
+            else
+            {
+                loopback_pdu_deliver(host_id, p_link, p_pdu);
+            }
+            // the peer takes a K-frame and gives its credit back, lost or not
+            if (p_pdu->type == LOOPBACK_PDU_L2CAP)
+            {
+                credits++;
+            }
+            p_link->head = (p_link->head + 1) % BLE_HOST_LOOPBACK_QUEUE_MAX;
+            p_link->count--;
+        }
+
+        if (credits != 0)
+        {
+            p_link->credit += credits;
+            g_loopback_evt.l2cap.evt_param.l2cap_flow_ctrl_credit_ind.host_id = host_id;
+            g_loopback_evt.l2cap.evt_param.l2cap_flow_ctrl_credit_ind.cid = BLE_HOST_LOOPBACK_CID;
+            g_loopback_evt.l2cap.evt_param.l2cap_flow_ctrl_credit_ind.credits = credits;
+            loopback_l2cap_evt_post(LE_L2CAP_EVT_FLOW_CTRL_CREDIT_IND, sizeof(ble_l2cap_flow_ctrl_credit_ind_t));
+        }
+        pending += p_link->count;
+    }
+    return pending;
+}
+
+void ble_host_loopback_stats_get(uint8_t host_id, ble_host_loopback_stats_t *p_stats)
+{
+    *p_stats = g_loopback_link[host_id].stats;
+}
+
+
+/* the host core */
+ble_err_t ble_host_callback_set(ble_app_event_t callback_type, ble_host_callback_t pfn_callback)
+{
+    switch (callback_type)
+    {
+    case APP_GENERAL_EVENT:
+        g_ble_event_cb = pfn_callback;
+        break;
+
+    case APP_SERVICE_EVENT:
+        g_service_cb = pfn_callback;
+        break;
+
+    case APP_L2CAP_DATA_EVENT:
+        g_l2cap_cb = pfn_callback;
+        break;
+
+    default:
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+    return BLE_ERR_OK;
+}
+
+bool bhc_host_id_is_valid_check(uint8_t host_id)
+{
+    return (host_id < BLE_SUPPORT_NUM_CONN_MAX);
+}
+
+bool bhc_host_id_is_connected_check(uint8_t host_id, uint16_t *conn_id)
+{
+    if ((host_id >= BLE_SUPPORT_NUM_CONN_MAX) || (loopback_peer(host_id) >= BLE_SUPPORT_NUM_CONN_MAX))
+    {
+        return false;
+    }
+    *conn_id = LOOPBACK_CONN_HANDLE_BASE + host_id;
+    return true;
+}
+
+bool bhc_host_parsing_process_is_finished_check(uint8_t host_id)
+{
+    (void)host_id;
+    return true;
+}
+
+bool bhc_host_is_in_encryption_check(uint8_t host_id)
+{
+    (void)host_id;
+    return false;
+}
+
+bool bhc_host_is_wating_gatt_rsp_check(uint8_t host_id)
+{
+    (void)host_id;
+    return false;
+}
+
+bool bhc_client_property_value_is_match_check(uint8_t host_id, uint16_t handle_num, uint8_t property)
+{
+    (void)host_id;
+    (void)handle_num;
+    (void)property;
+    return true;
+}
+
+bool bhc_server_property_value_is_match_check(uint8_t host_id, uint16_t handle_num, uint8_t property)
+{
+    (void)host_id;
+    (void)handle_num;
+    (void)property;
+    return true;
+}
+
+bool bhc_gatt_preferred_mtu_set(uint8_t host_id, uint16_t preferred_mtu)
+{
+    (void)host_id;
+    (void)preferred_mtu;
+    return true;
+}
+
+uint16_t bhc_gatt_att_mtu_get(uint8_t host_id)
+{
+    (void)host_id;
+    return g_loopback_cfg.att_mtu;
+}
+
+/* the notifications go to the peer, the other ATT PDUs are not carried */
+int8_t bhc_att_req(uint16_t conn_id, uint8_t att_opcode, uint16_t handle_num, uint8_t *p_data, uint16_t length)
+{
+    uint8_t host_id;
+
+    if ((loopback_host_id_get(conn_id, &host_id) == false) || (att_opcode != OPCODE_ATT_HANDLE_VALUE_NOTIFICATION) ||
+            (length > g_loopback_cfg.att_mtu - 3))
+    {
+        return BLE_ERR_CMD_NOT_SUPPORTED;
+    }
+    return loopback_pdu_put(host_id, LOOPBACK_PDU_ATT, handle_num, p_data, length);
+}
+
+int8_t bhc_att_error_rsp_req(uint16_t conn_id, uint8_t att_opcode, uint16_t handle_num, ble_att_error_code_t error_code)
+{
+    (void)conn_id;
+    (void)att_opcode;
+    (void)handle_num;
+    (void)error_code;
+    return BLE_ERR_OK;
+}
+
+ble_err_t ble_gatt_att_handle_mapping_get(ble_gatt_handle_table_param_t *p_param)
+{
+    (void)p_param;
+    return BLE_ERR_CMD_NOT_SUPPORTED;
+}
+
+/* the peer accepts the channel of any SPSM */
+ble_err_t bhc_l2cap_chan_connect_reg(uint16_t conn_id, uint16_t psm, uint16_t mtu)
+{
+    loopback_link_t *p_link;
+    uint8_t host_id;
+
+    (void)mtu;
+    if (loopback_host_id_get(conn_id, &host_id) == false)
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+    p_link = &g_loopback_link[host_id];
+    if ((p_link->chan_connected != 0) || (p_link->chan_rsp_pending != 0))
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+    p_link->chan_psm = psm;
+    p_link->chan_rsp_pending = 1;
+    return BLE_ERR_OK;
+}
+
+ble_err_t bhc_l2cap_data_send(uint16_t conn_id, uint16_t dest_id, uint8_t *p_data, uint16_t length)
+{
+    loopback_link_t *p_link;
+    ble_err_t status;
+    uint8_t host_id;
+
+    if (loopback_host_id_get(conn_id, &host_id) == false)
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+    p_link = &g_loopback_link[host_id];
+    if ((p_link->chan_connected == 0) || (dest_id != BLE_HOST_LOOPBACK_CID))
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+    if (length > g_loopback_cfg.l2cap_mps)
+    {
+        p_link->stats.mps_err_num++;
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+    if (p_link->credit == 0)
+    {
+        p_link->stats.credit_err_num++;
+        return BLE_ERR_INVALID_STATE;
+    }
+    status = loopback_pdu_put(host_id, LOOPBACK_PDU_L2CAP, dest_id, p_data, length);
+    if (status == BLE_ERR_OK)
+    {
+        p_link->credit--;
+    }
+    return status;
+}
+
+
+/* the HCI */
+ble_err_t hci_le_set_data_length_cmd(ble_hci_cmd_set_data_length_param_t *p_param)
+{
+    (void)p_param;
+    return BLE_ERR_OK;
+}
+
+ble_err_t hci_le_write_suggested_default_data_length_cmd(ble_hci_cmd_write_default_data_length_param_t *p_param)
+{
+    (void)p_param;
+    return BLE_ERR_OK;
+}
@@ -0,0 +1,60 @@
+/**************************************************************************//**
+ * @file     ble_host_loopback.h
+ * @version
+ * @brief    an in-process loopback of the BLE host core for a host build
+ *
+ * The host command API sources of ble-cmd-api (ble_cmd_l2cap.c,
+ * ble_cmd_att_gatt.c) run on the loopback instead of the prebuilt host core,
+ * the HCI and hci_bridge. The links of host id 2n and 2n + 1 are connected to
+ * each other:
+ *   notification : bhc_att_req() queues it, the peer gets a GATT client
+ *                  ble_evt_att_param_t by the APP_SERVICE_EVENT callback.
+ *   L2CAP K-frame: bhc_l2cap_data_send() queues it, the peer gets
+ *                  LE_L2CAP_EVT_DATA_RECEIVED and the sender gets the credit
+ *                  back by LE_L2CAP_EVT_FLOW_CTRL_CREDIT_IND, both by the
+ *                  APP_L2CAP_DATA_EVENT callback.
+ * A full queue is BLE_BUSY, the queued PDUs move in the connection events of
+ * ble_host_loopback_conn_event(). Only for the host build of the benchmarks,
+ * they run in one thread.
+ *
+ ******************************************************************************/
+
+#ifndef __BLE_SVCS_BENCH_HOST_LOOPBACK_H__
+#define __BLE_SVCS_BENCH_HOST_LOOPBACK_H__
+
+#include <stdint.h>
+#include "ble_api.h"
+#include "ble_att_gatt.h"
+
+#define BLE_HOST_LOOPBACK_QUEUE_MAX     (64)
+#define BLE_HOST_LOOPBACK_PDU_MAX       (BLE_GATT_ATT_MTU_MAX)
+#define BLE_HOST_LOOPBACK_CID           (0x0040)
+
+typedef struct
+{
+    uint16_t att_mtu;           // ATT_MTU of the links
+    uint16_t l2cap_mtu;         // the SDU MTU of the channel peer
+    uint16_t l2cap_mps;         // the MPS of the channel peer
+    uint16_t l2cap_credits;     // the initial credits of the channel peer
+    uint8_t  queue_num;         // PDUs queued per link, up to BLE_HOST_LOOPBACK_QUEUE_MAX
+    uint8_t  pdus_per_event;    // PDUs of a link delivered per connection event
+    uint32_t drop_every;        // one PDU of drop_every is lost, 0 for none
+} ble_host_loopback_cfg_t;
+
+typedef struct
+{
+    uint32_t tx_pdu_num;        // PDUs queued
+    uint32_t tx_busy_num;       // PDUs refused by a full queue
+    uint32_t drop_num;          // PDUs lost on purpose
+    uint32_t credit_err_num;    // K-frames sent without a credit
+    uint32_t mps_err_num;       // K-frames longer than the MPS
+} ble_host_loopback_stats_t;
+
+void ble_host_loopback_init(const ble_host_loopback_cfg_t *p_cfg);
+
+// one connection event of all the links, returns the PDUs still queued
+uint32_t ble_host_loopback_conn_event(void);
+
+void ble_host_loopback_stats_get(uint8_t host_id, ble_host_loopback_stats_t *p_stats);
+
+#endif /* __BLE_SVCS_BENCH_HOST_LOOPBACK_H__ */
@@ -0,0 +1,21 @@
+/**************************************************************************//**
+ * @file     ble_profile.h
+ * @version
+ * @brief    the application profile header of the ble service sources in a host build
+ *
+ ******************************************************************************/
+
+#ifndef __BLE_SVCS_BENCH_HOST_BLE_PROFILE_H__
+#define __BLE_SVCS_BENCH_HOST_BLE_PROFILE_H__
+
+#include <stdio.h>
+#include "ble_att_gatt.h"
+
+// the attribute databases of the application profile
+extern const ble_att_role_by_id_t att_db_link[];
+extern ble_att_db_mapping_by_id_size_t att_db_mapping_size[];
+
+// the service debug prints are not part of the bench output
+#define printf(...)     ((void)0)
+
+#endif /* __BLE_SVCS_BENCH_HOST_BLE_PROFILE_H__ */
@@ -0,0 +1,21 @@
+/**************************************************************************//**
+ * @file     hci_bridge.h
+ * @version
+ * @brief    the completed packets callback of the HCI bridge in a host build
+ *
+ * Only for the host build of the ble service benchmarks, the benchmark
+ * defines hci_bridge_completed_callback_set() and raises the callback for
+ * its Number of Completed Packets events.
+ *
+ ******************************************************************************/
+
+#ifndef __BLE_SVCS_BENCH_HOST_HCI_BRIDGE_H__
+#define __BLE_SVCS_BENCH_HOST_HCI_BRIDGE_H__
+
+#include <stdint.h>
+
+typedef void (*hci_bridge_completed_cb_t)(uint16_t conn_handle, uint16_t num);
+
+void hci_bridge_completed_callback_set(hci_bridge_completed_cb_t pfn_callback);
+
+#endif /* __BLE_SVCS_BENCH_HOST_HCI_BRIDGE_H__ */
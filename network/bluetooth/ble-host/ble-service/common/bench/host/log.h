@@ -0,0 +1,13 @@
+/**************************************************************************//**
+ * @file     log.h
+ * @version
+ * @brief    the log macros used by the ble service sources in a host build
+ *
+ ******************************************************************************/
+
+#ifndef __BLE_SVCS_BENCH_HOST_LOG_H__
+#define __BLE_SVCS_BENCH_HOST_LOG_H__
+
+#define log_info(...)   ((void)0)
+
+#endif /* __BLE_SVCS_BENCH_HOST_LOG_H__ */
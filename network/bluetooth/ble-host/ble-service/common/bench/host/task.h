@@ -0,0 +1,16 @@
+/**************************************************************************//**
+ * @file     task.h
+ * @version
+ * @brief    the FreeRTOS critical section used by the ble service sources in a host build
+ *
+ * Only for the host build of the ble service benchmarks, they run in one thread.
+ *
+ ******************************************************************************/
+
+#ifndef __BLE_SVCS_BENCH_HOST_TASK_H__
+#define __BLE_SVCS_BENCH_HOST_TASK_H__
+
+#define taskENTER_CRITICAL()    ((void)0)
+#define taskEXIT_CRITICAL()     ((void)0)
+
+#endif /* __BLE_SVCS_BENCH_HOST_TASK_H__ */
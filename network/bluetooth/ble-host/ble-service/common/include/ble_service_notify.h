@@ -0,0 +1,170 @@
+#ifndef _BLE_SERVICE_NOTIFY_H_
+#define _BLE_SERVICE_NOTIFY_H_
+
+/**************************************************************************//**
+ * @file  ble_service_notify.h
+ * @brief Provide the Credit Based Notification Queue of BLE Services.
+*****************************************************************************/
+#include <stdint.h>
+#include "ble_api.h"
+#include "ble_att_gatt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @ingroup service_basedDef
+ * @defgroup service_notifyDef BLE Service Notification Queue
+ * @{
+ * @details A per-link queue of notifications for high rate services, e.g. TRSPS, HIDS, OTS and FOTAS.
+ * The application writes are copied and coalesced into packets of (ATT_MTU - 3) bytes, the queue
+ * sends a packet while the link has controller ACL credits and takes the credits back from the
+ * Number of Completed Packets events. With the HCI bridge, ble_svcs_notify_queue_init() registers
+ * ble_svcs_notify_queue_tx_completed() by hci_bridge_completed_callback_set(), otherwise the
+ * application calls ble_svcs_notify_queue_tx_completed() for each event.
+ * The writes of a handle are a byte stream, the packet boundaries are not kept.
+ *
+ * ble_svcs_notify_queue_write() and ble_svcs_notify_queue_process() are called in one task,
+ * @ref BLE_SVCS_NOTIFY_EVT_TX_CREDIT asks that task to call ble_svcs_notify_queue_process().
+ * The host resets the queue of a link on its BLE_GAP_EVT_DISCONN_COMPLETE, before the application
+ * gets the event, ble_svcs_notify_queue_init() is called again for the next connection.
+ * @}
+**************************************************************************/
+
+/** Packets queued per link.
+ * @ingroup service_notifyDef
+*/
+#ifndef CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM
+#define CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM          8
+#endif
+
+/** The maximum payload of a queued packet, (@ref BLE_GATT_ATT_MTU_MAX - 3) bytes.
+ * @ingroup service_notifyDef
+*/
+#define BLE_SVCS_NOTIFY_PACKET_MAX                (BLE_GATT_ATT_MTU_MAX - 3)
+
+
+/**
+ * @ingroup service_notifyDef
+ * @defgroup service_notifyEvtDef BLE Service Notification Queue Events
+ * @{
+*/
+typedef uint8_t ble_svcs_notify_evt_t;
+#define BLE_SVCS_NOTIFY_EVT_TX_CREDIT             0x01    /**< Credits are back with packets queued, call ble_svcs_notify_queue_process() in the writing task. Raised in the Number of Completed Packets context. */
+#define BLE_SVCS_NOTIFY_EVT_READY                 0x02    /**< A write refused by BLE_BUSY fits now. Raised in the writing task. */
+/** @} */
+
+
+/** ble_svcs_notify_evt_handler_t
+ * @ingroup service_notifyDef
+ * @note This callback receives the notification queue events of a link.
+*/
+typedef void (*ble_svcs_notify_evt_handler_t)(uint8_t host_id, ble_svcs_notify_evt_t event);
+
+
+/** Notification queue statistics.
+ * @ingroup service_notifyDef
+*/
+typedef struct
+{
+    uint32_t write_num;        /**< Writes accepted. */
+    uint32_t write_busy_num;   /**< Writes refused by a full queue. */
+    uint32_t coalesce_num;     /**< Writes appended to a queued packet. */
+    uint32_t tx_num;           /**< Packets sent to the BLE stack. */
+    uint32_t tx_busy_num;      /**< Packets refused by the BLE stack, sent again later. */
+    uint32_t drop_num;         /**< Packets dropped by a BLE stack error. */
+    uint8_t  queued;           /**< Packets in the queue. */
+    uint8_t  credit;           /**< Controller ACL credits of the link. */
+} ble_svcs_notify_stats_t;
+
+
+/** Initialize the Notification Queue of a Link
+ *
+ * @ingroup service_notifyDef
+ *
+ * @note Call it after the connection is established, the queued data of the link is dropped.
+ * @note With the HCI bridge it sets ble_svcs_notify_queue_tx_completed() as the completed packets callback of the bridge.
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[in] credit_num : controller ACL packets the link may use, 1 ~ the total number of data packets of @ref BLE_COMMON_EVT_READ_BUFFER_SIZE.
+ * @param[in] acl_data_len : the data packet length of @ref BLE_COMMON_EVT_READ_BUFFER_SIZE, a notification longer than it takes more credits.
+ * @param[in] evt_handler : the event handler, NULL if not used.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_INVALID_STATE : The link is not connected.
+ * @retval BLE_ERR_INVALID_PARAMETER : Invalid parameter.
+ * @retval BLE_ERR_OK  : Setting success.
+*/
+ble_err_t ble_svcs_notify_queue_init(uint8_t host_id, uint8_t credit_num, uint16_t acl_data_len, ble_svcs_notify_evt_handler_t evt_handler);
+
+
+/** Drop the Queued Notifications of a Link and Disable its Queue
+ *
+ * @ingroup service_notifyDef
+ *
+ * @note The host calls it on the disconnection of the link.
+ *
+ * @param[in] host_id : the link's host id.
+*/
+void ble_svcs_notify_queue_reset(uint8_t host_id);
+
+
+/** Write Notification Data to the Queue
+ *
+ * @ingroup service_notifyDef
+ *
+ * @note The data is copied, appended to the last queued packet of the same handle and sent when the link has credits.
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[in] handle_num : handle number of the notified characteristic.
+ * @param[in] p_data : a pointer to data to send.
+ * @param[in] length : length of the data.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_INVALID_STATE : The queue of the link is not initialized.
+ * @retval BLE_ERR_INVALID_PARAMETER : Invalid parameter, or more than @ref CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM * (ATT_MTU - 3) bytes.
+ * @retval BLE_BUSY : No space for all the data, nothing is queued. @ref BLE_SVCS_NOTIFY_EVT_READY is raised when it fits.
+ * @retval BLE_ERR_OK  : The data is queued.
+*/
+ble_err_t ble_svcs_notify_queue_write(uint8_t host_id, uint16_t handle_num, const uint8_t *p_data, uint16_t length);
+
+
+/** Send the Queued Notifications of a Link while it has Credits
+ *
+ * @ingroup service_notifyDef
+ *
+ * @param[in] host_id : the link's host id.
+*/
+void ble_svcs_notify_queue_process(uint8_t host_id);
+
+
+/** Give the Completed ACL Packets of a Connection back as Credits
+ *
+ * @ingroup service_notifyDef
+ *
+ * @note The signature matches hci_bridge_completed_cb_t.
+ *
+ * @param[in] conn_handle : the connection handle of the Number of Completed Packets event.
+ * @param[in] num : the number of completed packets.
+*/
+void ble_svcs_notify_queue_tx_completed(uint16_t conn_handle, uint16_t num);
+
+
+/** Get the Notification Queue Statistics of a Link
+ *
+ * @ingroup service_notifyDef
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[out] p_stats : statistics.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_OK  : Success.
+*/
+ble_err_t ble_svcs_notify_queue_stats_get(uint8_t host_id, ble_svcs_notify_stats_t *p_stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _BLE_SERVICE_NOTIFY_H_ */
@@ -0,0 +1,230 @@
+#ifndef _BLE_SERVICE_TPUT_H_
+#define _BLE_SERVICE_TPUT_H_
+
+/**************************************************************************//**
+ * @file  ble_service_tput.h
+ * @brief Provide the Throughput Test of BLE Links.
+*****************************************************************************/
+#include <stdint.h>
+#include "ble_api.h"
+#include "ble_att_gatt.h"
+#include "ble_l2cap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @ingroup service_basedDef
+ * @defgroup service_tputDef BLE Throughput Test
+ * @{
+ * @details A sender streams test packets on a link and the receiver of the peer checks them, either on an LE
+ * credit based L2CAP channel of @ref BLE_SVCS_TPUT_SPSM by ble_cmd_l2cap_data_send() or as notifications of
+ * a characteristic value by ble_cmd_gatt_notification(). A test packet is a sequence number, the send time
+ * and a pattern of the sequence number:
+ *   | seq (4) | time_us (4) | (uint8_t)(seq + 8), (uint8_t)(seq + 9), ... |
+ * On L2CAP a packet is one SDU in one K-frame, the first 2 bytes of the K-frame are the SDU length.
+ *
+ * The receiver counts the lost packets by the sequence numbers, the packets out of order and the pattern
+ * errors, it reports the goodput of the good packets and the latency percentiles of the send time. The latency
+ * is in the clock of the sender, it is the delay when both ends share the clock (e.g. a loopback of two links)
+ * and the delay plus the clock offset of two devices, where only its spread is meaningful.
+ * The sender counts the sends refused by the BLE stack (BLE_BUSY) and the sends stopped by no L2CAP credit.
+ *
+ * The events of the links are given to ble_svcs_tput_l2cap_evt_handle() and ble_svcs_tput_att_evt_handle()
+ * in the application task, the other functions of a link are called in the same task.
+ * @}
+**************************************************************************/
+
+/** The SPSM of the throughput test channel, an SPSM of the dynamic range.
+ * @ingroup service_tputDef
+*/
+#define BLE_SVCS_TPUT_SPSM                          0x0080
+
+
+/** The header of a test packet, the sequence number and the send time.
+ * @ingroup service_tputDef
+*/
+#define BLE_SVCS_TPUT_HEADER_LEN                    8
+
+
+/** The maximum test packet length, a K-frame of an MPS of 247 bytes or a notification of an ATT_MTU of 247 bytes.
+ * @ingroup service_tputDef
+*/
+#ifndef CONFIG_BLE_SVCS_TPUT_PACKET_MAX
+#define CONFIG_BLE_SVCS_TPUT_PACKET_MAX             244
+#endif
+
+
+/** The SDU MTU of the test channel.
+ * @ingroup service_tputDef
+*/
+#ifndef CONFIG_BLE_SVCS_TPUT_MTU
+#define CONFIG_BLE_SVCS_TPUT_MTU                    CONFIG_BLE_SVCS_TPUT_PACKET_MAX
+#endif
+
+
+/** The latency histogram step, the percentiles are multiples of it. 125 us divides the 625 us and 1.25 ms BLE timings.
+ * @ingroup service_tputDef
+*/
+#ifndef CONFIG_BLE_SVCS_TPUT_LATENCY_STEP_US
+#define CONFIG_BLE_SVCS_TPUT_LATENCY_STEP_US        125
+#endif
+
+
+/** The latency histogram buckets per link, 4 bytes each. The latencies of the last bucket and above are counted in it.
+ * @ingroup service_tputDef
+*/
+#ifndef CONFIG_BLE_SVCS_TPUT_LATENCY_BUCKET_NUM
+#define CONFIG_BLE_SVCS_TPUT_LATENCY_BUCKET_NUM     256
+#endif
+
+
+/**
+ * @ingroup service_tputDef
+ * @defgroup service_tputPathDef BLE Throughput Test Paths
+ * @{
+*/
+typedef uint8_t ble_svcs_tput_path_t;
+#define BLE_SVCS_TPUT_PATH_L2CAP                    0x01    /**< LE credit based L2CAP channel. */
+#define BLE_SVCS_TPUT_PATH_NOTIFY                   0x02    /**< GATT notifications. */
+/** @} */
+
+
+/** ble_svcs_tput_time_t
+ * @ingroup service_tputDef
+ * @note This callback returns a free running microsecond clock.
+*/
+typedef uint32_t (*ble_svcs_tput_time_t)(void);
+
+
+/** Throughput test configuration of a link.
+ * @ingroup service_tputDef
+*/
+typedef struct
+{
+    ble_svcs_tput_path_t path;      /**< The path of the test packets. */
+    uint16_t handle_num;            /**< The characteristic value handle of the notifications, NOTIFY path only. */
+    uint16_t packet_len;            /**< Bytes of a test packet, @ref BLE_SVCS_TPUT_HEADER_LEN to @ref CONFIG_BLE_SVCS_TPUT_PACKET_MAX. */
+    uint32_t packet_num;            /**< Test packets sent by ble_svcs_tput_start(). */
+    ble_svcs_tput_time_t time_us;   /**< The clock of the send times and latencies. */
+} ble_svcs_tput_cfg_t;
+
+
+/** Throughput test statistics of a link.
+ * @ingroup service_tputDef
+*/
+typedef struct
+{
+    uint32_t tx_packet_num;         /**< Test packets sent. */
+    uint32_t tx_busy_num;           /**< Sends refused by the BLE stack, sent again later. */
+    uint32_t tx_stall_num;          /**< Sends stopped by no credit. */
+    uint32_t rx_packet_num;         /**< Test packets received. */
+    uint32_t rx_lost_num;           /**< Test packets missing in the sequence numbers. */
+    uint32_t rx_order_err_num;      /**< Test packets of a sequence number already passed. */
+    uint32_t rx_pattern_err_num;    /**< Test packets of a bad length or pattern. */
+    uint32_t rx_byte_num;           /**< Bytes of the good test packets. */
+    uint32_t rx_time_us;            /**< Time from the first to the last received test packet. */
+    uint32_t goodput_bps;           /**< Bits per second of the good test packets in rx_time_us. */
+    uint32_t latency_p50_us;        /**< 50th percentile latency, rounded down to @ref CONFIG_BLE_SVCS_TPUT_LATENCY_STEP_US,
+                                         latency_max_us if it is above the histogram range. */
+    uint32_t latency_p90_us;        /**< 90th percentile latency, as latency_p50_us. */
+    uint32_t latency_p99_us;        /**< 99th percentile latency, as latency_p50_us. */
+    uint32_t latency_max_us;        /**< Maximum latency. */
+    uint16_t credit;                /**< Credits of the peer, L2CAP path only. */
+} ble_svcs_tput_stats_t;
+
+
+/** Initialize the Throughput Test of a Link
+ *
+ * @ingroup service_tputDef
+ *
+ * @note The statistics of the link are cleared, a link is a sender and a receiver of the same path.
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[in] p_cfg : the test configuration.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_INVALID_PARAMETER : Invalid parameter.
+ * @retval BLE_ERR_OK  : Setting success.
+*/
+ble_err_t ble_svcs_tput_init(uint8_t host_id, const ble_svcs_tput_cfg_t *p_cfg);
+
+
+/** Connect the Throughput Test Channel
+ *
+ * @ingroup service_tputDef
+ *
+ * @param[in] host_id : the link's host id.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_INVALID_STATE : The link is not an L2CAP path link or the channel is established.
+ * @retval BLE_ERR_OK  : The request is sent, the channel is established by @ref LE_L2CAP_EVT_CREDIT_BASED_CONNECT_REQ_RSP.
+*/
+ble_err_t ble_svcs_tput_connect(uint8_t host_id);
+
+
+/** Handle an L2CAP Event of the Throughput Test
+ *
+ * @ingroup service_tputDef
+ *
+ * @param[in] p_param : the L2CAP event.
+*/
+void ble_svcs_tput_l2cap_evt_handle(ble_l2cap_evt_param_t *p_param);
+
+
+/** Handle an ATT Event of the Throughput Test
+ *
+ * @ingroup service_tputDef
+ *
+ * @note The notifications of the characteristic value handle of the configuration are test packets.
+ *
+ * @param[in] p_param : the ATT event.
+*/
+void ble_svcs_tput_att_evt_handle(ble_evt_att_param_t *p_param);
+
+
+/** Start Sending the Test Packets
+ *
+ * @ingroup service_tputDef
+ *
+ * @param[in] host_id : the link's host id.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_INVALID_PARAMETER : The test packet is longer than the peer MPS, the peer MTU or (ATT_MTU - 3).
+ * @retval BLE_ERR_INVALID_STATE : The link is not initialized, the channel is not established or a test is in progress.
+ * @retval BLE_ERR_OK  : The test is started.
+*/
+ble_err_t ble_svcs_tput_start(uint8_t host_id);
+
+
+/** Send the Test Packets of a Link while the BLE Stack takes them
+ *
+ * @ingroup service_tputDef
+ *
+ * @note It is called on the credit events, call it again after a BLE_BUSY of the BLE stack.
+ *
+ * @param[in] host_id : the link's host id.
+ *
+ * @return The test packets left to send.
+*/
+uint32_t ble_svcs_tput_process(uint8_t host_id);
+
+
+/** Get the Throughput Test Statistics of a Link
+ *
+ * @ingroup service_tputDef
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[out] p_stats : statistics.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_OK  : Success.
+*/
+ble_err_t ble_svcs_tput_stats_get(uint8_t host_id, ble_svcs_tput_stats_t *p_stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _BLE_SERVICE_TPUT_H_ */
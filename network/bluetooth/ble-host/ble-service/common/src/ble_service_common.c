@@ -245,30 +245,18 @@ ble_err_t ble_svcs_common_init(uint8_t host_id, ble_gatt_role_t role, uint8_t ma
 ble_err_t ble_svcs_handles_mapping_get(ble_gatt_handle_table_param_t *p_param)
 {
     ble_err_t status;
-    ble_gatt_handle_table_param_t *p_ble_gatt_handle_table_param;
+    ble_gatt_handle_table_param_t handle_table_param;
 
-    status = BLE_ERR_OK;
-    p_ble_gatt_handle_table_param = pvPortMalloc(sizeof(ble_gatt_handle_table_param_t));
+    // the BLE stack uses the parameters in the call only, keep them on the stack
+    handle_table_param.host_id = p_param->host_id;
+    handle_table_param.gatt_role = p_param->gatt_role;
+    handle_table_param.p_element = p_param->p_element;
+    handle_table_param.p_handle_num_addr = p_param->p_handle_num_addr;
 
-    if (p_ble_gatt_handle_table_param != NULL)
+    status = ble_cmd_gatt_att_handle_mapping_get(&handle_table_param);
+    if (status != BLE_ERR_OK) // send to BLE stack
     {
-        p_ble_gatt_handle_table_param->host_id = p_param->host_id;
-        p_ble_gatt_handle_table_param->gatt_role = p_param->gatt_role;
-        p_ble_gatt_handle_table_param->p_element = p_param->p_element;
-        p_ble_gatt_handle_table_param->p_handle_num_addr = p_param->p_handle_num_addr;
-
-        status = ble_cmd_gatt_att_handle_mapping_get(p_ble_gatt_handle_table_param);
-        if (status != BLE_ERR_OK) // send to BLE stack
-        {
-            log_info("<TYPE_BLE_GATT_ATT_HANDLE_MAPPING_GET> Send msg to BLE stack fail\n");
-        }
-        vPortFree(p_ble_gatt_handle_table_param);
-
-    }
-    else
-    {
-        log_info("<TYPE_BLE_GATT_ATT_HANDLE_MAPPING_GET> malloc fail\n");
-        status = BLE_ERR_ALLOC_MEMORY_FAIL;
+        log_info("<TYPE_BLE_GATT_ATT_HANDLE_MAPPING_GET> Send msg to BLE stack fail\n");
     }
 
     return status;
@@ -309,6 +297,7 @@ ble_err_t ble_svcs_auto_handle_cccd_read_req(ble_evt_att_param_t *p_param, uint1
 {
     ble_err_t status = BLE_ERR_INVALID_PARAMETER;
     uint8_t cccd[2];
+    ble_gatt_data_param_t gatt_data_param;
 
     // check cccd_value is valid or not
     if ( (cccd_value != BLEGATT_CCCD_NONE) &&
@@ -322,62 +311,29 @@ ble_err_t ble_svcs_auto_handle_cccd_read_req(ble_evt_att_param_t *p_param, uint1
     cccd[0] = (uint8_t)(cccd_value & 0xFF);
     cccd[1] = (uint8_t)((cccd_value >> 8) & 0xFF);
 
+    gatt_data_param.host_id = p_param->host_id;
+    gatt_data_param.handle_num = p_param->handle_num;
+    gatt_data_param.length = 2;
+    gatt_data_param.p_data = (uint8_t *)cccd;
+
     // check opcode first
     switch (p_param->opcode)
     {
     case OPCODE_ATT_READ_BY_TYPE_REQUEST:
-    {
-        ble_gatt_data_param_t *p_gatt_data_param;
-
-        p_gatt_data_param = pvPortMalloc(sizeof(ble_gatt_data_param_t));
-        if (p_gatt_data_param != NULL)
-        {
-            p_gatt_data_param->host_id = p_param->host_id;
-            p_gatt_data_param->handle_num = p_param->handle_num;
-            p_gatt_data_param->length = 2;
-            p_gatt_data_param->p_data = (uint8_t *)cccd;
-
-            status = ble_cmd_gatt_read_by_type_rsp(p_gatt_data_param);
-            if (status != BLE_ERR_OK) // send to BLE stack
-            {
-                log_info("<TYPE_BLE_GATT_READ_BY_TYPE_RSP> Send msg to BLE stack fail\n");
-            }
-            vPortFree(p_gatt_data_param);
-        }
-        else
+        status = ble_cmd_gatt_read_by_type_rsp(&gatt_data_param);
+        if (status != BLE_ERR_OK) // send to BLE stack
         {
-            log_info("<TYPE_BLE_GATT_READ_BY_TYPE_RSP> malloc fail\n");
-            status = BLE_ERR_ALLOC_MEMORY_FAIL;
+            log_info("<TYPE_BLE_GATT_READ_BY_TYPE_RSP> Send msg to BLE stack fail\n");
         }
-    }
-    break;
+        break;
 
     case OPCODE_ATT_READ_REQUEST:
-    {
-        ble_gatt_data_param_t *p_gatt_data_param;
-
-        p_gatt_data_param = pvPortMalloc(sizeof(ble_gatt_data_param_t));
-        if (p_gatt_data_param != NULL)
-        {
-            p_gatt_data_param->host_id = p_param->host_id;
-            p_gatt_data_param->handle_num = p_param->handle_num;
-            p_gatt_data_param->length = 2;
-            p_gatt_data_param->p_data = (uint8_t *)cccd;
-
-            status = ble_cmd_gatt_read_rsp(p_gatt_data_param);
-            if (status != BLE_ERR_OK) // send to BLE stack
-            {
-                log_info("<TYPE_BLE_GATT_READ_RSP> Send msg to BLE stack fail\n");
-            }
-            vPortFree(p_gatt_data_param);
-        }
-        else
+        status = ble_cmd_gatt_read_rsp(&gatt_data_param);
+        if (status != BLE_ERR_OK) // send to BLE stack
         {
-            log_info("<TYPE_BLE_GATT_READ_RSP> malloc fail\n");
-            status = BLE_ERR_ALLOC_MEMORY_FAIL;
+            log_info("<TYPE_BLE_GATT_READ_RSP> Send msg to BLE stack fail\n");
         }
-    }
-    break;
+        break;
 
     default:
         status = BLE_ERR_INVALID_PARAMETER;
@@ -393,62 +349,30 @@ ble_err_t ble_svcs_auto_handle_cccd_read_req(ble_evt_att_param_t *p_param, uint1
 ble_err_t ble_svcs_auto_handle_read_req(ble_evt_att_param_t *p_param, uint8_t *p_data, uint8_t length)
 {
     ble_err_t status = BLE_ERR_INVALID_PARAMETER;
+    ble_gatt_data_param_t gatt_data_param;
+
+    gatt_data_param.host_id = p_param->host_id;
+    gatt_data_param.handle_num = p_param->handle_num;
+    gatt_data_param.p_data = p_data;
+    gatt_data_param.length = length;
 
     switch (p_param->opcode)
     {
     case OPCODE_ATT_READ_BY_TYPE_REQUEST:
-    {
-        ble_gatt_data_param_t *p_gatt_data_param;
-
-        p_gatt_data_param = pvPortMalloc(sizeof(ble_gatt_data_param_t));
-        if (p_gatt_data_param != NULL)
-        {
-            p_gatt_data_param->host_id = p_param->host_id;
-            p_gatt_data_param->handle_num = p_param->handle_num;
-            p_gatt_data_param->p_data = p_data;
-            p_gatt_data_param->length = length;
-
-            status = ble_cmd_gatt_read_by_type_rsp(p_gatt_data_param);
-            if (status != BLE_ERR_OK) // send to BLE stack
-            {
-                log_info("<TYPE_BLE_GATT_READ_BY_TYPE_RSP> Send msg to BLE stack fail\n");
-            }
-            vPortFree(p_gatt_data_param);
-        }
-        else
+        status = ble_cmd_gatt_read_by_type_rsp(&gatt_data_param);
+        if (status != BLE_ERR_OK) // send to BLE stack
         {
-            log_info("<TYPE_BLE_GATT_READ_BY_TYPE_RSP> malloc fail\n");
-            status = BLE_ERR_ALLOC_MEMORY_FAIL;
+            log_info("<TYPE_BLE_GATT_READ_BY_TYPE_RSP> Send msg to BLE stack fail\n");
         }
-    }
-    break;
+        break;
 
     case OPCODE_ATT_READ_REQUEST:
-    {
-        ble_gatt_data_param_t *p_gatt_data_param;
-
-        p_gatt_data_param = pvPortMalloc(sizeof(ble_gatt_data_param_t));
-        if (p_gatt_data_param != NULL)
-        {
-            p_gatt_data_param->host_id = p_param->host_id;
-            p_gatt_data_param->handle_num = p_param->handle_num;
-            p_gatt_data_param->p_data = p_data;
-            p_gatt_data_param->length = length;
-
-            status = ble_cmd_gatt_read_rsp(p_gatt_data_param);
-            if (status != BLE_ERR_OK) // send to BLE stack
-            {
-                log_info("<TYPE_BLE_GATT_READ_RSP> Send msg to BLE stack fail\n");
-            }
-            vPortFree(p_gatt_data_param);
-        }
-        else
+        status = ble_cmd_gatt_read_rsp(&gatt_data_param);
+        if (status != BLE_ERR_OK) // send to BLE stack
         {
-            log_info("<TYPE_BLE_GATT_READ_RSP> malloc fail\n");
-            status = BLE_ERR_ALLOC_MEMORY_FAIL;
+            log_info("<TYPE_BLE_GATT_READ_RSP> Send msg to BLE stack fail\n");
         }
-    }
-    break;
+        break;
 
     default:
         status = BLE_ERR_INVALID_PARAMETER;
@@ -479,53 +403,32 @@ ble_err_t ble_svcs_auto_handle_read_blob_req(ble_evt_att_param_t *p_param, uint8
 
     if (err_rsp != ERR_CODE_ATT_NO_ERROR)
     {
-        ble_gatt_err_rsp_param_t *p_gatt_data_param;
+        ble_gatt_err_rsp_param_t gatt_err_rsp_param;
 
-        p_gatt_data_param = pvPortMalloc(sizeof(ble_gatt_err_rsp_param_t));
+        gatt_err_rsp_param.host_id = p_param->host_id;
+        gatt_err_rsp_param.handle_num = p_param->handle_num;
+        gatt_err_rsp_param.opcode = OPCODE_ATT_READ_BLOB_REQUEST;
+        gatt_err_rsp_param.err_rsp = err_rsp;
 
-        if (p_gatt_data_param != NULL)
-        {
-            p_gatt_data_param->host_id = p_param->host_id;
-            p_gatt_data_param->handle_num = p_param->handle_num;
-            p_gatt_data_param->opcode = OPCODE_ATT_READ_BLOB_REQUEST;
-            p_gatt_data_param->err_rsp = err_rsp;
-
-            status = ble_cmd_gatt_error_rsp(p_gatt_data_param);
-            if (status != BLE_ERR_OK) // send to BLE stack
-            {
-                log_info("<TYPE_BLE_GATT_ERROR_RSP> Send msg to BLE stack fail\n");
-            }
-            vPortFree(p_gatt_data_param);
-        }
-        else
+        status = ble_cmd_gatt_error_rsp(&gatt_err_rsp_param);
+        if (status != BLE_ERR_OK) // send to BLE stack
         {
-            log_info("<TYPE_BLE_GATT_ERROR_RSP> malloc fail\n");
-            status = BLE_ERR_ALLOC_MEMORY_FAIL;
+            log_info("<TYPE_BLE_GATT_ERROR_RSP> Send msg to BLE stack fail\n");
         }
     }
     else
     {
-        ble_gatt_data_param_t *p_gatt_data_param;
+        ble_gatt_data_param_t gatt_data_param;
 
-        p_gatt_data_param = pvPortMalloc(sizeof(ble_gatt_data_param_t));
-        if (p_gatt_data_param != NULL)
-        {
-            p_gatt_data_param->host_id = p_param->host_id;
-            p_gatt_data_param->handle_num = p_param->handle_num;
-            p_gatt_data_param->p_data = (p_data + offset);
-            p_gatt_data_param->length = (length - offset);
-
-            status = ble_cmd_gatt_read_blob_rsp(p_gatt_data_param);
-            if (status != BLE_ERR_OK) // send to BLE stack
-            {
-                log_info("<TYPE_BLE_GATT_READ_BLOB_RSP> Send msg to BLE stack fail\n");
-            }
-            vPortFree(p_gatt_data_param);
-        }
-        else
+        gatt_data_param.host_id = p_param->host_id;
+        gatt_data_param.handle_num = p_param->handle_num;
+        gatt_data_param.p_data = (p_data + offset);
+        gatt_data_param.length = (length - offset);
+
+        status = ble_cmd_gatt_read_blob_rsp(&gatt_data_param);
+        if (status != BLE_ERR_OK) // send to BLE stack
         {
-            log_info("<TYPE_BLE_GATT_READ_BLOB_RSP> malloc fail\n");
-            status = BLE_ERR_ALLOC_MEMORY_FAIL;
+            log_info("<TYPE_BLE_GATT_READ_BLOB_RSP> Send msg to BLE stack fail\n");
         }
     }
 
@@ -568,58 +471,50 @@ ble_err_t ble_svcs_cccd_set(uint8_t host_id, uint16_t handle_num, ble_gatt_cccd_
 ble_err_t ble_svcs_data_send(uint16_t type, ble_gatt_data_param_t *p_param)
 {
     ble_err_t status;
-    ble_gatt_data_param_t *p_data_param;
+    ble_gatt_data_param_t data_param;
 
-    status = BLE_ERR_OK;
-    p_data_param = pvPortMalloc(sizeof(ble_gatt_data_param_t));
-    if (p_data_param != NULL)
+    // the BLE stack queues the data in the call and may trim the length, so pass a stack copy
+    // instead of the heap on every notification, indication, response and write
+    data_param = *p_param;
+
+    switch (type)
     {
-        memcpy(p_data_param, p_param, sizeof(ble_gatt_data_param_t));
-        switch (type)
-        {
-        case TYPE_BLE_GATT_READ_RSP:
-            status = ble_cmd_gatt_read_rsp(p_data_param);
-            break;
-
-        case TYPE_BLE_GATT_READ_BY_TYPE_RSP:
-            status = ble_cmd_gatt_read_by_type_rsp(p_data_param);
-            break;
-
-        case TYPE_BLE_GATT_READ_BLOB_RSP:
-            status = ble_cmd_gatt_read_blob_rsp(p_data_param);
-            break;
-
-        case TYPE_BLE_GATT_NOTIFICATION:
-            status = ble_cmd_gatt_notification(p_data_param);
-            break;
-
-        case TYPE_BLE_GATT_INDICATION:
-            status = ble_cmd_gatt_indication(p_data_param);
-            break;
-
-        case TYPE_BLE_GATT_WRITE_REQ:
-            status = ble_cmd_gatt_write_req(p_data_param);
-            break;
-
-        case TYPE_BLE_GATT_WRITE_CMD:
-            status = ble_cmd_gatt_write_cmd(p_data_param);
-            break;
-
-        default:
-            log_info("<ble_svcs_data_send> unknown type.\n");
-            status = BLE_ERR_UNKNOW_TYPE;
-            break;
-        }
-        if (status != BLE_ERR_OK)
-        {
-            log_info("<ble_svcs_data_send> Send msg to BLE stack fail %d, type=0x%02x\n", status, type);
-        }
-        vPortFree(p_data_param);
+    case TYPE_BLE_GATT_READ_RSP:
+        status = ble_cmd_gatt_read_rsp(&data_param);
+        break;
+
+    case TYPE_BLE_GATT_READ_BY_TYPE_RSP:
+        status = ble_cmd_gatt_read_by_type_rsp(&data_param);
+        break;
+
+    case TYPE_BLE_GATT_READ_BLOB_RSP:
+        status = ble_cmd_gatt_read_blob_rsp(&data_param);
+        break;
+
+    case TYPE_BLE_GATT_NOTIFICATION:
+        status = ble_cmd_gatt_notification(&data_param);
+        break;
+
+    case TYPE_BLE_GATT_INDICATION:
+        status = ble_cmd_gatt_indication(&data_param);
+        break;
+
+    case TYPE_BLE_GATT_WRITE_REQ:
+        status = ble_cmd_gatt_write_req(&data_param);
+        break;
+
+    case TYPE_BLE_GATT_WRITE_CMD:
+        status = ble_cmd_gatt_write_cmd(&data_param);
+        break;
+
+    default:
+        log_info("<ble_svcs_data_send> unknown type.\n");
+        status = BLE_ERR_UNKNOW_TYPE;
+        break;
     }
-    else
+    if (status != BLE_ERR_OK)
     {
-        log_info("<ble_svcs_data_send> malloc fail, type=0x%02x\n", type);
-        status = BLE_ERR_DATA_MALLOC_FAIL;
+        log_info("<ble_svcs_data_send> Send msg to BLE stack fail %d, type=0x%02x\n", status, type);
     }
 
     return status;
@@ -0,0 +1,392 @@
+/************************************************************************
+ *
+ * File Name  : ble_service_notify.c
+ * Description: This file contains the credit based notification queue of BLE services
+ *
+ *
+ ************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "ble_host_cmd.h"
+#include "ble_service_notify.h"
+#include "log.h"
+#ifdef CONFIG_BUILD_COMPONENT_BLUETOOTH_HCI_BRIDGE
+#include "hci_bridge.h"
+#endif
+
+
+/**************************************************************************
+ * BLE Service Notification Queue Definitions
+ **************************************************************************/
+/** L2CAP basic header and ATT handle value notification header. */
+#define NOTIFY_PDU_HEADER_LEN       (4 + 3)
+
+typedef struct
+{
+    uint16_t handle_num;
+    uint16_t length;
+    uint8_t  data[BLE_SVCS_NOTIFY_PACKET_MAX];
+} notify_packet_t;
+
+typedef struct
+{
+    ble_svcs_notify_evt_handler_t evt_handler;
+    uint16_t conn_handle;
+    uint16_t acl_data_len;
+    uint16_t ready_len;                     // the length of the refused write
+    uint8_t  enable;
+    uint8_t  ready_wanted;
+    uint8_t  credit_num;
+    volatile uint8_t credit;                // also written in the completed packets context
+    uint8_t  head;
+    volatile uint8_t count;                 // also read in the completed packets context
+    ble_svcs_notify_stats_t stats;
+    notify_packet_t packet[CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM];
+} notify_link_t;
+
+static notify_link_t g_notify_link[BLE_SUPPORT_NUM_CONN_MAX];
+
+
+/**************************************************************************
+ * BLE Service Notification Queue Private Functions
+ **************************************************************************/
+static uint16_t notify_payload_max(uint8_t host_id)
+{
+    uint16_t mtu = bhc_gatt_att_mtu_get(host_id);
+
+    if (mtu < BLE_GATT_ATT_MTU_MIN)
+    {
+        mtu = BLE_GATT_ATT_MTU_MIN;
+    }
+    if (mtu > BLE_GATT_ATT_MTU_MAX)
+    {
+        mtu = BLE_GATT_ATT_MTU_MAX;
+    }
+    return (mtu - 3);
+}
+
+// ACL packets of a notification, a packet is never more than all the credits of the link
+static uint8_t notify_packet_cost(notify_link_t *p_link, notify_packet_t *p_packet)
+{
+    uint16_t cost;
+
+    cost = (p_packet->length + NOTIFY_PDU_HEADER_LEN + p_link->acl_data_len - 1) / p_link->acl_data_len;
+    if (cost > p_link->credit_num)
+    {
+        cost = p_link->credit_num;
+    }
+    return (uint8_t)cost;
+}
+
+static notify_packet_t *notify_packet_at(notify_link_t *p_link, uint8_t index)
+{
+    return &p_link->packet[(p_link->head + index) % CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM];
+}
+
+static uint32_t notify_space_get(notify_link_t *p_link, uint16_t handle_num, uint16_t payload_max)
+{
+    uint32_t space;
+    notify_packet_t *p_tail;
+
+    space = (uint32_t)(CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM - p_link->count) * payload_max;
+    if (p_link->count != 0)
+    {
+        p_tail = notify_packet_at(p_link, p_link->count - 1);
+        if ((p_tail->handle_num == handle_num) && (p_tail->length < payload_max))
+        {
+            space += (payload_max - p_tail->length);
+        }
+    }
+    return space;
+}
+
+
+/**************************************************************************
+ * BLE Service Notification Queue Public Functions
+ **************************************************************************/
+
+/** Initialize the Notification Queue of a Link
+*/
+ble_err_t ble_svcs_notify_queue_init(uint8_t host_id, uint8_t credit_num, uint16_t acl_data_len, ble_svcs_notify_evt_handler_t evt_handler)
+{
+    notify_link_t *p_link;
+    uint16_t conn_handle;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    if ((credit_num == 0) || (acl_data_len == 0))
+    {
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+
+    if (bhc_host_id_is_connected_check(host_id, &conn_handle) == false)
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+
+    p_link = &g_notify_link[host_id];
+
+    taskENTER_CRITICAL();
+    p_link->enable = 0;
+    taskEXIT_CRITICAL();
+
+    memset(p_link, 0, offsetof(notify_link_t, packet));
+    p_link->evt_handler = evt_handler;
+    p_link->conn_handle = conn_handle;
+    p_link->acl_data_len = acl_data_len;
+    p_link->credit_num = credit_num;
+    p_link->credit = credit_num;
+
+#ifdef CONFIG_BUILD_COMPONENT_BLUETOOTH_HCI_BRIDGE
+    // the credits come back from the Number of Completed Packets events of the bridge
+    hci_bridge_completed_callback_set(ble_svcs_notify_queue_tx_completed);
+#endif
+
+    taskENTER_CRITICAL();
+    p_link->enable = 1;
+    taskEXIT_CRITICAL();
+
+    return BLE_ERR_OK;
+}
+
+
+/** Drop the Queued Notifications of a Link
+*/
+void ble_svcs_notify_queue_reset(uint8_t host_id)
+{
+    notify_link_t *p_link;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return;
+    }
+
+    p_link = &g_notify_link[host_id];
+
+    taskENTER_CRITICAL();
+    p_link->enable = 0;
+    p_link->count = 0;
+    p_link->head = 0;
+    p_link->credit = p_link->credit_num;
+    p_link->ready_wanted = 0;
+    taskEXIT_CRITICAL();
+}
+
+
+/** Write Notification Data to the Queue
+*/
+ble_err_t ble_svcs_notify_queue_write(uint8_t host_id, uint16_t handle_num, const uint8_t *p_data, uint16_t length)
+{
+    notify_link_t *p_link;
+    notify_packet_t *p_packet;
+    uint16_t payload_max, copy_len;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = &g_notify_link[host_id];
+    if (p_link->enable == 0)
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+
+    if ((handle_num == 0) || (p_data == NULL) || (length == 0))
+    {
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+
+    payload_max = notify_payload_max(host_id);
+    if ((uint32_t)length > (uint32_t)CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM * payload_max)
+    {
+        // never fits, a BLE_BUSY would wait for a BLE_SVCS_NOTIFY_EVT_READY that is never raised
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+
+    if (length > notify_space_get(p_link, handle_num, payload_max))
+    {
+        p_link->ready_wanted = 1;
+        p_link->ready_len = length;
+        p_link->stats.write_busy_num++;
+        return BLE_BUSY;
+    }
+
+    // append to the last packet of the handle first
+    if (p_link->count != 0)
+    {
+        p_packet = notify_packet_at(p_link, p_link->count - 1);
+        if ((p_packet->handle_num == handle_num) && (p_packet->length < payload_max))
+        {
+            copy_len = payload_max - p_packet->length;
+            if (copy_len > length)
+            {
+                copy_len = length;
+            }
+            memcpy(p_packet->data + p_packet->length, p_data, copy_len);
+            p_packet->length += copy_len;
+            p_data += copy_len;
+            length -= copy_len;
+            p_link->stats.coalesce_num++;
+        }
+    }
+
+    while (length != 0)
+    {
+        p_packet = notify_packet_at(p_link, p_link->count);
+        copy_len = (length > payload_max) ? payload_max : length;
+        p_packet->handle_num = handle_num;
+        p_packet->length = copy_len;
+        memcpy(p_packet->data, p_data, copy_len);
+        p_data += copy_len;
+        length -= copy_len;
+        p_link->count++;
+    }
+    p_link->stats.write_num++;
+
+    ble_svcs_notify_queue_process(host_id);
+
+    return BLE_ERR_OK;
+}
+
+
+/** Send the Queued Notifications of a Link while it has Credits
+*/
+void ble_svcs_notify_queue_process(uint8_t host_id)
+{
+    notify_link_t *p_link;
+    notify_packet_t *p_packet;
+    ble_gatt_data_param_t param;
+    ble_err_t status;
+    uint8_t cost;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return;
+    }
+
+    p_link = &g_notify_link[host_id];
+    if (p_link->enable == 0)
+    {
+        return;
+    }
+
+    while (p_link->count != 0)
+    {
+        p_packet = notify_packet_at(p_link, 0);
+        cost = notify_packet_cost(p_link, p_packet);
+
+        taskENTER_CRITICAL();
+        if (p_link->credit < cost)
+        {
+            taskEXIT_CRITICAL();
+            break;
+        }
+        p_link->credit -= cost;
+        taskEXIT_CRITICAL();
+
+        // the BLE stack copies the data in the call
+        param.host_id = host_id;
+        param.handle_num = p_packet->handle_num;
+        param.length = p_packet->length;
+        param.p_data = p_packet->data;
+        status = ble_cmd_gatt_notification(&param);
+
+        if (status != BLE_ERR_OK)
+        {
+            taskENTER_CRITICAL();
+            p_link->credit += cost;
+            taskEXIT_CRITICAL();
+
+            if (status == BLE_BUSY)
+            {
+                // the stack queue is full, send it again on the next completed packets
+                p_link->stats.tx_busy_num++;
+                break;
+            }
+            log_info("<ble_svcs_notify_queue_process> drop, status %d\n", status);
+            p_link->stats.drop_num++;
+        }
+        else
+        {
+            p_link->stats.tx_num++;
+        }
+
+        p_link->head = (p_link->head + 1) % CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM;
+        p_link->count--;
+    }
+
+    if ((p_link->ready_wanted != 0) &&
+            (p_link->ready_len <= (CONFIG_BLE_SVCS_NOTIFY_QUEUE_NUM - p_link->count) * notify_payload_max(host_id)))
+    {
+        p_link->ready_wanted = 0;
+        if (p_link->evt_handler != NULL)
+        {
+            p_link->evt_handler(host_id, BLE_SVCS_NOTIFY_EVT_READY);
+        }
+    }
+}
+
+
+/** Give the Completed ACL Packets of a Connection back as Credits
+*/
+void ble_svcs_notify_queue_tx_completed(uint16_t conn_handle, uint16_t num)
+{
+    notify_link_t *p_link;
+    uint8_t host_id;
+    uint8_t pending;
+
+    for (host_id = 0; host_id < BLE_SUPPORT_NUM_CONN_MAX; host_id++)
+    {
+        p_link = &g_notify_link[host_id];
+
+        taskENTER_CRITICAL();
+        if ((p_link->enable == 0) || (p_link->conn_handle != conn_handle))
+        {
+            taskEXIT_CRITICAL();
+            continue;
+        }
+        // the completed packets count the other ACL data of the link too
+        if ((uint16_t)p_link->credit + num > p_link->credit_num)
+        {
+            p_link->credit = p_link->credit_num;
+        }
+        else
+        {
+            p_link->credit += num;
+        }
+        pending = (p_link->count != 0);
+        taskEXIT_CRITICAL();
+
+        if ((pending != 0) && (p_link->evt_handler != NULL))
+        {
+            p_link->evt_handler(host_id, BLE_SVCS_NOTIFY_EVT_TX_CREDIT);
+        }
+        break;
+    }
+}
+
+
+/** Get the Notification Queue Statistics of a Link
+*/
+ble_err_t ble_svcs_notify_queue_stats_get(uint8_t host_id, ble_svcs_notify_stats_t *p_stats)
+{
+    notify_link_t *p_link;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = &g_notify_link[host_id];
+    *p_stats = p_link->stats;
+    p_stats->queued = p_link->count;
+    p_stats->credit = p_link->credit;
+
+    return BLE_ERR_OK;
+}
@@ -0,0 +1,486 @@
+/************************************************************************
+ *
+ * File Name  : ble_service_tput.c
+ * Description: This file contains the throughput test of BLE links
+ *
+ *
+ ************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "ble_host_cmd.h"
+#include "ble_service_tput.h"
+#include "log.h"
+
+
+/**************************************************************************
+ * BLE Throughput Test Definitions
+ **************************************************************************/
+/** The SDU length field of the K-frame. */
+#define TPUT_SDU_LEN_SIZE           2
+
+/** The latency histogram of linear buckets, the last bucket is the latencies above the range. */
+#define TPUT_LATENCY_RANGE_US       ((uint32_t)CONFIG_BLE_SVCS_TPUT_LATENCY_STEP_US * (CONFIG_BLE_SVCS_TPUT_LATENCY_BUCKET_NUM - 1))
+
+typedef struct
+{
+    ble_svcs_tput_cfg_t cfg;
+    uint8_t  enable;
+    uint8_t  connected;
+    uint8_t  tx_active;
+    uint8_t  tx_built;                      // the pattern of tx_seq is in the frame
+    uint16_t dest_id;
+    uint16_t peer_mtu;
+    uint16_t peer_mps;
+    uint16_t credit;
+    uint32_t tx_seq;
+    uint32_t tx_remaining;
+    uint32_t rx_seq;                        // the next expected sequence number
+    uint32_t rx_first_us;
+    uint32_t rx_last_us;
+    uint16_t rx_first_len;
+    ble_svcs_tput_stats_t stats;
+    uint32_t latency[CONFIG_BLE_SVCS_TPUT_LATENCY_BUCKET_NUM];
+    uint8_t  frame[sizeof(ble_l2cap_data_send_t) + TPUT_SDU_LEN_SIZE + CONFIG_BLE_SVCS_TPUT_PACKET_MAX];
+} tput_link_t;
+
+static tput_link_t g_tput_link[BLE_SUPPORT_NUM_CONN_MAX];
+
+
+/**************************************************************************
+ * BLE Throughput Test Private Functions
+ **************************************************************************/
+static uint8_t *tput_packet_get(tput_link_t *p_link)
+{
+    return &((ble_l2cap_data_send_t *)p_link->frame)->data[TPUT_SDU_LEN_SIZE];
+}
+
+static void tput_u32_put(uint8_t *p_buf, uint32_t value)
+{
+    p_buf[0] = (uint8_t)value;
+    p_buf[1] = (uint8_t)(value >> 8);
+    p_buf[2] = (uint8_t)(value >> 16);
+    p_buf[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t tput_u32_get(const uint8_t *p_buf)
+{
+    return ((uint32_t)p_buf[0] | ((uint32_t)p_buf[1] << 8) | ((uint32_t)p_buf[2] << 16) | ((uint32_t)p_buf[3] << 24));
+}
+
+static uint16_t tput_latency_bucket(uint32_t latency_us)
+{
+    if (latency_us >= TPUT_LATENCY_RANGE_US)
+    {
+        return (CONFIG_BLE_SVCS_TPUT_LATENCY_BUCKET_NUM - 1);
+    }
+    return (uint16_t)(latency_us / CONFIG_BLE_SVCS_TPUT_LATENCY_STEP_US);
+}
+
+static uint32_t tput_latency_percentile(tput_link_t *p_link, uint32_t permille)
+{
+    uint32_t count, rank;
+    uint16_t index;
+
+    count = 0;
+    for (index = 0; index < CONFIG_BLE_SVCS_TPUT_LATENCY_BUCKET_NUM; index++)
+    {
+        count += p_link->latency[index];
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // the smallest bucket of at least permille of the latencies
+    rank = (uint32_t)(((uint64_t)count * permille + 999) / 1000);
+    count = 0;
+    for (index = 0; index < CONFIG_BLE_SVCS_TPUT_LATENCY_BUCKET_NUM; index++)
+    {
+        count += p_link->latency[index];
+        if (count >= rank)
+        {
+            break;
+        }
+    }
+    if (index >= (CONFIG_BLE_SVCS_TPUT_LATENCY_BUCKET_NUM - 1))
+    {
+        return p_link->stats.latency_max_us;
+    }
+
+    return (uint32_t)index * CONFIG_BLE_SVCS_TPUT_LATENCY_STEP_US;
+}
+
+static void tput_packet_build(tput_link_t *p_link)
+{
+    uint8_t *p_packet = tput_packet_get(p_link);
+    uint16_t i;
+
+    tput_u32_put(p_packet, p_link->tx_seq);
+    for (i = BLE_SVCS_TPUT_HEADER_LEN; i < p_link->cfg.packet_len; i++)
+    {
+        p_packet[i] = (uint8_t)(p_link->tx_seq + i);
+    }
+    p_link->tx_built = 1;
+}
+
+static ble_err_t tput_packet_send(uint8_t host_id, tput_link_t *p_link)
+{
+    ble_l2cap_data_send_t *p_frame = (ble_l2cap_data_send_t *)p_link->frame;
+    ble_gatt_data_param_t param;
+    uint8_t *p_packet = tput_packet_get(p_link);
+
+    // the send time of this attempt, the BLE stack copies the packet in the call
+    tput_u32_put(&p_packet[4], p_link->cfg.time_us());
+
+    if (p_link->cfg.path == BLE_SVCS_TPUT_PATH_L2CAP)
+    {
+        p_frame->host_id = host_id;
+        p_frame->dest_id = p_link->dest_id;
+        p_frame->length = TPUT_SDU_LEN_SIZE + p_link->cfg.packet_len;
+        p_frame->data[0] = (uint8_t)(p_link->cfg.packet_len & 0xFF);
+        p_frame->data[1] = (uint8_t)(p_link->cfg.packet_len >> 8);
+        return ble_cmd_l2cap_data_send(p_frame);
+    }
+
+    param.host_id = host_id;
+    param.handle_num = p_link->cfg.handle_num;
+    param.length = p_link->cfg.packet_len;
+    param.p_data = p_packet;
+    return ble_cmd_gatt_notification(&param);
+}
+
+static void tput_packet_receive(tput_link_t *p_link, const uint8_t *p_data, uint16_t length)
+{
+    uint32_t now_us, seq, latency_us;
+    uint16_t i;
+
+    now_us = p_link->cfg.time_us();
+    p_link->stats.rx_packet_num++;
+    if (length < BLE_SVCS_TPUT_HEADER_LEN)
+    {
+        p_link->stats.rx_pattern_err_num++;
+        return;
+    }
+
+    seq = tput_u32_get(p_data);
+    if (seq < p_link->rx_seq)
+    {
+        p_link->stats.rx_order_err_num++;
+        return;
+    }
+    p_link->stats.rx_lost_num += seq - p_link->rx_seq;
+    p_link->rx_seq = seq + 1;
+
+    for (i = BLE_SVCS_TPUT_HEADER_LEN; i < length; i++)
+    {
+        if (p_data[i] != (uint8_t)(seq + i))
+        {
+            p_link->stats.rx_pattern_err_num++;
+            return;
+        }
+    }
+
+    if (p_link->stats.rx_byte_num == 0)
+    {
+        p_link->rx_first_us = now_us;
+        p_link->rx_first_len = length;
+    }
+    p_link->rx_last_us = now_us;
+    p_link->stats.rx_byte_num += length;
+
+    latency_us = now_us - tput_u32_get(&p_data[4]);
+    p_link->latency[tput_latency_bucket(latency_us)]++;
+    if (latency_us > p_link->stats.latency_max_us)
+    {
+        p_link->stats.latency_max_us = latency_us;
+    }
+}
+
+static tput_link_t *tput_link_get(uint8_t host_id)
+{
+    if ((host_id >= BLE_SUPPORT_NUM_CONN_MAX) || (g_tput_link[host_id].enable == 0))
+    {
+        return NULL;
+    }
+    return &g_tput_link[host_id];
+}
+
+
+/**************************************************************************
+ * BLE Throughput Test Public Functions
+ **************************************************************************/
+
+/** Initialize the Throughput Test of a Link
+*/
+ble_err_t ble_svcs_tput_init(uint8_t host_id, const ble_svcs_tput_cfg_t *p_cfg)
+{
+    tput_link_t *p_link;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    if ((p_cfg == NULL) || (p_cfg->time_us == NULL) ||
+            ((p_cfg->path != BLE_SVCS_TPUT_PATH_L2CAP) && (p_cfg->path != BLE_SVCS_TPUT_PATH_NOTIFY)) ||
+            ((p_cfg->path == BLE_SVCS_TPUT_PATH_NOTIFY) && (p_cfg->handle_num == 0)) ||
+            (p_cfg->packet_len < BLE_SVCS_TPUT_HEADER_LEN) || (p_cfg->packet_len > CONFIG_BLE_SVCS_TPUT_PACKET_MAX))
+    {
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+
+    p_link = &g_tput_link[host_id];
+    memset(p_link, 0, offsetof(tput_link_t, frame));
+    p_link->cfg = *p_cfg;
+    p_link->enable = 1;
+
+    return BLE_ERR_OK;
+}
+
+
+/** Connect the Throughput Test Channel
+*/
+ble_err_t ble_svcs_tput_connect(uint8_t host_id)
+{
+    tput_link_t *p_link;
+    ble_l2cap_chan_connect_t param;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = tput_link_get(host_id);
+    if ((p_link == NULL) || (p_link->cfg.path != BLE_SVCS_TPUT_PATH_L2CAP) || (p_link->connected != 0))
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+
+    param.host_id = host_id;
+    param.spsm = BLE_SVCS_TPUT_SPSM;
+    param.mtu = CONFIG_BLE_SVCS_TPUT_MTU;
+
+    return ble_cmd_l2cap_chan_connect(&param);
+}
+
+
+/** Handle an L2CAP Event of the Throughput Test
+*/
+void ble_svcs_tput_l2cap_evt_handle(ble_l2cap_evt_param_t *p_param)
+{
+    ble_l2cap_credit_based_conn_req_rsp_t *p_rsp;
+    tput_link_t *p_link;
+    uint8_t host_id;
+
+    // the event parameters start with the host id
+    host_id = p_param->evt_param.l2cap_data_param.host_id;
+    p_link = tput_link_get(host_id);
+    if ((p_link == NULL) || (p_link->cfg.path != BLE_SVCS_TPUT_PATH_L2CAP))
+    {
+        return;
+    }
+
+    switch (p_param->event)
+    {
+    case LE_L2CAP_EVT_CREDIT_BASED_CONNECT_REQ_RSP:
+        p_rsp = &p_param->evt_param.l2cap_conn_req_rsp;
+        if (p_rsp->result != 0)
+        {
+            log_info("<ble_svcs_tput> connect fail, result 0x%04x\n", p_rsp->result);
+            break;
+        }
+        p_link->dest_id = p_rsp->dest_id;
+        p_link->peer_mtu = p_rsp->mtu;
+        p_link->peer_mps = p_rsp->mps;
+        p_link->credit = p_rsp->init_credits;
+        p_link->connected = 1;
+        break;
+
+    case LE_L2CAP_EVT_DISCONNECT:
+        p_link->connected = 0;
+        p_link->credit = 0;
+        p_link->tx_active = 0;
+        break;
+
+    case LE_L2CAP_EVT_FLOW_CTRL_CREDIT_IND:
+        if ((uint32_t)p_link->credit + p_param->evt_param.l2cap_flow_ctrl_credit_ind.credits > 0xFFFF)
+        {
+            p_link->credit = 0xFFFF;
+        }
+        else
+        {
+            p_link->credit += p_param->evt_param.l2cap_flow_ctrl_credit_ind.credits;
+        }
+        ble_svcs_tput_process(host_id);
+        break;
+
+    case LE_L2CAP_EVT_DATA_RECEIVED:
+        // a test packet is one SDU in one K-frame
+        if ((p_param->evt_param.l2cap_data_param.length < TPUT_SDU_LEN_SIZE) ||
+                ((p_param->evt_param.l2cap_data_param.data[0] | (p_param->evt_param.l2cap_data_param.data[1] << 8)) !=
+                 p_param->evt_param.l2cap_data_param.length - TPUT_SDU_LEN_SIZE))
+        {
+            p_link->stats.rx_packet_num++;
+            p_link->stats.rx_pattern_err_num++;
+            break;
+        }
+        tput_packet_receive(p_link, &p_param->evt_param.l2cap_data_param.data[TPUT_SDU_LEN_SIZE],
+                            p_param->evt_param.l2cap_data_param.length - TPUT_SDU_LEN_SIZE);
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+/** Handle an ATT Event of the Throughput Test
+*/
+void ble_svcs_tput_att_evt_handle(ble_evt_att_param_t *p_param)
+{
+    tput_link_t *p_link;
+
+    p_link = tput_link_get(p_param->host_id);
+    if ((p_link == NULL) || (p_link->cfg.path != BLE_SVCS_TPUT_PATH_NOTIFY))
+    {
+        return;
+    }
+
+    if ((p_param->gatt_role == BLE_GATT_ROLE_CLIENT) &&
+            (p_param->opcode == OPCODE_ATT_HANDLE_VALUE_NOTIFICATION) &&
+            (p_param->handle_num == p_link->cfg.handle_num))
+    {
+        tput_packet_receive(p_link, p_param->data, p_param->length);
+    }
+}
+
+
+/** Start Sending the Test Packets
+*/
+ble_err_t ble_svcs_tput_start(uint8_t host_id)
+{
+    tput_link_t *p_link;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = tput_link_get(host_id);
+    if ((p_link == NULL) || (p_link->tx_active != 0))
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+
+    if (p_link->cfg.path == BLE_SVCS_TPUT_PATH_L2CAP)
+    {
+        if (p_link->connected == 0)
+        {
+            return BLE_ERR_INVALID_STATE;
+        }
+        if ((p_link->cfg.packet_len > p_link->peer_mtu) || (TPUT_SDU_LEN_SIZE + p_link->cfg.packet_len > p_link->peer_mps))
+        {
+            return BLE_ERR_INVALID_PARAMETER;
+        }
+    }
+    else
+    {
+        if (p_link->cfg.packet_len + 3 > bhc_gatt_att_mtu_get(host_id))
+        {
+            return BLE_ERR_INVALID_PARAMETER;
+        }
+    }
+
+    p_link->tx_seq = 0;
+    p_link->tx_built = 0;
+    p_link->tx_remaining = p_link->cfg.packet_num;
+    p_link->tx_active = 1;
+
+    ble_svcs_tput_process(host_id);
+
+    return BLE_ERR_OK;
+}
+
+
+/** Send the Test Packets of a Link while the BLE Stack takes them
+*/
+uint32_t ble_svcs_tput_process(uint8_t host_id)
+{
+    tput_link_t *p_link;
+    ble_err_t status;
+
+    p_link = tput_link_get(host_id);
+    if ((p_link == NULL) || (p_link->tx_active == 0))
+    {
+        return 0;
+    }
+
+    while (p_link->tx_remaining != 0)
+    {
+        if ((p_link->cfg.path == BLE_SVCS_TPUT_PATH_L2CAP) && (p_link->credit == 0))
+        {
+            p_link->stats.tx_stall_num++;
+            return p_link->tx_remaining;
+        }
+
+        if (p_link->tx_built == 0)
+        {
+            tput_packet_build(p_link);
+        }
+
+        status = tput_packet_send(host_id, p_link);
+        if (status == BLE_BUSY)
+        {
+            p_link->stats.tx_busy_num++;
+            return p_link->tx_remaining;
+        }
+        if (status != BLE_ERR_OK)
+        {
+            log_info("<ble_svcs_tput> send fail, status %d\n", status);
+            p_link->tx_active = 0;
+            return p_link->tx_remaining;
+        }
+
+        if (p_link->cfg.path == BLE_SVCS_TPUT_PATH_L2CAP)
+        {
+            p_link->credit--;
+        }
+        p_link->stats.tx_packet_num++;
+        p_link->tx_seq++;
+        p_link->tx_remaining--;
+        p_link->tx_built = 0;
+    }
+
+    p_link->tx_active = 0;
+
+    return 0;
+}
+
+
+/** Get the Throughput Test Statistics of a Link
+*/
+ble_err_t ble_svcs_tput_stats_get(uint8_t host_id, ble_svcs_tput_stats_t *p_stats)
+{
+    tput_link_t *p_link;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = &g_tput_link[host_id];
+    *p_stats = p_link->stats;
+    p_stats->rx_time_us = p_link->rx_last_us - p_link->rx_first_us;
+    if (p_stats->rx_time_us != 0)
+    {
+        // the bytes after the first packet, the first one starts the time
+        p_stats->goodput_bps = (uint32_t)(((uint64_t)(p_link->stats.rx_byte_num - p_link->rx_first_len) * 8 * 1000000) / p_stats->rx_time_us);
+    }
+    p_stats->latency_p50_us = tput_latency_percentile(p_link, 500);
+    p_stats->latency_p90_us = tput_latency_percentile(p_link, 900);
+    p_stats->latency_p99_us = tput_latency_percentile(p_link, 990);
+    p_stats->credit = p_link->credit;
+
+    return BLE_ERR_OK;
+}
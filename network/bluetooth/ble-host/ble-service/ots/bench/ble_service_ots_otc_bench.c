@@ -0,0 +1,333 @@
+/**************************************************************************//**
+ * @file     ble_service_ots_otc_bench.c
+ * @version
+ * @brief    An object through the OTS Object Transfer Channel of a mock link
+ *
+ * Host 0 is the OTS server sending an object by ble_svcs_otc_send_start(),
+ * host 1 is the OTS client receiving it by ble_svcs_otc_recv_start(), both in
+ * RAM stores. A mock BLE stack carries the K-frames:
+ *   ble_cmd_l2cap_data_send(): a K-frame in the host queue, BLE_BUSY if full.
+ *   connection event: some K-frames go to the peer as LE_L2CAP_EVT_DATA_RECEIVED,
+ *                     the peer gives the credits back by LE_L2CAP_EVT_FLOW_CTRL_CREDIT_IND.
+ * The mock checks the K-frames against the credits and the MPS of the peer.
+ *
+ *   cc -O2 -DBLE_SUPPORT_NUM_CONN_MAX=2
+ *      -Inetwork/bluetooth/ble-host/ble-service/common/bench/host
+ *      -Inetwork/bluetooth/ble-host/ble-service/ots/include
+ *      -Inetwork/bluetooth/ble-host/ble-cmd-api/include
+ *      -Inetwork/bluetooth/ble-host/hci/include
+ *      network/bluetooth/ble-host/ble-service/ots/src/ble_service_ots_otc.c
+ *      network/bluetooth/ble-host/ble-service/ots/bench/ble_service_ots_otc_bench.c
+ *      -o ble_service_ots_otc_bench
+ *   ble_service_ots_otc_bench [-s object size] [-p peer mps] [-c credits] [-k frames per event]
+ *                            [-q host queue]
+ *
+ * The exit status is not 0 if the received object is not the sent object.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "ble_l2cap.h"
+#include "ble_service_ots_otc.h"
+
+#define BENCH_SERVER_ID         (0)
+#define BENCH_CLIENT_ID         (1)
+#define BENCH_CID               (0x0040)
+#define BENCH_QUEUE_MAX         (64)
+#define BENCH_FRAME_MAX         (CONFIG_BLE_SVCS_OTC_MPS_MAX)
+#define BENCH_EVENT_MAX         (100000000)
+
+typedef struct
+{
+    uint16_t length;
+    uint8_t  data[BENCH_FRAME_MAX];
+} bench_frame_t;
+
+typedef struct
+{
+    uint32_t size;
+    int mps;
+    int credits;
+    int frames_per_event;
+    int queue_num;
+} bench_cfg_t;
+
+static bench_cfg_t g_cfg = {4 * 1024 * 1024, 247, 10, 6, 8};
+
+/* K-frames of the server to the client */
+static bench_frame_t g_queue[BENCH_QUEUE_MAX];
+static int g_queue_head, g_queue_num;
+static int g_peer_credit;                       // credits the client gave and the server did not use
+static uint32_t g_credit_err, g_mps_err, g_connect_num;
+static int g_send_done, g_recv_done, g_error;
+
+
+/* mock BLE stack */
+void *pvPortMalloc(size_t xWantedSize)
+{
+    return malloc(xWantedSize);
+}
+
+void vPortFree(void *pv)
+{
+    free(pv);
+}
+
+ble_err_t ble_cmd_l2cap_chan_connect(ble_l2cap_chan_connect_t *p_param)
+{
+    g_connect_num++;
+    return (p_param->spsm == BLE_SVCS_OTC_SPSM) ? BLE_ERR_OK : BLE_ERR_INVALID_PARAMETER;
+}
+
+ble_err_t ble_cmd_l2cap_data_send(ble_l2cap_data_send_t *p_param)
+{
+    bench_frame_t *p_frame;
+
+    if ((p_param->host_id != BENCH_SERVER_ID) || (p_param->dest_id != BENCH_CID))
+    {
+        return BLE_ERR_L2CAP_DATA_DEST_ID_UNMATCH;
+    }
+    if (g_queue_num >= g_cfg.queue_num)
+    {
+        return BLE_BUSY;
+    }
+    if (p_param->length > g_cfg.mps)
+    {
+        g_mps_err++;
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+    if (g_peer_credit == 0)
+    {
+        g_credit_err++;
+    }
+    else
+    {
+        g_peer_credit--;
+    }
+
+    p_frame = &g_queue[(g_queue_head + g_queue_num) % BENCH_QUEUE_MAX];
+    p_frame->length = p_param->length;
+    memcpy(p_frame->data, p_param->data, p_param->length);
+    g_queue_num++;
+    return BLE_ERR_OK;
+}
+
+
+static void bench_evt_connected(uint8_t host_id)
+{
+    union
+    {
+        ble_l2cap_evt_param_t param;
+        uint8_t buf[sizeof(ble_l2cap_evt_param_t)];
+    } evt;
+
+    memset(&evt, 0, sizeof(evt));
+    evt.param.event = LE_L2CAP_EVT_CREDIT_BASED_CONNECT_REQ_RSP;
+    evt.param.evt_param.l2cap_conn_req_rsp.host_id = host_id;
+    evt.param.evt_param.l2cap_conn_req_rsp.dest_id = BENCH_CID;
+    evt.param.evt_param.l2cap_conn_req_rsp.mtu = CONFIG_BLE_SVCS_OTC_MTU;
+    evt.param.evt_param.l2cap_conn_req_rsp.mps = (uint16_t)g_cfg.mps;
+    evt.param.evt_param.l2cap_conn_req_rsp.init_credits = (uint16_t)g_cfg.credits;
+    evt.param.evt_param.l2cap_conn_req_rsp.result = 0;
+    ble_svcs_otc_l2cap_evt_handle(&evt.param);
+}
+
+/* a connection event, the client gives a credit back for each received K-frame */
+static int bench_conn_event(void)
+{
+    union
+    {
+        ble_l2cap_evt_param_t param;
+        uint8_t buf[sizeof(ble_l2cap_evt_param_t) + BENCH_FRAME_MAX];
+    } evt;
+    bench_frame_t *p_frame;
+    int num = 0;
+
+    while ((num < g_cfg.frames_per_event) && (g_queue_num != 0))
+    {
+        p_frame = &g_queue[g_queue_head];
+        memset(&evt.param, 0, sizeof(evt.param));
+        evt.param.event = LE_L2CAP_EVT_DATA_RECEIVED;
+        evt.param.evt_param.l2cap_data_param.host_id = BENCH_CLIENT_ID;
+        evt.param.evt_param.l2cap_data_param.psm = BLE_SVCS_OTC_SPSM;
+        evt.param.evt_param.l2cap_data_param.length = p_frame->length;
+        memcpy(evt.param.evt_param.l2cap_data_param.data, p_frame->data, p_frame->length);
+        ble_svcs_otc_l2cap_evt_handle(&evt.param);
+
+        g_queue_head = (g_queue_head + 1) % BENCH_QUEUE_MAX;
+        g_queue_num--;
+        num++;
+    }
+
+    if (num != 0)
+    {
+        g_peer_credit += num;
+        memset(&evt.param, 0, sizeof(evt.param));
+        evt.param.event = LE_L2CAP_EVT_FLOW_CTRL_CREDIT_IND;
+        evt.param.evt_param.l2cap_flow_ctrl_credit_ind.host_id = BENCH_SERVER_ID;
+        evt.param.evt_param.l2cap_flow_ctrl_credit_ind.cid = BENCH_CID;
+        evt.param.evt_param.l2cap_flow_ctrl_credit_ind.credits = (uint16_t)num;
+        ble_svcs_otc_l2cap_evt_handle(&evt.param);
+    }
+    return num;
+}
+
+
+/* application */
+static void bench_evt_handler(uint8_t host_id, ble_svcs_otc_evt_t event)
+{
+    switch (event)
+    {
+    case BLE_SVCS_OTC_EVT_SEND_DONE:
+        g_send_done = 1;
+        break;
+    case BLE_SVCS_OTC_EVT_RECV_DONE:
+        g_recv_done = 1;
+        break;
+    case BLE_SVCS_OTC_EVT_ERROR:
+        printf("host %d transfer error\n", host_id);
+        g_error = 1;
+        break;
+    default:
+        break;
+    }
+}
+
+static void bench_usage(const char *p_name)
+{
+    printf("usage: %s [-s object size] [-p peer mps] [-c credits] [-k frames per event] [-q host queue]\n", p_name);
+}
+
+int main(int argc, char **argv)
+{
+    ble_svcs_otc_ram_obj_t obj_tx, obj_rx;
+    ble_svcs_otc_stats_t stats_tx, stats_rx;
+    struct timespec t0, t1;
+    uint32_t i;
+    double sec;
+    int event, num, idle, ret;
+
+    for (i = 1; i < (uint32_t)argc; i++)
+    {
+        if (i + 1 >= (uint32_t)argc)
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-s") == 0)
+        {
+            g_cfg.size = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-p") == 0)
+        {
+            g_cfg.mps = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            g_cfg.credits = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-k") == 0)
+        {
+            g_cfg.frames_per_event = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            g_cfg.queue_num = atoi(argv[++i]);
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if ((g_cfg.size == 0) || (g_cfg.mps < 23) || (g_cfg.mps > BENCH_FRAME_MAX) || (g_cfg.credits < 1) ||
+            (g_cfg.frames_per_event < 1) || (g_cfg.queue_num < 1) || (g_cfg.queue_num > BENCH_QUEUE_MAX))
+    {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    obj_tx.size = g_cfg.size;
+    obj_tx.p_buf = malloc(g_cfg.size);
+    obj_rx.size = g_cfg.size;
+    obj_rx.p_buf = calloc(1, g_cfg.size);
+    if ((obj_tx.p_buf == NULL) || (obj_rx.p_buf == NULL))
+    {
+        printf("no memory\n");
+        free(obj_tx.p_buf);
+        free(obj_rx.p_buf);
+        return 1;
+    }
+    srand(1);
+    for (i = 0; i < g_cfg.size; i++)
+    {
+        obj_tx.p_buf[i] = (uint8_t)rand();
+    }
+
+    ble_svcs_otc_init(BENCH_SERVER_ID, bench_evt_handler);
+    ble_svcs_otc_init(BENCH_CLIENT_ID, bench_evt_handler);
+    if (ble_svcs_otc_connect(BENCH_CLIENT_ID) != BLE_ERR_OK)
+    {
+        printf("connect fail\n");
+        free(obj_tx.p_buf);
+        free(obj_rx.p_buf);
+        return 1;
+    }
+    bench_evt_connected(BENCH_SERVER_ID);
+    bench_evt_connected(BENCH_CLIENT_ID);
+    g_peer_credit = g_cfg.credits;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if ((ble_svcs_otc_recv_start(BENCH_CLIENT_ID, &ble_svcs_otc_ram_store, &obj_rx, 0, g_cfg.size) != BLE_ERR_OK) ||
+            (ble_svcs_otc_send_start(BENCH_SERVER_ID, &ble_svcs_otc_ram_store, &obj_tx, 0, g_cfg.size) != BLE_ERR_OK))
+    {
+        printf("transfer start fail\n");
+        free(obj_tx.p_buf);
+        free(obj_rx.p_buf);
+        return 1;
+    }
+
+    idle = 0;
+    for (event = 0; (event < BENCH_EVENT_MAX) && !g_error && !(g_send_done && g_recv_done); event++)
+    {
+        num = bench_conn_event();
+        // the application sends again after a BLE_BUSY
+        ble_svcs_otc_process(BENCH_SERVER_ID);
+        idle = (num == 0) ? (idle + 1) : 0;
+        if (idle > 2)
+        {
+            printf("stalled\n");
+            g_error = 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    ble_svcs_otc_stats_get(BENCH_SERVER_ID, &stats_tx);
+    ble_svcs_otc_stats_get(BENCH_CLIENT_ID, &stats_rx);
+    printf("object %u B, peer mtu %d, mps %d, %d credits, %d frames/event, host queue %d\n",
+           (unsigned)g_cfg.size, CONFIG_BLE_SVCS_OTC_MTU, g_cfg.mps, g_cfg.credits,
+           g_cfg.frames_per_event, g_cfg.queue_num);
+    printf("  %d events, bytes/event %.1f, host %.1f MB/s\n",
+           event, (double)g_cfg.size / event, g_cfg.size / sec / 1e6);
+    printf("  tx: sdu %u, frames %u, busy %u, stall %u; rx: sdu %u, frames %u, err %u\n",
+           (unsigned)stats_tx.tx_sdu_num, (unsigned)stats_tx.tx_frame_num, (unsigned)stats_tx.tx_busy_num,
+           (unsigned)stats_tx.tx_stall_num, (unsigned)stats_rx.rx_sdu_num, (unsigned)stats_rx.rx_frame_num,
+           (unsigned)stats_rx.rx_err_num);
+    printf("  frames without credit %u, frames over mps %u\n", (unsigned)g_credit_err, (unsigned)g_mps_err);
+
+    ret = 0;
+    if (g_error || !g_send_done || !g_recv_done || (g_credit_err != 0) || (g_mps_err != 0) ||
+            (memcmp(obj_tx.p_buf, obj_rx.p_buf, g_cfg.size) != 0))
+    {
+        printf("  object error\n");
+        ret = 1;
+    }
+    free(obj_tx.p_buf);
+    free(obj_rx.p_buf);
+    return ret;
+}
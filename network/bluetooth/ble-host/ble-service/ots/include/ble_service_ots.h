@@ -158,7 +158,7 @@ extern const ble_att_param_t att_ots_object_changed_client_charc_configuration;
 #define BLESERVICE_OTS_OBJECT_PROPERTIES_READ_RSP_EVENT                       0x16     /**< OTS characteristic OBJECT_PROPERTIES read response event.*/
 #define BLESERVICE_OTS_OBJECT_PROPERTIES_WRITE_EVENT                          0x17     /**< OTS characteristic OBJECT_PROPERTIES write event.*/
 #define BLESERVICE_OTS_OBJECT_PROPERTIES_WRITE_RSP_EVENT                      0x18     /**< OTS characteristic OBJECT_PROPERTIES write response event.*/
-#define BLESERVICE_OTS_OBJECT_ACTION_CONTROL_POINT_WRITE_EVENT                0x19     /**< OTS characteristic OBJECT_ACTION_CONTROL_POINT write event.*/
+#define BLESERVICE_OTS_OBJECT_ACTION_CONTROL_POINT_WRITE_EVENT                0x19     /**< OTS characteristic OBJECT_ACTION_CONTROL_POINT write event, the application starts the transfer of OACP Read and Write, see @ref service_ots_otcDef.*/
 #define BLESERVICE_OTS_OBJECT_ACTION_CONTROL_POINT_WRITE_RSP_EVENT            0x1a     /**< OTS characteristic OBJECT_ACTION_CONTROL_POINT write response event.*/
 #define BLESERVICE_OTS_OBJECT_ACTION_CONTROL_POINT_INDICATE_CONFIRM_EVENT     0x1b     /**< OTS characteristic OBJECT_ACTION_CONTROL_POINT indicate confirm event.*/
 #define BLESERVICE_OTS_OBJECT_ACTION_CONTROL_POINT_INDICATE_EVENT             0x1c     /**< OTS characteristic OBJECT_ACTION_CONTROL_POINT indicate event.*/
@@ -0,0 +1,240 @@
+#ifndef _BLE_SERVICE_OTS_OTC_H_
+#define _BLE_SERVICE_OTS_OTC_H_
+
+/**************************************************************************//**
+ * @file  ble_service_ots_otc.h
+ * @brief Provide the Object Transfer Channel of OTS.
+*****************************************************************************/
+#include <stdint.h>
+#include "ble_api.h"
+#include "ble_l2cap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @ingroup service_ots_def
+ * @defgroup service_ots_otcDef BLE OTS Object Transfer Channel
+ * @{
+ * @details The object contents of OTS move on an LE credit based L2CAP channel of @ref BLE_SVCS_OTC_SPSM.
+ * An object is sent as SDUs of up to the peer MTU bytes, an SDU is sent as K-frames of up to the peer MPS
+ * bytes and the first K-frame of an SDU starts with the SDU length. A K-frame takes one credit of the peer,
+ * the credits come from @ref LE_L2CAP_EVT_CREDIT_BASED_CONNECT_REQ_RSP and @ref LE_L2CAP_EVT_FLOW_CTRL_CREDIT_IND.
+ * The received K-frames are reassembled and written to the object store as they come, the object is never
+ * held in RAM by the channel.
+ *
+ * The object store is a read and a write callback on an object context, e.g. @ref ble_svcs_otc_ram_store
+ * or a store of the application on the flash.
+ *
+ * The OTS service keeps no objects and starts no transfer, it gives the OACP writes of the client to the
+ * application by @ref BLESERVICE_OTS_OBJECT_ACTION_CONTROL_POINT_WRITE_EVENT. The application checks the
+ * offset and the length of the procedure against its current object, then:
+ * - OACP Read (op code 0x05): indicates the OACP response and calls ble_svcs_otc_send_start().
+ * - OACP Write (op code 0x06): calls ble_svcs_otc_recv_start() and indicates the OACP response, so the
+ *   receive is started before the client sends.
+ *
+ * The L2CAP events of the link are given to ble_svcs_otc_l2cap_evt_handle() in the application task,
+ * the other functions of a link are called in the same task.
+ * @}
+**************************************************************************/
+
+/** The SPSM of the Object Transfer Channel.
+ * @ingroup service_ots_otcDef
+*/
+#define BLE_SVCS_OTC_SPSM                           0x0025
+
+
+/** The SDU MTU of the channel.
+ * @ingroup service_ots_otcDef
+*/
+#ifndef CONFIG_BLE_SVCS_OTC_MTU
+#define CONFIG_BLE_SVCS_OTC_MTU                     512
+#endif
+
+
+/** The maximum K-frame payload sent, the peer MPS is used if it is smaller.
+ * @ingroup service_ots_otcDef
+*/
+#ifndef CONFIG_BLE_SVCS_OTC_MPS_MAX
+#define CONFIG_BLE_SVCS_OTC_MPS_MAX                 247
+#endif
+
+
+/**
+ * @ingroup service_ots_otcDef
+ * @defgroup service_ots_otcEvtDef BLE OTS Object Transfer Channel Events
+ * @{
+*/
+typedef uint8_t ble_svcs_otc_evt_t;
+#define BLE_SVCS_OTC_EVT_CONNECTED                  0x01    /**< The channel is established. */
+#define BLE_SVCS_OTC_EVT_DISCONNECTED               0x02    /**< The channel is disconnected, a transfer in progress is aborted. */
+#define BLE_SVCS_OTC_EVT_SEND_DONE                  0x03    /**< All the data of ble_svcs_otc_send_start() is sent. */
+#define BLE_SVCS_OTC_EVT_RECV_DONE                  0x04    /**< All the data of ble_svcs_otc_recv_start() is written to the store. */
+#define BLE_SVCS_OTC_EVT_ERROR                      0x05    /**< A transfer is aborted by a store error, a BLE stack error or a bad K-frame. */
+/** @} */
+
+
+/** ble_svcs_otc_evt_handler_t
+ * @ingroup service_ots_otcDef
+ * @note This callback receives the Object Transfer Channel events of a link.
+*/
+typedef void (*ble_svcs_otc_evt_handler_t)(uint8_t host_id, ble_svcs_otc_evt_t event);
+
+
+/** Object store callbacks.
+ * @ingroup service_ots_otcDef
+ * @note The callbacks are called in the application task, a read fills all the length.
+*/
+typedef struct
+{
+    ble_err_t (*read)(void *p_ctx, uint32_t offset, uint8_t *p_buf, uint16_t length);            /**< Read object data for sending. */
+    ble_err_t (*write)(void *p_ctx, uint32_t offset, const uint8_t *p_data, uint16_t length);    /**< Write received object data. */
+} ble_svcs_otc_store_t;
+
+
+/** The object context of @ref ble_svcs_otc_ram_store.
+ * @ingroup service_ots_otcDef
+*/
+typedef struct
+{
+    uint8_t  *p_buf;    /**< The object contents. */
+    uint32_t size;      /**< The size of the buffer. */
+} ble_svcs_otc_ram_obj_t;
+
+
+/** The object store of objects in RAM, the object context is a @ref ble_svcs_otc_ram_obj_t.
+ * @ingroup service_ots_otcDef
+*/
+extern const ble_svcs_otc_store_t ble_svcs_otc_ram_store;
+
+
+/** Object Transfer Channel statistics.
+ * @ingroup service_ots_otcDef
+*/
+typedef struct
+{
+    uint32_t tx_sdu_num;        /**< SDUs sent. */
+    uint32_t tx_frame_num;      /**< K-frames sent. */
+    uint32_t tx_busy_num;       /**< K-frames refused by the BLE stack, sent again later. */
+    uint32_t tx_stall_num;      /**< Sends stopped by no credit. */
+    uint32_t rx_sdu_num;        /**< SDUs received. */
+    uint32_t rx_frame_num;      /**< K-frames received. */
+    uint32_t rx_err_num;        /**< K-frames dropped, out of a transfer or not matching the SDU length. */
+    uint16_t credit;            /**< Credits of the peer. */
+    uint16_t peer_mtu;          /**< The SDU MTU of the peer. */
+    uint16_t peer_mps;          /**< The MPS of the peer. */
+} ble_svcs_otc_stats_t;
+
+
+/** Initialize the Object Transfer Channel of a Link
+ *
+ * @ingroup service_ots_otcDef
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[in] evt_handler : the event handler, NULL if not used.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_OK  : Setting success.
+*/
+ble_err_t ble_svcs_otc_init(uint8_t host_id, ble_svcs_otc_evt_handler_t evt_handler);
+
+
+/** Connect the Object Transfer Channel (OTS client)
+ *
+ * @ingroup service_ots_otcDef
+ *
+ * @param[in] host_id : the link's host id.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_INVALID_STATE : The link is not connected or the channel is established.
+ * @retval BLE_ERR_OK  : The request is sent, @ref BLE_SVCS_OTC_EVT_CONNECTED is raised when the channel is established.
+*/
+ble_err_t ble_svcs_otc_connect(uint8_t host_id);
+
+
+/** Handle an L2CAP Event of the Object Transfer Channel
+ *
+ * @ingroup service_ots_otcDef
+ *
+ * @note Give the BLE_APP_L2CAP_EVENT events of the links to it, the channel connection response of
+ *       @ref LE_L2CAP_EVT_CREDIT_BASED_CONNECT_REQ_RSP is taken as the channel of the link.
+ *
+ * @param[in] p_param : the L2CAP event.
+*/
+void ble_svcs_otc_l2cap_evt_handle(ble_l2cap_evt_param_t *p_param);
+
+
+/** Start Sending an Object (OACP Read)
+ *
+ * @ingroup service_ots_otcDef
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[in] p_store : the object store.
+ * @param[in] p_ctx : the object context of the store.
+ * @param[in] offset : the offset of the first byte.
+ * @param[in] length : the number of bytes.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_INVALID_PARAMETER : Invalid parameter.
+ * @retval BLE_ERR_INVALID_STATE : The channel is not established or a send is in progress.
+ * @retval BLE_ERR_OK  : The send is started, @ref BLE_SVCS_OTC_EVT_SEND_DONE is raised when all the data is sent.
+*/
+ble_err_t ble_svcs_otc_send_start(uint8_t host_id, const ble_svcs_otc_store_t *p_store, void *p_ctx, uint32_t offset, uint32_t length);
+
+
+/** Start Receiving an Object (OACP Write)
+ *
+ * @ingroup service_ots_otcDef
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[in] p_store : the object store.
+ * @param[in] p_ctx : the object context of the store.
+ * @param[in] offset : the offset of the first byte.
+ * @param[in] length : the number of bytes.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_INVALID_PARAMETER : Invalid parameter.
+ * @retval BLE_ERR_INVALID_STATE : The channel is not established or a receive is in progress.
+ * @retval BLE_ERR_OK  : The receive is started, @ref BLE_SVCS_OTC_EVT_RECV_DONE is raised when all the data is written.
+*/
+ble_err_t ble_svcs_otc_recv_start(uint8_t host_id, const ble_svcs_otc_store_t *p_store, void *p_ctx, uint32_t offset, uint32_t length);
+
+
+/** Send the K-frames of a Link while it has Credits
+ *
+ * @ingroup service_ots_otcDef
+ *
+ * @note It is called on the credit events, call it again after a BLE_BUSY of the BLE stack.
+ *
+ * @param[in] host_id : the link's host id.
+*/
+void ble_svcs_otc_process(uint8_t host_id);
+
+
+/** Abort the Transfers of a Link
+ *
+ * @ingroup service_ots_otcDef
+ *
+ * @param[in] host_id : the link's host id.
+*/
+void ble_svcs_otc_abort(uint8_t host_id);
+
+
+/** Get the Object Transfer Channel Statistics of a Link
+ *
+ * @ingroup service_ots_otcDef
+ *
+ * @param[in] host_id : the link's host id.
+ * @param[out] p_stats : statistics.
+ *
+ * @retval BLE_ERR_INVALID_HOST_ID : Error host id.
+ * @retval BLE_ERR_OK  : Success.
+*/
+ble_err_t ble_svcs_otc_stats_get(uint8_t host_id, ble_svcs_otc_stats_t *p_stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _BLE_SERVICE_OTS_OTC_H_ */
@@ -0,0 +1,518 @@
+/************************************************************************
+ *
+ * File Name  : ble_service_ots_otc.c
+ * Description: This file contains the Object Transfer Channel of BLE OTS
+ *
+ *
+ ************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "ble_host_cmd.h"
+#include "ble_l2cap.h"
+#include "ble_service_ots_otc.h"
+#include "log.h"
+
+
+/**************************************************************************
+ * BLE OTS Object Transfer Channel Definitions
+ **************************************************************************/
+/** The SDU length field of the first K-frame of an SDU. */
+#define OTC_SDU_LEN_SIZE            2
+
+/** The smallest MTU and MPS of LE credit based channels. */
+#define OTC_MTU_MPS_MIN             23
+
+typedef struct
+{
+    const ble_svcs_otc_store_t *p_store;
+    void     *p_ctx;
+    uint32_t offset;                        // the store offset of the next byte
+    uint32_t remaining;                     // bytes of the transfer not sent or not received
+    uint16_t sdu_remaining;                 // bytes of the current SDU
+    uint8_t  active;
+} otc_transfer_t;
+
+typedef struct
+{
+    ble_svcs_otc_evt_handler_t evt_handler;
+    uint16_t dest_id;
+    uint16_t peer_mtu;
+    uint16_t peer_mps;
+    uint16_t credit;
+    uint8_t  enable;
+    uint8_t  connected;
+    otc_transfer_t tx;
+    otc_transfer_t rx;
+    uint16_t frame_len;                     // the K-frame payload waiting for a credit or the BLE stack
+    uint8_t  frame_sdu_end;                 // the waiting K-frame ends an SDU
+    ble_svcs_otc_stats_t stats;
+    uint8_t  frame[sizeof(ble_l2cap_data_send_t) + CONFIG_BLE_SVCS_OTC_MPS_MAX];
+} otc_link_t;
+
+static otc_link_t g_otc_link[BLE_SUPPORT_NUM_CONN_MAX];
+
+
+/**************************************************************************
+ * BLE OTS Object Transfer Channel Private Functions
+ **************************************************************************/
+static void otc_evt_post(uint8_t host_id, otc_link_t *p_link, ble_svcs_otc_evt_t event)
+{
+    if (p_link->evt_handler != NULL)
+    {
+        p_link->evt_handler(host_id, event);
+    }
+}
+
+static void otc_transfer_stop(otc_link_t *p_link)
+{
+    p_link->tx.active = 0;
+    p_link->rx.active = 0;
+    p_link->frame_len = 0;
+}
+
+static void otc_error(uint8_t host_id, otc_link_t *p_link)
+{
+    otc_transfer_stop(p_link);
+    otc_evt_post(host_id, p_link, BLE_SVCS_OTC_EVT_ERROR);
+}
+
+static uint16_t otc_frame_payload_max(otc_link_t *p_link)
+{
+    if (p_link->peer_mps < CONFIG_BLE_SVCS_OTC_MPS_MAX)
+    {
+        return p_link->peer_mps;
+    }
+    return CONFIG_BLE_SVCS_OTC_MPS_MAX;
+}
+
+// the next K-frame from the store, an SDU starts with its length
+static ble_err_t otc_frame_build(otc_link_t *p_link)
+{
+    ble_l2cap_data_send_t *p_frame = (ble_l2cap_data_send_t *)p_link->frame;
+    otc_transfer_t *p_tx = &p_link->tx;
+    uint16_t payload_max, head_len, data_len;
+    ble_err_t status;
+
+    payload_max = otc_frame_payload_max(p_link);
+    head_len = 0;
+    if (p_tx->sdu_remaining == 0)
+    {
+        p_tx->sdu_remaining = (p_tx->remaining > p_link->peer_mtu) ? p_link->peer_mtu : (uint16_t)p_tx->remaining;
+        p_frame->data[0] = (uint8_t)(p_tx->sdu_remaining & 0xFF);
+        p_frame->data[1] = (uint8_t)(p_tx->sdu_remaining >> 8);
+        head_len = OTC_SDU_LEN_SIZE;
+    }
+
+    data_len = payload_max - head_len;
+    if (data_len > p_tx->sdu_remaining)
+    {
+        data_len = p_tx->sdu_remaining;
+    }
+
+    // the store fills the K-frame in place
+    status = p_tx->p_store->read(p_tx->p_ctx, p_tx->offset, &p_frame->data[head_len], data_len);
+    if (status != BLE_ERR_OK)
+    {
+        return status;
+    }
+
+    p_tx->offset += data_len;
+    p_tx->remaining -= data_len;
+    p_tx->sdu_remaining -= data_len;
+    p_link->frame_len = head_len + data_len;
+    p_link->frame_sdu_end = (p_tx->sdu_remaining == 0);
+
+    return BLE_ERR_OK;
+}
+
+static void otc_frame_receive(uint8_t host_id, otc_link_t *p_link, uint8_t *p_data, uint16_t length)
+{
+    otc_transfer_t *p_rx = &p_link->rx;
+    uint16_t sdu_len;
+
+    p_link->stats.rx_frame_num++;
+    if (p_rx->active == 0)
+    {
+        p_link->stats.rx_err_num++;
+        return;
+    }
+
+    if (p_rx->sdu_remaining == 0)
+    {
+        if (length < OTC_SDU_LEN_SIZE)
+        {
+            p_link->stats.rx_err_num++;
+            otc_error(host_id, p_link);
+            return;
+        }
+        sdu_len = (uint16_t)(p_data[0] | (p_data[1] << 8));
+        if ((sdu_len == 0) || (sdu_len > CONFIG_BLE_SVCS_OTC_MTU) || (sdu_len > p_rx->remaining))
+        {
+            p_link->stats.rx_err_num++;
+            otc_error(host_id, p_link);
+            return;
+        }
+        p_rx->sdu_remaining = sdu_len;
+        p_data += OTC_SDU_LEN_SIZE;
+        length -= OTC_SDU_LEN_SIZE;
+    }
+
+    if (length > p_rx->sdu_remaining)
+    {
+        p_link->stats.rx_err_num++;
+        otc_error(host_id, p_link);
+        return;
+    }
+
+    if ((length != 0) && (p_rx->p_store->write(p_rx->p_ctx, p_rx->offset, p_data, length) != BLE_ERR_OK))
+    {
+        log_info("<ble_svcs_otc> store write fail, offset %u\n", (unsigned)p_rx->offset);
+        otc_error(host_id, p_link);
+        return;
+    }
+
+    p_rx->offset += length;
+    p_rx->remaining -= length;
+    p_rx->sdu_remaining -= length;
+    if (p_rx->sdu_remaining == 0)
+    {
+        p_link->stats.rx_sdu_num++;
+    }
+    if (p_rx->remaining == 0)
+    {
+        p_rx->active = 0;
+        otc_evt_post(host_id, p_link, BLE_SVCS_OTC_EVT_RECV_DONE);
+    }
+}
+
+static ble_err_t otc_transfer_start(otc_transfer_t *p_transfer, const ble_svcs_otc_store_t *p_store, void *p_ctx, uint32_t offset, uint32_t length)
+{
+    if ((p_store == NULL) || (length == 0))
+    {
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+
+    p_transfer->p_store = p_store;
+    p_transfer->p_ctx = p_ctx;
+    p_transfer->offset = offset;
+    p_transfer->remaining = length;
+    p_transfer->sdu_remaining = 0;
+    p_transfer->active = 1;
+
+    return BLE_ERR_OK;
+}
+
+
+/**************************************************************************
+ * BLE OTS Object Transfer Channel RAM Store
+ **************************************************************************/
+static ble_err_t otc_ram_read(void *p_ctx, uint32_t offset, uint8_t *p_buf, uint16_t length)
+{
+    ble_svcs_otc_ram_obj_t *p_obj = (ble_svcs_otc_ram_obj_t *)p_ctx;
+
+    if ((offset > p_obj->size) || (length > p_obj->size - offset))
+    {
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+    memcpy(p_buf, p_obj->p_buf + offset, length);
+
+    return BLE_ERR_OK;
+}
+
+static ble_err_t otc_ram_write(void *p_ctx, uint32_t offset, const uint8_t *p_data, uint16_t length)
+{
+    ble_svcs_otc_ram_obj_t *p_obj = (ble_svcs_otc_ram_obj_t *)p_ctx;
+
+    if ((offset > p_obj->size) || (length > p_obj->size - offset))
+    {
+        return BLE_ERR_INVALID_PARAMETER;
+    }
+    memcpy(p_obj->p_buf + offset, p_data, length);
+
+    return BLE_ERR_OK;
+}
+
+const ble_svcs_otc_store_t ble_svcs_otc_ram_store =
+{
+    otc_ram_read,
+    otc_ram_write,
+};
+
+
+/**************************************************************************
+ * BLE OTS Object Transfer Channel Public Functions
+ **************************************************************************/
+
+/** Initialize the Object Transfer Channel of a Link
+*/
+ble_err_t ble_svcs_otc_init(uint8_t host_id, ble_svcs_otc_evt_handler_t evt_handler)
+{
+    otc_link_t *p_link;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = &g_otc_link[host_id];
+    memset(p_link, 0, offsetof(otc_link_t, frame));
+    p_link->evt_handler = evt_handler;
+    p_link->enable = 1;
+
+    return BLE_ERR_OK;
+}
+
+
+/** Connect the Object Transfer Channel (OTS client)
+*/
+ble_err_t ble_svcs_otc_connect(uint8_t host_id)
+{
+    ble_l2cap_chan_connect_t param;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    if ((g_otc_link[host_id].enable == 0) || (g_otc_link[host_id].connected != 0))
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+
+    param.host_id = host_id;
+    param.spsm = BLE_SVCS_OTC_SPSM;
+    param.mtu = CONFIG_BLE_SVCS_OTC_MTU;
+
+    return ble_cmd_l2cap_chan_connect(&param);
+}
+
+
+/** Handle an L2CAP Event of the Object Transfer Channel
+*/
+void ble_svcs_otc_l2cap_evt_handle(ble_l2cap_evt_param_t *p_param)
+{
+    ble_l2cap_credit_based_conn_req_rsp_t *p_rsp;
+    otc_link_t *p_link;
+    uint8_t host_id;
+
+    // the event parameters start with the host id
+    host_id = p_param->evt_param.l2cap_data_param.host_id;
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return;
+    }
+
+    p_link = &g_otc_link[host_id];
+    if (p_link->enable == 0)
+    {
+        return;
+    }
+
+    switch (p_param->event)
+    {
+    case LE_L2CAP_EVT_CREDIT_BASED_CONNECT_REQ_RSP:
+        p_rsp = &p_param->evt_param.l2cap_conn_req_rsp;
+        if ((p_rsp->result != 0) || (p_rsp->mtu < OTC_MTU_MPS_MIN) || (p_rsp->mps < OTC_MTU_MPS_MIN))
+        {
+            log_info("<ble_svcs_otc> connect fail, result 0x%04x\n", p_rsp->result);
+            break;
+        }
+        p_link->dest_id = p_rsp->dest_id;
+        p_link->peer_mtu = p_rsp->mtu;
+        p_link->peer_mps = p_rsp->mps;
+        p_link->credit = p_rsp->init_credits;
+        p_link->connected = 1;
+        otc_evt_post(host_id, p_link, BLE_SVCS_OTC_EVT_CONNECTED);
+        break;
+
+    case LE_L2CAP_EVT_DISCONNECT:
+        if (p_link->connected != 0)
+        {
+            p_link->connected = 0;
+            p_link->credit = 0;
+            otc_transfer_stop(p_link);
+            otc_evt_post(host_id, p_link, BLE_SVCS_OTC_EVT_DISCONNECTED);
+        }
+        break;
+
+    case LE_L2CAP_EVT_FLOW_CTRL_CREDIT_IND:
+        if ((uint32_t)p_link->credit + p_param->evt_param.l2cap_flow_ctrl_credit_ind.credits > 0xFFFF)
+        {
+            // more than 65535 credits is an error of the peer, keep the maximum
+            p_link->credit = 0xFFFF;
+        }
+        else
+        {
+            p_link->credit += p_param->evt_param.l2cap_flow_ctrl_credit_ind.credits;
+        }
+        ble_svcs_otc_process(host_id);
+        break;
+
+    case LE_L2CAP_EVT_DATA_RECEIVED:
+        if (p_link->connected != 0)
+        {
+            otc_frame_receive(host_id, p_link, p_param->evt_param.l2cap_data_param.data, p_param->evt_param.l2cap_data_param.length);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+/** Start Sending an Object (OACP Read)
+*/
+ble_err_t ble_svcs_otc_send_start(uint8_t host_id, const ble_svcs_otc_store_t *p_store, void *p_ctx, uint32_t offset, uint32_t length)
+{
+    otc_link_t *p_link;
+    ble_err_t status;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = &g_otc_link[host_id];
+    if ((p_link->connected == 0) || (p_link->tx.active != 0))
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+
+    status = otc_transfer_start(&p_link->tx, p_store, p_ctx, offset, length);
+    if (status != BLE_ERR_OK)
+    {
+        return status;
+    }
+    p_link->frame_len = 0;
+
+    ble_svcs_otc_process(host_id);
+
+    return BLE_ERR_OK;
+}
+
+
+/** Start Receiving an Object (OACP Write)
+*/
+ble_err_t ble_svcs_otc_recv_start(uint8_t host_id, const ble_svcs_otc_store_t *p_store, void *p_ctx, uint32_t offset, uint32_t length)
+{
+    otc_link_t *p_link;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = &g_otc_link[host_id];
+    if ((p_link->connected == 0) || (p_link->rx.active != 0))
+    {
+        return BLE_ERR_INVALID_STATE;
+    }
+
+    return otc_transfer_start(&p_link->rx, p_store, p_ctx, offset, length);
+}
+
+
+/** Send the K-frames of a Link while it has Credits
+*/
+void ble_svcs_otc_process(uint8_t host_id)
+{
+    otc_link_t *p_link;
+    ble_l2cap_data_send_t *p_frame;
+    ble_err_t status;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return;
+    }
+
+    p_link = &g_otc_link[host_id];
+    if ((p_link->connected == 0) || (p_link->tx.active == 0))
+    {
+        return;
+    }
+
+    p_frame = (ble_l2cap_data_send_t *)p_link->frame;
+    while ((p_link->frame_len != 0) || (p_link->tx.remaining != 0))
+    {
+        if (p_link->frame_len == 0)
+        {
+            status = otc_frame_build(p_link);
+            if (status != BLE_ERR_OK)
+            {
+                log_info("<ble_svcs_otc> store read fail, offset %u\n", (unsigned)p_link->tx.offset);
+                otc_error(host_id, p_link);
+                return;
+            }
+        }
+
+        if (p_link->credit == 0)
+        {
+            p_link->stats.tx_stall_num++;
+            return;
+        }
+
+        // the BLE stack copies the K-frame in the call
+        p_frame->host_id = host_id;
+        p_frame->dest_id = p_link->dest_id;
+        p_frame->length = p_link->frame_len;
+        status = ble_cmd_l2cap_data_send(p_frame);
+        if (status == BLE_BUSY)
+        {
+            p_link->stats.tx_busy_num++;
+            return;
+        }
+        if (status != BLE_ERR_OK)
+        {
+            log_info("<ble_svcs_otc> send fail, status %d\n", status);
+            otc_error(host_id, p_link);
+            return;
+        }
+
+        p_link->credit--;
+        p_link->stats.tx_frame_num++;
+        if (p_link->frame_sdu_end != 0)
+        {
+            p_link->stats.tx_sdu_num++;
+        }
+        p_link->frame_len = 0;
+    }
+
+    p_link->tx.active = 0;
+    otc_evt_post(host_id, p_link, BLE_SVCS_OTC_EVT_SEND_DONE);
+}
+
+
+/** Abort the Transfers of a Link
+*/
+void ble_svcs_otc_abort(uint8_t host_id)
+{
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return;
+    }
+
+    otc_transfer_stop(&g_otc_link[host_id]);
+}
+
+
+/** Get the Object Transfer Channel Statistics of a Link
+*/
+ble_err_t ble_svcs_otc_stats_get(uint8_t host_id, ble_svcs_otc_stats_t *p_stats)
+{
+    otc_link_t *p_link;
+
+    if (host_id >= BLE_SUPPORT_NUM_CONN_MAX)
+    {
+        return BLE_ERR_INVALID_HOST_ID;
+    }
+
+    p_link = &g_otc_link[host_id];
+    *p_stats = p_link->stats;
+    p_stats->credit = p_link->credit;
+    p_stats->peer_mtu = p_link->peer_mtu;
+    p_stats->peer_mps = p_link->peer_mps;
+
+    return BLE_ERR_OK;
+}
@@ -249,6 +249,11 @@ ble_err_t ble_svcs_trsps_client_read(uint8_t host_id, uint16_t handle_num);
  *
  * @ingroup appTRSPS_App
  *
+ * @note With CONFIG_BLUETOOTH_LE_SERVICE_NOTIFY_QUEUE and ble_svcs_notify_queue_init() called for the link, a notification
+ *       is written to the notification queue: the data is a byte stream coalesced into (ATT_MTU - 3) byte packets,
+ *       @ref BLE_BUSY queues nothing and BLE_SVCS_NOTIFY_EVT_READY is raised when it fits. The queue of the link is
+ *       reset on the disconnection, then the notifications are sent directly until ble_svcs_notify_queue_init().
+ *
  * @param[in] host_id : the link's host id.
  * @param[in] cccd : BLE GATT characteristic cccd value to indicated notification or indication @ref ble_gatt_cccd_val_t .
  * @param[in] handle_num : handle number of write characteristic.
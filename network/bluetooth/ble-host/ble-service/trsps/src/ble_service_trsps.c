@@ -10,6 +10,9 @@
 #include "ble_service_trsps.h"
 #include "ble_profile.h"
 #include "log.h"
+#ifdef CONFIG_BLUETOOTH_LE_SERVICE_NOTIFY_QUEUE
+#include "ble_service_notify.h"
+#endif
 
 /** ble_svcs_trsps_handler
  * @note This callback receives the TRSPS events.
@@ -467,25 +470,15 @@ ble_err_t ble_svcs_trsps_client_send(uint8_t host_id, ble_gatt_write_t type, uin
 ble_err_t ble_svcs_trsps_client_read(uint8_t host_id, uint16_t handle_num)
 {
     ble_err_t status;
-    ble_gatt_read_req_param_t *p_param;
+    ble_gatt_read_req_param_t param;
 
-    p_param = pvPortMalloc(sizeof(ble_gatt_read_req_param_t));
-    if (p_param != NULL)
-    {
-        p_param->host_id = host_id;
-        p_param->handle_num = handle_num;
+    param.host_id = host_id;
+    param.handle_num = handle_num;
 
-        status = ble_cmd_gatt_read_req(p_param);
-        if (status != BLE_ERR_OK) // send to BLE stack
-        {
-            log_info("<TYPE_BLE_GATT_READ_REQ> Send msg to BLE stack fail\n");
-        }
-        vPortFree(p_param);
-    }
-    else
+    status = ble_cmd_gatt_read_req(&param);
+    if (status != BLE_ERR_OK) // send to BLE stack
     {
-        log_info("<TYPE_BLE_GATT_READ_REQ> malloc fail\n");
-        status = BLE_ERR_ALLOC_MEMORY_FAIL;
+        log_info("<TYPE_BLE_GATT_READ_REQ> Send msg to BLE stack fail\n");
     }
 
     return status;
@@ -511,7 +504,16 @@ ble_err_t ble_svcs_trsps_server_send(uint8_t host_id, ble_gatt_cccd_val_t cccd,
     }
     else if (cccd == BLEGATT_CCCD_NOTIFICATION)
     {
+#ifdef CONFIG_BLUETOOTH_LE_SERVICE_NOTIFY_QUEUE
+        // queued and coalesced if the notification queue of the link is initialized
+        status = ble_svcs_notify_queue_write(host_id, handle_num, p_data, length);
+        if (status == BLE_ERR_INVALID_STATE)
+        {
+            status = ble_svcs_data_send(TYPE_BLE_GATT_NOTIFICATION, &param);
+        }
+#else
         status = ble_svcs_data_send(TYPE_BLE_GATT_NOTIFICATION, &param);
+#endif
     }
     else
     {
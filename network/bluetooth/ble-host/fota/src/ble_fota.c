@@ -16,6 +16,7 @@
 #include "ble_fota.h"
 #include "ble_profile.h"
 #include "flashctl.h"
+#include "util_crc32.h"
 
 /**************************************************************************************************
  *    MACROS
@@ -131,20 +132,7 @@ static void ble_fota_system_reboot(void)
 
 static uint32_t ble_fota_crc32checksum(uint32_t flash_addr, uint32_t data_len)
 {
-    uint16_t k;
-    uint32_t i;
-    uint8_t *p_buf = ((uint8_t *)flash_addr);
-    uint32_t chk_sum = ~0, len = data_len;
-
-    for (i = 0; i < len; i ++ )
-    {
-        chk_sum ^= *p_buf++;
-        for (k = 0; k < 8; k ++)
-        {
-            chk_sum = chk_sum & 1 ? (chk_sum >> 1) ^ 0xedb88320 : chk_sum >> 1;
-        }
-    }
-    return ~chk_sum;
+    return util_crc32((const void *)flash_addr, data_len);
 }
 
 /** FOTA timer start to countdown.
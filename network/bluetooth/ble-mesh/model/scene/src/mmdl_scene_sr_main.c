@@ -16,6 +16,7 @@
 #include "mmdl_scene_sr.h"
 #include "mmdl_scene_common.h"
 #include "flashctl.h"
+#include "util_crc32.h"
 
 //=============================================================================
 //                Private Definitions of const value
@@ -62,18 +63,7 @@ static void mmdl_scene_send_register_status(mesh_app_mdl_evt_msg_idc_t *p_evt_ms
 
 static uint32_t scene_data_crc32( uint8_t *p_data, uint32_t data_len)
 {
-    uint16_t k;
-    uint32_t i, chk_sum = ~0, len = data_len;
-
-    for (i = 0; i < len; i ++ )
-    {
-        chk_sum ^= *p_data++;
-        for (k = 0; k < 8; k ++)
-        {
-            chk_sum = chk_sum & 1 ? (chk_sum >> 1) ^ 0xedb88320 : chk_sum >> 1;
-        }
-    }
-    return ~chk_sum;
+    return util_crc32(p_data, data_len);
 }
 
 static uint32_t scene_data_remove_all(void)
@@ -0,0 +1,742 @@
+/**************************************************************************//**
+ * @file     hci_bridge_sim_bench.c
+ * @version
+ * @brief    Benchmark and checks of the hci bridge on the simulated rf mcu
+ *
+ * hosal_rf.c and hci_bridge.c are built in this file with the host FreeRTOS
+ * of the rf mcu sim benchmark, their tasks are threads. hosal rf runs in BLE
+ * controller mode on the DUT instance, a peer instance on the same air
+ * receives the ACL data sent by the bridge and checks the order, the sequence
+ * and the payload:
+ *   rx  : bursts of ACL frames of the controller, every frame must reach the
+ *         data callback in order, in a lent buffer with CONFIG_HOSAL_RF_ZERO_COPY
+ *         and no byte copied, and every lent buffer must be returned.
+ *   tx  : ACL frames built in place by hci_bridge_acl_write(), then the same
+ *         frames by hci_bridge_message_write() which copies them.
+ *   echo: the data callback sends every received frame back by
+ *         hci_bridge_acl_write() in the bridge task.
+ *   async: hci_bridge_acl_write_async() keeps the bridge TX queue full, the
+ *         done callbacks must come in order. A thread writes by
+ *         hci_bridge_acl_write() at the same time, it waits for a free TX
+ *         request.
+ *
+ *   cc -O2 -pthread [-DCONFIG_HOSAL_RF_ZERO_COPY] [-DCONFIG_HOSAL_RF_RX_BATCH]
+ *      -Inetwork/rt569-rf/sim/bench/host -Iplatform/hosal/rt582_hosal/Inc
+ *      -Inetwork/rt569-rf/rt582/include -Inetwork/ruci/include
+ *      -Inetwork/rt569-rf/sim/include -Inetwork/rt569-rf/sim/host
+ *      -Iplatform/hosal/rt582_hosal/Src -Inetwork/bluetooth/hci_bridge/include
+ *      -Inetwork/bluetooth/hci_bridge/src -Iutility/utility/Inc
+ *      network/rt569-rf/sim/Src/rf_mcu_sim.c
+ *      network/bluetooth/hci_bridge/bench/hci_bridge_sim_bench.c -o hci_bridge_sim_bench
+ *   hci_bridge_sim_bench [-n frames] [-r air bit rate] [-m rx|tx|echo|async]
+ *
+ * The exit status is not 0 if a check fails, a run is stuck for more than
+ * BENCH_TIMEOUT_SEC or an unexpected error is logged.
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rf_mcu_sim.h"
+
+/* the target definitions used by hosal_rf.c and hci_bridge.c */
+#define __STATIC_FORCEINLINE            static inline
+#define CommSubsystem_IRQn              (0)
+#define NVIC_SetPriority(irq, prio)     ((void)(irq), (void)(prio))
+#define __disable_irq()                 ((void)0)
+#define ASSERT()                        abort()
+#define E_TASK_PRIORITY_HOSAL           (0)
+#define E_TASK_PRIORITY_OPENTHREAD      (0)
+
+static pthread_mutex_t g_bench_critical;
+
+static void enter_critical_section(void)
+{
+    pthread_mutex_lock(&g_bench_critical);
+}
+
+static void leave_critical_section(void)
+{
+    pthread_mutex_unlock(&g_bench_critical);
+}
+
+/* both files have their own callbacks of these names */
+#define g_hci_evt_cb                    g_rf_hci_evt_cb
+#define g_hci_data_cb                   g_rf_hci_data_cb
+#include "hosal_rf.c"
+#undef g_hci_evt_cb
+#undef g_hci_data_cb
+#include "hci_bridge.c"
+
+#define BENCH_DUT               (0)
+#define BENCH_PEER              (1)
+#define BENCH_AIR               (0)
+#define BENCH_TIMEOUT_SEC       (10)
+#define BENCH_ACL_HANDLE        (0x0001)
+/* the handle of the synchronous writes of the async run */
+#define BENCH_SYNC_HANDLE       (0x0002)
+#define BENCH_HANDLE_NUM        (3)
+#define BENCH_ACL_LEN           (251)
+#define BENCH_HCI_ACL_HDR_LEN   (5)
+#define BENCH_HCI_ACL_SN_HDR_LEN (7)
+/* a frame may wait for its release when the next burst comes */
+#define BENCH_RX_BURST          (HCI_BRIDGE_FRAME_BUFFER_NUM / 2)
+/* more buffers than TX requests, so the async writes get would block */
+#define BENCH_ASYNC_BUF_NUM     (CONFIG_HCI_BRIDGE_TX_QUEUE_NUM + 4)
+/* a synchronous write for every few async writes, the async writer waits
+ * for it, the bridge does not keep a free request for a synchronous writer */
+#define BENCH_SYNC_RATIO        (8)
+
+typedef struct __attribute__((packed))
+{
+    uint32_t seq;
+    uint64_t ts;
+} bench_tag_t;
+
+volatile uint32_t g_bench_log_error_num;
+
+static bool g_echo;
+static struct ble_hci_acl_data_sn_struct g_echo_acl;
+static uint32_t g_rx_sent;
+static volatile uint32_t g_rx_num;
+static volatile uint32_t g_rx_error;
+static volatile uint32_t g_completed_num;
+
+static struct ble_hci_acl_data_sn_struct g_async_acl[BENCH_ASYNC_BUF_NUM];
+static pthread_mutex_t g_async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_async_cond;
+static uint32_t g_async_done;
+static uint32_t g_async_error;
+static uint32_t g_sync_num;
+static uint32_t g_sync_done;
+static uint32_t g_sync_error;
+static uint64_t g_sync_ns_sum;
+static uint64_t g_sync_ns_max;
+
+static volatile uint32_t g_peer_num;
+static volatile uint32_t g_peer_error;
+static uint32_t g_peer_sn;
+/* the payload sequence of the next frame of each handle */
+static uint32_t g_peer_next[BENCH_HANDLE_NUM];
+static uint64_t g_peer_latency_sum;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint8_t bench_pattern(uint32_t seq, uint32_t idx)
+{
+    return (uint8_t)(seq * 7 + idx);
+}
+
+static void bench_timeout(int sig)
+{
+    (void)sig;
+    static const char msg[] = "stuck\n";
+
+    write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    _exit(1);
+}
+
+uint32_t mpcalrftrimread(uint32_t mp_id, uint32_t byte_cnt, uint8_t *p_rx_data)
+{
+    (void)mp_id;
+    memset(p_rx_data, 0, byte_cnt);
+    return 0;
+}
+
+bool rf_common_init_by_fw(RF_FW_LOAD_SELECT fw_select, COMM_SUBSYSTEM_ISR_t isr_func)
+{
+    COMM_SUBSYSTEM_ISR_CONFIG isr_cfg = {0};
+
+    (void)fw_select;
+    isr_cfg.commsubsystem_isr = isr_func;
+    return RfMcu_SysInit(false, NULL, 0, isr_cfg, RF_MCU_INIT_NO_ERROR) == RF_MCU_INIT_NO_ERROR;
+}
+
+/* waits until the count reaches the value, false on BENCH_TIMEOUT_SEC */
+static bool bench_wait(volatile uint32_t *p_count, uint32_t value)
+{
+    uint64_t end = bench_now_ns() + BENCH_TIMEOUT_SEC * 1000000000ULL;
+
+    while (__atomic_load_n(p_count, __ATOMIC_ACQUIRE) < value)
+    {
+        if (bench_now_ns() > end)
+        {
+            return false;
+        }
+        usleep(100);
+    }
+    return true;
+}
+
+/* the payload of a frame: the tag and the pattern of its sequence */
+static void bench_payload_build(uint8_t *p_payload, uint32_t seq)
+{
+    bench_tag_t tag;
+    uint32_t i;
+
+    for (i = sizeof(tag); i < BENCH_ACL_LEN; i++)
+    {
+        p_payload[i] = bench_pattern(seq, i);
+    }
+    tag.seq = seq;
+    tag.ts = bench_now_ns();
+    memcpy(p_payload, &tag, sizeof(tag));
+}
+
+static bool bench_payload_check(const uint8_t *p_payload, uint32_t seq, uint64_t *p_ts)
+{
+    bench_tag_t tag;
+    uint32_t i;
+
+    memcpy(&tag, p_payload, sizeof(tag));
+    if (tag.seq != seq)
+    {
+        return false;
+    }
+    for (i = sizeof(tag); i < BENCH_ACL_LEN; i++)
+    {
+        if (p_payload[i] != bench_pattern(seq, i))
+        {
+            return false;
+        }
+    }
+    *p_ts = tag.ts;
+    return true;
+}
+
+/* the frames sent by the bridge: transport, sequence, handle, length, data.
+ * The payload sequences of a handle start from 0 in every run. */
+static void bench_peer_isr(uint8_t int_status)
+{
+    RF_MCU_RXQ_ERROR rx_error;
+    RF_MCU_RX_CMDQ_ERROR evt_error;
+    uint8_t rx[RF_MCU_SIM_FRAME_SIZE];
+    uint16_t rx_len, sn, handle, len;
+    uint64_t ts;
+
+    RfMcu_InterruptClear(int_status);
+
+    if (int_status & RF_MCU_SIM_INT_RX_DATA)
+    {
+        while ((rx_len = RfMcu_RxQueueRead(rx, &rx_error)) != 0)
+        {
+            memcpy(&sn, &rx[1], 2);
+            memcpy(&handle, &rx[3], 2);
+            memcpy(&len, &rx[5], 2);
+            handle &= 0x0FFF;
+            if ((rx[0] != BLE_TRANSPORT_HCI_ACL_DATA) || (sn != (g_peer_sn & 0xFF))
+                    || (handle == 0) || (handle >= BENCH_HANDLE_NUM) || (len != BENCH_ACL_LEN)
+                    || (rx_len != BENCH_HCI_ACL_SN_HDR_LEN + len)
+                    || (!bench_payload_check(&rx[BENCH_HCI_ACL_SN_HDR_LEN], g_peer_next[handle],
+                                             &ts)))
+            {
+                g_peer_error++;
+            }
+            else
+            {
+                g_peer_next[handle]++;
+                g_peer_latency_sum += bench_now_ns() - ts;
+            }
+            g_peer_sn++;
+            __atomic_store_n(&g_peer_num, g_peer_num + 1, __ATOMIC_RELEASE);
+        }
+    }
+    if (int_status & RF_MCU_SIM_INT_EVENT)
+    {
+        while (RfMcu_EvtQueueRead(rx, &evt_error)) {}
+    }
+}
+
+/* the ACL data of the controller: transport, handle, length, data */
+static int bench_data_cb(uint8_t *p_data, uint16_t data_len)
+{
+    bool in_buffer;
+    uint16_t len;
+    uint64_t ts;
+
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    in_buffer = __rf_buffer_is_lent(p_data);
+#else
+    in_buffer = (p_data >= g_hci_frame.buffPool)
+                && (p_data + data_len <= g_hci_frame.buffPool + sizeof(g_hci_frame.buffPool));
+#endif
+    memcpy(&len, &p_data[3], 2);
+    if ((!in_buffer) || (p_data[0] != BLE_TRANSPORT_HCI_ACL_DATA) || (len != BENCH_ACL_LEN)
+            || (data_len != BENCH_HCI_ACL_HDR_LEN + len)
+            || (!bench_payload_check(&p_data[BENCH_HCI_ACL_HDR_LEN], g_rx_num, &ts)))
+    {
+        g_rx_error++;
+    }
+    else if (g_echo)
+    {
+        /* sent back in the bridge task */
+        g_echo_acl.handle = BENCH_ACL_HANDLE;
+        g_echo_acl.pb_flag = 0;
+        g_echo_acl.bc_flag = 0;
+        g_echo_acl.length = len;
+        memcpy(g_echo_acl.data, &p_data[BENCH_HCI_ACL_HDR_LEN], len);
+        if (hci_bridge_acl_write(&g_echo_acl) != HOSAL_RF_STATUS_SUCCESS)
+        {
+            g_rx_error++;
+        }
+    }
+    __atomic_store_n(&g_rx_num, g_rx_num + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/* the number of completed packets events of the frames on the air */
+static int bench_evt_cb(uint8_t *p_data, uint16_t data_len)
+{
+    uint32_t i;
+
+    if ((data_len >= 4) && (p_data[1] == 0x13))
+    {
+        for (i = 0; (i < p_data[3]) && (4 + i * 4 + 4 <= data_len); i++)
+        {
+            __atomic_fetch_add(&g_completed_num, p_data[6 + i * 4] | (p_data[7 + i * 4] << 8),
+                               __ATOMIC_RELEASE);
+        }
+    }
+    return 0;
+}
+
+/* the events of the last run come after the peer gets the frames, they are
+ * taken before the counters of the next run are reset */
+static bool bench_tx_idle(void)
+{
+    return bench_wait(&g_completed_num, g_peer_num);
+}
+
+static void bench_peer_reset(void)
+{
+    bench_tx_idle();
+    memset(g_peer_next, 0, sizeof(g_peer_next));
+    g_peer_error = 0;
+    g_peer_latency_sum = 0;
+    hci_bridge_stats_reset();
+}
+
+/* the lent buffers are returned after the callbacks */
+static bool bench_lent_idle(void)
+{
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    uint32_t all = (CONFIG_HOSAL_RF_LEND_BUF_NUM == 32) ? 0xFFFFFFFFUL
+                   : ((1UL << CONFIG_HOSAL_RF_LEND_BUF_NUM) - 1);
+    uint64_t end = bench_now_ns() + BENCH_TIMEOUT_SEC * 1000000000ULL;
+
+    while (g_lend_free_mask != all)
+    {
+        if (bench_now_ns() > end)
+        {
+            return false;
+        }
+        usleep(100);
+    }
+#endif
+    return true;
+}
+
+/* pushes the frames of the controller to the DUT, returns the frames/s */
+static double bench_rx_push(uint32_t frame_num)
+{
+    uint8_t rx[BENCH_HCI_ACL_HDR_LEN + BENCH_ACL_LEN];
+    uint16_t handle = BENCH_ACL_HANDLE, len = BENCH_ACL_LEN;
+    uint64_t start;
+    uint32_t k;
+
+    g_rx_sent = 0;
+    g_rx_num = 0;
+    g_rx_error = 0;
+    rx[0] = BLE_TRANSPORT_HCI_ACL_DATA;
+    memcpy(&rx[1], &handle, 2);
+    memcpy(&rx[3], &len, 2);
+
+    start = bench_now_ns();
+    while (g_rx_sent < frame_num)
+    {
+        /* the RF task reads the burst after the interrupts are enabled */
+        RfMcu_InterruptDisableAll();
+        for (k = 0; (k < BENCH_RX_BURST) && (g_rx_sent < frame_num); k++)
+        {
+            bench_payload_build(&rx[BENCH_HCI_ACL_HDR_LEN], g_rx_sent);
+            if (rf_mcu_sim_rx_push(BENCH_DUT, rx, sizeof(rx)) != 0)
+            {
+                break;
+            }
+            g_rx_sent++;
+        }
+        RfMcu_InterruptEnableAll();
+        if (!bench_wait(&g_rx_num, g_rx_sent))
+        {
+            break;
+        }
+    }
+    return g_rx_sent * 1e9 / (bench_now_ns() - start);
+}
+
+static int bench_rx_run(uint32_t frame_num)
+{
+    hci_bridge_stats_t stats;
+    double rate;
+    bool idle;
+
+    bench_tx_idle();
+    hci_bridge_stats_reset();
+    g_echo = false;
+    rate = bench_rx_push(frame_num);
+    idle = bench_lent_idle();
+    hci_bridge_stats_get(&stats);
+
+    printf("rx   %6u frames of %u B in bursts of %u: %9.0f frames/s\r\n", g_rx_sent,
+           BENCH_ACL_LEN, BENCH_RX_BURST, rate);
+    printf("     rx %u error %u, acl %u, copied %u B, dropped %u, lent buffers %s\r\n", g_rx_num,
+           g_rx_error, stats.rx_acl_num, stats.rx_copy_bytes, stats.rx_drop_num,
+           idle ? "returned" : "in use");
+
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    if (stats.rx_copy_bytes != 0)
+#else
+    if (stats.rx_copy_bytes != frame_num * (BENCH_HCI_ACL_HDR_LEN + BENCH_ACL_LEN))
+#endif
+    {
+        return -1;
+    }
+    return ((g_rx_error) || (g_rx_num != frame_num) || (stats.rx_acl_num != frame_num)
+            || (stats.rx_drop_num) || (!idle)) ? -1 : 0;
+}
+
+/* ACL frames built in place, then the same frames copied by the message write */
+static int bench_tx_run(uint32_t frame_num)
+{
+    static struct ble_hci_acl_data_sn_struct acl;
+    static ble_hci_message_t mesg;
+    hci_bridge_stats_t stats;
+    uint64_t start, elapsed[2];
+    uint32_t i, peer_base = g_peer_num, error = 0;
+
+    bench_peer_reset();
+    start = bench_now_ns();
+    for (i = 0; i < frame_num; i++)
+    {
+        acl.handle = BENCH_ACL_HANDLE;
+        acl.pb_flag = 0;
+        acl.bc_flag = 0;
+        acl.length = BENCH_ACL_LEN;
+        bench_payload_build(acl.data, i);
+        if (hci_bridge_acl_write(&acl) != HOSAL_RF_STATUS_SUCCESS)
+        {
+            error++;
+        }
+    }
+    bench_wait(&g_peer_num, peer_base + frame_num);
+    elapsed[0] = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (i = 0; i < frame_num; i++)
+    {
+        mesg.hci_message.hci_acl_data.transport_id = BLE_TRANSPORT_HCI_ACL_DATA;
+        mesg.hci_message.hci_acl_data.handle = BENCH_ACL_HANDLE;
+        mesg.hci_message.hci_acl_data.pb_flag = 0;
+        mesg.hci_message.hci_acl_data.bc_flag = 0;
+        mesg.hci_message.hci_acl_data.length = BENCH_ACL_LEN;
+        bench_payload_build(mesg.hci_message.hci_acl_data.data, frame_num + i);
+        if (hci_bridge_message_write(&mesg) != HOSAL_RF_STATUS_SUCCESS)
+        {
+            error++;
+        }
+    }
+    bench_wait(&g_peer_num, peer_base + frame_num * 2);
+    elapsed[1] = bench_now_ns() - start;
+    hci_bridge_stats_get(&stats);
+
+    printf("tx   %6u frames of %u B: acl write %9.0f frames/s, message write %9.0f frames/s\r\n",
+           frame_num, BENCH_ACL_LEN, frame_num * 1e9 / elapsed[0], frame_num * 1e9 / elapsed[1]);
+    printf("     peer %u error %u, latency avg %.1f us, acl %u, copied %u B, busy %u, "
+           "would block %u, write error %u\r\n", g_peer_num - peer_base, g_peer_error,
+           (g_peer_num - peer_base) ? g_peer_latency_sum / 1e3 / (g_peer_num - peer_base) : 0.0,
+           stats.tx_acl_num, stats.tx_copy_bytes, stats.tx_busy_num, stats.tx_would_block_num,
+           error);
+
+    return ((error) || (g_peer_error) || (g_peer_num - peer_base != frame_num * 2)
+            || (stats.tx_acl_num != frame_num * 2)
+            || (stats.tx_copy_bytes != frame_num * BENCH_ACL_LEN)) ? -1 : 0;
+}
+
+/* the frames of the controller are sent back in the data callback */
+static int bench_echo_run(uint32_t frame_num)
+{
+    hci_bridge_stats_t stats;
+    uint32_t peer_base = g_peer_num;
+    uint64_t start, elapsed;
+    bool idle;
+
+    bench_peer_reset();
+    g_echo = true;
+
+    start = bench_now_ns();
+    bench_rx_push(frame_num);
+    bench_wait(&g_peer_num, peer_base + frame_num);
+    elapsed = bench_now_ns() - start;
+    g_echo = false;
+    idle = bench_lent_idle();
+    hci_bridge_stats_get(&stats);
+
+    printf("echo %6u frames of %u B: %9.0f frames/s, latency avg %.1f us\r\n", frame_num,
+           BENCH_ACL_LEN, frame_num * 1e9 / elapsed,
+           (g_peer_num - peer_base) ? g_peer_latency_sum / 1e3 / (g_peer_num - peer_base) : 0.0);
+    printf("     rx %u error %u, peer %u error %u, busy %u, would block %u\r\n", g_rx_num,
+           g_rx_error, g_peer_num - peer_base, g_peer_error, stats.tx_busy_num,
+           stats.tx_would_block_num);
+
+    return ((g_rx_error) || (g_rx_num != frame_num) || (g_peer_error)
+            || (g_peer_num - peer_base != frame_num) || (stats.rx_drop_num) || (!idle)) ? -1 : 0;
+}
+
+/* called in the bridge task in the queue order */
+static void bench_async_done(struct ble_hci_acl_data_sn_struct *p_acl, int status, void *p_arg)
+{
+    uint32_t seq = (uint32_t)(uintptr_t)p_arg;
+
+    pthread_mutex_lock(&g_async_lock);
+    if ((status != HOSAL_RF_STATUS_SUCCESS) || (seq != g_async_done)
+            || (p_acl != &g_async_acl[seq % BENCH_ASYNC_BUF_NUM]))
+    {
+        g_async_error++;
+    }
+    g_async_done++;
+    pthread_cond_broadcast(&g_async_cond);
+    pthread_mutex_unlock(&g_async_lock);
+}
+
+/* waits until the count is more than the value, false on BENCH_TIMEOUT_SEC */
+static bool bench_async_wait(const uint32_t *p_count, uint32_t value)
+{
+    struct timespec deadline;
+    bool ret = true;
+
+    host_deadline(&deadline, BENCH_TIMEOUT_SEC * 1000);
+    pthread_mutex_lock(&g_async_lock);
+    while ((*p_count <= value) && (ret))
+    {
+        ret = (pthread_cond_timedwait(&g_async_cond, &g_async_lock, &deadline) == 0);
+    }
+    ret = (*p_count > value);
+    pthread_mutex_unlock(&g_async_lock);
+    return ret;
+}
+
+/* the synchronous writes along the async ones, they wait when the bridge TX
+ * queue is full */
+static void *bench_sync_proc(void *arg)
+{
+    static struct ble_hci_acl_data_sn_struct acl;
+    uint64_t start, ns;
+    uint32_t i;
+
+    for (i = 0; i < g_sync_num; i++)
+    {
+        acl.handle = BENCH_SYNC_HANDLE;
+        acl.pb_flag = 0;
+        acl.bc_flag = 0;
+        acl.length = BENCH_ACL_LEN;
+        bench_payload_build(acl.data, i);
+        start = bench_now_ns();
+        if (hci_bridge_acl_write(&acl) != HOSAL_RF_STATUS_SUCCESS)
+        {
+            g_sync_error++;
+        }
+        ns = bench_now_ns() - start;
+        g_sync_ns_sum += ns;
+        g_sync_ns_max = (ns > g_sync_ns_max) ? ns : g_sync_ns_max;
+
+        pthread_mutex_lock(&g_async_lock);
+        g_sync_done++;
+        pthread_cond_broadcast(&g_async_cond);
+        pthread_mutex_unlock(&g_async_lock);
+    }
+    return arg;
+}
+
+/* the async writes keep the bridge TX queue full, a thread writes
+ * synchronously at the same time */
+static int bench_async_run(uint32_t frame_num)
+{
+    struct ble_hci_acl_data_sn_struct *p_acl;
+    hci_bridge_stats_t stats;
+    uint32_t i, done, peer_base = g_peer_num, error = 0;
+    uint64_t start, elapsed;
+    pthread_t sync_thread;
+    int rval;
+
+    bench_peer_reset();
+    g_async_done = 0;
+    g_async_error = 0;
+    g_sync_num = frame_num / BENCH_SYNC_RATIO;
+    g_sync_done = 0;
+    g_sync_error = 0;
+    g_sync_ns_sum = 0;
+    g_sync_ns_max = 0;
+    if (pthread_create(&sync_thread, NULL, bench_sync_proc, NULL) != 0)
+    {
+        return -1;
+    }
+
+    start = bench_now_ns();
+    for (i = 0; (i < frame_num) && (!error); i++)
+    {
+        /* the buffer is free after the done callback of its last write */
+        if ((i >= BENCH_ASYNC_BUF_NUM)
+                && (!bench_async_wait(&g_async_done, i - BENCH_ASYNC_BUF_NUM)))
+        {
+            error++;
+            break;
+        }
+        /* else a free request goes to the async writer first */
+        if ((i >= BENCH_SYNC_RATIO) && (i % BENCH_SYNC_RATIO == 0)
+                && (!bench_async_wait(&g_sync_done, i / BENCH_SYNC_RATIO - 1)))
+        {
+            error++;
+            break;
+        }
+        p_acl = &g_async_acl[i % BENCH_ASYNC_BUF_NUM];
+        p_acl->handle = BENCH_ACL_HANDLE;
+        p_acl->pb_flag = 0;
+        p_acl->bc_flag = 0;
+        p_acl->length = BENCH_ACL_LEN;
+        bench_payload_build(p_acl->data, i);
+        for (;;)
+        {
+            /* the count before the write, a request is freed after it */
+            pthread_mutex_lock(&g_async_lock);
+            done = g_async_done;
+            pthread_mutex_unlock(&g_async_lock);
+            rval = hci_bridge_acl_write_async(p_acl, bench_async_done, (void *)(uintptr_t)i);
+            if (rval != HCI_BRIDGE_TX_WOULD_BLOCK)
+            {
+                break;
+            }
+            /* the sync thread holds one request at most, the others are async */
+            if (!bench_async_wait(&g_async_done, done))
+            {
+                error++;
+                break;
+            }
+        }
+        if (rval != HOSAL_RF_STATUS_SUCCESS)
+        {
+            error++;
+        }
+    }
+    if ((!error) && (frame_num) && (!bench_async_wait(&g_async_done, frame_num - 1)))
+    {
+        error++;
+    }
+    elapsed = bench_now_ns() - start;
+    pthread_join(sync_thread, NULL);
+    bench_wait(&g_peer_num, peer_base + frame_num + g_sync_num);
+    hci_bridge_stats_get(&stats);
+
+    printf("async %5u frames of %u B: %9.0f frames/s, done %u error %u, would block %u\r\n",
+           frame_num, BENCH_ACL_LEN, frame_num * 1e9 / elapsed, g_async_done, g_async_error,
+           stats.tx_would_block_num);
+    printf("     sync %u frames at the same time: write avg %.1f us, max %.1f us, error %u\r\n",
+           g_sync_num, g_sync_num ? g_sync_ns_sum / 1e3 / g_sync_num : 0.0, g_sync_ns_max / 1e3,
+           g_sync_error);
+    printf("     peer %u error %u, acl %u, busy %u\r\n", g_peer_num - peer_base, g_peer_error,
+           stats.tx_acl_num, stats.tx_busy_num);
+
+    return ((error) || (g_async_error) || (g_async_done != frame_num) || (g_sync_error)
+            || (g_peer_error) || (g_peer_num - peer_base != frame_num + g_sync_num)) ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    COMM_SUBSYSTEM_ISR_CONFIG isr_cfg = {0};
+    pthread_mutexattr_t attr;
+    uint32_t frame_num = 10000, bit_rate = 0;
+    const char *p_mode_name = NULL;
+    int opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "n:r:m:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            frame_num = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            bit_rate = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            p_mode_name = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n frames] [-r air bit rate] [-m rx|tx|echo|async]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&g_bench_critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+    host_cond_init(&g_async_cond);
+    signal(SIGALRM, bench_timeout);
+    if ((rf_mcu_sim_init(BENCH_DUT, BENCH_AIR) != 0) || (rf_mcu_sim_init(BENCH_PEER, BENCH_AIR) != 0))
+    {
+        fprintf(stderr, "init fail\n");
+        return 1;
+    }
+    rf_mcu_sim_air_config(BENCH_AIR, bit_rate, 0);
+
+    rf_mcu_sim_select(BENCH_PEER);
+    isr_cfg.commsubsystem_isr = bench_peer_isr;
+    RfMcu_SysInit(false, NULL, 0, isr_cfg, RF_MCU_INIT_NO_ERROR);
+    rf_mcu_sim_select(BENCH_DUT);
+    hosal_rf_init(HOSAL_RF_MODE_BLE_CONTROLLER);
+    hci_bridge_init();
+    hci_bridge_callback_set(HIC_INTERFACE_CALLBACK_TYPE_EVENT, bench_evt_cb);
+    hci_bridge_callback_set(HIC_INTERFACE_CALLBACK_TYPE_DATA, bench_data_cb);
+
+    if ((p_mode_name == NULL) || (strcmp(p_mode_name, "echo") == 0))
+    {
+        alarm(BENCH_TIMEOUT_SEC * 6);
+        ret |= (bench_echo_run(frame_num) != 0);
+    }
+    if ((p_mode_name == NULL) || (strcmp(p_mode_name, "rx") == 0))
+    {
+        alarm(BENCH_TIMEOUT_SEC * 6);
+        ret |= (bench_rx_run(frame_num) != 0);
+    }
+    if ((p_mode_name == NULL) || (strcmp(p_mode_name, "tx") == 0))
+    {
+        alarm(BENCH_TIMEOUT_SEC * 6);
+        ret |= (bench_tx_run(frame_num) != 0);
+    }
+    if ((p_mode_name == NULL) || (strcmp(p_mode_name, "async") == 0))
+    {
+        alarm(BENCH_TIMEOUT_SEC * 6);
+        ret |= (bench_async_run(frame_num) != 0);
+    }
+    alarm(0);
+
+    if (g_bench_log_error_num)
+    {
+        printf("%u errors logged\r\n", g_bench_log_error_num);
+        ret = 1;
+    }
+    return ret;
+}
@@ -22,10 +22,47 @@ typedef enum
 
 
 typedef int (*hci_bridge_callback_t)(uint8_t *p_data, uint16_t data_len);
+/* the ACL data is sent to the RF TX queue, the caller can reuse the buffer */
+typedef void (*hci_bridge_tx_done_t)(struct ble_hci_acl_data_sn_struct *p_acl, int status, void *p_arg);
+
+/* a number of completed packets event, called in the bridge task for each handle */
+typedef void (*hci_bridge_completed_cb_t)(uint16_t conn_handle, uint16_t num);
+
+/* the TX queue is full, retry after a TX done callback */
+#define HCI_BRIDGE_TX_WOULD_BLOCK (-1)
+
+/* per direction frame, byte and copy counters */
+typedef struct
+{
+    uint32_t rx_evt_num;
+    uint32_t rx_acl_num;
+    uint32_t rx_acl_bytes;
+    uint32_t rx_copy_bytes;
+    uint32_t rx_drop_num;
+    uint32_t tx_cmd_num;
+    uint32_t tx_acl_num;
+    uint32_t tx_acl_bytes;
+    uint32_t tx_copy_bytes;
+    uint32_t tx_busy_num;
+    uint32_t tx_would_block_num;
+} hci_bridge_stats_t;
 
 void hci_bridge_init(void);
 void hci_bridge_callback_set(hci_bridge_callback_type_t type, hci_bridge_callback_t pfn_callback);
+/* called before the event callback gets the number of completed packets event */
+void hci_bridge_completed_callback_set(hci_bridge_completed_cb_t pfn_callback);
 int hci_bridge_message_write(ble_hci_message_t *pmesg);
+/* send the ACL data built in place, the transport id and the sequence are filled by the bridge */
+int hci_bridge_acl_write(struct ble_hci_acl_data_sn_struct *p_acl);
+/*
+ * Queues the ACL data without waiting, the bridge task sends the queued data
+ * in order when the RF TX queue has space. The buffer must be kept until
+ * done_cb, which is called in the bridge task.
+ * return: 0, or HCI_BRIDGE_TX_WOULD_BLOCK if the bridge TX queue is full
+ */
+int hci_bridge_acl_write_async(struct ble_hci_acl_data_sn_struct *p_acl, hci_bridge_tx_done_t done_cb, void *p_arg);
+void hci_bridge_stats_get(hci_bridge_stats_t *p_stats);
+void hci_bridge_stats_reset(void);
 
 #endif // 1_HCI_BRIDGE_H_
 
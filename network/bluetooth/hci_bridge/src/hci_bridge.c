@@ -12,6 +12,7 @@
 /**************************************************************************************************
  *    INCLUDES
  *************************************************************************************************/
+#include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -20,6 +21,7 @@
 #include "hosal_rf.h"
 #include "log.h"
 #include "queue.h"
+#include "semphr.h"
 #include "task.h"
 /**************************************************************************************************
  *    MACROS
@@ -28,8 +30,14 @@
 /**************************************************************************************************
  *    CONSTANTS AND DEFINES
  *************************************************************************************************/
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+/* the frame data is the buffer lent by hosal rf */
+#define HCI_BRIDGE_FRAME_BUFFER_NUM CONFIG_HOSAL_RF_LEND_BUF_NUM
+#define HCI_BRIDGE_FRAME_MAX_SIZE   0
+#else
 #define HCI_BRIDGE_FRAME_BUFFER_NUM 12
 #define HCI_BRIDGE_FRAME_MAX_SIZE   (sizeof(ble_hci_message_t))
+#endif
 
 typedef struct {
     utils_dlist_t dlist;
@@ -37,6 +45,22 @@ typedef struct {
     uint8_t* pdata;
 } hci_rx_msg_t;
 
+#ifndef CONFIG_HCI_BRIDGE_TX_QUEUE_NUM
+#define CONFIG_HCI_BRIDGE_TX_QUEUE_NUM 8
+#endif
+
+/* the bound of a synchronous ACL write wait, it checks again after it */
+#ifndef CONFIG_HCI_BRIDGE_TX_WAIT_MS
+#define CONFIG_HCI_BRIDGE_TX_WAIT_MS 10
+#endif
+
+typedef struct {
+    utils_dlist_t dlist;
+    struct ble_hci_acl_data_sn_struct* p_acl;
+    hci_bridge_tx_done_t done_cb;
+    void* p_arg;
+} hci_tx_req_t;
+
 #define HCI_BRIDGE_ALIGHNED_FRAME_SIZE ((sizeof(hci_rx_msg_t) + 3) & 0xfffffffc)
 #define HCI_BRIDGE_TOTAL_FRAME_SIZE                                            \
     (HCI_BRIDGE_ALIGHNED_FRAME_SIZE + HCI_BRIDGE_FRAME_MAX_SIZE)
@@ -45,6 +69,9 @@ typedef struct {
     utils_dlist_t rxFrameList;
     utils_dlist_t rxEventList;
     utils_dlist_t frameList;
+    utils_dlist_t txPendList;
+    utils_dlist_t txFreeList;
+    hci_tx_req_t txReq[CONFIG_HCI_BRIDGE_TX_QUEUE_NUM];
     uint32_t dbgRxFrameNum;
     uint8_t buffPool[HCI_BRIDGE_TOTAL_FRAME_SIZE * HCI_BRIDGE_FRAME_BUFFER_NUM];
 } hci_bridge_frame_t;
@@ -54,6 +81,7 @@ typedef enum {
 
     HIC_INTERFACE_EVENT_STATE_HCI_EVT = 0x00000002,
     HIC_INTERFACE_EVENT_STATE_HCI_DATA = 0x00000004,
+    HIC_INTERFACE_EVENT_STATE_HCI_TX = 0x00000008,
 
     HIC_INTERFACE_EVENT_STATE_ALL = 0xffffffff,
 } hci_bridge_event_t;
@@ -80,7 +108,11 @@ static hci_bridge_frame_t g_hci_frame;
 static hci_bridge_event_t g_hci_evt_var;
 static hci_bridge_callback_t g_hci_evt_cb;
 static hci_bridge_callback_t g_hci_data_cb;
+static hci_bridge_completed_cb_t g_hci_completed_cb;
 static struct ble_hci_acl_data_sn_struct ghci_message_tx_data;
+static hci_bridge_stats_t g_hci_stats;
+static SemaphoreHandle_t g_tx_sync_sem;
+static StaticSemaphore_t g_tx_sync_sem_buf;
 
 /**************************************************************************************************
  *    LOCAL FUNCTIONS
@@ -105,6 +137,9 @@ static void __hci_data(hci_bridge_event_t evt) {
         if (pframe) {
             if (g_hci_data_cb)
                 g_hci_data_cb(pframe->pdata, pframe->len);
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            hosal_rf_buffer_release(pframe->pdata);
+#endif
 
             enter_critical_section();
             utils_dlist_add_tail(&pframe->dlist, &g_hci_frame.frameList);
@@ -113,6 +148,24 @@ static void __hci_data(hci_bridge_event_t evt) {
     } while (pframe);
 }
 
+/* number of completed packets: 0x04 0x13 len num_handles {handle, num}... */
+static void __hci_completed(const uint8_t* pdata, uint16_t len) {
+    uint8_t num_handles;
+
+    if (g_hci_completed_cb == NULL || len < 4 || pdata[1] != 0x13) {
+        return;
+    }
+    num_handles = pdata[3];
+    if (len < 4 + num_handles * 4) {
+        return;
+    }
+    for (uint8_t i = 0; i < num_handles; i++) {
+        const uint8_t* p = pdata + 4 + i * 4;
+
+        g_hci_completed_cb((p[0] | (p[1] << 8)) & 0x0fff, p[2] | (p[3] << 8));
+    }
+}
+
 static void __hci_evt(hci_bridge_event_t evt) {
     hci_rx_msg_t* pframe;
 
@@ -132,8 +185,13 @@ static void __hci_evt(hci_bridge_event_t evt) {
         leave_critical_section();
 
         if (pframe) {
+            /* parsed first, the event callback may reuse the frame */
+            __hci_completed(pframe->pdata, pframe->len);
             if (g_hci_evt_cb)
                 g_hci_evt_cb(pframe->pdata, pframe->len);
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            hosal_rf_buffer_release(pframe->pdata);
+#endif
 
             enter_critical_section();
             utils_dlist_add_tail(&pframe->dlist, &g_hci_frame.frameList);
@@ -151,15 +209,127 @@ static void __hci_signal(void) {
     }
 }
 
+/*
+ * Sends the pending ACL data in order until the RF TX queue is full.
+ * Only the bridge task sends ACL data, so the sequence follows the queue order.
+ * return: true if some requests are still pending
+ */
+static bool __hci_tx(void) {
+    struct ble_hci_acl_data_sn_struct* p_acl;
+    hci_tx_req_t* preq;
+    int rval;
+
+    for (;;) {
+        preq = NULL;
+        enter_critical_section();
+        if (!utils_dlist_empty(&g_hci_frame.txPendList)) {
+            preq = (hci_tx_req_t*)g_hci_frame.txPendList.next;
+        }
+        leave_critical_section();
+
+        if (preq == NULL) {
+            return false;
+        }
+
+        /* the sequenced ACL header is filled in place */
+        p_acl = preq->p_acl;
+        p_acl->transport_id = 0x02;
+        p_acl->sequence = g_tx_sn;
+        rval = hosal_rf_write_tx_data((uint8_t*)p_acl,
+                                      p_acl->length + 1 /*transport*/
+                                          + 2 /* sequence */ + 2 /*handle*/
+                                          + 2 /*length*/);
+        if (rval != HOSAL_RF_STATUS_SUCCESS) {
+            g_hci_stats.tx_busy_num++;
+            return true;
+        }
+        g_tx_sn++;
+
+        g_hci_stats.tx_acl_num++;
+        g_hci_stats.tx_acl_bytes += p_acl->length;
+
+        enter_critical_section();
+        utils_dlist_del(&preq->dlist);
+        utils_dlist_add_tail(&preq->dlist, &g_hci_frame.txFreeList);
+        leave_critical_section();
+
+        if (preq->done_cb) {
+            preq->done_cb(p_acl, HOSAL_RF_STATUS_SUCCESS, preq->p_arg);
+        }
+        /* wake a synchronous writer, its data is sent or a request is free */
+        xSemaphoreGive(g_tx_sync_sem);
+    }
+}
+
 static void __hci_proc(void* pvParameters) {
     hci_bridge_event_t sevent = HIC_INTERFACE_EVENT_STATE_NONE;
+    bool tx_pending = false;
+
     for (;;) {
-        if (ulTaskNotifyTake(pdFALSE, portMAX_DELAY) != 0) {
+        /* retry the pending TX every tick if no TX done or completed packets event */
+        if (ulTaskNotifyTake(pdFALSE, tx_pending ? 1 : portMAX_DELAY) != 0) {
             HCI_BRIDGE_GET_NOTIFY(sevent);
             __hci_evt(sevent);
             __hci_data(sevent);
         }
+        tx_pending = __hci_tx();
+    }
+}
+
+static int __tx_done_cb(void* p_arg) {
+    HCI_BRIDGE_NOTIFY(HIC_INTERFACE_EVENT_STATE_HCI_TX);
+    return 0;
+}
+
+static void __acl_sync_done(struct ble_hci_acl_data_sn_struct* p_acl,
+                            int status, void* p_arg) {
+    *(volatile bool*)p_arg = true;
+}
+
+/*
+ * Waits until a TX request is sent. The semaphore may be taken by another
+ * waiter, so the wait is bounded and the caller checks again.
+ * return: true if a notification of the bridge task is taken
+ */
+static bool __acl_wait(void) {
+    if (xTaskGetCurrentTaskHandle() != g_hci_taskHandle) {
+        xSemaphoreTake(g_tx_sync_sem,
+                       pdMS_TO_TICKS(CONFIG_HCI_BRIDGE_TX_WAIT_MS));
+        return false;
+    }
+
+    /* called in a bridge callback, the bridge task sends it here */
+    if (__hci_tx()) {
+        return (ulTaskNotifyTake(pdFALSE,
+                                 pdMS_TO_TICKS(CONFIG_HCI_BRIDGE_TX_WAIT_MS))
+                != 0);
+    }
+    return false;
+}
+
+/* queue the ACL data and wait for it is sent */
+static int __acl_send(struct ble_hci_acl_data_sn_struct* p_acl) {
+    volatile bool done = false;
+    bool notified = false;
+    int rval;
+
+    while ((rval = hci_bridge_acl_write_async(p_acl, __acl_sync_done,
+                                              (void*)&done))
+           == HCI_BRIDGE_TX_WOULD_BLOCK) {
+        notified |= __acl_wait();
+    }
+    if (rval == HOSAL_RF_STATUS_SUCCESS) {
+        while (!done) {
+            notified |= __acl_wait();
+        }
     }
+
+    if (notified) {
+        /* the events of the taken notification are handled after the callback */
+        xTaskNotifyGive(g_hci_taskHandle);
+    }
+
+    return rval;
 }
 
 static int __evt_cb(void* p_arg) {
@@ -176,12 +346,18 @@ static int __evt_cb(void* p_arg) {
         }
         leave_critical_section();
 
+        pmesg = (ble_hci_message_t*)(p_arg);
         if (p) {
-            pmesg = (ble_hci_message_t*)(p_arg);
             data_len = pmesg->hci_message.hci_event.length + 3;
 
             p->len = data_len;
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            p->pdata = (uint8_t*)pmesg;
+#else
             memcpy(p->pdata, pmesg, data_len);
+            g_hci_stats.rx_copy_bytes += data_len;
+#endif
+            g_hci_stats.rx_evt_num++;
 
             enter_critical_section();
             utils_dlist_add_tail(&p->dlist, &g_hci_frame.rxEventList);
@@ -198,14 +374,23 @@ static int __evt_cb(void* p_arg) {
                 ret = 1;
             } else if (p->pdata[1] == 0x05) {
                 ret = 1;
+            } else if (p->pdata[1] == 0x13) {
+                /* number of completed packets, the controller has free buffers */
+                HCI_BRIDGE_NOTIFY(HIC_INTERFACE_EVENT_STATE_HCI_TX);
             }
+        } else {
+            g_hci_stats.rx_drop_num++;
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            hosal_rf_buffer_release(pmesg);
+#endif
         }
     } while (0);
 
     return ret;
 }
 
-static int __data_cb(void* p_arg) {
+/* queue the ACL data for the bridge task, return: false if dropped */
+static bool __data_enqueue(void* p_arg) {
     hci_rx_msg_t* p = NULL;
     uint16_t data_len;
     ble_hci_message_t* pmesg;
@@ -217,21 +402,53 @@ static int __data_cb(void* p_arg) {
         }
         leave_critical_section();
 
+        pmesg = (ble_hci_message_t*)(p_arg);
         if (p) {
-            pmesg = (ble_hci_message_t*)(p_arg);
             data_len = pmesg->hci_message.hci_acl_data.length + 5;
             p->len = data_len;
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            p->pdata = (uint8_t*)pmesg;
+#else
             memcpy(p->pdata, pmesg, data_len);
+            g_hci_stats.rx_copy_bytes += data_len;
+#endif
+            g_hci_stats.rx_acl_num++;
+            g_hci_stats.rx_acl_bytes += pmesg->hci_message.hci_acl_data.length;
 
             enter_critical_section();
             utils_dlist_add_tail(&p->dlist, &g_hci_frame.rxFrameList);
             leave_critical_section();
-
-            HCI_BRIDGE_NOTIFY(HIC_INTERFACE_EVENT_STATE_HCI_DATA);
+        } else {
+            g_hci_stats.rx_drop_num++;
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            hosal_rf_buffer_release(pmesg);
+#endif
         }
     } while (0);
+    return (p != NULL);
+}
+
+static int __data_cb(void* p_arg) {
+    if (__data_enqueue(p_arg)) {
+        HCI_BRIDGE_NOTIFY(HIC_INTERFACE_EVENT_STATE_HCI_DATA);
+    }
+    return 0;
+}
+
+#ifndef CONFIG_HOSAL_RF_ZERO_COPY
+/* a burst of ACL data, the bridge task is notified once */
+static int __data_batch_cb(hosal_rf_rx_frame_t* p_frames, uint32_t num) {
+    bool queued = false;
+
+    for (uint32_t i = 0; i < num; i++) {
+        queued |= __data_enqueue(p_frames[i].p_data);
+    }
+    if (queued) {
+        HCI_BRIDGE_NOTIFY(HIC_INTERFACE_EVENT_STATE_HCI_DATA);
+    }
     return 0;
 }
+#endif
 
 /**************************************************************************************************
  *    GLOBAL FUNCTIONS
@@ -239,14 +456,22 @@ static int __data_cb(void* p_arg) {
 void hci_bridge_init(void) {
     hci_rx_msg_t* pframe = NULL;
     memset(&g_hci_frame, 0, offsetof(hci_bridge_frame_t, buffPool));
+    memset(&g_hci_stats, 0, sizeof(g_hci_stats));
 
     enter_critical_section();
     utils_dlist_init(&g_hci_frame.frameList);
     utils_dlist_init(&g_hci_frame.rxFrameList);
     utils_dlist_init(&g_hci_frame.rxEventList);
+    utils_dlist_init(&g_hci_frame.txPendList);
+    utils_dlist_init(&g_hci_frame.txFreeList);
+    for (int i = 0; i < CONFIG_HCI_BRIDGE_TX_QUEUE_NUM; i++) {
+        utils_dlist_add_tail(&g_hci_frame.txReq[i].dlist,
+                             &g_hci_frame.txFreeList);
+    }
     for (int i = 0; i < HCI_BRIDGE_FRAME_BUFFER_NUM; i++) {
         pframe = (hci_rx_msg_t*)(g_hci_frame.buffPool
                                  + (HCI_BRIDGE_TOTAL_FRAME_SIZE * i));
+        /* zero copy: pdata is set to the lent buffer on receiving */
         pframe->pdata = ((uint8_t*)pframe) + HCI_BRIDGE_ALIGHNED_FRAME_SIZE;
         utils_dlist_add_tail(&pframe->dlist, &g_hci_frame.frameList);
     }
@@ -254,6 +479,12 @@ void hci_bridge_init(void) {
 
     hosal_rf_callback_set(HOSAL_RF_BLE_EVENT_CALLBACK, __evt_cb, NULL);
     hosal_rf_callback_set(HOSAL_RF_BLE_RX_CALLBACK, __data_cb, NULL);
+#ifndef CONFIG_HOSAL_RF_ZERO_COPY
+    hosal_rf_rx_batch_callback_set(HOSAL_RF_BLE_RX_CALLBACK, __data_batch_cb);
+#endif
+    hosal_rf_callback_set(HOSAL_RF_BLE_TX_CALLBACK, __tx_done_cb, NULL);
+
+    g_tx_sync_sem = xSemaphoreCreateBinaryStatic(&g_tx_sync_sem_buf);
 
     xTaskCreate(__hci_proc, "bridge-hci", 512, NULL, E_TASK_PRIORITY_OPENTHREAD,
                 &g_hci_taskHandle);
@@ -270,10 +501,13 @@ void hci_bridge_callback_set(hci_bridge_callback_type_t type,
     }
 }
 
+void hci_bridge_completed_callback_set(hci_bridge_completed_cb_t pfn_callback) {
+    g_hci_completed_cb = pfn_callback;
+}
+
 int hci_bridge_message_write(ble_hci_message_t* pmesg) {
     int rval = 0;
     uint8_t transport_id, hci_command_length;
-    uint16_t hci_acl_data_length;
 
     transport_id = pmesg->hci_message.ble_hci_array[0];
 
@@ -293,12 +527,11 @@ int hci_bridge_message_write(ble_hci_message_t* pmesg) {
                         break;
                     }
                 } while (rval != HOSAL_RF_STATUS_SUCCESS);
+                g_hci_stats.tx_cmd_num++;
                 break;
 
             /*HCI ACL Data*/
             case 0x02:
-                ghci_message_tx_data.transport_id = 0x02;
-                ghci_message_tx_data.sequence = g_tx_sn;
                 ghci_message_tx_data.handle =
                     pmesg->hci_message.hci_acl_data.handle;
                 ghci_message_tx_data.pb_flag =
@@ -310,15 +543,9 @@ int hci_bridge_message_write(ble_hci_message_t* pmesg) {
                 memcpy(ghci_message_tx_data.data,
                        pmesg->hci_message.hci_acl_data.data,
                        ghci_message_tx_data.length);
+                g_hci_stats.tx_copy_bytes += ghci_message_tx_data.length;
 
-                hci_acl_data_length = pmesg->hci_message.hci_acl_data.length
-                                      + 1 /*transport*/ + 2 /* sequence */
-                                      + 2 /*handle*/ + 2 /*length*/;
-                do {
-                    rval = hosal_rf_write_tx_data(
-                        (uint8_t*)&ghci_message_tx_data, hci_acl_data_length);
-                } while (rval != HOSAL_RF_STATUS_SUCCESS);
-                g_tx_sn++;
+                rval = __acl_send(&ghci_message_tx_data);
                 break;
 
             default: break;
@@ -327,4 +554,41 @@ int hci_bridge_message_write(ble_hci_message_t* pmesg) {
     } while (0);
 
     return rval;
-}
\ No newline at end of file
+}
+
+int hci_bridge_acl_write(struct ble_hci_acl_data_sn_struct* p_acl) {
+    return __acl_send(p_acl);
+}
+
+int hci_bridge_acl_write_async(struct ble_hci_acl_data_sn_struct* p_acl,
+                               hci_bridge_tx_done_t done_cb, void* p_arg) {
+    hci_tx_req_t* preq = NULL;
+
+    enter_critical_section();
+    if (!utils_dlist_empty(&g_hci_frame.txFreeList)) {
+        preq = (hci_tx_req_t*)g_hci_frame.txFreeList.next;
+        utils_dlist_del(&preq->dlist);
+        preq->p_acl = p_acl;
+        preq->done_cb = done_cb;
+        preq->p_arg = p_arg;
+        utils_dlist_add_tail(&preq->dlist, &g_hci_frame.txPendList);
+    }
+    leave_critical_section();
+
+    if (preq == NULL) {
+        g_hci_stats.tx_would_block_num++;
+        return HCI_BRIDGE_TX_WOULD_BLOCK;
+    }
+
+    HCI_BRIDGE_NOTIFY(HIC_INTERFACE_EVENT_STATE_HCI_TX);
+    return HOSAL_RF_STATUS_SUCCESS;
+}
+
+void hci_bridge_stats_get(hci_bridge_stats_t* p_stats) {
+    *p_stats = g_hci_stats;
+    p_stats->rx_drop_num += hosal_rf_buffer_drop_count();
+}
+
+void hci_bridge_stats_reset(void) {
+    memset(&g_hci_stats, 0, sizeof(g_hci_stats));
+}
@@ -27,6 +27,8 @@
 #include "ot_ota_handler.h"
 #include "queue.h"
 #include "timers.h"
+#include "util_bitmap.h"
+#include "util_crc32.h"
 #include "util_string.h"
 
 //=============================================================================
@@ -39,6 +41,9 @@ unsigned int ota_debug_flags = 0;
             printf(args, ##__VA_ARGS__);                                       \
     } while (0);
 
+/* bytes of OTA image CRC calculated in one critical section */
+#define OTA_CRC_CHUNK_SIZE 64
+
 //=============================================================================
 //                Private ENUM
 //=============================================================================
@@ -86,35 +91,46 @@ static bool need_reboot = true;
 static uint8_t g_ota_response_k = 2;
 static uint8_t g_ota_response_c = 0;
 static uint16_t g_resp_table[OTA_RESPONSE_TABLE_SIZE];
+/* the CRC of the received image, it's cleared when the image flash is changed */
+static uint32_t g_ota_crc_cache_len = 0;
+static uint32_t g_ota_crc_cache = 0;
 
 //=============================================================================
 //                Functions
 //=============================================================================
+static void crc32checksum_yield(void) {
+    /* let the pending interrupts (e.g. radio) run between two chunks */
+    leave_critical_section();
+    enter_critical_section();
+}
+
+static void ota_crc_cache_clear(void) {
+    g_ota_crc_cache_len = 0;
+}
+
 uint32_t crc32checksum(uint32_t flash_addr, uint32_t data_len) {
-    uint16_t k;
-    uint32_t i;
-    uint8_t* buf = ((uint8_t*)flash_addr);
-    uint32_t chkSum = ~0, len = data_len;
+    uint32_t chkSum;
     enter_critical_section();
-    for (i = 0; i < len; i++) {
-        chkSum ^= *buf++;
-        for (k = 0; k < 8; k++) {
-            chkSum = chkSum & 1 ? (chkSum >> 1) ^ 0xedb88320 : chkSum >> 1;
-        }
-    }
+    chkSum = util_crc32_chunked(0, (const void*)flash_addr, data_len,
+                                OTA_CRC_CHUNK_SIZE, crc32checksum_yield);
     leave_critical_section();
-    return ~chkSum;
+    return chkSum;
+}
+
+/* the CRC of the OTA image, it's calculated again only after the image flash is changed */
+static uint32_t ota_image_crc32(uint32_t data_len) {
+    if (g_ota_crc_cache_len == 0 || g_ota_crc_cache_len != data_len) {
+        g_ota_crc_cache = crc32checksum((OTA_FLASH_START + 0x20), data_len);
+        g_ota_crc_cache_len = data_len;
+    }
+    return g_ota_crc_cache;
 }
 
 /*bit map*/
 uint32_t* ota_bitmap_init(uint32_t lens) {
     uint16_t bitmap_size;
     uint32_t* bitmap = NULL;
-    bitmap_size = (lens >> 5);
-    if (lens % 32) {
-        ++bitmap_size;
-    }
-    bitmap_size *= sizeof(uint32_t);
+    bitmap_size = UTIL_BITMAP_WORDS(lens) * sizeof(uint32_t);
 
     ota_printf("ota_bitmap_init \r\n");
     bitmap = pvPortMalloc(bitmap_size);
@@ -132,11 +148,17 @@ void ota_bitmap_set(uint32_t* bitmap, uint32_t index) {
         return;
     }
     enter_critical_section();
-    uint32_t tmp_index = 0, bit = 0;
-    tmp_index = index >> 5;
-    bit = index % 32;
+    util_bitmap_set(bitmap, index);
+    leave_critical_section();
+}
 
-    bitmap[tmp_index] |= 0x1 << bit;
+void ota_bitmap_set_all(uint32_t* bitmap, uint32_t lens) {
+    if (NULL == bitmap) {
+        ota_printf("ota_bitmap_set_all bitmap null \r\n");
+        return;
+    }
+    enter_critical_section();
+    util_bitmap_set_all(bitmap, lens);
     leave_critical_section();
 }
 
@@ -153,10 +175,7 @@ uint32_t ota_bitmap_get_bit(uint32_t* bitmap, uint32_t index) {
         ota_change_state_and_timer(OTA_IDLE, 0);
         return 0;
     }
-    uint32_t tmp_index = index >> 5, bit = 0;
-
-    bit = index % 32;
-    return (bitmap[tmp_index] & (0x1 << bit));
+    return util_bitmap_get(bitmap, index);
 }
 
 uint32_t ota_bitmap_get_remain(uint32_t* bitmap, uint32_t lens) {
@@ -165,38 +184,34 @@ uint32_t ota_bitmap_get_remain(uint32_t* bitmap, uint32_t lens) {
         ota_change_state_and_timer(OTA_IDLE, 0);
         return 0;
     }
-    uint32_t tmp_lens = lens >> 5, i = 0, j = 0, remain = 0;
-    if (lens % 32) {
-        ++tmp_lens;
-    }
+    return util_bitmap_count_zero(bitmap, lens);
+}
 
-    for (i = 0; i < tmp_lens; i++) {
-        if (i == (tmp_lens - 1)) {
-            for (j = 0; j < (lens % 32); j++) {
-                if ((bitmap[i] & (0x1 << j)) == 0) {
-                    ++remain;
-                }
-            }
-        } else {
-            for (j = 0; j < 32; j++) {
-                if ((bitmap[i] & (0x1 << j)) == 0) {
-                    ++remain;
-                }
-            }
-        }
+/* the next missing segment from index, lens: no missing segment */
+uint32_t ota_bitmap_get_next_remain(uint32_t* bitmap, uint32_t lens,
+                                    uint32_t index) {
+    if (NULL == bitmap) {
+        return lens;
     }
-    return remain;
+    return util_bitmap_find_next_zero(bitmap, lens, index);
 }
 
 void ota_bitmap_print(uint32_t* bitmap, uint32_t lens) {
-    uint32_t tmp_lens = lens >> 5, i = 0;
-    if (lens % 32) {
-        ++tmp_lens;
-    }
+    util_bitmap_range_t ranges[8];
+    uint32_t num, i, start = 0;
 
-    for (i = 0; i < tmp_lens; i++) {
-        ota_printf("%X ", bitmap[i]);
-    }
+    /* print the missing segments as ranges */
+    do {
+        num = util_bitmap_zero_ranges(bitmap, lens, start, ranges,
+                                      sizeof(ranges) / sizeof(ranges[0]));
+        for (i = 0; i < num; i++) {
+            ota_printf("%u-%u ", ranges[i].start,
+                       ranges[i].start + ranges[i].len - 1);
+        }
+        if (num) {
+            start = ranges[num - 1].start + ranges[num - 1].len;
+        }
+    } while (num == sizeof(ranges) / sizeof(ranges[0]));
     ota_printf("\n\n");
 }
 
@@ -1059,34 +1074,35 @@ static void ota_request_handler() {
 
             req_index = otRandomNonCryptoGetUint32InRange(0, remain);
             ota_printf("[s] req [ ");
-            for (i = 0; i < toatol_num; i++) {
-                if (0 == ota_bitmap_get_bit(g_ota_bitmap, i)) {
-                    if (remain > OTA_REQUEST_TABLE_SIZE) {
-                        if ((remain - req_index) < OTA_REQUEST_TABLE_SIZE) {
-                            if (remain_index < (OTA_REQUEST_TABLE_SIZE
-                                                - (remain - req_index - 1))
-                                || (remain_index >= req_index)) {
-                                ota_request.req_table[index] = i;
-                                ota_printf("%u ", ota_request.req_table[index]);
-                                index++;
-                            }
-                        } else {
-                            if ((remain_index >= req_index)) {
-                                ota_request.req_table[index] = i;
-                                ota_printf("%u ", ota_request.req_table[index]);
-                                index++;
-                            }
+            for (i = ota_bitmap_get_next_remain(g_ota_bitmap, toatol_num, 0);
+                 i < toatol_num;
+                 i = ota_bitmap_get_next_remain(g_ota_bitmap, toatol_num,
+                                                i + 1)) {
+                if (remain > OTA_REQUEST_TABLE_SIZE) {
+                    if ((remain - req_index) < OTA_REQUEST_TABLE_SIZE) {
+                        if (remain_index < (OTA_REQUEST_TABLE_SIZE
+                                            - (remain - req_index - 1))
+                            || (remain_index >= req_index)) {
+                            ota_request.req_table[index] = i;
+                            ota_printf("%u ", ota_request.req_table[index]);
+                            index++;
                         }
-                        remain_index++;
                     } else {
-                        ota_request.req_table[index] = i;
-                        ota_printf("%u ", ota_request.req_table[index]);
-                        index++;
+                        if ((remain_index >= req_index)) {
+                            ota_request.req_table[index] = i;
+                            ota_printf("%u ", ota_request.req_table[index]);
+                            index++;
+                        }
                     }
+                    remain_index++;
+                } else {
+                    ota_request.req_table[index] = i;
+                    ota_printf("%u ", ota_request.req_table[index]);
+                    index++;
+                }
 
-                    if (index > OTA_REQUEST_TABLE_SIZE) {
-                        break;
-                    }
+                if (index >= OTA_REQUEST_TABLE_SIZE) {
+                    break;
                 }
             }
             ota_printf(" ] \r\n");
@@ -1108,8 +1124,7 @@ static void ota_request_handler() {
             }
         } while (0);
     } else {
-        crc32 = crc32checksum((OTA_FLASH_START + 0x20),
-                              (g_ota_image_size - 0x20));
+        crc32 = ota_image_crc32(g_ota_image_size - 0x20);
         if (crc32 != g_ota_image_crc) {
             ota_printf("ota request upgrade fail %X %X\n", crc32,
                        g_ota_image_crc);
@@ -1199,8 +1214,7 @@ static void ota_image_received_handler() {
                ((remain * 100) / (toatol_num - 1)));
 
     if (remain == 0) {
-        crc32 = crc32checksum((OTA_FLASH_START + 0x20),
-                              (g_ota_image_size - 0x20));
+        crc32 = ota_image_crc32(g_ota_image_size - 0x20);
         if (crc32 != g_ota_image_crc) {
             ota_printf("ota data upgrade fail \n");
             ota_change_state_and_timer(OTA_IDLE, 0);
@@ -1227,8 +1241,7 @@ static void ota_unicast_received_handler() {
                ((remain * 100) / (toatol_num - 1)));
 
     if (remain == 0) {
-        crc32 = crc32checksum((OTA_FLASH_START + 0x20),
-                              (g_ota_image_size - 0x20));
+        crc32 = ota_image_crc32(g_ota_image_size - 0x20);
         if (crc32 != g_ota_image_crc) {
             ota_printf("ota data upgrade fail \n");
             ota_change_state_and_timer(OTA_IDLE, 0);
@@ -1291,9 +1304,7 @@ void ota_start(uint16_t segments_size, uint16_t intervel) {
     }
     // Initiator bitmap set all
     g_ota_bitmap = ota_bitmap_init(g_ota_toatol_num);
-    for (uint32_t i = 0; i < g_ota_toatol_num; i++) {
-        ota_bitmap_set(g_ota_bitmap, i);
-    }
+    ota_bitmap_set_all(g_ota_bitmap, g_ota_toatol_num);
 
     ota_printf("ota_toatol_num %u \n", g_ota_toatol_num);
     uint32_t crc32 = crc32checksum((OTA_FLASH_START + 0x20),
@@ -1406,8 +1417,7 @@ static void ota_data_received_event_handler(uint8_t* data, uint16_t lens) {
 
         if (ota_get_state() == OTA_IDLE
             && ota_get_image_version() == ota_data.version) {
-            crc32 = crc32checksum((OTA_FLASH_START + 0x20),
-                                  (ota_data.size - 0x20));
+            crc32 = ota_image_crc32(ota_data.size - 0x20);
             if (crc32 == ota_get_image_crc()) {
                 // Initiator bitmap set all
                 if (g_ota_bitmap) {
@@ -1415,9 +1425,7 @@ static void ota_data_received_event_handler(uint8_t* data, uint16_t lens) {
                     g_ota_bitmap = NULL;
                 }
                 g_ota_bitmap = ota_bitmap_init(toatol_num);
-                for (i = 0; i < toatol_num; i++) {
-                    ota_bitmap_set(g_ota_bitmap, i);
-                }
+                ota_bitmap_set_all(g_ota_bitmap, toatol_num);
                 g_ota_toatol_num = toatol_num;
                 g_ota_segments_size = ota_data.segments;
                 ota_change_state_and_timer(OTA_DONE, OTA_DONE_TIMEOUT);
@@ -1470,6 +1478,7 @@ static void ota_data_received_event_handler(uint8_t* data, uint16_t lens) {
             } else {
                 ota_change_state_and_timer(OTA_DATA_RECEIVING, timeout);
             }
+            ota_crc_cache_clear();
             enter_critical_section();
             for (i = 0; i < 0x57; i++) {
                 // Page erase (4096 bytes)
@@ -1487,6 +1496,7 @@ static void ota_data_received_event_handler(uint8_t* data, uint16_t lens) {
 
         ota_bitmap_set(g_ota_bitmap, ota_data.seq);
 
+        ota_crc_cache_clear();
         enter_critical_section();
         tmp_addr = OTA_FLASH_START + (ota_data.segments * ota_data.seq);
         for (i = 0; i < ota_data_lens; i++) {
@@ -1499,8 +1509,7 @@ static void ota_data_received_event_handler(uint8_t* data, uint16_t lens) {
         leave_critical_section();
 
         if (0 == ota_bitmap_get_remain(g_ota_bitmap, toatol_num)) {
-            crc32 = crc32checksum((OTA_FLASH_START + 0x20),
-                                  (ota_data.size - 0x20));
+            crc32 = ota_image_crc32(ota_data.size - 0x20);
             if (crc32 != ota_data.crc) {
                 ota_printf("ota data upgrade fail %X %X\n", crc32,
                            ota_data.crc);
@@ -1542,8 +1551,7 @@ static void ota_request_received_event_handler(uint8_t* data, uint16_t lens) {
 
         if (ota_get_state() == OTA_IDLE) {
             if (ota_get_image_version() == ota_request.version) {
-                crc32 = crc32checksum((OTA_FLASH_START + 0x20),
-                                      (ota_request.size - 0x20));
+                crc32 = ota_image_crc32(ota_request.size - 0x20);
                 if (crc32 == ota_get_image_crc()) {
                     // Initiator bitmap set all
                     ota_printf("same version and idle \n");
@@ -1552,9 +1560,7 @@ static void ota_request_received_event_handler(uint8_t* data, uint16_t lens) {
                         g_ota_bitmap = NULL;
                     }
                     g_ota_bitmap = ota_bitmap_init(toatol_num);
-                    for (i = 0; i < toatol_num; i++) {
-                        ota_bitmap_set(g_ota_bitmap, i);
-                    }
+                    ota_bitmap_set_all(g_ota_bitmap, toatol_num);
                     g_ota_toatol_num = toatol_num;
                     g_ota_segments_size = ota_request.segments;
                     ota_change_state_and_timer(OTA_DONE, OTA_DONE_TIMEOUT);
@@ -1621,8 +1627,7 @@ static void ota_response_received_event_handler(uint8_t* data, uint16_t lens) {
         if (g_ota_state == OTA_IDLE) {
             ota_printf("ota response %s\n", OtaStateToString(g_ota_state));
             if (ota_get_image_version() == ota_response.version) {
-                crc32 = crc32checksum((OTA_FLASH_START + 0x20),
-                                      (ota_response.size - 0x20));
+                crc32 = ota_image_crc32(ota_response.size - 0x20);
                 if (crc32 == ota_get_image_crc()) {
                     // Initiator bitmap set all
                     ota_printf("response same version and idle \n");
@@ -1631,9 +1636,7 @@ static void ota_response_received_event_handler(uint8_t* data, uint16_t lens) {
                         g_ota_bitmap = NULL;
                     }
                     g_ota_bitmap = ota_bitmap_init(toatol_num);
-                    for (i = 0; i < toatol_num; i++) {
-                        ota_bitmap_set(g_ota_bitmap, i);
-                    }
+                    ota_bitmap_set_all(g_ota_bitmap, toatol_num);
                     g_ota_toatol_num = toatol_num;
                     g_ota_segments_size = ota_response.segments;
                     ota_change_state_and_timer(OTA_DONE, OTA_DONE_TIMEOUT);
@@ -1648,6 +1651,7 @@ static void ota_response_received_event_handler(uint8_t* data, uint16_t lens) {
                     g_ota_toatol_num = toatol_num;
                     g_ota_segments_size = ota_response.segments;
                     ota_bootinfo_reset();
+                    ota_crc_cache_clear();
                     enter_critical_section();
                     for (i = 0; i < 0x57; i++) {
                         // Page erase (4096 bytes)
@@ -1717,6 +1721,7 @@ static void ota_response_received_event_handler(uint8_t* data, uint16_t lens) {
             ota_printf("[R] ota response %u remain %u\n", ota_response.seq,
                        ota_bitmap_get_remain(g_ota_bitmap, toatol_num));
 
+            ota_crc_cache_clear();
             enter_critical_section();
             tmp_addr = OTA_FLASH_START
                        + (ota_response.segments * ota_response.seq);
@@ -1731,8 +1736,7 @@ static void ota_response_received_event_handler(uint8_t* data, uint16_t lens) {
             }
             leave_critical_section();
             if (0 == ota_bitmap_get_remain(g_ota_bitmap, toatol_num)) {
-                crc32 = crc32checksum((OTA_FLASH_START + 0x20),
-                                      (ota_response.size - 0x20));
+                crc32 = ota_image_crc32(ota_response.size - 0x20);
                 if (crc32 != ota_response.crc) {
                     ota_printf("ota response upgrade fail %X %X\n", crc32,
                                ota_response.crc);
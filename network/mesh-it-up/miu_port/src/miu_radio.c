@@ -31,6 +31,7 @@
 #include "log.h"
 #include "soft_source_match_table.h"
 #include "subg_ctrl.h"
+#include "util_frame_ring.h"
 #include "util_list.h"
 #include "util_string.h"
 
@@ -93,14 +94,20 @@ enum {
 
 #define OTRADIO_MAC_HEADER_ACK_REQUEST_MASK (1 << 5)
 #define OTRADIO_MAX_PSDU                    OT_RADIO_FRAME_MAX_SIZE + 28
-#define OTRADIO_RX_FRAME_BUFFER_NUM         8
+
+/* RX frames between the lmac15p4 RX callback and the OpenThread task */
+#ifndef CONFIG_MIU_RADIO_RX_FRAME_NUM
+#define CONFIG_MIU_RADIO_RX_FRAME_NUM 8
+#endif
+#define OTRADIO_RX_FRAME_BUFFER_NUM CONFIG_MIU_RADIO_RX_FRAME_NUM
 
 typedef struct _otRadio_rxFrame_t {
-    utils_dlist_t dlist;
     otRadioFrame frame;
+    uint8_t psdu[OTRADIO_MAX_PSDU];
 } otRadio_rxFrame_t;
 
-#define ALIGNED_RX_FRAME_SIZE ((sizeof(otRadio_rxFrame_t) + 3) & 0xfffffffc)
+/* the TX and the ACK frames */
+#define ALIGNED_RX_FRAME_SIZE ((sizeof(otRadioFrame) + 3) & 0xfffffffc)
 #define TOTAL_RX_FRAME_SIZE   (ALIGNED_RX_FRAME_SIZE + OTRADIO_MAX_PSDU)
 
 //=============================================================================
@@ -108,8 +115,6 @@ typedef struct _otRadio_rxFrame_t {
 //=============================================================================
 typedef struct _otRadio_t {
     otInstance* aInstance;
-    utils_dlist_t rxFrameList;
-    utils_dlist_t frameList;
     otRadioFrame* pTxFrame;
     otRadioFrame* pAckFrame;
     uint32_t isCoexEnabled;
@@ -117,15 +122,16 @@ typedef struct _otRadio_t {
     uint64_t tstx;
     uint64_t tsIsr;
 
-    uint32_t dbgRxFrameNum;
-    uint32_t dbgFrameNum;
     uint32_t dbgMaxAckFrameLenth;
-    uint32_t dbgMaxPendingFrameNum;
 
-    uint8_t buffPool[TOTAL_RX_FRAME_SIZE * (OTRADIO_RX_FRAME_BUFFER_NUM + 2)];
+    uint8_t buffPool[TOTAL_RX_FRAME_SIZE * 2];
 } otRadio_t;
 
 static otRadio_t otRadio_var;
+static util_frame_ring_t otRadio_rxRing;
+static uint8_t otRadio_rxRingBuf[UTIL_FRAME_RING_BUF_SIZE(
+    sizeof(otRadio_rxFrame_t), OTRADIO_RX_FRAME_BUFFER_NUM)]
+    __attribute__((aligned(8)));
 //=============================================================================
 //                Private Global Variables
 //=============================================================================
@@ -1077,40 +1083,13 @@ void ot_radioTask(ot_system_event_t trxEvent) {
     }
 
     if (trxEvent & OT_SYSTEM_EVENT_RADIO_RX_DONE) {
-        pframe = NULL;
-        OT_ENTER_CRITICAL();
-        if (!utils_dlist_empty(&otRadio_var.rxFrameList)) {
-            pframe = (otRadio_rxFrame_t*)otRadio_var.rxFrameList.next;
-            utils_dlist_del(&pframe->dlist);
-            otRadio_var.dbgRxFrameNum--;
-        } else {
-            pframe = NULL;
-        }
-        OT_EXIT_CRITICAL();
-
-        if (pframe) {
-            // log_info("=== Radio Status ===\n");
-            // log_info("dbgRxFrameNum: %u\n", otRadio_var.dbgRxFrameNum);
-            // log_info("dbgFrameNum: %u\n", otRadio_var.dbgFrameNum);
-            // log_info("dbgMaxPendingFrameNum: %u\n", otRadio_var.dbgMaxPendingFrameNum);
-            // log_info("=====================\n");
+        /* the notifications may be merged, take all frames in the ring */
+        while ((pframe = util_frame_ring_get_peek(&otRadio_rxRing)) != NULL) {
             // log_info("ot rx seq %d done",
             //          otMacFrameGetSequence(&pframe->frame));
             otPlatRadioReceiveDone(otRadio_var.aInstance, &pframe->frame,
                                    OT_ERROR_NONE);
-
-            OT_ENTER_CRITICAL();
-            utils_dlist_add_tail(&pframe->dlist, &otRadio_var.frameList);
-            otRadio_var.dbgFrameNum++;
-            OT_EXIT_CRITICAL();
-            // if (!utils_dlist_empty(&otRadio_var.rxFrameList))
-            // {
-            //     vTaskDelay(5);
-            //     OT_NOTIFY(OT_SYSTEM_EVENT_RADIO_RX_DONE);
-            // }
-            // OT_EXIT_CRITICAL();
-        } else {
-            log_warn("otRadio_var.dbgRxFrameNum %d", otRadio_var.dbgRxFrameNum);
+            util_frame_ring_get_release(&otRadio_rxRing);
         }
     } else if (trxEvent & OT_SYSTEM_EVENT_RADIO_RX_NO_BUFF) {
         log_warn("Radio RX Buffer Full! Drop frame.");
@@ -1178,82 +1157,63 @@ static void _RxDoneEvent(uint16_t packet_length, uint8_t* rx_data_address,
     static uint8_t rx_done_cnt = 0;
 
     if (crc_status == 0) {
-        if (otRadio_var.dbgRxFrameNum >= OTRADIO_RX_FRAME_BUFFER_NUM) {
+        p = util_frame_ring_put_reserve(&otRadio_rxRing);
+        if (p == NULL) {
             OT_NOTIFY(OT_SYSTEM_EVENT_RADIO_RX_NO_BUFF);
         } else {
-            OT_ENTER_CRITICAL();
-            if (!utils_dlist_empty(&otRadio_var.frameList)) {
-                p = (otRadio_rxFrame_t*)otRadio_var.frameList.next;
-                utils_dlist_del(&p->dlist);
-                otRadio_var.dbgFrameNum--;
-
-            } else {
-                p = NULL;
-            }
-            OT_EXIT_CRITICAL();
-            if (p) {
-                lmac15p4_rx_rtc_time_read(rx_done_cnt, &rx_now32Time);
-                p->frame.mInfo.mRxInfo.mTimestamp = longtime_to_longlong_time(
-                    &rx_prev32Time, rx_now32Time, &rx_timerWraps);
+            p->frame.mPsdu = p->psdu;
+            lmac15p4_rx_rtc_time_read(rx_done_cnt, &rx_now32Time);
+            p->frame.mInfo.mRxInfo.mTimestamp = longtime_to_longlong_time(
+                &rx_prev32Time, rx_now32Time, &rx_timerWraps);
 #ifdef CONFIG_MIU_DEVICE_TYPE_RCP
-                p->frame.mInfo.mRxInfo.mTimestamp -= (2500);
+            p->frame.mInfo.mRxInfo.mTimestamp -= (2500);
 #else
-                p->frame.mInfo.mRxInfo.mTimestamp -= (2030 * 10);
+            p->frame.mInfo.mRxInfo.mTimestamp -= (2030 * 10);
 #endif
-                p->frame.mLength = (packet_length - 10);
-                if (OTRADIO_MAX_PSDU < p->frame.mLength) {
-                    log_warn("Rx Done len error %d", p->frame.mLength);
-                    return;
-                }
-                memcpy(p->frame.mPsdu, (rx_data_address + 9), p->frame.mLength);
-
-                p->frame.mChannel = sCurrentChannel;
-                rssi = rssi >= RAFAEL_RECEIVE_SENSITIVITY
-                           ? RAFAEL_RECEIVE_SENSITIVITY
-                           : rssi;
-                p->frame.mInfo.mRxInfo.mRssi = -rssi;
-                p->frame.mInfo.mRxInfo.mLqi =
-                    ((RAFAEL_RECEIVE_SENSITIVITY - rssi) * 0xFF)
-                    / RAFAEL_RECEIVE_SENSITIVITY;
-
-                p->frame.mInfo.mRxInfo.mAckedWithFramePending = false;
-
-                if (
+            p->frame.mLength = (packet_length - 10);
+            if (OTRADIO_MAX_PSDU < p->frame.mLength) {
+                log_warn("Rx Done len error %d", p->frame.mLength);
+                return;
+            }
+            memcpy(p->frame.mPsdu, (rx_data_address + 9), p->frame.mLength);
+
+            p->frame.mChannel = sCurrentChannel;
+            rssi = rssi >= RAFAEL_RECEIVE_SENSITIVITY
+                       ? RAFAEL_RECEIVE_SENSITIVITY
+                       : rssi;
+            p->frame.mInfo.mRxInfo.mRssi = -rssi;
+            p->frame.mInfo.mRxInfo.mLqi =
+                ((RAFAEL_RECEIVE_SENSITIVITY - rssi) * 0xFF)
+                / RAFAEL_RECEIVE_SENSITIVITY;
+
+            p->frame.mInfo.mRxInfo.mAckedWithFramePending = false;
+
+            if (
 #if OPENTHREAD_CONFIG_THREAD_VERSION >= OT_THREAD_VERSION_1_2
-                    ((otMacFrameIsVersion2015(&p->frame)
-                      && otMacFrameIsCommand(&p->frame))
-                     || otMacFrameIsData(&p->frame)
-                     || otMacFrameIsDataRequest(&p->frame))
+                ((otMacFrameIsVersion2015(&p->frame)
+                  && otMacFrameIsCommand(&p->frame))
+                 || otMacFrameIsData(&p->frame)
+                 || otMacFrameIsDataRequest(&p->frame))
 #else
-                    otMacFrameIsDataRequest(&p->frame)
+                otMacFrameIsDataRequest(&p->frame)
 #endif
-                    && hasFramePending(&p->frame)) {
-                    p->frame.mInfo.mRxInfo.mAckedWithFramePending = true;
-                }
+                && hasFramePending(&p->frame)) {
+                p->frame.mInfo.mRxInfo.mAckedWithFramePending = true;
+            }
 
 #if OPENTHREAD_CONFIG_THREAD_VERSION >= OT_THREAD_VERSION_1_2
-                if (otMacFrameIsVersion2015(&p->frame)
-                    && otMacFrameIsSecurityEnabled(&p->frame)
-                    && otMacFrameIsAckRequested(&p->frame)) {
-                    p->frame.mInfo.mRxInfo.mAckedWithSecEnhAck = true;
-                    p->frame.mInfo.mRxInfo.mAckFrameCounter =
-                        ++sMacFrameCounter;
-                }
+            if (otMacFrameIsVersion2015(&p->frame)
+                && otMacFrameIsSecurityEnabled(&p->frame)
+                && otMacFrameIsAckRequested(&p->frame)) {
+                p->frame.mInfo.mRxInfo.mAckedWithSecEnhAck = true;
+                p->frame.mInfo.mRxInfo.mAckFrameCounter =
+                    ++sMacFrameCounter;
+            }
 #endif // OPENTHREAD_CONFIG_THREAD_VERSION >= OT_THREAD_VERSION_1_2
 
-                OT_ENTER_CRITICAL();
-                utils_dlist_add_tail(&p->dlist, &otRadio_var.rxFrameList);
-                otRadio_var.dbgRxFrameNum++;
-                if (otRadio_var.dbgMaxPendingFrameNum
-                    < otRadio_var.dbgRxFrameNum) {
-                    otRadio_var.dbgMaxPendingFrameNum =
-                        otRadio_var.dbgRxFrameNum;
-                }
-                OT_EXIT_CRITICAL();
-                // log_info("rx seq %d done", otMacFrameGetSequence(&p->frame));
-                // log_info("rx done %d [%d]", otMacFrameGetSequence(&p->frame), otRadio_var.dbgRxFrameNum);
-                OT_NOTIFY(OT_SYSTEM_EVENT_RADIO_RX_DONE);
-            }
+            util_frame_ring_put_commit(&otRadio_rxRing);
+            // log_info("rx seq %d done", otMacFrameGetSequence(&p->frame));
+            OT_NOTIFY(OT_SYSTEM_EVENT_RADIO_RX_DONE);
         }
     } else {
         // log_warn("crc error %d", crc_status);
@@ -1288,7 +1248,6 @@ void ot_radioInit() {
     lmac15p4_callback_t mac_cb;
     uint8_t ieeeAddr[OT_EXT_ADDRESS_SIZE] = {0xFF, 0xFF, 0xFF, 0xFF,
                                              0xFF, 0xFF, 0xFF, 0xFF};
-    otRadio_rxFrame_t* pframe = NULL;
 
     if (sMacAddrReadMode == 1) {
         rafael_otp_mac_addr(sIEEE_EUI64Addr);
@@ -1306,20 +1265,9 @@ void ot_radioInit() {
     otRadio_var.pAckFrame->mPsdu = ((uint8_t*)otRadio_var.pAckFrame)
                                    + ALIGNED_RX_FRAME_SIZE;
 
-    OT_ENTER_CRITICAL();
-    utils_dlist_init(&otRadio_var.frameList);
-    utils_dlist_init(&otRadio_var.rxFrameList);
-
-    for (int i = 0; i < OTRADIO_RX_FRAME_BUFFER_NUM; i++) {
-        pframe = (otRadio_rxFrame_t*)(otRadio_var.buffPool
-                                      + TOTAL_RX_FRAME_SIZE * (i + 2));
-        pframe->frame.mPsdu = ((uint8_t*)pframe) + ALIGNED_RX_FRAME_SIZE;
-        utils_dlist_init(&pframe->dlist);
-        utils_dlist_add_tail(&pframe->dlist, &otRadio_var.frameList);
-        otRadio_var.dbgFrameNum++;
-    }
-    // otRadio_var.dbgFrameNum = OTRADIO_RX_FRAME_BUFFER_NUM;
-    OT_EXIT_CRITICAL();
+    util_frame_ring_init(&otRadio_rxRing, "miu rx", otRadio_rxRingBuf,
+                         sizeof(otRadio_rxFrame_t),
+                         OTRADIO_RX_FRAME_BUFFER_NUM);
     mac_cb.rx_cb = _RxDoneEvent;
     mac_cb.tx_cb = _TxDoneEvent;
     lmac15p4_cb_set(0, &mac_cb);
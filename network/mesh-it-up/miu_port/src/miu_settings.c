@@ -79,21 +79,26 @@ static bool otPlatSettingsSet_raw(otInstance *aInstance, uint16_t aKey, const ui
     int index, char * key, uint32_t * bitmapArray) 
 {
     EfErrCode   ret;
+    char        bmKey[OT_MAX_KEY_LEN];
+    efd_env     envs[2];
     uint32_t i = index >> 5;
     uint32_t j = index & 0xfffff;
 
     bitmapArray[i] = bitmapArray[i] | (1 << j);
 
-    efd_port_env_lock();
-    do {
-        sprintf(key, "ot-%x-%x", aKey, index);
-        ret = efd_set_env_blob(key, aValue, aValueLength);
+    sprintf(key, "ot-%x-%x", aKey, index);
+    sprintf(bmKey, "ot-bm-%x", aKey);
 
-        if (EFD_NO_ERR == ret) {
-            sprintf(key, "ot-bm-%x", aKey);
-            ret = efd_set_env_blob(key, bitmapArray, OT_MAX_ENTRY_BITMAP * 4);
-        }
-    } while (0);
+    /** the value and the bitmap are updated together */
+    envs[0].key = key;
+    envs[0].value = (void *)aValue;
+    envs[0].value_len = aValueLength;
+    envs[1].key = bmKey;
+    envs[1].value = bitmapArray;
+    envs[1].value_len = OT_MAX_ENTRY_BITMAP * 4;
+
+    efd_port_env_lock();
+    ret = efd_set_env_batch(envs, 2);
     efd_port_env_unlock();
 
     return EFD_NO_ERR == ret? OT_ERROR_NONE : OT_ERROR_FAILED;
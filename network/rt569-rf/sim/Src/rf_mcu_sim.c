@@ -0,0 +1,860 @@
+/**************************************************************************//**
+ * @file     rf_mcu_sim.c
+ * @version
+ * @brief    Host simulated rf mcu, the RfMcu_* queue API on in-process queues
+ *
+ * Replaces rf_mcu.c, rf_mcu_ahb.c and rf_mcu_spi.c in a Linux build:
+ *
+ *   cc -I<hosal inc> -Inetwork/rt569-rf/rt582/include -Inetwork/ruci/include
+ *      -Inetwork/rt569-rf/sim/include -Inetwork/rt569-rf/sim/host
+ *      -c network/rt569-rf/sim/Src/rf_mcu_sim.c
+ *
+ * A command is handled by the command model in the sending thread. A frame
+ * written to a TX queue is moved by the air thread, the air thread holds it
+ * for the air time, converts it for every other instance of the air, queues
+ * it to their RX queues and then frees the TX queue of the sender:
+ * - RUCI PCI frame: RX interrupt to the receivers, TX done interrupt to the
+ *   sender with the state of rf_mcu_sim_tx_state_set().
+ * - HCI ACL frame: RX interrupt to the receivers, number of completed packets
+ *   event to the sender.
+ *
+ * RfMcu_InterruptDisableAll() locks the instance, the ISR is called with the
+ * instance locked so it does not break into a disabled section.
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rf_mcu_sim.h"
+#include "ruci.h"
+
+#define SIM_HCI_CMD                 (0x01)
+#define SIM_HCI_ACL_DATA            (0x02)
+#define SIM_HCI_EVENT               (0x04)
+#define SIM_HCI_EVT_CMD_COMPLETE    (0x0E)
+#define SIM_HCI_EVT_NUM_COMP_PKTS   (0x13)
+
+#define SIM_RX_RSSI                 (60)
+#define SIM_RX_SNR                  (20)
+
+typedef struct
+{
+    uint16_t len;
+    uint8_t data[RF_MCU_SIM_FRAME_SIZE];
+} sim_frame_t;
+
+typedef struct
+{
+    sim_frame_t *p_frame;
+    uint32_t depth;
+    uint32_t rd;
+    uint32_t wr;
+} sim_queue_t;
+
+typedef struct
+{
+    bool used;
+    uint32_t air_id;
+    pthread_mutex_t lock;
+    COMM_SUBSYSTEM_ISR_t isr;
+    bool in_isr;
+    uint32_t int_pending;
+    uint32_t int_enable;
+    RF_MCU_STATE state;
+    RF_MCU_STATE tx_state;
+    rf_mcu_sim_cmd_fn cmd_fn;
+    rf_mcu_sim_rx_fn rx_fn;
+
+    sim_frame_t rxq_frame[CONFIG_RF_MCU_SIM_RXQ_DEPTH];
+    sim_frame_t evtq_frame[CONFIG_RF_MCU_SIM_EVTQ_DEPTH];
+    sim_queue_t rxq;
+    sim_queue_t evtq;
+
+    sim_frame_t txq[RF_MCU_SIM_TXQ_NUM];
+    uint32_t txq_seq[RF_MCU_SIM_TXQ_NUM];
+    uint8_t txq_busy;
+
+    rf_mcu_sim_stats_t stats;
+    uint8_t mem[RF_MCU_SIM_MEM_SIZE];
+} sim_inst_t;
+
+typedef struct
+{
+    bool started;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t seq;
+    uint32_t pending;   /* frames in the TX queues */
+    uint32_t bit_rate;
+    uint32_t loss_permille;
+    unsigned int seed;
+} sim_air_t;
+
+static sim_inst_t g_sim_inst[CONFIG_RF_MCU_SIM_INST_NUM];
+static sim_air_t g_sim_air[CONFIG_RF_MCU_SIM_AIR_NUM];
+static pthread_mutex_t g_sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread uint32_t g_sim_cur = 0;
+
+/**************************************************************************************************
+ *    LOCAL FUNCTIONS
+ *************************************************************************************************/
+static sim_inst_t *sim_inst(void)
+{
+    return &g_sim_inst[g_sim_cur];
+}
+
+static bool sim_queue_push(sim_queue_t *p_q, const uint8_t *p_data, uint32_t len)
+{
+    sim_frame_t *p_frame;
+
+    if ((p_q->wr - p_q->rd) >= p_q->depth)
+    {
+        return false;
+    }
+    p_frame = &p_q->p_frame[p_q->wr % p_q->depth];
+    p_frame->len = len;
+    memcpy(p_frame->data, p_data, len);
+    p_q->wr++;
+    return true;
+}
+
+static uint16_t sim_queue_pop(sim_queue_t *p_q, uint8_t *p_data)
+{
+    sim_frame_t *p_frame;
+
+    if (p_q->wr == p_q->rd)
+    {
+        return 0;
+    }
+    p_frame = &p_q->p_frame[p_q->rd % p_q->depth];
+    memcpy(p_data, p_frame->data, p_frame->len);
+    p_q->rd++;
+    return p_frame->len;
+}
+
+/* raises the interrupt status and calls the ISR with the instance selected,
+ * the status raised by the ISR itself is handled after it returns */
+static void sim_raise(uint32_t inst, uint32_t status)
+{
+    sim_inst_t *p_inst = &g_sim_inst[inst];
+    uint32_t cur = g_sim_cur, int_status;
+
+    pthread_mutex_lock(&p_inst->lock);
+    p_inst->int_pending |= status;
+    while ((p_inst->isr) && (!p_inst->in_isr))
+    {
+        int_status = p_inst->int_pending & p_inst->int_enable;
+        if (int_status == 0)
+        {
+            break;
+        }
+        p_inst->in_isr = true;
+        g_sim_cur = inst;
+        p_inst->isr((uint8_t)int_status);
+        g_sim_cur = cur;
+        p_inst->in_isr = false;
+        /* not cleared by the ISR, keep it pending */
+        if ((p_inst->int_pending & p_inst->int_enable) == int_status)
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&p_inst->lock);
+}
+
+static void sim_evt_queue(uint32_t inst, const uint8_t *p_evt, uint32_t len)
+{
+    sim_inst_t *p_inst = &g_sim_inst[inst];
+    bool queued;
+
+    pthread_mutex_lock(&p_inst->lock);
+    queued = sim_queue_push(&p_inst->evtq, p_evt, len);
+    if (queued)
+    {
+        p_inst->stats.evt_num++;
+    }
+    else
+    {
+        p_inst->stats.evt_overflow_num++;
+    }
+    pthread_mutex_unlock(&p_inst->lock);
+
+    if (queued)
+    {
+        sim_raise(inst, RF_MCU_SIM_INT_EVENT);
+    }
+}
+
+static void sim_cmd_default(uint32_t inst, const uint8_t *p_cmd, uint32_t cmd_len)
+{
+    uint8_t evt[8];
+
+    if (cmd_len < 2)
+    {
+        return;
+    }
+
+    if (p_cmd[0] == SIM_HCI_CMD)
+    {
+        if (cmd_len < 3)
+        {
+            return;
+        }
+        evt[0] = SIM_HCI_EVENT;
+        evt[1] = SIM_HCI_EVT_CMD_COMPLETE;
+        evt[2] = 4;
+        evt[3] = 1;
+        evt[4] = p_cmd[1];
+        evt[5] = p_cmd[2];
+        evt[6] = 0;
+        sim_evt_queue(inst, evt, 7);
+    }
+    else if ((p_cmd[0] == RUCI_CMN_SYS_CMD_HEADER) || (p_cmd[0] == RUCI_CMN_HAL_CMD_HEADER))
+    {
+        SET_RUCI_PARA_CMN_CNF_EVENT(evt, p_cmd[0], p_cmd[1], 0);
+        sim_evt_queue(inst, evt, RUCI_LEN_CMN_CNF_EVENT);
+    }
+    else
+    {
+        SET_RUCI_PARA_CNF_EVENT(evt, p_cmd[0], p_cmd[1], 0);
+        sim_evt_queue(inst, evt, RUCI_LEN_CNF_EVENT);
+    }
+}
+
+static uint32_t sim_rx_default(uint32_t from, uint32_t to, const uint8_t *p_tx, uint32_t tx_len,
+                               uint8_t *p_rx)
+{
+    uint32_t psdu_len;
+
+    UNUSED(from);
+    UNUSED(to);
+
+    if ((p_tx[0] == RUCI_PCI_DATA_HEADER) && (tx_len >= RUCI_LEN_SET_TX_CONTROL_FIELD))
+    {
+        psdu_len = tx_len - RUCI_LEN_SET_TX_CONTROL_FIELD;
+        if ((psdu_len + RUCI_LEN_RX_CONTROL_FIELD) > RF_MCU_SIM_FRAME_SIZE)
+        {
+            return 0;
+        }
+        p_rx[0] = RUCI_PCI_DATA_HEADER;
+        p_rx[1] = RUCI_CODE_RX_CONTROL_FIELD;
+        p_rx[2] = (uint8_t)(psdu_len + RUCI_PARA_LEN_RX_CONTROL_FIELD);
+        p_rx[3] = (uint8_t)((psdu_len + RUCI_PARA_LEN_RX_CONTROL_FIELD) >> 8);
+        memcpy(&p_rx[4], &p_tx[RUCI_LEN_SET_TX_CONTROL_FIELD], psdu_len);
+        p_rx[4 + psdu_len] = 0;     /* crc status, 0: pass */
+        p_rx[5 + psdu_len] = SIM_RX_RSSI;
+        p_rx[6 + psdu_len] = SIM_RX_SNR;
+        return psdu_len + RUCI_LEN_RX_CONTROL_FIELD;
+    }
+
+    memcpy(p_rx, p_tx, tx_len);
+    return tx_len;
+}
+
+static uint8_t sim_txq_free(sim_inst_t *p_inst)
+{
+    return (uint8_t)(~p_inst->txq_busy & ((1 << RF_MCU_SIM_TXQ_NUM) - 1));
+}
+
+/* the oldest frame in the TX queues of the air */
+static bool sim_air_oldest(uint32_t air_id, uint32_t *p_inst, uint32_t *p_q)
+{
+    uint32_t i, q, seq = 0;
+    bool found = false;
+
+    for (i = 0; i < CONFIG_RF_MCU_SIM_INST_NUM; i++)
+    {
+        sim_inst_t *p_inst_i = &g_sim_inst[i];
+
+        if ((!p_inst_i->used) || (p_inst_i->air_id != air_id))
+        {
+            continue;
+        }
+        pthread_mutex_lock(&p_inst_i->lock);
+        for (q = 0; q < RF_MCU_SIM_TXQ_NUM; q++)
+        {
+            if ((p_inst_i->txq_busy & (1 << q))
+                    && ((!found) || ((int32_t)(p_inst_i->txq_seq[q] - seq) < 0)))
+            {
+                seq = p_inst_i->txq_seq[q];
+                *p_inst = i;
+                *p_q = q;
+                found = true;
+            }
+        }
+        pthread_mutex_unlock(&p_inst_i->lock);
+    }
+    return found;
+}
+
+static void sim_air_sleep(uint32_t bit_rate, uint32_t len)
+{
+    struct timespec ts;
+    uint64_t ns;
+
+    if (bit_rate == 0)
+    {
+        return;
+    }
+    ns = (uint64_t)len * 8 * 1000000000ULL / bit_rate;
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    nanosleep(&ts, NULL);
+}
+
+static void sim_air_deliver(sim_air_t *p_air, uint32_t air_id, uint32_t from,
+                            const sim_frame_t *p_tx)
+{
+    static __thread uint8_t rx[RF_MCU_SIM_FRAME_SIZE];
+    uint32_t to, rx_len;
+    bool queued;
+
+    for (to = 0; to < CONFIG_RF_MCU_SIM_INST_NUM; to++)
+    {
+        sim_inst_t *p_to = &g_sim_inst[to];
+
+        if ((to == from) || (!p_to->used) || (p_to->air_id != air_id))
+        {
+            continue;
+        }
+        if ((p_air->loss_permille)
+                && ((uint32_t)(rand_r(&p_air->seed) % 1000) < p_air->loss_permille))
+        {
+            pthread_mutex_lock(&p_to->lock);
+            p_to->stats.rx_lost_num++;
+            pthread_mutex_unlock(&p_to->lock);
+            continue;
+        }
+
+        rx_len = p_to->rx_fn(from, to, p_tx->data, p_tx->len, rx);
+        if (rx_len == 0)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&p_to->lock);
+        queued = sim_queue_push(&p_to->rxq, rx, rx_len);
+        if (queued)
+        {
+            p_to->stats.rx_num++;
+            p_to->stats.rx_bytes += rx_len;
+        }
+        else
+        {
+            p_to->stats.rx_overflow_num++;
+        }
+        pthread_mutex_unlock(&p_to->lock);
+
+        if (queued)
+        {
+            sim_raise(to, RF_MCU_SIM_INT_RX_DATA);
+        }
+    }
+}
+
+static void sim_air_tx_done(uint32_t from, const sim_frame_t *p_tx)
+{
+    sim_inst_t *p_from = &g_sim_inst[from];
+    uint8_t evt[8];
+
+    if (p_tx->data[0] == SIM_HCI_ACL_DATA)
+    {
+        evt[0] = SIM_HCI_EVENT;
+        evt[1] = SIM_HCI_EVT_NUM_COMP_PKTS;
+        evt[2] = 5;
+        evt[3] = 1;
+        evt[4] = p_tx->data[1];
+        evt[5] = p_tx->data[2] & 0x0F;
+        evt[6] = 1;
+        evt[7] = 0;
+        sim_evt_queue(from, evt, 8);
+        return;
+    }
+
+    pthread_mutex_lock(&p_from->lock);
+    p_from->state = (RF_MCU_STATE)(p_from->state | RF_MCU_STATE_EVENT_DONE | p_from->tx_state);
+    pthread_mutex_unlock(&p_from->lock);
+    sim_raise(from, RF_MCU_SIM_INT_TX_DONE);
+}
+
+static void *sim_air_proc(void *p_arg)
+{
+    static __thread sim_frame_t tx;
+    uint32_t air_id = (uint32_t)(uintptr_t)p_arg;
+    sim_air_t *p_air = &g_sim_air[air_id];
+    uint32_t from, q;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&p_air->lock);
+        while (p_air->pending == 0)
+        {
+            pthread_cond_wait(&p_air->cond, &p_air->lock);
+        }
+        pthread_mutex_unlock(&p_air->lock);
+
+        if (!sim_air_oldest(air_id, &from, &q))
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&g_sim_inst[from].lock);
+        tx = g_sim_inst[from].txq[q];
+        pthread_mutex_unlock(&g_sim_inst[from].lock);
+
+        sim_air_sleep(p_air->bit_rate, tx.len);
+        sim_air_deliver(p_air, air_id, from, &tx);
+
+        pthread_mutex_lock(&g_sim_inst[from].lock);
+        g_sim_inst[from].txq_busy &= ~(1 << q);
+        g_sim_inst[from].stats.tx_num++;
+        g_sim_inst[from].stats.tx_bytes += tx.len;
+        pthread_mutex_unlock(&g_sim_inst[from].lock);
+
+        sim_air_tx_done(from, &tx);
+
+        pthread_mutex_lock(&p_air->lock);
+        p_air->pending--;
+        pthread_cond_broadcast(&p_air->cond);
+        pthread_mutex_unlock(&p_air->lock);
+    }
+
+    return NULL;
+}
+
+/**************************************************************************************************
+ *    SIMULATOR FUNCTIONS
+ *************************************************************************************************/
+int rf_mcu_sim_init(uint32_t inst, uint32_t air_id)
+{
+    pthread_mutexattr_t attr;
+    sim_inst_t *p_inst;
+    sim_air_t *p_air;
+    int ret = 0;
+
+    if ((inst >= CONFIG_RF_MCU_SIM_INST_NUM) || (air_id >= CONFIG_RF_MCU_SIM_AIR_NUM))
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_sim_lock);
+    p_inst = &g_sim_inst[inst];
+    p_air = &g_sim_air[air_id];
+    if (!p_inst->used)
+    {
+        memset(p_inst, 0, sizeof(sim_inst_t));
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&p_inst->lock, &attr);
+        pthread_mutexattr_destroy(&attr);
+        p_inst->rxq.p_frame = p_inst->rxq_frame;
+        p_inst->rxq.depth = CONFIG_RF_MCU_SIM_RXQ_DEPTH;
+        p_inst->evtq.p_frame = p_inst->evtq_frame;
+        p_inst->evtq.depth = CONFIG_RF_MCU_SIM_EVTQ_DEPTH;
+        p_inst->int_enable = COMM_SUBSYSTEM_INT_ENABLE;
+        p_inst->cmd_fn = sim_cmd_default;
+        p_inst->rx_fn = sim_rx_default;
+    }
+    p_inst->air_id = air_id;
+
+    if (!p_air->started)
+    {
+        pthread_mutex_init(&p_air->lock, NULL);
+        pthread_cond_init(&p_air->cond, NULL);
+        p_air->seed = air_id + 1;
+        if (pthread_create(&p_air->thread, NULL, sim_air_proc, (void *)(uintptr_t)air_id) != 0)
+        {
+            ret = -1;
+        }
+        else
+        {
+            pthread_detach(p_air->thread);
+            p_air->started = true;
+        }
+    }
+    if (ret == 0)
+    {
+        p_inst->used = true;
+    }
+    pthread_mutex_unlock(&g_sim_lock);
+
+    return ret;
+}
+
+void rf_mcu_sim_select(uint32_t inst)
+{
+    if (inst < CONFIG_RF_MCU_SIM_INST_NUM)
+    {
+        g_sim_cur = inst;
+    }
+}
+
+uint32_t rf_mcu_sim_current(void)
+{
+    return g_sim_cur;
+}
+
+void rf_mcu_sim_air_config(uint32_t air_id, uint32_t bit_rate, uint32_t loss_permille)
+{
+    if (air_id >= CONFIG_RF_MCU_SIM_AIR_NUM)
+    {
+        return;
+    }
+    g_sim_air[air_id].bit_rate = bit_rate;
+    g_sim_air[air_id].loss_permille = (loss_permille > 1000) ? 1000 : loss_permille;
+}
+
+void rf_mcu_sim_cmd_fn_set(uint32_t inst, rf_mcu_sim_cmd_fn cmd_fn)
+{
+    if (inst < CONFIG_RF_MCU_SIM_INST_NUM)
+    {
+        g_sim_inst[inst].cmd_fn = (cmd_fn) ? cmd_fn : sim_cmd_default;
+    }
+}
+
+void rf_mcu_sim_rx_fn_set(uint32_t inst, rf_mcu_sim_rx_fn rx_fn)
+{
+    if (inst < CONFIG_RF_MCU_SIM_INST_NUM)
+    {
+        g_sim_inst[inst].rx_fn = (rx_fn) ? rx_fn : sim_rx_default;
+    }
+}
+
+void rf_mcu_sim_tx_state_set(uint32_t inst, RF_MCU_STATE state)
+{
+    if (inst < CONFIG_RF_MCU_SIM_INST_NUM)
+    {
+        g_sim_inst[inst].tx_state = state;
+    }
+}
+
+int rf_mcu_sim_evt_push(uint32_t inst, const uint8_t *p_evt, uint32_t evt_len)
+{
+    uint32_t overflow;
+
+    if ((inst >= CONFIG_RF_MCU_SIM_INST_NUM) || (evt_len > RF_MCU_SIM_FRAME_SIZE))
+    {
+        return -1;
+    }
+    overflow = g_sim_inst[inst].stats.evt_overflow_num;
+    sim_evt_queue(inst, p_evt, evt_len);
+    return (overflow == g_sim_inst[inst].stats.evt_overflow_num) ? 0 : -1;
+}
+
+int rf_mcu_sim_rx_push(uint32_t inst, const uint8_t *p_rx, uint32_t rx_len)
+{
+    sim_inst_t *p_inst;
+    bool queued;
+
+    if ((inst >= CONFIG_RF_MCU_SIM_INST_NUM) || (rx_len > RF_MCU_SIM_FRAME_SIZE))
+    {
+        return -1;
+    }
+    p_inst = &g_sim_inst[inst];
+    pthread_mutex_lock(&p_inst->lock);
+    queued = sim_queue_push(&p_inst->rxq, p_rx, rx_len);
+    if (queued)
+    {
+        p_inst->stats.rx_num++;
+        p_inst->stats.rx_bytes += rx_len;
+    }
+    else
+    {
+        p_inst->stats.rx_overflow_num++;
+    }
+    pthread_mutex_unlock(&p_inst->lock);
+
+    if (!queued)
+    {
+        return -1;
+    }
+    sim_raise(inst, RF_MCU_SIM_INT_RX_DATA);
+    return 0;
+}
+
+void rf_mcu_sim_stats_get(uint32_t inst, rf_mcu_sim_stats_t *p_stats)
+{
+    if (inst < CONFIG_RF_MCU_SIM_INST_NUM)
+    {
+        pthread_mutex_lock(&g_sim_inst[inst].lock);
+        *p_stats = g_sim_inst[inst].stats;
+        pthread_mutex_unlock(&g_sim_inst[inst].lock);
+    }
+}
+
+void rf_mcu_sim_stats_reset(uint32_t inst)
+{
+    if (inst < CONFIG_RF_MCU_SIM_INST_NUM)
+    {
+        pthread_mutex_lock(&g_sim_inst[inst].lock);
+        memset(&g_sim_inst[inst].stats, 0, sizeof(rf_mcu_sim_stats_t));
+        pthread_mutex_unlock(&g_sim_inst[inst].lock);
+    }
+}
+
+void rf_mcu_sim_air_flush(uint32_t air_id)
+{
+    sim_air_t *p_air;
+
+    if ((air_id >= CONFIG_RF_MCU_SIM_AIR_NUM) || (!g_sim_air[air_id].started))
+    {
+        return;
+    }
+    p_air = &g_sim_air[air_id];
+    pthread_mutex_lock(&p_air->lock);
+    while (p_air->pending)
+    {
+        pthread_cond_wait(&p_air->cond, &p_air->lock);
+    }
+    pthread_mutex_unlock(&p_air->lock);
+}
+
+/**************************************************************************************************
+ *    RF MCU FUNCTIONS
+ *************************************************************************************************/
+RF_MCU_INIT_STATUS RfMcu_SysInit(bool load_image, const uint8_t *p_sys_image, uint32_t image_size,
+                                 COMM_SUBSYSTEM_ISR_CONFIG rf_mcu_isr_cfg,
+                                 RF_MCU_INIT_STATUS rf_mcu_init_state)
+{
+    UNUSED(load_image);
+    UNUSED(p_sys_image);
+    UNUSED(image_size);
+
+    if (rf_mcu_init_state != RF_MCU_INIT_NO_ERROR)
+    {
+        return rf_mcu_init_state;
+    }
+    if (!sim_inst()->used)
+    {
+        return RF_MCU_CPU_AWAKE_FAIL;
+    }
+    RfMcu_IsrInit(rf_mcu_isr_cfg.commsubsystem_isr, rf_mcu_isr_cfg.content);
+    sim_inst()->state = RF_MCU_STATE_INIT_SUCCEED;
+    return RF_MCU_INIT_NO_ERROR;
+}
+
+RF_MCU_INIT_STATUS RfMcu_SysInitWithPatch(bool load_image, const uint8_t *p_sys_image,
+        uint32_t sys_image_size, const uint8_t *p_patch_image,
+        uint32_t patch_image_size, COMM_SUBSYSTEM_ISR_CONFIG rf_mcu_isr_cfg,
+        RF_MCU_INIT_STATUS rf_mcu_init_state)
+{
+    UNUSED(p_patch_image);
+    UNUSED(patch_image_size);
+    return RfMcu_SysInit(load_image, p_sys_image, sys_image_size, rf_mcu_isr_cfg,
+                         rf_mcu_init_state);
+}
+
+RF_MCU_INIT_STATUS RfMcu_SysInitWithConst(bool load_image, const uint8_t *p_sys_image,
+        uint32_t sys_image_size, const uint8_t *p_const, uint32_t const_size,
+        COMM_SUBSYSTEM_ISR_CONFIG rf_mcu_isr_cfg,
+        RF_MCU_INIT_STATUS rf_mcu_init_state)
+{
+    UNUSED(p_const);
+    UNUSED(const_size);
+    return RfMcu_SysInit(load_image, p_sys_image, sys_image_size, rf_mcu_isr_cfg,
+                         rf_mcu_init_state);
+}
+
+void RfMcu_IsrInit(COMM_SUBSYSTEM_ISR_t isr, uint32_t content)
+{
+    UNUSED(content);
+    pthread_mutex_lock(&sim_inst()->lock);
+    sim_inst()->isr = isr;
+    pthread_mutex_unlock(&sim_inst()->lock);
+}
+
+void RfMcu_IsrHandler(void)
+{
+    sim_raise(g_sim_cur, 0);
+}
+
+void RfMcu_InterruptDisableAll(void)
+{
+    pthread_mutex_lock(&sim_inst()->lock);
+}
+
+void RfMcu_InterruptEnableAll(void)
+{
+    pthread_mutex_unlock(&sim_inst()->lock);
+}
+
+void RfMcu_InterruptClear(uint32_t value)
+{
+    pthread_mutex_lock(&sim_inst()->lock);
+    sim_inst()->int_pending &= ~value;
+    pthread_mutex_unlock(&sim_inst()->lock);
+}
+
+uint16_t RfMcu_InterruptEnGet(void)
+{
+    return (uint16_t)sim_inst()->int_enable;
+}
+
+void RfMcu_InterruptEnSet(uint16_t int_enable)
+{
+    pthread_mutex_lock(&sim_inst()->lock);
+    sim_inst()->int_enable = int_enable;
+    pthread_mutex_unlock(&sim_inst()->lock);
+}
+
+RF_MCU_STATE RfMcu_McuStateRead(void)
+{
+    return sim_inst()->state;
+}
+
+void RfMcu_HostCmdSet(uint8_t cmd)
+{
+    /* the host acknowledges the TX state bits */
+    pthread_mutex_lock(&sim_inst()->lock);
+    sim_inst()->state = (RF_MCU_STATE)(sim_inst()->state & ~(cmd | RF_MCU_STATE_EVENT_DONE));
+    pthread_mutex_unlock(&sim_inst()->lock);
+}
+
+void RfMcu_HostWakeUpMcu(void)
+{
+}
+
+uint8_t RfMcu_PowerStateCheck(void)
+{
+    return (sim_inst()->used) ? RF_MCU_PWR_STATE_NORMAL : RF_MCU_PWR_STATE_DEEP_SLEEP;
+}
+
+void RfMcu_DmaInit(void)
+{
+}
+
+bool RfMcu_RxQueueCheck(void)
+{
+    return sim_inst()->rxq.wr != sim_inst()->rxq.rd;
+}
+
+uint16_t RfMcu_RxQueueRead(uint8_t *rx_data, RF_MCU_RXQ_ERROR *rx_queue_error)
+{
+    uint16_t len;
+
+    pthread_mutex_lock(&sim_inst()->lock);
+    len = sim_queue_pop(&sim_inst()->rxq, rx_data);
+    pthread_mutex_unlock(&sim_inst()->lock);
+
+    *rx_queue_error = (len) ? RF_MCU_RXQ_GET_SUCCESS : RF_MCU_RXQ_NOT_AVAILABLE;
+    return len;
+}
+
+bool RfMcu_EvtQueueCheck(void)
+{
+    return sim_inst()->evtq.wr != sim_inst()->evtq.rd;
+}
+
+uint16_t RfMcu_EvtQueueRead(uint8_t *evt, RF_MCU_RX_CMDQ_ERROR *rx_evt_error)
+{
+    uint16_t len;
+
+    pthread_mutex_lock(&sim_inst()->lock);
+    len = sim_queue_pop(&sim_inst()->evtq, evt);
+    pthread_mutex_unlock(&sim_inst()->lock);
+
+    *rx_evt_error = (len) ? RF_MCU_RX_CMDQ_GET_SUCCESS : RF_MCU_RX_CMDQ_NOT_AVAILABLE;
+    return len;
+}
+
+bool RfMcu_CmdQueueFullCheck(void)
+{
+    /* the command model runs in RfMcu_CmdQueueSend */
+    return false;
+}
+
+RF_MCU_TX_CMDQ_ERROR RfMcu_CmdQueueSend(const uint8_t *cmd, uint32_t cmd_length)
+{
+    if ((!sim_inst()->used) || (cmd_length == 0) || (cmd_length > RF_MCU_SIM_FRAME_SIZE))
+    {
+        return RF_MCU_TX_CMDQ_ERR_INIT;
+    }
+
+    pthread_mutex_lock(&sim_inst()->lock);
+    sim_inst()->stats.cmd_num++;
+    pthread_mutex_unlock(&sim_inst()->lock);
+
+    sim_inst()->cmd_fn(g_sim_cur, cmd, cmd_length);
+    return RF_MCU_TX_CMDQ_SET_SUCCESS;
+}
+
+bool RfMcu_TxQueueFullCheck(void)
+{
+    return sim_txq_free(sim_inst()) == 0;
+}
+
+RF_MCU_TXQ_ERROR RfMcu_TxQueueSendById(uint8_t queue_id, const uint8_t *tx_data,
+                                       uint32_t data_length)
+{
+    sim_inst_t *p_inst = sim_inst();
+    sim_air_t *p_air;
+
+    if ((!p_inst->used) || (queue_id >= RF_MCU_SIM_TXQ_NUM) || (data_length == 0)
+            || (data_length > RF_MCU_SIM_FRAME_SIZE))
+    {
+        return RF_MCU_TXQ_ERR_INIT;
+    }
+    p_air = &g_sim_air[p_inst->air_id];
+
+    pthread_mutex_lock(&p_inst->lock);
+    if (p_inst->txq_busy & (1 << queue_id))
+    {
+        p_inst->stats.tx_full_num++;
+        pthread_mutex_unlock(&p_inst->lock);
+        return RF_MCU_TXQ_FULL;
+    }
+    p_inst->txq[queue_id].len = data_length;
+    memcpy(p_inst->txq[queue_id].data, tx_data, data_length);
+
+    pthread_mutex_lock(&p_air->lock);
+    p_inst->txq_seq[queue_id] = p_air->seq++;
+    p_inst->txq_busy |= (1 << queue_id);
+    p_air->pending++;
+    pthread_cond_broadcast(&p_air->cond);
+    pthread_mutex_unlock(&p_air->lock);
+    pthread_mutex_unlock(&p_inst->lock);
+
+    return RF_MCU_TXQ_SET_SUCCESS;
+}
+
+RF_MCU_TXQ_ERROR RfMcu_TxQueueSend(uint8_t *tx_data, uint32_t data_length)
+{
+    uint8_t txq_free = sim_txq_free(sim_inst());
+
+    if (txq_free == 0)
+    {
+        return RF_MCU_TXQ_FULL;
+    }
+    return RfMcu_TxQueueSendById((uint8_t)__builtin_ctz(txq_free), tx_data, data_length);
+}
+
+void RfMcu_MemorySet(uint16_t sys_addr, const uint8_t *p_data, uint16_t data_length)
+{
+    if (((uint32_t)sys_addr + data_length) > RF_MCU_SIM_MEM_SIZE)
+    {
+        return;
+    }
+    pthread_mutex_lock(&sim_inst()->lock);
+    memcpy(&sim_inst()->mem[sys_addr], p_data, data_length);
+    pthread_mutex_unlock(&sim_inst()->lock);
+}
+
+void RfMcu_MemoryGet(uint16_t sys_addr, uint8_t *p_data, uint16_t data_length)
+{
+    sim_inst_t *p_inst = sim_inst();
+    uint32_t txq_free;
+
+    if (((uint32_t)sys_addr + data_length) > RF_MCU_SIM_MEM_SIZE)
+    {
+        memset(p_data, 0, data_length);
+        return;
+    }
+    pthread_mutex_lock(&p_inst->lock);
+    txq_free = sim_txq_free(p_inst) | RF_MCU_SIM_TXQ_FREE_RSVD;
+    memcpy(&p_inst->mem[RF_MCU_SIM_TXQ_FREE_ADDR], &txq_free, sizeof(txq_free));
+    memcpy(p_data, &p_inst->mem[sys_addr], data_length);
+    pthread_mutex_unlock(&p_inst->lock);
+}
@@ -0,0 +1,439 @@
+/**************************************************************************//**
+ * @file     hosal_rf_sim_bench.c
+ * @version
+ * @brief    Benchmark and checks of hosal_rf.c on the simulated rf mcu
+ *
+ * hosal_rf.c is built in this file with the host FreeRTOS of bench/host, its
+ * task is a thread and its ISR is called by the simulated rf mcu. It runs in
+ * multi-protocol mode with the 2.4G O-QPSK modem:
+ *   cmd: RUCI commands by hosal_rf_ioctl(), the confirm events go through the
+ *        event buffer pool and the event queue.
+ *   evt: more events than event buffers while nothing reads them, the extra
+ *        events are dropped and counted, the commands work again after the
+ *        reader takes the queued ones.
+ *   rx : bursts of mixed HCI ACL and 15.4 frames of the max lengths, every
+ *        frame must be delivered in order, inside g_rx_data or a lent buffer.
+ *
+ *   cc -O2 -pthread -DCONFIG_HOSAL_RF_RX_BATCH
+ *      -Inetwork/rt569-rf/sim/bench/host -Iplatform/hosal/rt582_hosal/Inc
+ *      -Inetwork/rt569-rf/rt582/include -Inetwork/ruci/include
+ *      -Inetwork/rt569-rf/sim/include -Inetwork/rt569-rf/sim/host
+ *      -Iplatform/hosal/rt582_hosal/Src
+ *      network/rt569-rf/sim/Src/rf_mcu_sim.c
+ *      network/rt569-rf/sim/bench/hosal_rf_sim_bench.c -o hosal_rf_sim_bench
+ *   hosal_rf_sim_bench [-n commands] [-b rx bursts] [-m cmd|evt|rx]
+ *
+ * The exit status is not 0 if a check fails, a run is stuck for more than
+ * BENCH_TIMEOUT_SEC or hosal_rf.c logs an unexpected error.
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rf_mcu_sim.h"
+
+/* the target definitions used by hosal_rf.c */
+#define __STATIC_FORCEINLINE            static inline
+#define CommSubsystem_IRQn              (0)
+#define NVIC_SetPriority(irq, prio)     ((void)(irq), (void)(prio))
+#define __disable_irq()                 ((void)0)
+#define ASSERT()                        abort()
+#define E_TASK_PRIORITY_HOSAL           (0)
+
+static pthread_mutex_t g_bench_critical;
+
+static void enter_critical_section(void)
+{
+    pthread_mutex_lock(&g_bench_critical);
+}
+
+static void leave_critical_section(void)
+{
+    pthread_mutex_unlock(&g_bench_critical);
+}
+
+#include "hosal_rf.c"
+
+#define BENCH_DUT               (0)
+#define BENCH_AIR               (0)
+#define BENCH_TIMEOUT_SEC       (10)
+#define BENCH_HCI_ACL_HDR_LEN   (5)
+#define BENCH_PCI_RX_HDR_LEN    (4)
+
+typedef struct __attribute__((packed))
+{
+    uint32_t seq;
+    uint64_t ts;
+} bench_tag_t;
+
+volatile uint32_t g_bench_log_error_num;
+
+static uint32_t g_rx_sent;
+static volatile uint32_t g_rx_num;
+static volatile uint32_t g_rx_error;
+static volatile uint32_t g_rx_batch_num;
+static uint64_t g_rx_latency_sum;
+static unsigned int g_rx_seed = 1;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint8_t bench_pattern(uint32_t seq, uint32_t idx)
+{
+    return (uint8_t)(seq * 7 + idx);
+}
+
+static void bench_timeout(int sig)
+{
+    (void)sig;
+    static const char msg[] = "stuck\n";
+
+    write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    _exit(1);
+}
+
+uint32_t mpcalrftrimread(uint32_t mp_id, uint32_t byte_cnt, uint8_t *p_rx_data)
+{
+    (void)mp_id;
+    memset(p_rx_data, 0, byte_cnt);
+    return 0;
+}
+
+bool rf_common_init_by_fw(RF_FW_LOAD_SELECT fw_select, COMM_SUBSYSTEM_ISR_t isr_func)
+{
+    COMM_SUBSYSTEM_ISR_CONFIG isr_cfg = {0};
+
+    (void)fw_select;
+    isr_cfg.commsubsystem_isr = isr_func;
+    return RfMcu_SysInit(false, NULL, 0, isr_cfg, RF_MCU_INIT_NO_ERROR) == RF_MCU_INIT_NO_ERROR;
+}
+
+/* waits until the count reaches the value, false on BENCH_TIMEOUT_SEC */
+static bool bench_wait(volatile uint32_t *p_count, uint32_t value)
+{
+    uint64_t end = bench_now_ns() + BENCH_TIMEOUT_SEC * 1000000000ULL;
+
+    while (__atomic_load_n(p_count, __ATOMIC_ACQUIRE) < value)
+    {
+        if (bench_now_ns() > end)
+        {
+            return false;
+        }
+        usleep(100);
+    }
+    return true;
+}
+
+static int bench_cmd_run(uint32_t cmd_num)
+{
+    hosal_rf_evt_pool_stats_t pool;
+    uint64_t start, elapsed;
+    uint32_t i, err = 0, drop_cnt;
+
+    hosal_rf_evt_pool_stats_get(&pool);
+    drop_cnt = pool.drop_cnt;
+    start = bench_now_ns();
+    for (i = 0; i < cmd_num; i++)
+    {
+        if (hosal_rf_ioctl(HOSAL_RF_IOCTL_FREQUENCY_SET, (void *)(uintptr_t)(2405 + i % 16))
+                != HOSAL_RF_STATUS_SUCCESS)
+        {
+            err++;
+        }
+    }
+    elapsed = bench_now_ns() - start;
+    hosal_rf_evt_pool_stats_get(&pool);
+
+    printf("cmd  %6u commands: %.2f us/command, error %u\r\n", cmd_num, elapsed / 1e3 / cmd_num, err);
+    printf("     event pool %u, in use %u, high water %u, wait %u, drop %u\r\n", pool.total,
+           pool.in_use, pool.high_water, pool.wait_cnt, pool.drop_cnt);
+
+    return ((err) || (pool.in_use) || (pool.drop_cnt != drop_cnt)) ? -1 : 0;
+}
+
+/* more events than buffers and nothing reads them, the RF task must not block */
+static int bench_evt_run(void)
+{
+    hosal_rf_evt_pool_stats_t pool, after;
+    uint8_t evt[HOSAL_RF_EVT_BUF_SIZE];
+    uint32_t i, extra = 3, read_num = 0, bad = 0, errors;
+
+    hosal_rf_evt_pool_stats_get(&pool);
+    errors = g_bench_log_error_num;
+    for (i = 0; i < CONFIG_HOSAL_RF_EVT_BUF_NUM + extra; i++)
+    {
+        evt[0] = HOSAL_RF_RUCI_PCI_EVENT;
+        evt[1] = 0x01;
+        evt[2] = 2;
+        evt[3] = (uint8_t)i;
+        evt[4] = 0;
+        if (rf_mcu_sim_evt_push(BENCH_DUT, evt, 5) != 0)
+        {
+            printf("evt  event queue of the rf mcu full\r\n");
+            return -1;
+        }
+    }
+    if ((!bench_wait((volatile uint32_t *)&g_evt_pool_stats.drop_cnt, pool.drop_cnt + extra))
+            || (!bench_wait(&g_bench_log_error_num, errors + extra)))
+    {
+        printf("evt  the extra events are not dropped\r\n");
+        return -1;
+    }
+    /* the drops are expected */
+    g_bench_log_error_num = errors;
+
+    /* the queued events are the first ones, in order */
+    for (i = 0; i < CONFIG_HOSAL_RF_EVT_BUF_NUM; i++)
+    {
+        if ((hosal_rf_read_event(evt) != 5) || (evt[3] != (uint8_t)i))
+        {
+            bad++;
+        }
+        read_num++;
+    }
+    hosal_rf_evt_pool_stats_get(&after);
+
+    printf("evt  %u events to %u buffers: read %u, bad %u, dropped %u, in use %u\r\n",
+           CONFIG_HOSAL_RF_EVT_BUF_NUM + extra, after.total, read_num, bad,
+           after.drop_cnt - pool.drop_cnt, after.in_use);
+
+    /* the command path works again */
+    return ((bad) || (after.in_use) || (after.drop_cnt - pool.drop_cnt != extra)
+            || (bench_cmd_run(16) != 0)) ? -1 : 0;
+}
+
+static void bench_rx_check(const uint8_t *p_data, uint32_t len, uint64_t now)
+{
+    uint32_t hdr_len = (p_data[0] == HOSAL_RF_HCI_ACL_DATA) ? BENCH_HCI_ACL_HDR_LEN
+                       : BENCH_PCI_RX_HDR_LEN;
+    const uint8_t *p_payload = &p_data[hdr_len];
+    bool in_rx_data = (p_data >= g_rx_data) && (p_data + len <= g_rx_data + sizeof(g_rx_data));
+    bench_tag_t tag;
+    uint32_t i;
+
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    in_rx_data = in_rx_data || __rf_buffer_is_lent(p_data);
+#endif
+    if (!in_rx_data)
+    {
+        g_rx_error++;
+        return;
+    }
+    memcpy(&tag, p_payload, sizeof(tag));
+    for (i = sizeof(tag); i < len - hdr_len; i++)
+    {
+        if (p_payload[i] != bench_pattern(tag.seq, i))
+        {
+            g_rx_error++;
+            return;
+        }
+    }
+    if (tag.seq != g_rx_num)
+    {
+        g_rx_error++;
+    }
+    g_rx_latency_sum += now - tag.ts;
+    __atomic_store_n(&g_rx_num, g_rx_num + 1, __ATOMIC_RELEASE);
+}
+
+static int bench_rx_batch_cb(hosal_rf_rx_frame_t *p_frames, uint32_t num)
+{
+    uint64_t now = bench_now_ns();
+    uint32_t i;
+
+    g_rx_batch_num++;
+    for (i = 0; i < num; i++)
+    {
+        bench_rx_check(p_frames[i].p_data, p_frames[i].len, now);
+    }
+    return HOSAL_RF_CB_NOTHING;
+}
+
+static int bench_rx_cb(void *p_arg)
+{
+    uint8_t *p_data = (uint8_t *)p_arg;
+    uint32_t len;
+
+    g_rx_batch_num++;
+    if (p_data[0] == HOSAL_RF_HCI_ACL_DATA)
+    {
+        len = BENCH_HCI_ACL_HDR_LEN + (p_data[3] | (p_data[4] << 8));
+    }
+    else
+    {
+        len = BENCH_PCI_RX_HDR_LEN + (p_data[2] | (p_data[3] << 8)) + 3;
+    }
+    bench_rx_check(p_data, len, bench_now_ns());
+    /* a lent ACL frame is owned by the callback */
+    hosal_rf_buffer_release(p_data);
+    return HOSAL_RF_CB_NOTHING;
+}
+
+/* an HCI ACL frame of HOSAL_RF_RX_MAX_LEN_BLE bytes or a 15.4 frame of
+ * HOSAL_RF_RX_MAX_LEN_OQPSK bytes: header, PSDU, crc status, rssi and snr,
+ * two of three are ACL frames in a random order */
+static uint32_t bench_rx_build(uint8_t *p_rx, uint32_t seq)
+{
+    uint32_t hdr_len, len, i;
+    uint16_t data_len;
+    bench_tag_t tag;
+
+    if (rand_r(&g_rx_seed) % 3 != 0)
+    {
+        hdr_len = BENCH_HCI_ACL_HDR_LEN;
+        len = HOSAL_RF_RX_MAX_LEN_BLE;
+        data_len = (uint16_t)(len - hdr_len);
+        p_rx[0] = HOSAL_RF_HCI_ACL_DATA;
+        p_rx[1] = 0x01;
+        p_rx[2] = 0x00;
+        memcpy(&p_rx[3], &data_len, 2);
+    }
+    else
+    {
+        hdr_len = BENCH_PCI_RX_HDR_LEN;
+        len = HOSAL_RF_RX_MAX_LEN_OQPSK;
+        data_len = (uint16_t)(len - hdr_len - 3);
+        p_rx[0] = RUCI_PCI_DATA_HEADER;
+        p_rx[1] = 0x00;
+        memcpy(&p_rx[2], &data_len, 2);
+    }
+    for (i = sizeof(tag); i < len - hdr_len; i++)
+    {
+        p_rx[hdr_len + i] = bench_pattern(seq, i);
+    }
+    tag.seq = seq;
+    tag.ts = bench_now_ns();
+    memcpy(&p_rx[hdr_len], &tag, sizeof(tag));
+    return len;
+}
+
+static int bench_rx_run(uint32_t burst_num)
+{
+    uint8_t rx[RF_MCU_SIM_FRAME_SIZE];
+    uint64_t start, elapsed;
+    uint32_t i, k, len;
+
+    g_rx_sent = 0;
+    g_rx_num = 0;
+    g_rx_error = 0;
+    g_rx_batch_num = 0;
+    g_rx_latency_sum = 0;
+
+    start = bench_now_ns();
+    for (i = 0; i < burst_num; i++)
+    {
+        /* the RF task reads the burst after the interrupts are enabled */
+        RfMcu_InterruptDisableAll();
+        for (k = 0; k < CONFIG_RF_MCU_SIM_RXQ_DEPTH; k++)
+        {
+            len = bench_rx_build(rx, g_rx_sent);
+            if (rf_mcu_sim_rx_push(BENCH_DUT, rx, len) != 0)
+            {
+                break;
+            }
+            g_rx_sent++;
+        }
+        RfMcu_InterruptEnableAll();
+        if (!bench_wait(&g_rx_num, g_rx_sent))
+        {
+            break;
+        }
+    }
+    elapsed = bench_now_ns() - start;
+
+    printf("rx   %6u frames in bursts of %u, acl %u B, 15.4 %u B: %9.0f frames/s\r\n", g_rx_sent,
+           CONFIG_RF_MCU_SIM_RXQ_DEPTH, HOSAL_RF_RX_MAX_LEN_BLE, HOSAL_RF_RX_MAX_LEN_OQPSK,
+           g_rx_sent * 1e9 / elapsed);
+    printf("     rx %u error %u, %u callbacks, latency avg %.1f us\r\n", g_rx_num, g_rx_error,
+           g_rx_batch_num, (g_rx_num) ? g_rx_latency_sum / 1e3 / g_rx_num : 0.0);
+
+    return ((g_rx_error) || (g_rx_num != g_rx_sent)
+            || (g_rx_sent != burst_num * CONFIG_RF_MCU_SIM_RXQ_DEPTH)) ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    hosal_rf_15p4_modem_cnf_t modem_cnf = {HOSAL_RF_MODEM_2P4G_OQPSK, 0};
+    pthread_mutexattr_t attr;
+    uint32_t cmd_num = 10000, burst_num = 1000;
+    const char *p_mode_name = NULL;
+    int opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "n:b:m:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            cmd_num = strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            burst_num = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            p_mode_name = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n commands] [-b rx bursts] [-m cmd|evt|rx]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&g_bench_critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+    signal(SIGALRM, bench_timeout);
+    if (rf_mcu_sim_init(BENCH_DUT, BENCH_AIR) != 0)
+    {
+        fprintf(stderr, "init fail\n");
+        return 1;
+    }
+    rf_mcu_sim_select(BENCH_DUT);
+    hosal_rf_init(HOSAL_RF_MODE_MULTI_PROTOCOL);
+    hosal_rf_rx_batch_callback_set(HOSAL_RF_PCI_RX_CALLBACK, bench_rx_batch_cb);
+    hosal_rf_rx_batch_callback_set(HOSAL_RF_BLE_RX_CALLBACK, bench_rx_batch_cb);
+    hosal_rf_callback_set(HOSAL_RF_PCI_RX_CALLBACK, bench_rx_cb, NULL);
+    hosal_rf_callback_set(HOSAL_RF_BLE_RX_CALLBACK, bench_rx_cb, NULL);
+
+    alarm(BENCH_TIMEOUT_SEC);
+    if (hosal_rf_ioctl(HOSAL_RF_IOCTL_MODEM_SET, &modem_cnf) != HOSAL_RF_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "modem set fail\n");
+        return 1;
+    }
+
+    if ((p_mode_name == NULL) || (strcmp(p_mode_name, "cmd") == 0))
+    {
+        alarm(BENCH_TIMEOUT_SEC);
+        ret |= (bench_cmd_run(cmd_num) != 0);
+    }
+    if ((p_mode_name == NULL) || (strcmp(p_mode_name, "evt") == 0))
+    {
+        alarm(BENCH_TIMEOUT_SEC);
+        ret |= (bench_evt_run() != 0);
+    }
+    if ((p_mode_name == NULL) || (strcmp(p_mode_name, "rx") == 0))
+    {
+        alarm(BENCH_TIMEOUT_SEC * 6);
+        ret |= (bench_rx_run(burst_num) != 0);
+    }
+    alarm(0);
+
+    if (g_bench_log_error_num)
+    {
+        printf("%u errors logged\r\n", g_bench_log_error_num);
+        ret = 1;
+    }
+    return ret;
+}
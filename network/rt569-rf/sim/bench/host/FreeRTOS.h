@@ -0,0 +1,97 @@
+/**************************************************************************//**
+ * @file     FreeRTOS.h
+ * @version
+ * @brief    the FreeRTOS types, ticks and heap used by hosal_rf.c in a host build
+ *
+ * Only for the host build of the hosal rf benchmark. The tasks are threads,
+ * the ISRs of the simulated rf mcu run in the air thread and in the threads
+ * pushing frames, so the semaphores and queues are thread safe. A tick is a
+ * millisecond of CLOCK_MONOTONIC.
+ *
+ ******************************************************************************/
+
+#ifndef __RF_MCU_SIM_BENCH_HOST_FREERTOS_H__
+#define __RF_MCU_SIM_BENCH_HOST_FREERTOS_H__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define errQUEUE_FULL           ((BaseType_t)0)
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define tskIDLE_PRIORITY        (0)
+
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+/* the ISRs are threads, the task and the ISR APIs are the same */
+#define xPortIsInsideInterrupt() pdFALSE
+
+#define pvPortMalloc(size)      malloc(size)
+#define vPortFree(p)            free(p)
+
+#define configASSERT(x)                                                         \
+    do                                                                          \
+    {                                                                           \
+        if (!(x))                                                               \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: assert %s\n", __FILE__, __LINE__, #x);      \
+            abort();                                                            \
+        }                                                                       \
+    } while (0)
+
+static inline TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/* the CLOCK_MONOTONIC deadline of a wait of ticks for pthread_cond_timedwait */
+static inline void host_deadline(struct timespec *p_ts, TickType_t ticks)
+{
+    clock_gettime(CLOCK_MONOTONIC, p_ts);
+    p_ts->tv_sec += ticks / 1000;
+    p_ts->tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (p_ts->tv_nsec >= 1000000000L)
+    {
+        p_ts->tv_sec++;
+        p_ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* a condition variable of CLOCK_MONOTONIC */
+static inline void host_cond_init(pthread_cond_t *p_cond)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(p_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/* waits on the condition of a locked mutex, returns pdFALSE on time out */
+static inline BaseType_t host_cond_wait(pthread_cond_t *p_cond, pthread_mutex_t *p_lock,
+                                        const struct timespec *p_deadline, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        pthread_cond_wait(p_cond, p_lock);
+        return pdTRUE;
+    }
+    return (pthread_cond_timedwait(p_cond, p_lock, p_deadline) == 0) ? pdTRUE : pdFALSE;
+}
+
+#endif /* __RF_MCU_SIM_BENCH_HOST_FREERTOS_H__ */
@@ -0,0 +1,35 @@
+/**************************************************************************//**
+ * @file     log.h
+ * @version
+ * @brief    the log used by hosal_rf.c in a host build
+ *
+ * The benchmark counts the errors, the warnings go to stderr and the other
+ * logs are dropped. Only for the host build of the hosal rf benchmark.
+ *
+ ******************************************************************************/
+
+#ifndef __RF_MCU_SIM_BENCH_HOST_LOG_H__
+#define __RF_MCU_SIM_BENCH_HOST_LOG_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+extern volatile uint32_t g_bench_log_error_num;
+
+#define log_error(...)                                                          \
+    do                                                                          \
+    {                                                                           \
+        __atomic_fetch_add(&g_bench_log_error_num, 1, __ATOMIC_RELAXED);        \
+        fprintf(stderr, __VA_ARGS__);                                           \
+        fprintf(stderr, "\n");                                                  \
+    } while (0)
+#define log_warn(...)                                                           \
+    do                                                                          \
+    {                                                                           \
+        fprintf(stderr, __VA_ARGS__);                                           \
+        fprintf(stderr, "\n");                                                  \
+    } while (0)
+#define log_info(...)       ((void)0)
+#define log_debug(...)      ((void)0)
+
+#endif /* __RF_MCU_SIM_BENCH_HOST_LOG_H__ */
@@ -0,0 +1,39 @@
+/**************************************************************************//**
+ * @file     mp_sector.h
+ * @version
+ * @brief    the MP sector items used by hosal_rf.c in a host build
+ *
+ * Only for the host build of the hosal rf benchmark, the benchmark reads the
+ * items as zeros.
+ *
+ ******************************************************************************/
+
+#ifndef __RF_MCU_SIM_BENCH_HOST_MP_SECTOR_H__
+#define __RF_MCU_SIM_BENCH_HOST_MP_SECTOR_H__
+
+#include <stdint.h>
+
+#define MP_ID_TX_POWER_TRIM     (0x5A010011)
+#define MP_CNT_TX_POWER_TRIM    (sizeof(mp_tx_power_trim_t))
+
+typedef struct __attribute__((packed))
+{
+    uint32_t mp_id;
+    uint8_t mp_valid;
+    uint16_t mp_cnt;
+} mp_sector_head_t;
+
+typedef struct __attribute__((packed))
+{
+    mp_sector_head_t head;
+    uint8_t flag;
+    uint8_t mode;
+    uint8_t tx_gain_idx_2g_fsk;
+    uint8_t tx_gain_idx_subg0_fsk;
+    uint8_t tx_gain_idx_subg1_fsk;
+    uint8_t tx_gain_idx_subg2_fsk;
+} mp_tx_power_trim_t;
+
+uint32_t mpcalrftrimread(uint32_t mp_id, uint32_t byte_cnt, uint8_t *p_rx_data);
+
+#endif /* __RF_MCU_SIM_BENCH_HOST_MP_SECTOR_H__ */
@@ -0,0 +1,104 @@
+/**************************************************************************//**
+ * @file     queue.h
+ * @version
+ * @brief    the FreeRTOS queue used by hosal_rf.c in a host build
+ *
+ * A ring of fixed size items with a mutex and a condition variable, the send
+ * and the receive wait up to the ticks given. Only for the host build of the
+ * hosal rf benchmark, it is one translation unit.
+ *
+ ******************************************************************************/
+
+#ifndef __RF_MCU_SIM_BENCH_HOST_QUEUE_H__
+#define __RF_MCU_SIM_BENCH_HOST_QUEUE_H__
+
+#include <string.h>
+#include "FreeRTOS.h"
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *p_items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+} host_queue_t;
+
+typedef host_queue_t *QueueHandle_t;
+
+static inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = calloc(1, sizeof(host_queue_t));
+
+    if (queue)
+    {
+        pthread_mutex_init(&queue->lock, NULL);
+        host_cond_init(&queue->cond);
+        queue->p_items = calloc(length, item_size);
+        queue->length = length;
+        queue->item_size = item_size;
+    }
+    return queue;
+}
+
+static inline BaseType_t xQueueSend(QueueHandle_t queue, const void *p_item, TickType_t wait)
+{
+    struct timespec deadline;
+    BaseType_t ret = pdTRUE;
+
+    host_deadline(&deadline, wait);
+    pthread_mutex_lock(&queue->lock);
+    while ((queue->count == queue->length) && (ret == pdTRUE))
+    {
+        ret = (wait == 0) ? pdFALSE : host_cond_wait(&queue->cond, &queue->lock, &deadline, wait);
+    }
+    ret = errQUEUE_FULL;
+    if (queue->count < queue->length)
+    {
+        memcpy(queue->p_items + ((queue->head + queue->count) % queue->length) * queue->item_size,
+               p_item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->cond);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ret;
+}
+
+static inline BaseType_t xQueueReceive(QueueHandle_t queue, void *p_item, TickType_t wait)
+{
+    struct timespec deadline;
+    BaseType_t ret = pdTRUE;
+
+    host_deadline(&deadline, wait);
+    pthread_mutex_lock(&queue->lock);
+    while ((queue->count == 0) && (ret == pdTRUE))
+    {
+        ret = (wait == 0) ? pdFALSE : host_cond_wait(&queue->cond, &queue->lock, &deadline, wait);
+    }
+    ret = pdFALSE;
+    if (queue->count)
+    {
+        memcpy(p_item, queue->p_items + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->cond);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ret;
+}
+
+static inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    UBaseType_t count;
+
+    pthread_mutex_lock(&queue->lock);
+    count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+#endif /* __RF_MCU_SIM_BENCH_HOST_QUEUE_H__ */
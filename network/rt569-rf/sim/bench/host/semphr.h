@@ -0,0 +1,91 @@
+/**************************************************************************//**
+ * @file     semphr.h
+ * @version
+ * @brief    the FreeRTOS semaphores used by hosal_rf.c in a host build
+ *
+ * A semaphore is a count of a mutex and a condition variable, taken from
+ * the threads and given from the threads and the ISRs. Only for the host
+ * build of the hosal rf benchmark, it is one translation unit.
+ *
+ ******************************************************************************/
+
+#ifndef __RF_MCU_SIM_BENCH_HOST_SEMPHR_H__
+#define __RF_MCU_SIM_BENCH_HOST_SEMPHR_H__
+
+#include "FreeRTOS.h"
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max, UBaseType_t initial,
+                                                               StaticSemaphore_t *p_sem)
+{
+    pthread_mutex_init(&p_sem->lock, NULL);
+    host_cond_init(&p_sem->cond);
+    p_sem->count = initial;
+    p_sem->max = max;
+    return p_sem;
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *p_sem)
+{
+    return xSemaphoreCreateCountingStatic(1, 0, p_sem);
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateBinaryStatic(malloc(sizeof(StaticSemaphore_t)));
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+    struct timespec deadline;
+    BaseType_t ret = pdTRUE;
+
+    host_deadline(&deadline, wait);
+    pthread_mutex_lock(&sem->lock);
+    while ((sem->count == 0) && (ret == pdTRUE))
+    {
+        ret = (wait == 0) ? pdFALSE : host_cond_wait(&sem->cond, &sem->lock, &deadline, wait);
+    }
+    if (sem->count)
+    {
+        sem->count--;
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    BaseType_t ret = pdFALSE;
+
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count < sem->max)
+    {
+        sem->count++;
+        pthread_cond_signal(&sem->cond);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+static inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *p_woken)
+{
+    if (p_woken)
+    {
+        *p_woken = pdFALSE;
+    }
+    return xSemaphoreGive(sem);
+}
+
+#endif /* __RF_MCU_SIM_BENCH_HOST_SEMPHR_H__ */
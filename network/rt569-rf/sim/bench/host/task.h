@@ -0,0 +1,120 @@
+/**************************************************************************//**
+ * @file     task.h
+ * @version
+ * @brief    the FreeRTOS tasks and task notifications used by hosal_rf.c and
+ *           hci_bridge.c in a host build
+ *
+ * A task is a detached thread, it runs on the simulated rf mcu instance of
+ * the thread creating it. Only for the host build of the hosal rf benchmark,
+ * it is one translation unit.
+ *
+ ******************************************************************************/
+
+#ifndef __RF_MCU_SIM_BENCH_HOST_TASK_H__
+#define __RF_MCU_SIM_BENCH_HOST_TASK_H__
+
+#include <sched.h>
+#include <unistd.h>
+#include "FreeRTOS.h"
+#include "rf_mcu_sim.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+typedef struct
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    uint32_t inst;
+    TaskFunction_t func;
+    void *param;
+} host_task_t;
+
+typedef host_task_t *TaskHandle_t;
+
+/* the task of the calling thread, for ulTaskNotifyTake() */
+static __thread host_task_t *g_host_task_self;
+
+static void *host_task_proc(void *arg)
+{
+    host_task_t *p_task = (host_task_t *)arg;
+
+    g_host_task_self = p_task;
+    rf_mcu_sim_select(p_task->inst);
+    p_task->func(p_task->param);
+    return NULL;
+}
+
+static inline BaseType_t xTaskCreate(TaskFunction_t func, const char *name, uint32_t stack,
+                                     void *param, UBaseType_t priority, TaskHandle_t *p_handle)
+{
+    host_task_t *p_task = calloc(1, sizeof(host_task_t));
+
+    (void)name;
+    (void)stack;
+    (void)priority;
+    if (p_task == NULL)
+    {
+        return pdFAIL;
+    }
+    pthread_mutex_init(&p_task->lock, NULL);
+    host_cond_init(&p_task->cond);
+    p_task->inst = rf_mcu_sim_current();
+    p_task->func = func;
+    p_task->param = param;
+    if (p_handle)
+    {
+        *p_handle = p_task;
+    }
+    if (pthread_create(&p_task->thread, NULL, host_task_proc, p_task) != 0)
+    {
+        return pdFAIL;
+    }
+    pthread_detach(p_task->thread);
+    return pdPASS;
+}
+
+static inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    host_task_t *p_task = g_host_task_self;
+    struct timespec deadline;
+    uint32_t value;
+
+    configASSERT(p_task);
+    host_deadline(&deadline, wait);
+    pthread_mutex_lock(&p_task->lock);
+    while ((p_task->notify == 0) && (wait != 0)
+            && (host_cond_wait(&p_task->cond, &p_task->lock, &deadline, wait) == pdTRUE)) {}
+    value = p_task->notify;
+    if (value)
+    {
+        p_task->notify = (clear) ? 0 : (value - 1);
+    }
+    pthread_mutex_unlock(&p_task->lock);
+    return value;
+}
+
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *p_woken)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    if (p_woken)
+    {
+        *p_woken = pdFALSE;
+    }
+}
+
+/* NULL in a thread which is not a task */
+static inline TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return g_host_task_self;
+}
+
+#define xTaskNotifyGive(task)   vTaskNotifyGiveFromISR(task, NULL)
+#define taskYIELD()             sched_yield()
+#define vTaskDelay(ticks)       usleep((useconds_t)(ticks) * 1000)
+
+#endif /* __RF_MCU_SIM_BENCH_HOST_TASK_H__ */
@@ -0,0 +1,334 @@
+/**************************************************************************//**
+ * @file     rf_mcu_sim_bench.c
+ * @version
+ * @brief    Throughput and latency benchmark of the simulated rf mcu
+ *
+ * Two instances on one air, the sender transmits by the TX queue sequence of
+ * hosal_rf_write_tx_data() (free mask at 0x0048 and RfMcu_TxQueueSendById),
+ * the receiver reads the RX queue in its ISR and checks the frames:
+ *
+ *   cc -O2 -pthread -Inetwork/rt569-rf/rt582/include -Inetwork/ruci/include
+ *      -Inetwork/rt569-rf/sim/include -Inetwork/rt569-rf/sim/host
+ *      network/rt569-rf/sim/Src/rf_mcu_sim.c
+ *      network/rt569-rf/sim/bench/rf_mcu_sim_bench.c -o rf_mcu_sim_bench
+ *   rf_mcu_sim_bench [-n frames] [-r bit rate] [-l loss permille] [-m 15p4|ble]
+ *
+ * The exit status is not 0 if a frame is corrupted, out of order or missing
+ * without a counted loss.
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rf_mcu_sim.h"
+#include "ruci.h"
+
+#define BENCH_DUT               (0)
+#define BENCH_PEER              (1)
+#define BENCH_AIR               (0)
+
+#define BENCH_15P4_PSDU_LEN     (127)
+#define BENCH_BLE_ACL_LEN       (251)
+#define BENCH_HCI_ACL_HDR_LEN   (5)
+#define BENCH_PCI_RX_HDR_LEN    (4)
+
+typedef struct
+{
+    const char *name;
+    uint32_t hdr_len;       /* TX header before the payload */
+    uint32_t rx_hdr_len;    /* RX header before the payload */
+    uint32_t payload_len;
+} bench_mode_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t seq;
+    uint64_t ts;
+} bench_tag_t;
+
+static const bench_mode_t g_modes[] =
+{
+    {"15p4", RUCI_LEN_SET_TX_CONTROL_FIELD, BENCH_PCI_RX_HDR_LEN, BENCH_15P4_PSDU_LEN},
+    {"ble", BENCH_HCI_ACL_HDR_LEN, BENCH_HCI_ACL_HDR_LEN, BENCH_BLE_ACL_LEN},
+};
+
+static const bench_mode_t *g_mode;
+static uint32_t *g_latency;
+static uint32_t g_frame_num;
+static volatile uint32_t g_rx_num;
+static volatile uint32_t g_rx_error;
+static uint32_t g_next_seq;
+
+static pthread_mutex_t g_txq_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_txq_cond = PTHREAD_COND_INITIALIZER;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint8_t bench_pattern(uint32_t seq, uint32_t idx)
+{
+    return (uint8_t)(seq * 7 + idx);
+}
+
+static void bench_dut_isr(uint8_t int_status)
+{
+    RF_MCU_RX_CMDQ_ERROR evt_error;
+    uint8_t evt[RF_MCU_SIM_FRAME_SIZE];
+
+    RfMcu_InterruptClear(int_status);
+
+    if (int_status & RF_MCU_SIM_INT_EVENT)
+    {
+        /* number of completed packets of the ACL frames */
+        while (RfMcu_EvtQueueRead(evt, &evt_error)) {}
+    }
+    if (int_status & RF_MCU_SIM_INT_TX_DONE)
+    {
+        RfMcu_HostCmdSet((uint8_t)(RfMcu_McuStateRead() & 0xF4));
+    }
+
+    pthread_mutex_lock(&g_txq_lock);
+    pthread_cond_signal(&g_txq_cond);
+    pthread_mutex_unlock(&g_txq_lock);
+}
+
+static void bench_rx_check(const uint8_t *p_rx, uint32_t rx_len, uint64_t now)
+{
+    const uint8_t *p_payload = &p_rx[g_mode->rx_hdr_len];
+    bench_tag_t tag;
+    uint32_t i;
+
+    if (rx_len < g_mode->rx_hdr_len + g_mode->payload_len)
+    {
+        g_rx_error++;
+        return;
+    }
+    memcpy(&tag, p_payload, sizeof(tag));
+    for (i = sizeof(tag); i < g_mode->payload_len; i++)
+    {
+        if (p_payload[i] != bench_pattern(tag.seq, i))
+        {
+            g_rx_error++;
+            return;
+        }
+    }
+    /* lost frames are skipped, the others are in order */
+    if ((tag.seq < g_next_seq) || (tag.seq >= g_frame_num))
+    {
+        g_rx_error++;
+        return;
+    }
+    g_next_seq = tag.seq + 1;
+    g_latency[g_rx_num] = (uint32_t)(now - tag.ts);
+    g_rx_num++;
+}
+
+static void bench_peer_isr(uint8_t int_status)
+{
+    RF_MCU_RXQ_ERROR rx_error;
+    RF_MCU_RX_CMDQ_ERROR evt_error;
+    uint8_t rx[RF_MCU_SIM_FRAME_SIZE];
+    uint16_t rx_len;
+
+    RfMcu_InterruptClear(int_status);
+
+    if (int_status & RF_MCU_SIM_INT_RX_DATA)
+    {
+        while ((rx_len = RfMcu_RxQueueRead(rx, &rx_error)) != 0)
+        {
+            bench_rx_check(rx, rx_len, bench_now_ns());
+        }
+    }
+    if (int_status & RF_MCU_SIM_INT_EVENT)
+    {
+        while (RfMcu_EvtQueueRead(rx, &evt_error)) {}
+    }
+}
+
+static void bench_frame_build(uint8_t *p_tx, uint32_t seq)
+{
+    uint8_t *p_payload = &p_tx[g_mode->hdr_len];
+    uint16_t len;
+    bench_tag_t tag;
+    uint32_t i;
+
+    if (g_mode->hdr_len == RUCI_LEN_SET_TX_CONTROL_FIELD)
+    {
+        len = (uint16_t)(g_mode->payload_len + 2);
+        SET_RUCI_PARA_SET_TX_CONTROL_FIELD(p_tx, 0, (uint8_t)seq);
+        memcpy(&p_tx[2], &len, 2);
+    }
+    else
+    {
+        len = (uint16_t)g_mode->payload_len;
+        p_tx[0] = 0x02;     /* HCI ACL, handle 1 */
+        p_tx[1] = 0x01;
+        p_tx[2] = 0x00;
+        memcpy(&p_tx[3], &len, 2);
+    }
+
+    for (i = sizeof(tag); i < g_mode->payload_len; i++)
+    {
+        p_payload[i] = bench_pattern(seq, i);
+    }
+    tag.seq = seq;
+    tag.ts = bench_now_ns();
+    memcpy(p_payload, &tag, sizeof(tag));
+}
+
+/* the hosal_rf_write_tx_data() sequence, waits for a free TX queue */
+static void bench_send(const uint8_t *p_tx, uint32_t tx_len)
+{
+    struct timespec ts;
+    uint32_t reg_val;
+
+    for (;;)
+    {
+        RfMcu_MemoryGet(RF_MCU_SIM_TXQ_FREE_ADDR, (uint8_t *)&reg_val, 4);
+        if ((reg_val & 0x7F)
+                && (RfMcu_TxQueueSendById((uint8_t)__builtin_ctz(reg_val & 0x7F), p_tx, tx_len)
+                    == RF_MCU_TXQ_SET_SUCCESS))
+        {
+            return;
+        }
+
+        pthread_mutex_lock(&g_txq_lock);
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100000;
+        if (ts.tv_nsec >= 1000000000L)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&g_txq_cond, &g_txq_lock, &ts);
+        pthread_mutex_unlock(&g_txq_lock);
+    }
+}
+
+static int bench_cmp(const void *p_a, const void *p_b)
+{
+    uint32_t a = *(const uint32_t *)p_a, b = *(const uint32_t *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+static int bench_run(const bench_mode_t *p_mode, uint32_t frame_num, uint32_t bit_rate,
+                     uint32_t loss_permille)
+{
+    uint8_t tx[RF_MCU_SIM_FRAME_SIZE];
+    rf_mcu_sim_stats_t dut, peer;
+    uint64_t start, elapsed, sum = 0;
+    uint32_t i, missing;
+
+    g_mode = p_mode;
+    g_frame_num = frame_num;
+    g_rx_num = 0;
+    g_rx_error = 0;
+    g_next_seq = 0;
+    rf_mcu_sim_air_config(BENCH_AIR, bit_rate, loss_permille);
+    rf_mcu_sim_stats_reset(BENCH_DUT);
+    rf_mcu_sim_stats_reset(BENCH_PEER);
+
+    start = bench_now_ns();
+    for (i = 0; i < frame_num; i++)
+    {
+        bench_frame_build(tx, i);
+        bench_send(tx, p_mode->hdr_len + p_mode->payload_len);
+    }
+    rf_mcu_sim_air_flush(BENCH_AIR);
+    elapsed = bench_now_ns() - start;
+
+    rf_mcu_sim_stats_get(BENCH_DUT, &dut);
+    rf_mcu_sim_stats_get(BENCH_PEER, &peer);
+    missing = frame_num - g_rx_num - peer.rx_lost_num - peer.rx_overflow_num;
+
+    qsort(g_latency, g_rx_num, sizeof(uint32_t), bench_cmp);
+    for (i = 0; i < g_rx_num; i++)
+    {
+        sum += g_latency[i];
+    }
+
+    printf("%-4s %6u frames %4u B, bit rate %7u: %9.0f frames/s %8.2f Mbit/s\r\n",
+           p_mode->name, frame_num, p_mode->payload_len, bit_rate,
+           frame_num * 1e9 / elapsed, frame_num * p_mode->payload_len * 8e3 / elapsed);
+    if (g_rx_num)
+    {
+        printf("     latency us: avg %.1f p50 %.1f p99 %.1f max %.1f\r\n",
+               sum / 1e3 / g_rx_num, g_latency[g_rx_num / 2] / 1e3,
+               g_latency[(uint64_t)g_rx_num * 99 / 100] / 1e3, g_latency[g_rx_num - 1] / 1e3);
+    }
+    printf("     rx %u lost %u overflow %u error %u missing %u, tx queue full %u\r\n",
+           g_rx_num, peer.rx_lost_num, peer.rx_overflow_num, g_rx_error, missing,
+           dut.tx_full_num);
+
+    return ((g_rx_error) || (missing)) ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    COMM_SUBSYSTEM_ISR_CONFIG isr_cfg = {0};
+    uint32_t frame_num = 10000, bit_rate = 0, loss_permille = 0, i;
+    const char *p_mode_name = NULL;
+    int opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "n:r:l:m:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            frame_num = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            bit_rate = strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            loss_permille = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            p_mode_name = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n frames] [-r bit rate] [-l loss permille] [-m 15p4|ble]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    g_latency = malloc(sizeof(uint32_t) * (frame_num + 1));
+    if ((g_latency == NULL) || (rf_mcu_sim_init(BENCH_DUT, BENCH_AIR) != 0)
+            || (rf_mcu_sim_init(BENCH_PEER, BENCH_AIR) != 0))
+    {
+        fprintf(stderr, "init fail\n");
+        return 1;
+    }
+
+    rf_mcu_sim_select(BENCH_PEER);
+    isr_cfg.commsubsystem_isr = bench_peer_isr;
+    RfMcu_SysInit(false, NULL, 0, isr_cfg, RF_MCU_INIT_NO_ERROR);
+    rf_mcu_sim_select(BENCH_DUT);
+    isr_cfg.commsubsystem_isr = bench_dut_isr;
+    RfMcu_SysInit(false, NULL, 0, isr_cfg, RF_MCU_INIT_NO_ERROR);
+
+    for (i = 0; i < sizeof(g_modes) / sizeof(g_modes[0]); i++)
+    {
+        if ((p_mode_name == NULL) || (strcmp(p_mode_name, g_modes[i].name) == 0))
+        {
+            if (bench_run(&g_modes[i], frame_num, bit_rate, loss_permille) != 0)
+            {
+                ret = 1;
+            }
+        }
+    }
+
+    free(g_latency);
+    return ret;
+}
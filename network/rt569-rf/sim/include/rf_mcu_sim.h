@@ -0,0 +1,147 @@
+/**************************************************************************//**
+ * @file     rf_mcu_sim.h
+ * @version
+ * @brief    header file for the host simulated rf mcu
+ *
+ * The simulator implements the RfMcu_* queue API of rf_mcu.h with in-process
+ * queues, so hosal_rf.c and the radio ports above it run on a Linux host.
+ * The instances on the same air receive the frames transmitted by the other
+ * instances of the air, one thread per air moves the frames.
+ *
+ * The RfMcu_* API works on the instance selected by rf_mcu_sim_select() in
+ * the calling thread, the ISR of an instance is called with the instance
+ * selected.
+ *
+ ******************************************************************************/
+
+#ifndef __RF_MCU_SIM_H__
+#define __RF_MCU_SIM_H__
+
+#include "rf_mcu.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifndef CONFIG_RF_MCU_SIM_INST_NUM
+#define CONFIG_RF_MCU_SIM_INST_NUM          4
+#endif
+
+#ifndef CONFIG_RF_MCU_SIM_AIR_NUM
+#define CONFIG_RF_MCU_SIM_AIR_NUM           2
+#endif
+
+#ifndef CONFIG_RF_MCU_SIM_RXQ_DEPTH
+#define CONFIG_RF_MCU_SIM_RXQ_DEPTH         16
+#endif
+
+#ifndef CONFIG_RF_MCU_SIM_EVTQ_DEPTH
+#define CONFIG_RF_MCU_SIM_EVTQ_DEPTH        8
+#endif
+
+#define RF_MCU_SIM_TXQ_NUM                  7       /**< TX queues, the free mask is read at 0x0048 */
+#define RF_MCU_SIM_FRAME_SIZE               (512)   /**< max length of a queued frame */
+#define RF_MCU_SIM_MEM_SIZE                 (0x10000)
+
+/* interrupt status raised to the ISR, same bits as the hosal rf status */
+#define RF_MCU_SIM_INT_EVENT                (RF_MCU_SW_0_INTR)
+#define RF_MCU_SIM_INT_TX_DONE              (RF_MCU_SW_1_INTR)
+#define RF_MCU_SIM_INT_RX_DATA              (RF_MCU_BMU_RX_VALID_INTR)
+
+#define RF_MCU_SIM_TXQ_FREE_ADDR            (0x0048)
+/* a register bit above the TX queues, the register read is never 0 as
+ * hosal_rf_write_tx_data() asserts */
+#define RF_MCU_SIM_TXQ_FREE_RSVD            (0x80000000UL)
+
+/**
+ * @brief Firmware model of a command written to the command queue.
+ *
+ * The default model answers a HCI command with a command complete event and a
+ * RUCI command with a confirm event, both with success status.
+ */
+typedef void (*rf_mcu_sim_cmd_fn)(uint32_t inst, const uint8_t *p_cmd, uint32_t cmd_len);
+
+/**
+ * @brief Converts a frame transmitted by @p from to the frame received by @p to.
+ *
+ * @returns The length of the frame in @p p_rx, 0 if @p to does not receive it.
+ *
+ * The default converts a RUCI PCI TX frame (tx control field and PSDU) to a
+ * RX frame of the rx control field layout: header, sub header, length, PSDU,
+ * crc status, rssi and snr. The HCI ACL and the other frames are copied.
+ */
+typedef uint32_t (*rf_mcu_sim_rx_fn)(uint32_t from, uint32_t to, const uint8_t *p_tx,
+                                     uint32_t tx_len, uint8_t *p_rx);
+
+typedef struct
+{
+    uint32_t tx_num;            /**< frames transmitted */
+    uint32_t tx_bytes;
+    uint32_t tx_full_num;       /**< TX queue send to a busy queue */
+    uint32_t rx_num;            /**< frames queued to the RX queue */
+    uint32_t rx_bytes;
+    uint32_t rx_overflow_num;   /**< frames dropped by a full RX queue */
+    uint32_t rx_lost_num;       /**< frames dropped by the air loss rate */
+    uint32_t evt_num;
+    uint32_t evt_overflow_num;  /**< events dropped by a full event queue */
+    uint32_t cmd_num;
+} rf_mcu_sim_stats_t;
+
+/**
+ * Initializes an instance and joins it to an air, the air thread is started
+ * by the first instance of the air.
+ *
+ * @returns 0 on success, -1 on invalid arguments or thread error.
+ */
+int rf_mcu_sim_init(uint32_t inst, uint32_t air_id);
+
+/** Selects the instance of the RfMcu_* API in the calling thread. */
+void rf_mcu_sim_select(uint32_t inst);
+
+/** The instance selected in the calling thread. */
+uint32_t rf_mcu_sim_current(void);
+
+/**
+ * Configures the air.
+ *
+ * @param[in] bit_rate Bits per second to hold a frame on the air, 0: no air time.
+ * @param[in] loss_permille Frames lost per thousand receptions.
+ */
+void rf_mcu_sim_air_config(uint32_t air_id, uint32_t bit_rate, uint32_t loss_permille);
+
+/** Replaces the command model of an instance, NULL: the default model. */
+void rf_mcu_sim_cmd_fn_set(uint32_t inst, rf_mcu_sim_cmd_fn cmd_fn);
+
+/** Replaces the receiving conversion of an instance, NULL: the default. */
+void rf_mcu_sim_rx_fn_set(uint32_t inst, rf_mcu_sim_rx_fn rx_fn);
+
+/** Sets the MCU state read by RfMcu_McuStateRead() after a TX done. */
+void rf_mcu_sim_tx_state_set(uint32_t inst, RF_MCU_STATE state);
+
+/**
+ * Queues an event as the firmware and raises the event interrupt, for the
+ * command models.
+ *
+ * @returns 0 on success, -1 if the event queue is full.
+ */
+int rf_mcu_sim_evt_push(uint32_t inst, const uint8_t *p_evt, uint32_t evt_len);
+
+/**
+ * Queues a RX frame as the firmware and raises the RX interrupt.
+ *
+ * @returns 0 on success, -1 if the RX queue is full.
+ */
+int rf_mcu_sim_rx_push(uint32_t inst, const uint8_t *p_rx, uint32_t rx_len);
+
+void rf_mcu_sim_stats_get(uint32_t inst, rf_mcu_sim_stats_t *p_stats);
+void rf_mcu_sim_stats_reset(uint32_t inst);
+
+/** Waits until the TX queues of the air are empty. */
+void rf_mcu_sim_air_flush(uint32_t air_id);
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif /* __RF_MCU_SIM_H__ */
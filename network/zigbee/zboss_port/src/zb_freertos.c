@@ -21,6 +21,7 @@
 #include "zboss_api.h"
 #include "zigbee_platform.h"
 #include "fota_define.h"
+#include "util_crc32.h"
 
 //=============================================================================
 //                Private Definitions of const value
@@ -62,47 +63,7 @@ uint8_t SystemReadyToSleep(void)
 }
 uint32_t crc32(uint32_t flash_addr, uint32_t data_len)
 {
-    uint8_t RemainLen = (data_len & (0x3));
-    uint32_t i;
-    uint16_t j, k;
-    uint32_t ChkSum = ~0;
-    uint32_t Len = (data_len >> 2), Read;
-    uint32_t *FlashPtr = (uint32_t *)flash_addr;
-
-    for (i = 0; i < Len; i ++)
-    {
-        //get 32 bits at one time
-        Read = FlashPtr[i];
-        //get the CRC of 32 bits
-        for (j = 0; j < 32; j += 8)
-        {
-            //get the CRC of 8 bits
-            ChkSum ^= ((Read >> j) & 0xFF);
-            for (k = 0; k < 8; k ++)
-            {
-                ChkSum = (ChkSum & 1) ? (ChkSum >> 1) ^ 0xedb88320 : ChkSum >> 1;
-            }
-        }
-    }
-
-    /*if data_len not align 4 bytes*/
-    if (RemainLen > 0)
-    {
-        Read = FlashPtr[i];
-
-        //get the CRC of 32 bits
-        for (j = 0; j < (RemainLen << 3); j += 8)
-        {
-            //get the CRC of 8 bits
-            ChkSum ^= ((Read >> j) & 0xFF);
-            for (k = 0; k < 8; k ++)
-            {
-                ChkSum = (ChkSum & 1) ? (ChkSum >> 1) ^ 0xedb88320 : ChkSum >> 1;
-            }
-        }
-    }
-    ChkSum = ~ChkSum;
-    return ChkSum;
+    return util_crc32((const void *)flash_addr, data_len);
 }
 
 uint32_t file_offset_process = 0;
@@ -28,7 +28,7 @@
 
 #include "lmac15p4.h"
 #include "log.h"
-#include "util_list.h"
+#include "util_frame_ring.h"
 //=============================================================================
 //                Private Definitions of const value
 //=============================================================================
@@ -48,7 +48,12 @@
 #define MAC_PIB_MAC_MIN_BE                    2
 
 #define ZB_RADIO_MAX_PSDU            152
-#define ZB_RADIO_RX_FRAME_BUFFER_NUM 16
+
+/* RX frames between the lmac15p4 RX callback and the zboss task */
+#ifndef CONFIG_ZB_RADIO_RX_FRAME_NUM
+#define CONFIG_ZB_RADIO_RX_FRAME_NUM 16
+#endif
+#define ZB_RADIO_RX_FRAME_BUFFER_NUM CONFIG_ZB_RADIO_RX_FRAME_NUM
 
 typedef struct {
     uint8_t* mPsdu; ///< The PSDU.
@@ -107,13 +112,10 @@ typedef struct {
 } zbRadioFrame;
 
 typedef struct {
-    utils_dlist_t dlist;
     zbRadioFrame frame;
+    uint8_t psdu[ZB_RADIO_MAX_PSDU];
 } zbRadio_rxFrame_t;
 
-#define ALIGNED_RX_FRAME_SIZE ((sizeof(zbRadio_rxFrame_t) + 3) & 0xfffffffc)
-#define TOTAL_RX_FRAME_SIZE   (ALIGNED_RX_FRAME_SIZE + ZB_RADIO_MAX_PSDU)
-
 //=============================================================================
 //                Private ENUM
 //=============================================================================
@@ -122,25 +124,13 @@ enum {
     kMaxChannel = 26,
 };
 
-//=============================================================================
-//                Private Struct
-//=============================================================================
-
-typedef struct _otRadio_t {
-    utils_dlist_t rxFrameList;
-    utils_dlist_t frameList;
-    uint32_t dbgRxFrameNum;
-    uint32_t dbgFrameNum;
-    uint32_t dbgMaxAckFrameLenth;
-    uint32_t dbgMaxPendingFrameNum;
-
-    uint8_t buffPool[TOTAL_RX_FRAME_SIZE * (ZB_RADIO_RX_FRAME_BUFFER_NUM + 2)];
-} zbRadio_t;
-
 //=============================================================================
 //                Private Global Variables
 //=============================================================================
-static zbRadio_t zbRadio_var;
+static util_frame_ring_t zbRadio_rxRing;
+static uint8_t zbRadio_rxRingBuf[UTIL_FRAME_RING_BUF_SIZE(
+    sizeof(zbRadio_rxFrame_t), ZB_RADIO_RX_FRAME_BUFFER_NUM)]
+    __attribute__((aligned(8)));
 
 static uint8_t sPromiscuous = false;
 static uint16_t sShortAddress = 0xFFFF;
@@ -258,23 +248,16 @@ void zb_radioTask(zb_system_event_t trxEvent) {
     }
 
     if (trxEvent & ZB_SYSTEM_EVENT_RADIO_RX_DONE) {
-        pframe = NULL;
-
-        b_p = ZB_RING_BUFFER_PUT_RESERVE(&MAC_CTX().mac_rx_queue);
-
-        if (!b_p) {
-            ZB_NOTIFY(ZB_SYSTEM_EVENT_RADIO_RX_DONE);
-        }
-
-        ZB_ENTER_CRITICAL();
-        if (!utils_dlist_empty(&zbRadio_var.rxFrameList)) {
-            pframe = (zbRadio_rxFrame_t*)zbRadio_var.rxFrameList.next;
-            zbRadio_var.dbgRxFrameNum--;
-            utils_dlist_del(&pframe->dlist);
-        }
-        ZB_EXIT_CRITICAL();
+        pframe = util_frame_ring_get_peek(&zbRadio_rxRing);
 
         if (pframe) {
+            b_p = ZB_RING_BUFFER_PUT_RESERVE(&MAC_CTX().mac_rx_queue);
+            if (!b_p) {
+                /* the MAC RX queue is full, keep the frame for the retry */
+                ZB_NOTIFY(ZB_SYSTEM_EVENT_RADIO_RX_DONE);
+                return;
+            }
+
             /* Process Rx pakcet */
             bptr = zb_buf_initial_alloc(*b_p, (zb_uint_t)pframe->frame.mLength);
             memcpy(bptr, pframe->frame.mPsdu, pframe->frame.mLength);
@@ -302,16 +285,10 @@ void zb_radioTask(zb_system_event_t trxEvent) {
             ZB_RING_BUFFER_FLUSH_PUT(&MAC_CTX().mac_rx_queue);
             ZB_MAC_SET_RX_INT_STATUS_BIT();
 
-            ZB_ENTER_CRITICAL();
-            utils_dlist_add_tail(&pframe->dlist, &zbRadio_var.frameList);
-            zbRadio_var.dbgFrameNum++;
-
-            if (!utils_dlist_empty(&zbRadio_var.rxFrameList)) {
+            util_frame_ring_get_release(&zbRadio_rxRing);
+            if (util_frame_ring_count(&zbRadio_rxRing)) {
                 ZB_NOTIFY(ZB_SYSTEM_EVENT_RADIO_RX_DONE);
             }
-            ZB_EXIT_CRITICAL();
-        } else {
-            log_warn("zbRadio_var.dbgRxFrameNum %d", zbRadio_var.dbgRxFrameNum);
         }
     } else if (trxEvent & ZB_SYSTEM_EVENT_RADIO_RX_NO_BUFF) {
     }
@@ -325,15 +302,15 @@ static void _RxDoneEvent(uint16_t packet_length, uint8_t* rx_data_address,
         return;
 
     if (crc_status == 0) {
-        ZB_ENTER_CRITICAL();
-        if (!utils_dlist_empty(&zbRadio_var.frameList)) {
-            p = (zbRadio_rxFrame_t*)zbRadio_var.frameList.next;
-            zbRadio_var.dbgFrameNum--;
-            utils_dlist_del(&p->dlist);
-        }
-        ZB_EXIT_CRITICAL();
+        p = util_frame_ring_put_reserve(&zbRadio_rxRing);
 
         if (p) {
+            if ((packet_length < 9)
+                || ((packet_length - 9) > ZB_RADIO_MAX_PSDU)) {
+                log_warn("Rx Done len error %d", packet_length);
+                return;
+            }
+            p->frame.mPsdu = p->psdu;
             memcpy(p->frame.mPsdu, (rx_data_address + 8), (packet_length - 9));
             p->frame.mLength = (packet_length - 9);
 
@@ -341,13 +318,7 @@ static void _RxDoneEvent(uint16_t packet_length, uint8_t* rx_data_address,
             p->frame.mInfo.mRxInfo.mRssi = -rssi;
             p->frame.mInfo.mRxInfo.mLqi = ((100 - rssi) * 0xFF) / 100;
 
-            ZB_ENTER_CRITICAL();
-            utils_dlist_add_tail(&p->dlist, &zbRadio_var.rxFrameList);
-            zbRadio_var.dbgRxFrameNum++;
-            if (zbRadio_var.dbgMaxPendingFrameNum < zbRadio_var.dbgRxFrameNum) {
-                zbRadio_var.dbgMaxPendingFrameNum = zbRadio_var.dbgRxFrameNum;
-            }
-            ZB_EXIT_CRITICAL();
+            util_frame_ring_put_commit(&zbRadio_rxRing);
             // TRANS_CTX().rx_timestamp = Timer_25us_Tick;
             ZB_NOTIFY(ZB_SYSTEM_EVENT_RADIO_RX_DONE);
         } else {
@@ -371,23 +342,10 @@ static void _TxDoneEvent(uint32_t tx_status) {
 }
 
 void zb_radioInit(void) {
-    zbRadio_rxFrame_t* pframe = NULL;
     lmac15p4_callback_t mac_cb;
 
-    memset(&zbRadio_var, 0, offsetof(zbRadio_t, buffPool));
-    ZB_ENTER_CRITICAL();
-    utils_dlist_init(&zbRadio_var.frameList);
-    utils_dlist_init(&zbRadio_var.rxFrameList);
-
-    for (int i = 0; i < ZB_RADIO_RX_FRAME_BUFFER_NUM; i++) {
-        pframe = (zbRadio_rxFrame_t*)(zbRadio_var.buffPool
-                                      + TOTAL_RX_FRAME_SIZE * (i + 2));
-        pframe->frame.mPsdu = ((uint8_t*)pframe) + ALIGNED_RX_FRAME_SIZE;
-        utils_dlist_add_tail(&pframe->dlist, &zbRadio_var.frameList);
-    }
-
-    zbRadio_var.dbgFrameNum = ZB_RADIO_RX_FRAME_BUFFER_NUM;
-    ZB_EXIT_CRITICAL();
+    util_frame_ring_init(&zbRadio_rxRing, "zb rx", zbRadio_rxRingBuf,
+                         sizeof(zbRadio_rxFrame_t), ZB_RADIO_RX_FRAME_BUFFER_NUM);
 
     lmac15p4_init(LMAC15P4_2P4G_OQPSK, 0);
 
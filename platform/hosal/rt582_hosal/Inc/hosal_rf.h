@@ -22,6 +22,15 @@ extern "C"
 
 typedef int (*hosal_rf_callback_t)(void* p_arg);
 
+/* a received frame, p_data is valid in the callback only */
+typedef struct {
+    uint8_t* p_data;
+    uint32_t len;
+} hosal_rf_rx_frame_t;
+
+typedef int (*hosal_rf_rx_batch_callback_t)(hosal_rf_rx_frame_t* p_frames,
+                                            uint32_t num);
+
 /**
  * @brief
  *
@@ -263,6 +272,28 @@ typedef struct {
 #define HOSAL_RF_PCI_EVENT_CALLBACK 3
 #define HOSAL_RF_PCI_RX_CALLBACK    4
 #define HOSAL_RF_PCI_TX_CALLBACK    5
+#define HOSAL_RF_BLE_TX_CALLBACK    6
+
+/*
+ * CONFIG_HOSAL_RF_ZERO_COPY: the BLE event and RX callbacks get a buffer lent
+ * by hosal rf instead of the shared read buffer, the callback owns it and
+ * returns it by hosal_rf_buffer_release() when the frame is consumed.
+ */
+#ifndef CONFIG_HOSAL_RF_LEND_BUF_NUM
+#define CONFIG_HOSAL_RF_LEND_BUF_NUM 12
+#endif
+#define HOSAL_RF_LEND_BUF_SIZE 384
+
+/* RUCI event buffer pool */
+typedef struct {
+    uint8_t total;      /* number of buffers */
+    uint8_t in_use;     /* buffers in the queue or being read */
+    uint8_t high_water; /* max in_use */
+    uint8_t reserved;
+    uint32_t wait_cnt;  /* allocations waited for a free buffer */
+    uint32_t drop_cnt;  /* events dropped after the bounded wait or by a full
+                           event queue */
+} hosal_rf_evt_pool_stats_t;
 
 int hosal_rf_write_command(uint8_t* command_ptr, uint32_t command_len);
 int hosal_rf_write_tx_data(uint8_t* tx_data_ptr, uint32_t tx_data_len);
@@ -272,6 +303,17 @@ void hosal_rf_init(hosal_rf_mode_t mode);
 hosal_rf_status_t hosal_rf_ioctl(hosal_rf_ioctl_t ctl, void* p_arg);
 int hosal_rf_callback_set(int callback_type, hosal_rf_callback_t pfn_callback,
                           void* arg);
+/*
+ * CONFIG_HOSAL_RF_RX_BATCH: all pending frames are read before the delivery,
+ * the frames of the same type in a row are given to the batch callback at
+ * once. callback_type: HOSAL_RF_PCI_RX_CALLBACK or HOSAL_RF_BLE_RX_CALLBACK,
+ * the batch callback is used instead of the frame callback if it is set.
+ */
+int hosal_rf_rx_batch_callback_set(int callback_type,
+                                   hosal_rf_rx_batch_callback_t pfn_callback);
+void hosal_rf_buffer_release(void* p_buf);
+uint32_t hosal_rf_buffer_drop_count(void);
+void hosal_rf_evt_pool_stats_get(hosal_rf_evt_pool_stats_t* p_stats);
 void hosal_rf_suspend(void);
 void hosal_rf_resume(void);
 
@@ -68,6 +68,40 @@
 
 #define HOSAL_RF_HCI_ACL_DATA       (0x02)
 
+#define HOSAL_RF_RX_MAX_LEN_OQPSK   (127 + 15)
+/* an HCI ACL frame of the hci bridge or a BLE modem frame */
+#ifndef CONFIG_HOSAL_RF_RX_MAX_LEN_BLE
+#define CONFIG_HOSAL_RF_RX_MAX_LEN_BLE (255 + 13)
+#endif
+#define HOSAL_RF_RX_MAX_LEN_BLE     CONFIG_HOSAL_RF_RX_MAX_LEN_BLE
+
+#ifdef CONFIG_HOSAL_RF_RX_BATCH
+#ifndef CONFIG_HOSAL_RF_RX_BATCH_NUM
+#define CONFIG_HOSAL_RF_RX_BATCH_NUM (16)
+#endif
+#define HOSAL_RF_RX_BATCH_NUM       CONFIG_HOSAL_RF_RX_BATCH_NUM
+#else
+#define HOSAL_RF_RX_BATCH_NUM       (1)
+#endif
+
+#define HOSAL_RF_EVT_QUEUE_NUM      (4)
+/* RUCI event: header, sub header, length and up to 255 bytes */
+#define HOSAL_RF_EVT_BUF_SIZE       (260)
+
+/* the event queue has an entry per buffer, so a taken buffer is always queued
+ * without waiting */
+#ifndef CONFIG_HOSAL_RF_EVT_BUF_NUM
+#define CONFIG_HOSAL_RF_EVT_BUF_NUM HOSAL_RF_EVT_QUEUE_NUM
+#endif
+
+#ifndef CONFIG_HOSAL_RF_EVT_WAIT_MS
+#define CONFIG_HOSAL_RF_EVT_WAIT_MS (10)
+#endif
+
+#if (CONFIG_HOSAL_RF_EVT_BUF_NUM > 32)
+#error "CONFIG_HOSAL_RF_EVT_BUF_NUM must not be larger than 32"
+#endif
+
 /**************************************************************************************************
  *    TYPEDEFS
  *************************************************************************************************/
@@ -92,6 +126,31 @@ static hosal_rf_callback_t g_pci_rx_done_cb = NULL;
 static hosal_rf_callback_t g_pci_tx_done_cb = NULL;
 static hosal_rf_callback_t g_hci_evt_cb = NULL;
 static hosal_rf_callback_t g_hci_data_cb = NULL;
+static hosal_rf_callback_t g_hci_tx_done_cb = NULL;
+static hosal_rf_rx_batch_callback_t g_pci_rx_batch_cb = NULL;
+static hosal_rf_rx_batch_callback_t g_hci_rx_batch_cb = NULL;
+static hosal_rf_rx_frame_t g_rx_frames[HOSAL_RF_RX_BATCH_NUM];
+static hosal_rf_mode_t g_rf_mode;
+static hosal_rf_modem_t g_rf_modem;
+
+/* RUCI event buffer pool, bit n of free mask: buffer n is free */
+static uint32_t g_evt_buf[CONFIG_HOSAL_RF_EVT_BUF_NUM]
+                         [HOSAL_RF_EVT_BUF_SIZE / sizeof(uint32_t)];
+static volatile uint32_t g_evt_free_mask;
+static SemaphoreHandle_t g_evt_pool_sem;
+static StaticSemaphore_t g_evt_pool_sem_buf;
+static hosal_rf_evt_pool_stats_t g_evt_pool_stats;
+
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+#if (CONFIG_HOSAL_RF_LEND_BUF_NUM > 32)
+#error "CONFIG_HOSAL_RF_LEND_BUF_NUM must not be larger than 32"
+#endif
+/* the buffers lent to the BLE callbacks, bit n of free mask: buffer n is free */
+static uint32_t g_lend_buf[CONFIG_HOSAL_RF_LEND_BUF_NUM]
+                          [HOSAL_RF_LEND_BUF_SIZE / sizeof(uint32_t)];
+static volatile uint32_t g_lend_free_mask;
+static uint32_t g_lend_drop_cnt;
+#endif
 
 /**************************************************************************************************
  *    EXTERN
@@ -195,66 +254,278 @@ static void __rf_tx_data_queue_init(void) {
     }
 }
 
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+static uint8_t* __rf_buffer_take(void) {
+    uint8_t* p_buf = NULL;
+    uint32_t idx;
+
+    enter_critical_section();
+    if (g_lend_free_mask) {
+        idx = __builtin_ctz(g_lend_free_mask);
+        g_lend_free_mask &= ~(1UL << idx);
+        p_buf = (uint8_t*)g_lend_buf[idx];
+    }
+    leave_critical_section();
+
+    return p_buf;
+}
+
+static bool __rf_buffer_is_lent(const uint8_t* p_buf) {
+    return (p_buf >= (const uint8_t*)g_lend_buf)
+           && (p_buf < (const uint8_t*)g_lend_buf + sizeof(g_lend_buf));
+}
+
+/* lend the frame to the BLE callback, a frame in the shared buffer is copied
+ * or dropped if no buffer to lend */
+static int __rf_buffer_lend(hosal_rf_callback_t cb, uint8_t* p_buf,
+                            uint32_t len) {
+    uint8_t* p_lend = p_buf;
+
+    if (cb == NULL) {
+        hosal_rf_buffer_release(p_buf);
+        return HOSAL_RF_CB_NOTHING;
+    }
+    if (!__rf_buffer_is_lent(p_buf)) {
+        p_lend = (len <= HOSAL_RF_LEND_BUF_SIZE) ? __rf_buffer_take() : NULL;
+        if (p_lend == NULL) {
+            g_lend_drop_cnt++;
+            return HOSAL_RF_CB_NOTHING;
+        }
+        memcpy(p_lend, p_buf, len);
+    }
+    return cb(p_lend);
+}
+#endif
+
+static uint8_t* __rf_evt_buf_alloc(void) {
+    uint32_t idx;
+
+    if (xSemaphoreTake(g_evt_pool_sem, 0) != pdTRUE) {
+        g_evt_pool_stats.wait_cnt++;
+        if (xSemaphoreTake(g_evt_pool_sem,
+                           pdMS_TO_TICKS(CONFIG_HOSAL_RF_EVT_WAIT_MS))
+            != pdTRUE) {
+            return NULL;
+        }
+    }
+
+    enter_critical_section();
+    idx = __builtin_ctz(g_evt_free_mask);
+    g_evt_free_mask &= ~(1UL << idx);
+    if (++g_evt_pool_stats.in_use > g_evt_pool_stats.high_water) {
+        g_evt_pool_stats.high_water = g_evt_pool_stats.in_use;
+    }
+    leave_critical_section();
+
+    return (uint8_t*)g_evt_buf[idx];
+}
+
+static void __rf_evt_buf_free(uint8_t* p_buf) {
+    uint32_t idx = (p_buf - (uint8_t*)g_evt_buf) / sizeof(g_evt_buf[0]);
+
+    enter_critical_section();
+    g_evt_free_mask |= (1UL << idx);
+    g_evt_pool_stats.in_use--;
+    leave_critical_section();
+
+    xSemaphoreGive(g_evt_pool_sem);
+}
+
 __STATIC_FORCEINLINE void handle_event_status(void) {
     RF_MCU_RX_CMDQ_ERROR rxCmdError = RF_MCU_RX_CMDQ_ERR_INIT;
     uint32_t event_len = 0;
     uint8_t* evt_ptr = NULL;
+    uint8_t* p_buf = g_event_buffer;
 
-    event_len = RfMcu_EvtQueueRead(g_event_buffer, &rxCmdError);
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    if (g_hci_evt_cb) {
+        p_buf = __rf_buffer_take();
+        if (p_buf == NULL) {
+            p_buf = g_event_buffer;
+        }
+    }
+#endif
+    event_len = RfMcu_EvtQueueRead(p_buf, &rxCmdError);
     if (rxCmdError == RF_MCU_RX_CMDQ_GET_SUCCESS) {
-        switch (g_event_buffer[0]) {
+        switch (p_buf[0]) {
         case HOSAL_RF_HCI_EVENT:
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            if (__rf_buffer_lend(g_hci_evt_cb, p_buf, event_len)
+                == HOSAL_RF_CB_CMD_COMPLETE) {
+                xSemaphoreGive(xSemaphore);
+            }
+            p_buf = g_event_buffer; /* owned by the callback */
+#else
             if (g_hci_evt_cb) {
-                if (g_hci_evt_cb(g_event_buffer) == HOSAL_RF_CB_CMD_COMPLETE) {
+                if (g_hci_evt_cb(p_buf) == HOSAL_RF_CB_CMD_COMPLETE) {
                     xSemaphoreGive(xSemaphore);
                 }
             }
+#endif
             break;
 
         case HOSAL_RF_RUCI_PCI_EVENT:
         case HOSAL_RF_RUCI_SF_HOST_EVENT:
         case HOSAL_RF_RUCI_CMN_EVENT:
-            do {
-                evt_ptr = pvPortMalloc(event_len);
-                if (evt_ptr == NULL) {
-                    vTaskDelay(1);
-                }
-            } while (evt_ptr == NULL);
+            evt_ptr = __rf_evt_buf_alloc();
+            if (evt_ptr == NULL) {
+                /* the reader does not take the events */
+                g_evt_pool_stats.drop_cnt++;
+                log_error("event 0x%02x dropped", p_buf[0]);
+                xSemaphoreGive(xSemaphore);
+                break;
+            }
 
-            memcpy(evt_ptr, g_event_buffer, event_len);
-            if (xQueueSend(g_rf_evt_handle, (void*)&evt_ptr, portMAX_DELAY)
-                    != pdPASS) {
-                configASSERT(0);
+            if (event_len > HOSAL_RF_EVT_BUF_SIZE) {
+                event_len = HOSAL_RF_EVT_BUF_SIZE;
+            }
+            memcpy(evt_ptr, p_buf, event_len);
+            if (xQueueSend(g_rf_evt_handle, (void*)&evt_ptr, 0) != pdPASS) {
+                __rf_evt_buf_free(evt_ptr);
+                g_evt_pool_stats.drop_cnt++;
+                log_error("event 0x%02x dropped", p_buf[0]);
             }
             xSemaphoreGive(xSemaphore);
             break;
 
         default:
-            log_error("unknown event 0x%02x\n", g_event_buffer[0]);
+            log_error("unknown event 0x%02x\n", p_buf[0]);
             break;
         }
     }
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    if (p_buf != g_event_buffer) {
+        hosal_rf_buffer_release(p_buf);
+    }
+#endif
 }
 
-__STATIC_FORCEINLINE void handle_rx_data_status(void) {
-    RF_MCU_RXQ_ERROR rx_queue_error = RF_MCU_RXQ_ERR_INIT;
+/* the max frame length of RfMcu_RxQueueRead, the largest frame of the active
+ * protocols: the BLE frames come in BLE controller and multi-protocol modes,
+ * the frames of the modem in RUCI and multi-protocol modes */
+static uint32_t __rf_rx_max_len(void) {
+    uint32_t max_len = 0;
 
-    while (RfMcu_RxQueueRead(g_rx_data, &rx_queue_error) != 0) {
-        if (rx_queue_error != RF_MCU_RXQ_GET_SUCCESS) {
-            break;
+    if ((g_rf_mode == HOSAL_RF_MODE_BLE_CONTROLLER)
+        || (g_rf_mode == HOSAL_RF_MODE_MULTI_PROTOCOL)) {
+        max_len = HOSAL_RF_RX_MAX_LEN_BLE;
+    }
+    if (g_rf_mode != HOSAL_RF_MODE_BLE_CONTROLLER) {
+        if ((g_rf_modem == HOSAL_RF_MODEM_2P4G_OQPSK)
+            || (g_rf_modem == HOSAL_RF_MODEM_SUBG_OQPSK)) {
+            max_len = (max_len > HOSAL_RF_RX_MAX_LEN_OQPSK)
+                          ? max_len
+                          : HOSAL_RF_RX_MAX_LEN_OQPSK;
+        } else if (g_rf_modem == HOSAL_RF_MODEM_BLE) {
+            max_len = HOSAL_RF_RX_MAX_LEN_BLE;
+        } else {
+            /* FSK or not set yet */
+            max_len = sizeof(g_rx_data);
         }
-        if (g_rx_data[0] == RUCI_PCI_DATA_HEADER) {
-            if (g_pci_rx_done_cb) {
-                g_pci_rx_done_cb(g_rx_data);
+    }
+    return max_len;
+}
+
+/* delivers the frames in order, the frames of the same header in a row are
+ * delivered to the batch callback at once */
+static void __rf_rx_deliver(hosal_rf_rx_frame_t* p_frames, uint32_t num) {
+    uint32_t i, k, n;
+    uint8_t hdr;
+
+    for (i = 0; i < num; i += n) {
+        hdr = p_frames[i].p_data[0];
+        for (n = 1; (i + n < num) && (p_frames[i + n].p_data[0] == hdr); n++) {}
+
+        if (hdr == RUCI_PCI_DATA_HEADER) {
+            if (g_pci_rx_batch_cb) {
+                g_pci_rx_batch_cb(&p_frames[i], n);
+            } else if (g_pci_rx_done_cb) {
+                for (k = i; k < i + n; k++) {
+                    g_pci_rx_done_cb(p_frames[k].p_data);
+                }
+            }
+        } else if (hdr == HOSAL_RF_HCI_ACL_DATA) {
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            /* the lent frames are owned by the callback one by one */
+            for (k = i; k < i + n; k++) {
+                __rf_buffer_lend(g_hci_data_cb, p_frames[k].p_data,
+                                 p_frames[k].len);
             }
-        } else if (g_rx_data[0] == HOSAL_RF_HCI_ACL_DATA) {
-            if (g_hci_data_cb) {
-                g_hci_data_cb(g_rx_data);
+            continue;
+#else
+            if (g_hci_rx_batch_cb) {
+                g_hci_rx_batch_cb(&p_frames[i], n);
+            } else if (g_hci_data_cb) {
+                for (k = i; k < i + n; k++) {
+                    g_hci_data_cb(p_frames[k].p_data);
+                }
             }
+#endif
+        } else {
+            log_error("invalid data header 0x%02x\n", hdr);
         }
-        else {
-            log_error("invalid data header 0x%02x\n", g_rx_data[0]);
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+        for (k = i; k < i + n; k++) {
+            hosal_rf_buffer_release(p_frames[k].p_data);
         }
+#endif
+    }
+}
+
+__STATIC_FORCEINLINE void handle_rx_data_status(void) {
+    RF_MCU_RXQ_ERROR rx_queue_error = RF_MCU_RXQ_ERR_INIT;
+    uint32_t num = 0, offset = 0, rx_len;
+    uint32_t max_len = __rf_rx_max_len();
+    uint8_t* p_buf;
+
+    for (;;) {
+        p_buf = NULL;
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+        /* only the BLE frames in BLE controller mode, they fit the lent buffer */
+        if ((g_hci_data_cb) && (g_rf_mode == HOSAL_RF_MODE_BLE_CONTROLLER)) {
+            p_buf = __rf_buffer_take();
+        }
+#endif
+        if (p_buf == NULL) {
+#ifdef CONFIG_HOSAL_RF_RX_BATCH
+            /* the frames are packed in g_rx_data, deliver them first if the
+             * longest frame of the active protocols does not fit the rest */
+            if ((sizeof(g_rx_data) - offset) < max_len) {
+                __rf_rx_deliver(g_rx_frames, num);
+                num = 0;
+                offset = 0;
+            }
+#endif
+            p_buf = &g_rx_data[offset];
+        }
+        rx_len = RfMcu_RxQueueRead(p_buf, &rx_queue_error);
+        if ((rx_len == 0) || (rx_queue_error != RF_MCU_RXQ_GET_SUCCESS)) {
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+            hosal_rf_buffer_release(p_buf);
+#endif
+            break;
+        }
+
+        g_rx_frames[num].p_data = p_buf;
+        g_rx_frames[num].len = rx_len;
+        num++;
+#ifdef CONFIG_HOSAL_RF_RX_BATCH
+        if (p_buf == &g_rx_data[offset]) {
+            offset += (rx_len + 3) & ~3UL;
+        }
+        if (num == HOSAL_RF_RX_BATCH_NUM) {
+            __rf_rx_deliver(g_rx_frames, num);
+            num = 0;
+            offset = 0;
+        }
+#else
+        __rf_rx_deliver(g_rx_frames, num);
+        num = 0;
+#endif
+    }
+
+    if (num) {
+        __rf_rx_deliver(g_rx_frames, num);
     }
 }
 
@@ -264,6 +535,9 @@ __STATIC_FORCEINLINE void handle_tx_done_status(void) {
     if (g_pci_tx_done_cb) {
         g_pci_tx_done_cb((void*)tx_status);
     }
+    if (g_hci_tx_done_cb) {
+        g_hci_tx_done_cb((void*)tx_status);
+    }
     RfMcu_HostCmdSet((tx_status & 0xF4));
 }
 
@@ -381,6 +655,9 @@ static hosal_rf_status_t __rf_modem_set(hosal_rf_15p4_modem_cnf_t* modem_cnf) {
         if (cmd_ptr) {
             vPortFree(cmd_ptr);
         }
+        if (rval == HOSAL_RF_STATUS_SUCCESS) {
+            g_rf_modem = (hosal_rf_modem_t)modem_cnf->modem;
+        }
     }
 
     return rval;
@@ -1063,7 +1340,7 @@ uint32_t hosal_rf_read_event(uint8_t* event_data_ptr) {
     } else {
         event_len = pdata[2] + 3;
         memcpy(event_data_ptr, pdata, event_len);
-        vPortFree(pdata);
+        __rf_evt_buf_free(pdata);
     }
     return event_len;
 }
@@ -1073,6 +1350,37 @@ uint32_t hosal_rf_read_rx_data(uint8_t* rx_data_ptr) {
     return (uint32_t)RfMcu_RxQueueRead(rx_data_ptr, &rx_queue_error);
 }
 
+void hosal_rf_buffer_release(void* p_buf) {
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    uint32_t idx;
+
+    if (!__rf_buffer_is_lent(p_buf)) {
+        return;
+    }
+    idx = ((uint8_t*)p_buf - (uint8_t*)g_lend_buf) / sizeof(g_lend_buf[0]);
+
+    enter_critical_section();
+    g_lend_free_mask |= (1UL << idx);
+    leave_critical_section();
+#else
+    (void)p_buf;
+#endif
+}
+
+void hosal_rf_evt_pool_stats_get(hosal_rf_evt_pool_stats_t* p_stats) {
+    enter_critical_section();
+    *p_stats = g_evt_pool_stats;
+    leave_critical_section();
+}
+
+uint32_t hosal_rf_buffer_drop_count(void) {
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    return g_lend_drop_cnt;
+#else
+    return 0;
+#endif
+}
+
 hosal_rf_status_t hosal_rf_ioctl(hosal_rf_ioctl_t ctl, void* p_arg) {
     hosal_rf_status_t rval = HOSAL_RF_STATUS_SUCCESS;
 
@@ -1274,6 +1582,28 @@ int hosal_rf_callback_set(int callback_type, hosal_rf_callback_t pfn_callback,
         g_hci_data_cb = pfn_callback;
         break;
 
+    case HOSAL_RF_BLE_TX_CALLBACK:
+        g_hci_tx_done_cb = pfn_callback;
+        break;
+
+    default:
+        return HOSAL_RF_STATUS_INVALID_PARAMETER;
+    }
+
+    return HOSAL_RF_STATUS_SUCCESS;
+}
+
+int hosal_rf_rx_batch_callback_set(int callback_type,
+                                   hosal_rf_rx_batch_callback_t pfn_callback) {
+    switch (callback_type) {
+    case HOSAL_RF_PCI_RX_CALLBACK:
+        g_pci_rx_batch_cb = pfn_callback;
+        break;
+
+    case HOSAL_RF_BLE_RX_CALLBACK:
+        g_hci_rx_batch_cb = pfn_callback;
+        break;
+
     default:
         return HOSAL_RF_STATUS_INVALID_PARAMETER;
     }
@@ -1282,6 +1612,12 @@ int hosal_rf_callback_set(int callback_type, hosal_rf_callback_t pfn_callback,
 }
 
 void hosal_rf_init(hosal_rf_mode_t mode) {
+    g_rf_mode = mode;
+#ifdef CONFIG_HOSAL_RF_ZERO_COPY
+    g_lend_free_mask = (CONFIG_HOSAL_RF_LEND_BUF_NUM == 32)
+                           ? 0xFFFFFFFFUL
+                           : ((1UL << CONFIG_HOSAL_RF_LEND_BUF_NUM) - 1);
+#endif
     NVIC_SetPriority(CommSubsystem_IRQn, 0x4);
     RfMcu_DmaInit();
 
@@ -1297,13 +1633,22 @@ void hosal_rf_init(hosal_rf_mode_t mode) {
     xSemaphore = xSemaphoreCreateBinaryStatic(&xSemaphoreBuffer);
     xSemaphoreGive(xSemaphore);
 
+    g_evt_free_mask = (CONFIG_HOSAL_RF_EVT_BUF_NUM == 32)
+                          ? 0xFFFFFFFFUL
+                          : ((1UL << CONFIG_HOSAL_RF_EVT_BUF_NUM) - 1);
+    memset(&g_evt_pool_stats, 0, sizeof(g_evt_pool_stats));
+    g_evt_pool_stats.total = CONFIG_HOSAL_RF_EVT_BUF_NUM;
+    g_evt_pool_sem = xSemaphoreCreateCountingStatic(
+        CONFIG_HOSAL_RF_EVT_BUF_NUM, CONFIG_HOSAL_RF_EVT_BUF_NUM,
+        &g_evt_pool_sem_buf);
+
     if (xTaskCreate(__rf_proc, (char*)"hoasl-rf",
                     HOSAL_RF_PROC_TASK_SIZE / sizeof(StackType_t), NULL,
                     E_TASK_PRIORITY_HOSAL, &g_rf_taskHandle)
             != pdPASS) {
         puts("Task create fail....");
     }
-    g_rf_evt_handle = xQueueCreate(4, sizeof(void*));
+    g_rf_evt_handle = xQueueCreate(CONFIG_HOSAL_RF_EVT_BUF_NUM, sizeof(void*));
 
     __rf_tx_data_queue_init();
 }
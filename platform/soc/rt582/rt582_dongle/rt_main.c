@@ -7,6 +7,12 @@
 #include "hosal_uart.h"
 #include "mcu.h"
 #include "uart_stdio.h"
+#if CONFIG_LOG_DEFERRED
+#include "log.h"
+#endif
+#ifdef CONFIG_SW_TIMER_TICKLESS
+#include "sw_timer.h"
+#endif
 
 extern uint8_t _heap_start;
 extern uint8_t _heap_size;
@@ -29,6 +35,11 @@ static HeapRegion_t xHeapRegions[] = {
 
 void __attribute__((weak)) vApplicationStackOverflowHook(TaskHandle_t xTask,
                                                          char* pcTaskName) {
+#if CONFIG_LOG_DEFERRED
+    /* the log task will not run again, output its pending logs first */
+    taskDISABLE_INTERRUPTS();
+    log_deferred_flush();
+#endif
     puts("Stack Overflow checked\r\n");
     if (pcTaskName) {
         printf("Stack name %s\r\n", pcTaskName);
@@ -118,6 +129,11 @@ void __attribute__((weak)) vAssertCalled(const char* const pcFileName,
                                          unsigned long ulLine) {
     char* current_task_name = (char*)pcTaskGetTaskName(
         xTaskGetCurrentTaskHandle());
+#if CONFIG_LOG_DEFERRED
+    /* the log task will not run again, output its pending logs first */
+    taskDISABLE_INTERRUPTS();
+    log_deferred_flush();
+#endif
     printf("assert: [%s] %s:%ld\n", current_task_name, pcFileName, ulLine);
     taskDISABLE_INTERRUPTS();
     while (1) {}
@@ -210,6 +226,9 @@ void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime_ms) {
     timern_t* TIMER = TIMER3;
 #endif
     uint32_t now_v;
+#ifdef CONFIG_SW_TIMER_TICKLESS
+    uint32_t sw_timer_idle_ms;
+#endif
 
     __disable_irq();
 
@@ -227,6 +246,18 @@ void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime_ms) {
         if (Lpm_Get_Low_Power_Mask_Status() != LOW_POWER_NO_MASK) {
             __WFI();
         } else {
+#ifdef CONFIG_SW_TIMER_TICKLESS
+            /* wake up for the next sw_timer alarm */
+            sw_timer_idle_ms = sw_timer_tickless_sleep_enter();
+            if (xExpectedIdleTime_ms > sw_timer_idle_ms) {
+                xExpectedIdleTime_ms = sw_timer_idle_ms;
+            }
+            if (xExpectedIdleTime_ms == 0) {
+                sw_timer_tickless_sleep_exit(0);
+                __enable_irq();
+                return;
+            }
+#endif
             TIMER->LOAD = ((xExpectedIdleTime_ms) * 40) - 1;
             TIMER->CLEAR = 1;
             TIMER->CONTROL.bit.INT_ENABLE = 1;
@@ -246,6 +277,9 @@ void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime_ms) {
             xModifiableIdleTime = (xExpectedIdleTime_ms)-now_v;
 
             vTaskStepTick(xModifiableIdleTime);
+#ifdef CONFIG_SW_TIMER_TICKLESS
+            sw_timer_tickless_sleep_exit(xModifiableIdleTime);
+#endif
         }
     }
 
@@ -269,6 +303,10 @@ int rt582_main(void) {
     __init_sleep();
 #endif
 
+#if CONFIG_LOG_DEFERRED
+    log_deferred_init();
+#endif
+
     printf("Starting RT582 now %d.... \r\n",
            CONFIG_HOSAL_SOC_MAIN_ENTRY_TASK_SIZE);
 
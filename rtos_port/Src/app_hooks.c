@@ -13,6 +13,12 @@
 #include "hosal_lpm.h"
 #include "hosal_sysctrl.h"
 #include "FreeRTOSConfig.h"
+#if CONFIG_LOG_DEFERRED
+#include "log.h"
+#endif
+#ifdef CONFIG_SW_TIMER_TICKLESS
+#include "sw_timer.h"
+#endif
 
 extern uint8_t _heap_start;
 extern uint8_t _heap_size;
@@ -33,6 +39,11 @@ void __attribute__((weak)) vHeapRegionsInt(void) {
 
 void __attribute__((weak)) vApplicationStackOverflowHook(TaskHandle_t xTask,
                                                          char* pcTaskName) {
+#if CONFIG_LOG_DEFERRED
+    /* the log task will not run again, output its pending logs first */
+    taskDISABLE_INTERRUPTS();
+    log_deferred_flush();
+#endif
     puts("Stack Overflow checked\r\n");
     if (pcTaskName) {
         printf("Stack name %s\r\n", pcTaskName);
@@ -122,6 +133,11 @@ void __attribute__((weak)) vAssertCalled(const char* const pcFileName,
                                          unsigned long ulLine) {
     char* current_task_name = (char*)pcTaskGetTaskName(
         xTaskGetCurrentTaskHandle());
+#if CONFIG_LOG_DEFERRED
+    /* the log task will not run again, output its pending logs first */
+    taskDISABLE_INTERRUPTS();
+    log_deferred_flush();
+#endif
     printf("assert: [%s] %s:%ld\n", current_task_name, pcFileName, ulLine);
     taskDISABLE_INTERRUPTS();
     while (1) {}
@@ -251,6 +267,9 @@ void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime_ms) {
     TickType_t xModifiableIdleTime;
     uint32_t now_v, para;
     uint32_t clock_tick_k =0;
+#ifdef CONFIG_SW_TIMER_TICKLESS
+    uint32_t sw_timer_idle_ms;
+#endif
 
     __disable_irq();
 
@@ -275,6 +294,18 @@ void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime_ms) {
             __enable_irq();
             return;
         } else {
+#ifdef CONFIG_SW_TIMER_TICKLESS
+            /* wake up for the next sw_timer alarm */
+            sw_timer_idle_ms = sw_timer_tickless_sleep_enter();
+            if (xExpectedIdleTime_ms > sw_timer_idle_ms) {
+                xExpectedIdleTime_ms = sw_timer_idle_ms;
+            }
+            if (xExpectedIdleTime_ms == 0) {
+                sw_timer_tickless_sleep_exit(0);
+                __enable_irq();
+                return;
+            }
+#endif
             RTOS_PreSleepProcessing(xExpectedIdleTime_ms);
 
             lpm_enter_low_power_mode();
@@ -287,6 +318,9 @@ void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime_ms) {
             xModifiableIdleTime = (xExpectedIdleTime_ms)-now_v;
 
             vTaskStepTick(xModifiableIdleTime);
+#ifdef CONFIG_SW_TIMER_TICKLESS
+            sw_timer_tickless_sleep_exit(xModifiableIdleTime);
+#endif
         }
     }
 
@@ -21,7 +21,16 @@ size_t efd_get_env_blob(const char * key, void * value_buf, size_t buf_len, size
 bool efd_get_env_obj(const char * key, env_node_obj_t env);
 size_t efd_read_env_value(env_node_obj_t env, uint8_t * value_buf, size_t buf_len);
 EfErrCode efd_set_env_blob(const char * key, const void * value_buf, size_t buf_len);
+EfErrCode efd_set_env_batch(const efd_env * envs, size_t num);
 void info_env(void);
+void efd_get_gc_stats(efd_gc_stats_t * stats);
+void efd_reset_gc_stats(void);
+void efd_get_boot_stats(efd_boot_stats_t * stats);
+void efd_get_wear_stats(efd_wear_stats_t * stats, uint32_t * counts, size_t num);
+void efd_print_wear(void);
+#ifdef EFD_ENV_USING_CHECKPOINT
+EfErrCode efd_env_checkpoint(void);
+#endif
 
 /* efd_env.c, efd_env_legacy_wl.c and efd_env_legacy.c */
 EfErrCode efd_load_env(void);
@@ -59,6 +68,18 @@ size_t efd_log_get_used_size(void);
 size_t efd_log_get_total_size(void);
 #endif
 
+#ifdef EFD_USING_PORT_SIM
+/* efd_port_sim.c */
+EfErrCode efd_port_sim_open(const char * path);
+void efd_port_sim_close(void);
+void efd_port_sim_power_cut(uint32_t op_num);
+#endif
+
+#ifdef EFD_USING_BENCH
+/* efd_bench.c */
+EfErrCode efd_bench_run(size_t key_num, size_t value_len, size_t rounds);
+#endif
+
 /* efd_utils.c */
 uint32_t efd_calc_crc32(uint32_t crc, const void * buf, size_t size);
 
@@ -68,6 +89,9 @@ EfErrCode efd_port_erase(uint32_t addr, size_t size);
 EfErrCode efd_port_write(uint32_t addr, const uint32_t * buf, size_t size);
 void efd_port_env_lock(void);
 void efd_port_env_unlock(void);
+uint32_t efd_port_get_ms(void);
+void efd_port_get_stats(efd_port_stats_t * stats);
+void efd_port_reset_stats(void);
 void efd_log_debug(const char * file, const long line, const char * format, ...);
 void efd_log_info(const char * format, ...);
 void efd_print(const char * format, ...);
@@ -42,6 +42,46 @@ extern "C" {
             ;                                                                                                                      \
     }
 
+/* flash port access statistics, @see efd_port_get_stats */
+typedef struct _efd_port_stats
+{
+    uint32_t read_count;  /**< efd_port_read call count */
+    uint32_t read_bytes;  /**< total bytes read from flash */
+    uint32_t write_count; /**< efd_port_write call count */
+    uint32_t write_bytes; /**< total bytes written to flash */
+    uint32_t erase_count; /**< erased sector count */
+    uint32_t cache_hit;   /**< read cache page hit count */
+    uint32_t cache_miss;  /**< read cache page miss count */
+    uint32_t page_read;   /**< flash page (or single byte) read count */
+} efd_port_stats_t;
+
+/* ENV garbage collection statistics, @see efd_get_gc_stats */
+typedef struct _efd_gc_stats
+{
+    uint32_t collect_count; /**< synchronous GC count which collected sectors */
+    uint32_t env_moved;     /**< moved ENV record count */
+    uint32_t sector_erased; /**< collected sector count */
+    uint32_t max_pause_ms;  /**< the longest GC pause while holding the ENV lock */
+} efd_gc_stats_t;
+
+/* ENV boot statistics, @see efd_get_boot_stats */
+typedef struct _efd_boot_stats
+{
+    bool from_checkpoint;  /**< the index is restored from checkpoint */
+    uint32_t env_scanned;  /**< ENV node read count while loading */
+    uint32_t ms;           /**< efd_load_env time */
+} efd_boot_stats_t;
+
+/* ENV sector wear statistics, @see efd_get_wear_stats */
+typedef struct _efd_wear_stats
+{
+    uint32_t sector_num; /**< ENV sector number */
+    uint32_t hist_num;   /**< the erase count number can be saved in the histogram buffer */
+    uint32_t min;        /**< the least sector erase count */
+    uint32_t max;        /**< the most sector erase count */
+    uint32_t total;      /**< the total sector erase count */
+} efd_wear_stats_t;
+
 typedef struct _efd_env
 {
     char * key;
@@ -0,0 +1,154 @@
+#include <EnhancedFlashDataset.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(EFD_USING_BENCH) && defined(EFD_USING_ENV)
+
+/* the max value length of the benchmark */
+#ifndef EFD_BENCH_VALUE_MAX
+#define EFD_BENCH_VALUE_MAX 256
+#endif
+
+/* same as the OpenThread settings key length */
+#define BENCH_KEY_LEN 20
+
+struct bench_result {
+    uint32_t ops;
+    uint32_t ms;
+    efd_port_stats_t stats;
+};
+
+static void bench_fill_value(uint8_t* value, size_t len, size_t key_index,
+                             size_t round) {
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        value[i] = (uint8_t)(key_index + round + i);
+    }
+}
+
+/* using the OpenThread settings key format `ot-<key>-<index>` */
+static void bench_make_key(char* key, size_t key_index) {
+    snprintf(key, BENCH_KEY_LEN, "ot-%x-%x", (unsigned)(key_index >> 4),
+             (unsigned)(key_index & 0x0F));
+}
+
+static void bench_begin(struct bench_result* res) {
+    efd_port_reset_stats();
+    res->ops = 0;
+    res->ms = efd_port_get_ms();
+}
+
+static void bench_end(struct bench_result* res) {
+    res->ms = efd_port_get_ms() - res->ms;
+    efd_port_get_stats(&res->stats);
+}
+
+static void bench_report(const char* name, struct bench_result* res) {
+    uint32_t ops = res->ops ? res->ops : 1;
+    uint32_t ms = res->ms ? res->ms : 1;
+
+    EFD_INFO("%-4s: %lu ops in %lu ms, %lu ops/sec, read %lu B/op, write %lu "
+             "B/op, erase %lu sectors, %lu.%02lu page reads/op, read cache %lu hit %lu miss\n",
+             name, (unsigned long)res->ops, (unsigned long)res->ms,
+             (unsigned long)((uint64_t)res->ops * 1000 / ms),
+             (unsigned long)(res->stats.read_bytes / ops),
+             (unsigned long)(res->stats.write_bytes / ops),
+             (unsigned long)res->stats.erase_count,
+             (unsigned long)(res->stats.page_read / ops),
+             (unsigned long)((uint64_t)res->stats.page_read * 100 / ops % 100),
+             (unsigned long)res->stats.cache_hit,
+             (unsigned long)res->stats.cache_miss);
+}
+
+/**
+ * Run the ENV throughput benchmark.
+ * It sets and gets `key_num` keys for `rounds` times, then report ops/sec and
+ * flash bytes read/written per operation. The sector erase count of the set
+ * phase shows the GC cost, the erase count of each sector after it shows the wear.
+ *
+ * @note the ENV area will be set to default after the benchmark
+ *
+ * @param key_num key number
+ * @param value_len value length of each key
+ * @param rounds rewrite rounds of all keys
+ *
+ * @return result
+ */
+EfErrCode efd_bench_run(size_t key_num, size_t value_len, size_t rounds) {
+    static uint8_t value[EFD_BENCH_VALUE_MAX], read_buf[EFD_BENCH_VALUE_MAX];
+    char key[BENCH_KEY_LEN];
+    struct bench_result res;
+    efd_gc_stats_t gc_stats;
+    efd_wear_stats_t wear_stats;
+    EfErrCode result = EFD_NO_ERR;
+    size_t i, round, saved_len;
+
+    if (value_len == 0 || value_len > EFD_BENCH_VALUE_MAX) {
+        return EFD_ENV_ARG_ERR;
+    }
+
+    result = efd_env_set_default();
+    if (result != EFD_NO_ERR) {
+        return result;
+    }
+
+    EFD_INFO("EFD bench: %u keys, %u bytes value, %u rounds, area %u bytes\n",
+             (unsigned)key_num, (unsigned)value_len, (unsigned)rounds,
+             (unsigned)ENV_AREA_SIZE);
+
+    /* set phase */
+    efd_reset_gc_stats();
+    bench_begin(&res);
+    for (round = 0; round < rounds && result == EFD_NO_ERR; round++) {
+        for (i = 0; i < key_num; i++) {
+            bench_make_key(key, i);
+            bench_fill_value(value, value_len, i, round);
+            result = efd_set_env_blob(key, value, value_len);
+            if (result != EFD_NO_ERR) {
+                break;
+            }
+            res.ops++;
+        }
+    }
+    bench_end(&res);
+    bench_report("set", &res);
+    efd_get_gc_stats(&gc_stats);
+    EFD_INFO("gc  : %lu collects, %lu sectors, %lu ENV moved, max pause %lu "
+             "ms\n",
+             (unsigned long)gc_stats.collect_count,
+             (unsigned long)gc_stats.sector_erased,
+             (unsigned long)gc_stats.env_moved,
+             (unsigned long)gc_stats.max_pause_ms);
+    efd_get_wear_stats(&wear_stats, NULL, 0);
+    EFD_INFO("wear: %lu sectors, erase count min %lu, max %lu, total %lu\n",
+             (unsigned long)wear_stats.sector_num, (unsigned long)wear_stats.min,
+             (unsigned long)wear_stats.max, (unsigned long)wear_stats.total);
+    if (result != EFD_NO_ERR) {
+        EFD_INFO("EFD bench: set failed (%d)\n", result);
+        goto __exit;
+    }
+
+    /* get phase, the value must be the last round */
+    bench_begin(&res);
+    for (i = 0; i < key_num; i++) {
+        bench_make_key(key, i);
+        bench_fill_value(value, value_len, i, rounds - 1);
+        if (efd_get_env_blob(key, read_buf, value_len, &saved_len) != value_len
+            || saved_len != value_len || memcmp(value, read_buf, value_len)) {
+            EFD_INFO("EFD bench: verify '%s' failed\n", key);
+            result = EFD_READ_ERR;
+            break;
+        }
+        res.ops++;
+    }
+    bench_end(&res);
+    bench_report("get", &res);
+
+__exit:
+    efd_env_set_default();
+
+    return result;
+}
+
+#endif /* defined(EFD_USING_BENCH) && defined(EFD_USING_ENV) */
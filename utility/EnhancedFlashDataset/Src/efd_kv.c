@@ -49,6 +49,22 @@
 #define EFD_SECTOR_CACHE_TABLE_SIZE 8
 #endif
 
+#ifdef EFD_ENV_USING_CHECKPOINT
+#ifndef EFD_CKPT_START_ADDR
+#error "Please configure the checkpoint area start address (in efd_cfg.h)"
+#endif
+
+/* the checkpoint area size, it must be out of the ENV area */
+#ifndef EFD_CKPT_AREA_SIZE
+#define EFD_CKPT_AREA_SIZE EFD_ERASE_MIN_SIZE
+#endif
+
+/* magic word(`C`, `K`, `4`, `0`) */
+#define CKPT_MAGIC_WORD 0x30344B43
+/* the key directory is not ready when checkpoint */
+#define CKPT_KEY_DIR_NOT_READY 0xFFFF
+#endif /* EFD_ENV_USING_CHECKPOINT */
+
 #if EFD_ENV_CACHE_TABLE_SIZE > 0xFFFF
 #error "The ENV cache table size must less than 0xFFFF"
 #endif
@@ -57,8 +73,28 @@
 #define EFD_ENV_USING_CACHE
 #endif
 
+#ifdef EFD_ENV_USING_KEY_DIR
+/* the key directory table size (entries), it must be a power of 2. Each entry uses 8 bytes RAM */
+#ifndef EFD_KEY_DIR_TABLE_SIZE
+#define EFD_KEY_DIR_TABLE_SIZE 256
+#endif
+
+#if (EFD_KEY_DIR_TABLE_SIZE & (EFD_KEY_DIR_TABLE_SIZE - 1)) != 0
+#error "The key directory table size must be a power of 2"
+#endif
+
+/* the max used entries (including deleted entries) before rebuild, 3/4 of the table */
+#define KEY_DIR_LOAD_MAX (EFD_KEY_DIR_TABLE_SIZE - EFD_KEY_DIR_TABLE_SIZE / 4)
+/* the key directory entry is never used */
+#define KEY_DIR_EMPTY 0xFFFFFFFF
+/* the key directory entry was deleted */
+#define KEY_DIR_DELETED 0xFFFFFFFE
+#endif /* EFD_ENV_USING_KEY_DIR */
+
 /* the sector is not combined value */
 #define SECTOR_NOT_COMBINED 0xFFFFFFFF
+/* the sector erase count is unknown */
+#define SECTOR_ERASE_COUNT_UNKNOWN 0xFFFFFFFF
 /* the next address is get failed */
 #define FAILED_ADDR 0xFFFFFFFF
 
@@ -85,6 +121,7 @@
 #endif
 
 #define STORE_STATUS_TABLE_SIZE STATUS_TABLE_SIZE(SECTOR_STORE_STATUS_NUM)
+#define CKPT_STATUS_TABLE_SIZE  STATUS_TABLE_SIZE(CKPT_STATUS_NUM)
 #define DIRTY_STATUS_TABLE_SIZE STATUS_TABLE_SIZE(SECTOR_DIRTY_STATUS_NUM)
 #define ENV_STATUS_TABLE_SIZE   STATUS_TABLE_SIZE(ENV_STATUS_NUM)
 
@@ -110,6 +147,13 @@
     ((unsigned long)(&((struct env_hdr_data*)0)->name_len))
 
 #define VER_NUM_ENV_NAME "__ver_num__"
+/* the batch commit record, it's value is the record number of the batch */
+#define BATCH_ENV_NAME "__batch__"
+
+/* the max ENV number of one batch write */
+#ifndef EFD_ENV_BATCH_MAX
+#define EFD_ENV_BATCH_MAX 8
+#endif
 
 enum sector_store_status {
     SECTOR_STORE_UNUSED,
@@ -129,6 +173,15 @@ enum sector_dirty_status {
 };
 typedef enum sector_dirty_status sector_dirty_status_t;
 
+enum ckpt_status {
+    CKPT_UNUSED,
+    CKPT_PRE_WRITE,
+    CKPT_VALID,
+    CKPT_STALE,
+    CKPT_STATUS_NUM,
+};
+typedef enum ckpt_status ckpt_status_t;
+
 struct sector_hdr_data {
     struct {
         uint8_t store
@@ -140,7 +193,7 @@ struct sector_hdr_data {
     uint32_t magic; /**< magic word(`E`, `F`, `4`, `0`) */
     uint32_t
         combined; /**< the combined next sector number, 0xFFFFFFFF: not combined */
-    uint32_t reserved;
+    uint32_t erase_count; /**< the sector erase count, 0xFFFFFFFF: unknown (formatted by old version) */
 } __attribute__((__packed__));
 
 ;
@@ -160,6 +213,7 @@ struct sector_meta_data {
     uint32_t magic; /**< magic word(`E`, `F`, `4`, `0`) */
     uint32_t
         combined; /**< the combined next sector number, 0xFFFFFFFF: not combined */
+    uint32_t erase_count; /**< the sector erase count */
     size_t remain;      /**< remain size */
     uint32_t empty_env; /**< the next empty ENV node start address */
 } __attribute__((__packed__));
@@ -198,7 +252,39 @@ struct sector_cache_node {
 ;
 typedef struct sector_cache_node* sector_cache_node_t;
 
+#ifdef EFD_ENV_USING_CHECKPOINT
+struct ckpt_hdr_data {
+    uint8_t status_table
+        [CKPT_STATUS_TABLE_SIZE]; /**< checkpoint status, @see ckpt_status_t */
+    uint32_t magic;               /**< magic word(`C`, `K`, `4`, `0`) */
+    uint32_t len;        /**< checkpoint total length (header + data), must align by EFD_WRITE_GRAN */
+    uint32_t generation; /**< increased by every checkpoint */
+    uint32_t crc32;      /**< crc32(env_start_addr + ... + data) */
+    uint32_t env_start_addr; /**< ENV area start address when checkpoint */
+    uint32_t env_area_size;  /**< ENV area size when checkpoint */
+    uint16_t sector_num;     /**< sector cache node number */
+    uint16_t key_num;        /**< key directory node number, CKPT_KEY_DIR_NOT_READY: not ready */
+} __attribute__((__packed__));
+typedef struct ckpt_hdr_data* ckpt_hdr_data_t;
+
+#define CKPT_HDR_DATA_SIZE (EFD_WG_ALIGN(sizeof(struct ckpt_hdr_data)))
+#define CKPT_MAGIC_OFFSET  ((unsigned long)(&((struct ckpt_hdr_data*)0)->magic))
+#define CKPT_CRC_OFFSET    ((unsigned long)(&((struct ckpt_hdr_data*)0)->env_start_addr))
+#endif /* EFD_ENV_USING_CHECKPOINT */
+
+#ifdef EFD_ENV_USING_KEY_DIR
+struct key_dir_node {
+    uint32_t name_crc; /**< ENV name's CRC32 value */
+    uint32_t addr;     /**< ENV node address, KEY_DIR_EMPTY or KEY_DIR_DELETED */
+};
+typedef struct key_dir_node* key_dir_node_t;
+#endif /* EFD_ENV_USING_KEY_DIR */
+
 static void gc_collect(void);
+#ifdef EFD_ENV_USING_CHECKPOINT
+static void ckpt_stale(uint32_t addr);
+static uint32_t ckpt_find_latest(ckpt_hdr_data_t latest_hdr);
+#endif
 
 /* ENV start address in flash */
 static uint32_t env_start_addr = 0;
@@ -212,6 +298,12 @@ static bool init_ok = false;
 static bool gc_request = false;
 /* is in recovery check status when first reboot */
 static bool in_recovery_check = false;
+/* GC statistics */
+static efd_gc_stats_t gc_stats;
+/* boot statistics of the last efd_load_env */
+static efd_boot_stats_t boot_stats;
+/* read_env call count, for the boot statistics */
+static uint32_t env_read_count = 0;
 
 #ifdef EFD_ENV_USING_CACHE
 /* ENV cache table */
@@ -220,6 +312,15 @@ struct env_cache_node env_cache_table[EFD_ENV_CACHE_TABLE_SIZE] = {0};
 struct sector_cache_node sector_cache_table[EFD_SECTOR_CACHE_TABLE_SIZE] = {0};
 #endif /* EFD_ENV_USING_CACHE */
 
+#ifdef EFD_ENV_USING_KEY_DIR
+/* key directory, open addressing hash table of all ENV by name CRC32 */
+static struct key_dir_node key_dir_table[EFD_KEY_DIR_TABLE_SIZE];
+/* the used entries number in key directory, including deleted entries */
+static size_t key_dir_used = 0;
+/* the key directory is holding all ENV, so a lookup miss means the ENV is NOT exist */
+static bool key_dir_ready = false;
+#endif /* EFD_ENV_USING_KEY_DIR */
+
 static size_t set_status(uint8_t status_table[], size_t status_num,
                          size_t status_index) {
     size_t byte_index = ~0UL;
@@ -273,6 +374,10 @@ static EfErrCode write_status(uint32_t addr, uint8_t status_table[],
     EFD_ASSERT(status_index < status_num);
     EFD_ASSERT(status_table);
 
+#ifdef EFD_ENV_USING_CHECKPOINT
+    ckpt_stale(addr);
+#endif
+
     /* set the status first */
     byte_index = set_status(status_table, status_num, status_index);
 
@@ -462,7 +567,8 @@ static uint32_t continue_ff_addr(uint32_t start, uint32_t end) {
 static uint32_t find_next_env_addr(uint32_t start, uint32_t end) {
     uint8_t buf[32];
     uint32_t start_bak = start, i;
-    uint32_t magic;
+    uint32_t magic, sec_end = EFD_ALIGN_DOWN(start, SECTOR_SIZE) + SECTOR_SIZE;
+    size_t read_size;
 
 #ifdef EFD_ENV_USING_CACHE
     uint32_t empty_env;
@@ -474,7 +580,13 @@ static uint32_t find_next_env_addr(uint32_t start, uint32_t end) {
 #endif /* EFD_ENV_USING_CACHE */
 
     for (; start < end; start += (sizeof(buf) - sizeof(uint32_t))) {
-        efd_port_read(start, (uint32_t*)buf, sizeof(buf));
+        /* don't read over the sector end, the last sector is the end of ENV area */
+        read_size = sizeof(buf);
+        if (start + read_size > sec_end) {
+            read_size = sec_end - start;
+            memset(buf, 0xFF, sizeof(buf));
+        }
+        efd_port_read(start, (uint32_t*)buf, read_size);
         for (i = 0; i < sizeof(buf) - sizeof(uint32_t) && start + i < end;
              i++) {
 #ifndef EFD_BIG_ENDIAN /* Little Endian Order */
@@ -537,6 +649,8 @@ static EfErrCode read_env(env_node_obj_t env) {
     uint32_t calc_crc32 = 0, crc_data_len, env_name_addr;
     EfErrCode result = EFD_NO_ERR;
     size_t len, size;
+
+    env_read_count++;
     /* read ENV header raw data */
     efd_port_read(env->addr.start, (uint32_t*)&env_hdr,
                   sizeof(struct env_hdr_data));
@@ -612,11 +726,15 @@ static EfErrCode read_sector_meta_data(uint32_t addr, sector_meta_data_t sector,
     if (sector->magic != SECTOR_MAGIC_WORD) {
         sector->check_ok = false;
         sector->combined = SECTOR_NOT_COMBINED;
+        sector->erase_count = 0;
         return EFD_ENV_INIT_FAILED;
     }
     sector->check_ok = true;
     /* get other sector meta data */
     sector->combined = sec_hdr.combined;
+    sector->erase_count = sec_hdr.erase_count == SECTOR_ERASE_COUNT_UNKNOWN
+                              ? 0
+                              : sec_hdr.erase_count;
     sector->status.store = (sector_store_status_t)get_status(
         sec_hdr.status_table.store, SECTOR_STORE_STATUS_NUM);
     sector->status.dirty = (sector_dirty_status_t)get_status(
@@ -757,9 +875,145 @@ static bool find_env_no_cache(const char* key, env_node_obj_t env) {
     return find_ok;
 }
 
+#ifdef EFD_ENV_USING_KEY_DIR
+static void key_dir_reset(void) {
+    size_t i;
+
+    for (i = 0; i < EFD_KEY_DIR_TABLE_SIZE; i++) {
+        key_dir_table[i].addr = KEY_DIR_EMPTY;
+    }
+    key_dir_used = 0;
+}
+
+static bool key_dir_insert(uint32_t name_crc, uint32_t addr) {
+    size_t i, index = name_crc & (EFD_KEY_DIR_TABLE_SIZE - 1);
+
+    if (key_dir_used >= KEY_DIR_LOAD_MAX) {
+        return false;
+    }
+    /* linear probing, reuse the first deleted entry */
+    for (i = 0; i < EFD_KEY_DIR_TABLE_SIZE; i++) {
+        key_dir_node_t node = &key_dir_table[index];
+
+        if (node->addr == KEY_DIR_EMPTY || node->addr == KEY_DIR_DELETED) {
+            if (node->addr == KEY_DIR_EMPTY) {
+                key_dir_used++;
+            }
+            node->name_crc = name_crc;
+            node->addr = addr;
+            return true;
+        }
+        index = (index + 1) & (EFD_KEY_DIR_TABLE_SIZE - 1);
+    }
+
+    return false;
+}
+
+static bool key_dir_build_cb(env_node_obj_t env, void* arg1, void* arg2) {
+    bool* build_ok = arg1;
+
+    if (env->crc_is_ok && env->status == ENV_WRITE) {
+        if (!key_dir_insert(efd_calc_crc32(0, env->name, env->name_len),
+                            env->addr.start)) {
+            /* out of the memory budget */
+            *build_ok = false;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Rebuild the key directory by scanning all ENV on flash.
+ * The key directory will be disabled when it's out of the memory budget.
+ */
+static void key_dir_build(void) {
+    struct env_node_obj env;
+    bool build_ok = true;
+
+    key_dir_reset();
+    env_iterator(&env, &build_ok, NULL, key_dir_build_cb);
+    key_dir_ready = build_ok;
+    if (!build_ok) {
+        log_warn("EFD key directory is full (%d), fall back to scan.\n",
+                 EFD_KEY_DIR_TABLE_SIZE);
+    }
+}
+
+/*
+ * Add the new ENV node address to key directory.
+ * The old node of the same ENV will be removed by key_dir_remove when it's deleted.
+ */
+static void key_dir_add(const char* name, size_t name_len, uint32_t addr) {
+    if (!key_dir_ready) {
+        return;
+    }
+    if (!key_dir_insert(efd_calc_crc32(0, name, name_len), addr)) {
+        /* too many entries or deleted entries, the new ENV is on flash now */
+        key_dir_build();
+    }
+}
+
+static void key_dir_remove(const char* name, size_t name_len, uint32_t addr) {
+    uint32_t name_crc;
+    size_t i, index;
+
+    if (!key_dir_ready) {
+        return;
+    }
+    name_crc = efd_calc_crc32(0, name, name_len);
+    index = name_crc & (EFD_KEY_DIR_TABLE_SIZE - 1);
+    for (i = 0; i < EFD_KEY_DIR_TABLE_SIZE; i++) {
+        key_dir_node_t node = &key_dir_table[index];
+
+        if (node->addr == KEY_DIR_EMPTY) {
+            return;
+        } else if (node->addr == addr) {
+            node->addr = KEY_DIR_DELETED;
+            return;
+        }
+        index = (index + 1) & (EFD_KEY_DIR_TABLE_SIZE - 1);
+    }
+}
+
+/*
+ * Find the ENV by key directory. Only the ENV nodes which has same name CRC32 will be read.
+ */
+static bool find_env_by_key_dir(const char* key, env_node_obj_t env) {
+    size_t i, key_len = strlen(key), index;
+    uint32_t name_crc = efd_calc_crc32(0, key, key_len);
+
+    index = name_crc & (EFD_KEY_DIR_TABLE_SIZE - 1);
+    for (i = 0; i < EFD_KEY_DIR_TABLE_SIZE; i++) {
+        key_dir_node_t node = &key_dir_table[index];
+
+        if (node->addr == KEY_DIR_EMPTY) {
+            break;
+        } else if (node->addr != KEY_DIR_DELETED && node->name_crc == name_crc) {
+            env->addr.start = node->addr;
+            read_env(env);
+            if (env->crc_is_ok && env->status == ENV_WRITE
+                && env->name_len == key_len && !memcmp(env->name, key, key_len)) {
+                return true;
+            }
+        }
+        index = (index + 1) & (EFD_KEY_DIR_TABLE_SIZE - 1);
+    }
+
+    return false;
+}
+#endif /* EFD_ENV_USING_KEY_DIR */
+
 static bool find_env(const char* key, env_node_obj_t env) {
     bool find_ok = false;
 
+#ifdef EFD_ENV_USING_KEY_DIR
+    if (key_dir_ready) {
+        return find_env_by_key_dir(key, env);
+    }
+#endif /* EFD_ENV_USING_KEY_DIR */
+
 #ifdef EFD_ENV_USING_CACHE
     size_t key_len = strlen(key);
 
@@ -960,9 +1214,24 @@ static EfErrCode write_env_hdr(uint32_t addr, env_hdr_data_t env_hdr) {
 static EfErrCode format_sector(uint32_t addr, uint32_t combined_value) {
     EfErrCode result = EFD_NO_ERR;
     struct sector_hdr_data sec_hdr;
+    uint32_t erase_count = 0;
 
     EFD_ASSERT(addr % SECTOR_SIZE == 0);
 
+#ifdef EFD_ENV_USING_CHECKPOINT
+    ckpt_stale(addr);
+#endif
+
+    /* inherit the erase count from the old sector header */
+    efd_port_read(addr, (uint32_t*)&sec_hdr, sizeof(struct sector_hdr_data));
+    if (sec_hdr.magic == SECTOR_MAGIC_WORD
+        && sec_hdr.erase_count != SECTOR_ERASE_COUNT_UNKNOWN) {
+        erase_count = sec_hdr.erase_count;
+    }
+    if (erase_count < SECTOR_ERASE_COUNT_UNKNOWN - 1) {
+        erase_count++;
+    }
+
     result = efd_port_erase(addr, SECTOR_SIZE);
     if (result == EFD_NO_ERR) {
         /* initialize the header data */
@@ -973,7 +1242,7 @@ static EfErrCode format_sector(uint32_t addr, uint32_t combined_value) {
                    SECTOR_DIRTY_FALSE);
         sec_hdr.magic = SECTOR_MAGIC_WORD;
         sec_hdr.combined = combined_value;
-        sec_hdr.reserved = 0xFFFFFFFF;
+        sec_hdr.erase_count = erase_count;
         /* save the header */
         result = efd_port_write(addr, (uint32_t*)&sec_hdr,
                                 sizeof(struct sector_hdr_data));
@@ -1074,6 +1343,25 @@ static bool alloc_env_cb(sector_meta_data_t sector, void* arg1, void* arg2) {
     return false;
 }
 
+#ifdef EFD_ENV_USING_WEAR_LEVELING
+static bool alloc_env_least_worn_cb(sector_meta_data_t sector, void* arg1,
+                                    void* arg2) {
+    size_t* env_size = arg1;
+    uint32_t* least_worn = arg2;
+
+    /* find the least-worn empty sector, the first one is selected when the erase count is same */
+    if (sector->check_ok && sector->remain > *env_size
+        && sector->status.dirty == SECTOR_DIRTY_FALSE
+        && (least_worn[0] == FAILED_ADDR
+            || sector->erase_count < least_worn[1])) {
+        least_worn[0] = sector->empty_env;
+        least_worn[1] = sector->erase_count;
+    }
+
+    return false;
+}
+#endif /* EFD_ENV_USING_WEAR_LEVELING */
+
 static uint32_t alloc_env(sector_meta_data_t sector, size_t env_size) {
     uint32_t empty_env = FAILED_ADDR;
     size_t empty_sector = 0, using_sector = 0;
@@ -1088,8 +1376,21 @@ static uint32_t alloc_env(sector_meta_data_t sector, size_t env_size) {
     }
     if (empty_sector > 0 && empty_env == FAILED_ADDR) {
         if (empty_sector > EFD_GC_EMPTY_SEC_THRESHOLD || gc_request) {
+#ifdef EFD_ENV_USING_WEAR_LEVELING
+            /* [0]: empty ENV address, [1]: erase count */
+            uint32_t least_worn[2] = {FAILED_ADDR, 0};
+
+            sector_iterator(sector, SECTOR_STORE_EMPTY, &env_size, least_worn,
+                            alloc_env_least_worn_cb, true);
+            if ((empty_env = least_worn[0]) != FAILED_ADDR) {
+                /* the sector meta data must be the allocated sector */
+                read_sector_meta_data(EFD_ALIGN_DOWN(empty_env, SECTOR_SIZE),
+                                      sector, true);
+            }
+#else
             sector_iterator(sector, SECTOR_STORE_EMPTY, &env_size, &empty_env,
                             alloc_env_cb, true);
+#endif /* EFD_ENV_USING_WEAR_LEVELING */
         } else {
             /* no space for new ENV now will GC and retry */
             // log_info("Trigger a GC check after alloc ENV failed.\n");
@@ -1104,6 +1405,8 @@ static EfErrCode del_env(const char* key, env_node_obj_t old_env,
                          bool complete_del) {
     EfErrCode result = EFD_NO_ERR;
     uint32_t dirty_status_addr;
+    /* old_env points to it after the find, keep it for the whole function */
+    struct env_node_obj env;
     static bool last_is_complete_del = false;
 
 #if (ENV_STATUS_TABLE_SIZE >= DIRTY_STATUS_TABLE_SIZE)
@@ -1114,7 +1417,6 @@ static EfErrCode del_env(const char* key, env_node_obj_t old_env,
 
     /* need find ENV */
     if (!old_env) {
-        struct env_node_obj env;
         /* find ENV */
         if (find_env(key, &env)) {
             old_env = &env;
@@ -1146,6 +1448,13 @@ static EfErrCode del_env(const char* key, env_node_obj_t old_env,
         }
 
         last_is_complete_del = false;
+
+#ifdef EFD_ENV_USING_KEY_DIR
+        if (result == EFD_NO_ERR) {
+            key_dir_remove(old_env->name, old_env->name_len,
+                           old_env->addr.start);
+        }
+#endif /* EFD_ENV_USING_KEY_DIR */
     }
 
     dirty_status_addr = EFD_ALIGN_DOWN(old_env->addr.start, SECTOR_SIZE)
@@ -1179,7 +1488,8 @@ static EfErrCode move_env(env_node_obj_t env) {
         if (in_recovery_check) {
             struct env_node_obj env_bak;
             char name[EFD_ENV_NAME_MAX + 1] = {0};
-            memcpy(name, env->name, env->name_len + 1);
+            /* the name on flash is not terminated */
+            memcpy(name, env->name, env->name_len);
             /* check the ENV in flash is already create success */
             if (find_env_no_cache(name, &env_bak)) {
                 /* already create success, don't need to duplicate */
@@ -1221,6 +1531,10 @@ static EfErrCode move_env(env_node_obj_t env) {
                                 + EFD_WG_ALIGN(env->value_len));
         update_env_cache(env->name, env->name_len, env_addr);
 #endif /* EFD_ENV_USING_CACHE */
+
+#ifdef EFD_ENV_USING_KEY_DIR
+        key_dir_add(env->name, env->name_len, env_addr);
+#endif /* EFD_ENV_USING_KEY_DIR */
     }
 
     // log_info("Moved the ENV (%.*s) from 0x%08X to 0x%08X.\n", env->name_len, env->name, env->addr.start, env_addr);
@@ -1268,6 +1582,7 @@ static bool gc_check_cb(sector_meta_data_t sector, void* arg1, void* arg2) {
 
 static bool do_gc(sector_meta_data_t sector, void* arg1, void* arg2) {
     struct env_node_obj env;
+    bool* collected = arg1;
 
     if (sector->check_ok
         && (sector->status.dirty == SECTOR_DIRTY_TRUE
@@ -1286,16 +1601,28 @@ static bool do_gc(sector_meta_data_t sector, void* arg1, void* arg2) {
                 /* move the ENV to new space */
                 if (move_env(&env) != EFD_NO_ERR) {
                     // log_info("Error: Moved the ENV (%.*s) for GC failed.\n", env.name_len, env.name);
+                } else {
+                    gc_stats.env_moved++;
                 }
             }
         }
         format_sector(sector->addr, SECTOR_NOT_COMBINED);
+        gc_stats.sector_erased++;
+        *collected = true;
         // log_info("Collect a sector @0x%08X\n", sector->addr);
     }
 
     return false;
 }
 
+static void gc_update_pause(uint32_t start_ms) {
+    uint32_t pause_ms = efd_port_get_ms() - start_ms;
+
+    if (pause_ms > gc_stats.max_pause_ms) {
+        gc_stats.max_pause_ms = pause_ms;
+    }
+}
+
 /*
  * The GC will be triggered on the following scene:
  * 1. alloc an ENV when the flash not has enough space
@@ -1304,6 +1631,8 @@ static bool do_gc(sector_meta_data_t sector, void* arg1, void* arg2) {
 static void gc_collect(void) {
     struct sector_meta_data sector;
     size_t empty_sec = 0;
+    uint32_t start_ms = efd_port_get_ms();
+    bool collected = false;
 #if (LPWR_FLASH_PROTECT_ENABLE == 1 && CHIP_DEVICE_CONFIG_ENABLE_SED != 1)
     if (flash_vbat_read() < 2500)
         return;
@@ -1315,12 +1644,41 @@ static void gc_collect(void) {
     /* do GC collect */
     // log_info("The remain empty sector is %d, GC threshold is %d.\n", empty_sec, EFD_GC_EMPTY_SEC_THRESHOLD);
     if (empty_sec <= EFD_GC_EMPTY_SEC_THRESHOLD) {
-        sector_iterator(&sector, SECTOR_STORE_UNUSED, NULL, NULL, do_gc, false);
+        sector_iterator(&sector, SECTOR_STORE_UNUSED, &collected, NULL, do_gc,
+                        false);
+    }
+
+    if (collected) {
+        gc_stats.collect_count++;
+        gc_update_pause(start_ms);
     }
 
     gc_request = false;
 }
 
+
+/**
+ * Get the GC statistics.
+ *
+ * @param stats the statistics buffer
+ */
+void efd_get_gc_stats(efd_gc_stats_t* stats) {
+    EFD_ASSERT(stats);
+
+    efd_port_env_lock();
+    *stats = gc_stats;
+    efd_port_env_unlock();
+}
+
+/**
+ * Reset the GC statistics.
+ */
+void efd_reset_gc_stats(void) {
+    efd_port_env_lock();
+    memset(&gc_stats, 0, sizeof(gc_stats));
+    efd_port_env_unlock();
+}
+
 static EfErrCode align_write(uint32_t addr, const uint32_t* buf, size_t size) {
     EfErrCode result = EFD_NO_ERR;
     size_t align_remain;
@@ -1353,6 +1711,54 @@ static EfErrCode align_write(uint32_t addr, const uint32_t* buf, size_t size) {
     return result;
 }
 
+static void init_env_hdr(env_hdr_data_t env_hdr, const char* key, size_t len) {
+    memset(env_hdr, 0xFF, sizeof(struct env_hdr_data));
+    env_hdr->magic = ENV_MAGIC_WORD;
+    env_hdr->name_len = strlen(key);
+    env_hdr->value_len = len;
+    env_hdr->len = ENV_HDR_DATA_SIZE + EFD_WG_ALIGN(env_hdr->name_len)
+                   + EFD_WG_ALIGN(env_hdr->value_len);
+}
+
+/*
+ * write the ENV header, name and value, the ENV status will be ENV_PRE_WRITE
+ */
+static EfErrCode write_env_data(uint32_t env_addr, env_hdr_data_t env_hdr,
+                                const char* key, const void* value) {
+    EfErrCode result = EFD_NO_ERR;
+    size_t align_remain;
+    uint8_t ff = 0xFF;
+
+    /* start calculate CRC32 */
+    env_hdr->crc32 = efd_calc_crc32(0, &env_hdr->name_len,
+                                    ENV_HDR_DATA_SIZE - ENV_NAME_LEN_OFFSET);
+    env_hdr->crc32 = efd_calc_crc32(env_hdr->crc32, key, env_hdr->name_len);
+    align_remain = EFD_WG_ALIGN(env_hdr->name_len) - env_hdr->name_len;
+    while (align_remain--) {
+        env_hdr->crc32 = efd_calc_crc32(env_hdr->crc32, &ff, 1);
+    }
+    env_hdr->crc32 = efd_calc_crc32(env_hdr->crc32, value, env_hdr->value_len);
+    align_remain = EFD_WG_ALIGN(env_hdr->value_len) - env_hdr->value_len;
+    while (align_remain--) {
+        env_hdr->crc32 = efd_calc_crc32(env_hdr->crc32, &ff, 1);
+    }
+    /* write ENV header data */
+    result = write_env_hdr(env_addr, env_hdr);
+    /* write key name */
+    if (result == EFD_NO_ERR) {
+        result = align_write(env_addr + ENV_HDR_DATA_SIZE, (uint32_t*)key,
+                             env_hdr->name_len);
+    }
+    /* write value */
+    if (result == EFD_NO_ERR) {
+        result = align_write(env_addr + ENV_HDR_DATA_SIZE
+                                 + EFD_WG_ALIGN(env_hdr->name_len),
+                             value, env_hdr->value_len);
+    }
+
+    return result;
+}
+
 static EfErrCode create_env_blob(sector_meta_data_t sector, const char* key,
                                  const void* value, size_t len) {
     EfErrCode result = EFD_NO_ERR;
@@ -1365,12 +1771,7 @@ static EfErrCode create_env_blob(sector_meta_data_t sector, const char* key,
         return EFD_ENV_NAME_ERR;
     }
 
-    memset(&env_hdr, 0xFF, sizeof(struct env_hdr_data));
-    env_hdr.magic = ENV_MAGIC_WORD;
-    env_hdr.name_len = strlen(key);
-    env_hdr.value_len = len;
-    env_hdr.len = ENV_HDR_DATA_SIZE + EFD_WG_ALIGN(env_hdr.name_len)
-                  + EFD_WG_ALIGN(env_hdr.value_len);
+    init_env_hdr(&env_hdr, key, len);
 
     if (env_hdr.len > SECTOR_SIZE - SECTOR_HDR_DATA_SIZE) {
         // log_info("Error: The ENV size is too big\n");
@@ -1379,35 +1780,13 @@ static EfErrCode create_env_blob(sector_meta_data_t sector, const char* key,
 
     if (env_addr != FAILED_ADDR
         || (env_addr = new_env(sector, env_hdr.len)) != FAILED_ADDR) {
-        size_t align_remain;
         /* update the sector status */
         if (result == EFD_NO_ERR) {
             result = update_sec_status(sector, env_hdr.len, &is_full);
         }
+        /* write ENV header, key name and value */
         if (result == EFD_NO_ERR) {
-            uint8_t ff = 0xFF;
-            /* start calculate CRC32 */
-            env_hdr.crc32 = efd_calc_crc32(
-                0, &env_hdr.name_len, ENV_HDR_DATA_SIZE - ENV_NAME_LEN_OFFSET);
-            env_hdr.crc32 = efd_calc_crc32(env_hdr.crc32, key,
-                                           env_hdr.name_len);
-            align_remain = EFD_WG_ALIGN(env_hdr.name_len) - env_hdr.name_len;
-            while (align_remain--) {
-                env_hdr.crc32 = efd_calc_crc32(env_hdr.crc32, &ff, 1);
-            }
-            env_hdr.crc32 = efd_calc_crc32(env_hdr.crc32, value,
-                                           env_hdr.value_len);
-            align_remain = EFD_WG_ALIGN(env_hdr.value_len) - env_hdr.value_len;
-            while (align_remain--) {
-                env_hdr.crc32 = efd_calc_crc32(env_hdr.crc32, &ff, 1);
-            }
-            /* write ENV header data */
-            result = write_env_hdr(env_addr, &env_hdr);
-        }
-        /* write key name */
-        if (result == EFD_NO_ERR) {
-            result = align_write(env_addr + ENV_HDR_DATA_SIZE, (uint32_t*)key,
-                                 env_hdr.name_len);
+            result = write_env_data(env_addr, &env_hdr, key, value);
 
 #ifdef EFD_ENV_USING_CACHE
             if (!is_full) {
@@ -1419,17 +1798,16 @@ static EfErrCode create_env_blob(sector_meta_data_t sector, const char* key,
             update_env_cache(key, env_hdr.name_len, env_addr);
 #endif /* EFD_ENV_USING_CACHE */
         }
-        /* write value */
-        if (result == EFD_NO_ERR) {
-            result = align_write(
-                env_addr + ENV_HDR_DATA_SIZE + EFD_WG_ALIGN(env_hdr.name_len),
-                value, env_hdr.value_len);
-        }
         /* change the ENV status to ENV_WRITE */
         if (result == EFD_NO_ERR) {
             result = write_status(env_addr, env_hdr.status_table,
                                   ENV_STATUS_NUM, ENV_WRITE);
         }
+#ifdef EFD_ENV_USING_KEY_DIR
+        if (result == EFD_NO_ERR) {
+            key_dir_add(key, env_hdr.name_len, env_addr);
+        }
+#endif /* EFD_ENV_USING_KEY_DIR */
         /* trigger GC collect when current sector is full */
         if (result == EFD_NO_ERR && is_full) {
             // log_info("Trigger a GC check after created ENV.\n");
@@ -1574,14 +1952,162 @@ EfErrCode efd_set_and_save_env(const char* key, const char* value) {
     return efd_set_env_blob(key, value, strlen(value));
 }
 
+static EfErrCode set_env_batch(const efd_env* envs, size_t num) {
+    EfErrCode result = EFD_NO_ERR;
+    static struct env_node_obj old_env[EFD_ENV_BATCH_MAX];
+    static bool old_is_found[EFD_ENV_BATCH_MAX];
+    struct sector_meta_data sector;
+    struct env_hdr_data batch_hdr, env_hdr;
+    struct env_node_obj batch_env;
+    uint32_t batch_num = num, batch_addr, env_addr;
+    size_t i, j, total_len;
+    bool is_full = false;
+
+    /* the batch commit record is the first record, then the ENV records follow it */
+    init_env_hdr(&batch_hdr, BATCH_ENV_NAME, sizeof(batch_num));
+    total_len = batch_hdr.len;
+    for (i = 0; i < num; i++) {
+        if (envs[i].key == NULL
+            || (envs[i].value == NULL && envs[i].value_len > 0)
+            || strlen(envs[i].key) > EFD_ENV_NAME_MAX) {
+            return EFD_ENV_ARG_ERR;
+        }
+        for (j = 0; j < i; j++) {
+            if (!strcmp(envs[i].key, envs[j].key)) {
+                return EFD_ENV_ARG_ERR;
+            }
+        }
+        init_env_hdr(&env_hdr, envs[i].key, envs[i].value_len);
+        total_len += env_hdr.len;
+    }
+    /* all records must be in one sector */
+    if (total_len > SECTOR_SIZE - SECTOR_HDR_DATA_SIZE) {
+        return EFD_ENV_FULL;
+    }
+    /* alloc the space for all records once */
+    if ((batch_addr = new_env(&sector, total_len)) == FAILED_ADDR) {
+        return EFD_ENV_FULL;
+    }
+    result = update_sec_status(&sector, total_len, &is_full);
+    /* write all records, the status is ENV_PRE_WRITE */
+    if (result == EFD_NO_ERR) {
+        result = write_env_data(batch_addr, &batch_hdr, BATCH_ENV_NAME,
+                                &batch_num);
+    }
+    env_addr = batch_addr + batch_hdr.len;
+    for (i = 0; i < num && result == EFD_NO_ERR; i++) {
+        init_env_hdr(&env_hdr, envs[i].key, envs[i].value_len);
+        result = write_env_data(env_addr, &env_hdr, envs[i].key,
+                                envs[i].value);
+        env_addr += env_hdr.len;
+    }
+#ifdef EFD_ENV_USING_CACHE
+    if (result == EFD_NO_ERR && !is_full) {
+        update_sector_cache(sector.addr, env_addr);
+    }
+#endif /* EFD_ENV_USING_CACHE */
+    if (result != EFD_NO_ERR) {
+        /* the ENV_PRE_WRITE records will be dropped on next boot */
+        return result;
+    }
+    /* prepare to delete the old ENV */
+    for (i = 0; i < num && result == EFD_NO_ERR; i++) {
+        old_is_found[i] = find_env(envs[i].key, &old_env[i]);
+        if (old_is_found[i]) {
+            result = del_env(envs[i].key, &old_env[i], false);
+        }
+    }
+    /* commit the batch. After this point, it will be finished when recovery */
+    if (result == EFD_NO_ERR) {
+        result = write_status(batch_addr, batch_hdr.status_table,
+                              ENV_STATUS_NUM, ENV_WRITE);
+    }
+    /* change the ENV status to ENV_WRITE in a single pass */
+    env_addr = batch_addr + batch_hdr.len;
+    for (i = 0; i < num && result == EFD_NO_ERR; i++) {
+        init_env_hdr(&env_hdr, envs[i].key, envs[i].value_len);
+        result = write_status(env_addr, env_hdr.status_table, ENV_STATUS_NUM,
+                              ENV_WRITE);
+#ifdef EFD_ENV_USING_CACHE
+        update_env_cache(envs[i].key, env_hdr.name_len, env_addr);
+#endif /* EFD_ENV_USING_CACHE */
+#ifdef EFD_ENV_USING_KEY_DIR
+        key_dir_add(envs[i].key, env_hdr.name_len, env_addr);
+#endif /* EFD_ENV_USING_KEY_DIR */
+        env_addr += env_hdr.len;
+    }
+    /* delete the old ENV */
+    for (i = 0; i < num && result == EFD_NO_ERR; i++) {
+        if (old_is_found[i]) {
+            result = del_env(envs[i].key, &old_env[i], true);
+        }
+    }
+    /* the batch is finished, delete the commit record */
+    if (result == EFD_NO_ERR) {
+        batch_env.addr.start = batch_addr;
+        batch_env.name_len = strlen(BATCH_ENV_NAME);
+        memcpy(batch_env.name, BATCH_ENV_NAME, batch_env.name_len);
+        result = del_env(NULL, &batch_env, true);
+    }
+    /* trigger GC collect when current sector is full */
+    if (is_full) {
+        gc_request = true;
+    }
+    if (gc_request) {
+        gc_collect();
+    }
+
+    return result;
+}
+
+/**
+ * Set a batch of blob ENV. All records are written to one sector with one
+ * space allocation, and they are crash-atomic as a group: after a power
+ * failure all of them are updated or none of them.
+ *
+ * @note the batch can NOT delete ENV, and the key can NOT be duplicated in one batch
+ *
+ * @param envs ENV array, the value_len is the value blob length
+ * @param num ENV number, it must be less than or equal to EFD_ENV_BATCH_MAX
+ *
+ * @return result
+ */
+EfErrCode efd_set_env_batch(const efd_env* envs, size_t num) {
+    EfErrCode result = EFD_NO_ERR;
+
+    if (!init_ok) {
+        // log_info("ENV isn't initialize OK.\n");
+        return EFD_ENV_INIT_FAILED;
+    }
+
+    if (envs == NULL || num == 0 || num > EFD_ENV_BATCH_MAX) {
+        return EFD_ENV_ARG_ERR;
+    }
+
+    /* lock the ENV cache */
+    efd_port_env_lock();
+
+    result = set_env_batch(envs, num);
+
+    /* unlock the ENV cache */
+    efd_port_env_unlock();
+
+    return result;
+}
+
 /**
  * Save ENV to flash.
  *
  * @note this function is DEPRECATED
  */
 EfErrCode efd_save_env(void) {
+#ifdef EFD_ENV_USING_CHECKPOINT
+    /* save the index checkpoint on this mode */
+    return efd_env_checkpoint();
+#else
     /* do nothing not cur mode */
     return EFD_NO_ERR;
+#endif
 }
 
 /**
@@ -1599,6 +2125,13 @@ EfErrCode efd_env_set_default(void) {
 
     /* lock the ENV cache */
     efd_port_env_lock();
+
+#ifdef EFD_ENV_USING_KEY_DIR
+    /* all ENV will be erased */
+    key_dir_reset();
+    key_dir_ready = !in_recovery_check;
+#endif /* EFD_ENV_USING_KEY_DIR */
+
     /* format all sectors */
     for (addr = env_start_addr; addr < env_start_addr + ENV_AREA_SIZE;
          addr += SECTOR_SIZE) {
@@ -1705,6 +2238,81 @@ void info_env(void) {
     efd_port_env_unlock();
 }
 
+static bool wear_stats_cb(sector_meta_data_t sector, void* arg1, void* arg2) {
+    efd_wear_stats_t* stats = arg1;
+    uint32_t* counts = arg2;
+
+    if (counts && stats->sector_num < stats->hist_num) {
+        counts[stats->sector_num] = sector->erase_count;
+    }
+    if (stats->sector_num == 0 || sector->erase_count < stats->min) {
+        stats->min = sector->erase_count;
+    }
+    if (sector->erase_count > stats->max) {
+        stats->max = sector->erase_count;
+    }
+    stats->total += sector->erase_count;
+    stats->sector_num++;
+
+    return false;
+}
+
+/**
+ * Get the ENV sector wear statistics.
+ *
+ * @param stats the statistics buffer
+ * @param counts the erase count of each sector by address order, it can be NULL
+ * @param num the max number of counts
+ */
+void efd_get_wear_stats(efd_wear_stats_t* stats, uint32_t* counts, size_t num) {
+    struct sector_meta_data sector;
+
+    EFD_ASSERT(stats);
+
+    memset(stats, 0, sizeof(efd_wear_stats_t));
+    stats->hist_num = counts ? num : 0;
+    if (!init_ok) {
+        return;
+    }
+
+    /* lock the ENV cache */
+    efd_port_env_lock();
+
+    sector_iterator(&sector, SECTOR_STORE_UNUSED, stats, counts, wear_stats_cb,
+                    false);
+
+    /* unlock the ENV cache */
+    efd_port_env_unlock();
+}
+
+/**
+ * Print the ENV sector erase count histogram.
+ */
+void efd_print_wear(void) {
+    uint32_t counts[SECTOR_NUM];
+    efd_wear_stats_t stats;
+    size_t i, j, bar;
+
+    efd_get_wear_stats(&stats, counts, SECTOR_NUM);
+    if (stats.sector_num == 0) {
+        return;
+    }
+
+    efd_print("sector erase count: min %lu, max %lu, avg %lu\n",
+              (unsigned long)stats.min, (unsigned long)stats.max,
+              (unsigned long)(stats.total / stats.sector_num));
+    for (i = 0; i < stats.sector_num && i < SECTOR_NUM; i++) {
+        efd_print("0x%08lx %8lu |", (unsigned long)(env_start_addr + i * SECTOR_SIZE),
+                  (unsigned long)counts[i]);
+        /* the bar is scaled to 32 characters */
+        bar = stats.max ? counts[i] * 32 / stats.max : 0;
+        for (j = 0; j < bar; j++) {
+            efd_print("#");
+        }
+        efd_print("\n");
+    }
+}
+
 #ifdef EFD_ENV_AUTO_UPDATE
 /*
  * Auto update ENV to latest default when current EFD_ENV_VER_NUM is changed.
@@ -1769,6 +2377,40 @@ static bool check_and_recovery_gc_cb(sector_meta_data_t sector, void* arg1,
     return false;
 }
 
+/*
+ * Finish the committed batch which was interrupted by power failure
+ */
+static bool check_and_recovery_batch_cb(env_node_obj_t env, void* arg1,
+                                        void* arg2) {
+    if (env->crc_is_ok && env->status == ENV_WRITE
+        && env->name_len == strlen(BATCH_ENV_NAME)
+        && !memcmp(env->name, BATCH_ENV_NAME, env->name_len)) {
+        uint8_t status_table[ENV_STATUS_TABLE_SIZE];
+        struct env_node_obj batch_env;
+        uint32_t batch_num = 0, i;
+
+        efd_port_read(env->addr.value, &batch_num, sizeof(batch_num));
+        /* the ENV records follow the commit record */
+        batch_env.addr.start = env->addr.start + env->len;
+        for (i = 0; i < batch_num; i++) {
+            read_env(&batch_env);
+            if (!batch_env.crc_is_ok) {
+                break;
+            }
+            if (batch_env.status == ENV_PRE_WRITE) {
+                write_status(batch_env.addr.start, status_table, ENV_STATUS_NUM,
+                             ENV_WRITE);
+            }
+            batch_env.addr.start += batch_env.len;
+        }
+        /* the old ENV which is ENV_PRE_DELETE will be deleted by check_and_recovery_env_cb */
+        write_status(env->addr.start, status_table, ENV_STATUS_NUM,
+                     ENV_DELETED);
+    }
+
+    return false;
+}
+
 static bool check_and_recovery_env_cb(env_node_obj_t env, void* arg1,
                                       void* arg2) {
     /* recovery the prepare deleted ENV */
@@ -1787,12 +2429,334 @@ static bool check_and_recovery_env_cb(env_node_obj_t env, void* arg1,
         // TODO �����쳣������״̬װ��ͼ
         write_status(env->addr.start, status_table, ENV_STATUS_NUM,
                      ENV_ERR_HDR);
-        return true;
+        /* continue check, the batch write maybe has more than one ENV_PRE_WRITE record */
+        return false;
+    }
+
+    return false;
+}
+
+#ifdef EFD_ENV_USING_CHECKPOINT
+/* the valid checkpoint address on flash, FAILED_ADDR: no valid checkpoint */
+static uint32_t ckpt_valid_addr = FAILED_ADDR;
+/* the next free checkpoint address, FAILED_ADDR: the checkpoint area must be erased */
+static uint32_t ckpt_next_addr = FAILED_ADDR;
+/* the last checkpoint generation */
+static uint32_t ckpt_generation = 0;
+/* the checkpoint area is read, so ckpt_valid_addr is the valid checkpoint on flash */
+static bool ckpt_found = false;
+
+/*
+ * Mark the valid checkpoint to stale before the ENV area is changed.
+ * The ENV area may be formatted before the checkpoint is restored, e.g. by
+ * efd_load_env, so the checkpoint on flash is looked up the first time.
+ */
+static void ckpt_stale(uint32_t addr) {
+    uint8_t status_table[CKPT_STATUS_TABLE_SIZE];
+    struct ckpt_hdr_data hdr;
+    uint32_t valid_addr;
+
+    if (addr < env_start_addr || addr >= env_start_addr + ENV_AREA_SIZE) {
+        return;
+    }
+    if (!ckpt_found) {
+        ckpt_valid_addr = ckpt_find_latest(&hdr);
+    }
+    valid_addr = ckpt_valid_addr;
+    if (valid_addr == FAILED_ADDR) {
+        return;
+    }
+    ckpt_valid_addr = FAILED_ADDR;
+    write_status(valid_addr, status_table, CKPT_STATUS_NUM, CKPT_STALE);
+}
+
+/*
+ * Iterate the checkpoint records in the checkpoint area, find the latest valid one and the free space.
+ */
+static uint32_t ckpt_find_latest(ckpt_hdr_data_t latest_hdr) {
+    struct ckpt_hdr_data hdr;
+    uint32_t addr = EFD_CKPT_START_ADDR, latest = FAILED_ADDR;
+
+    ckpt_found = true;
+    ckpt_next_addr = FAILED_ADDR;
+    while (addr + CKPT_HDR_DATA_SIZE <= EFD_CKPT_START_ADDR + EFD_CKPT_AREA_SIZE) {
+        efd_port_read(addr, (uint32_t*)&hdr, sizeof(struct ckpt_hdr_data));
+        if (hdr.magic != CKPT_MAGIC_WORD) {
+            size_t i;
+            /* the free space must be erased */
+            for (i = 0; i < sizeof(struct ckpt_hdr_data); i++) {
+                if (((uint8_t*)&hdr)[i] != 0xFF) {
+                    return latest;
+                }
+            }
+            ckpt_next_addr = addr;
+            return latest;
+        }
+        if (hdr.len < CKPT_HDR_DATA_SIZE
+            || hdr.len > EFD_CKPT_START_ADDR + EFD_CKPT_AREA_SIZE - addr) {
+            return latest;
+        }
+        if (hdr.generation >= ckpt_generation) {
+            ckpt_generation = hdr.generation;
+        }
+        if (get_status(hdr.status_table, CKPT_STATUS_NUM) == CKPT_VALID) {
+            latest = addr;
+            *latest_hdr = hdr;
+        }
+        addr += hdr.len;
+    }
+
+    return latest;
+}
+
+static uint32_t ckpt_calc_crc32(ckpt_hdr_data_t hdr) {
+    uint32_t crc = 0;
+    size_t i;
+
+    crc = efd_calc_crc32(crc, &hdr->env_start_addr,
+                         sizeof(struct ckpt_hdr_data) - CKPT_CRC_OFFSET);
+#ifdef EFD_ENV_USING_CACHE
+    crc = efd_calc_crc32(crc, sector_cache_table, sizeof(sector_cache_table));
+#endif /* EFD_ENV_USING_CACHE */
+#ifdef EFD_ENV_USING_KEY_DIR
+    if (hdr->key_num != CKPT_KEY_DIR_NOT_READY) {
+        for (i = 0; i < EFD_KEY_DIR_TABLE_SIZE; i++) {
+            if (key_dir_table[i].addr != KEY_DIR_EMPTY
+                && key_dir_table[i].addr != KEY_DIR_DELETED) {
+                crc = efd_calc_crc32(crc, &key_dir_table[i],
+                                     sizeof(struct key_dir_node));
+            }
+        }
+    }
+#endif /* EFD_ENV_USING_KEY_DIR */
+    (void)i;
+
+    return crc;
+}
+
+/*
+ * Restore the sector cache and key directory from the latest valid checkpoint.
+ *
+ * @return true: restore OK, the ENV scan can be skipped
+ */
+static bool ckpt_restore(void) {
+    struct ckpt_hdr_data hdr;
+    uint32_t addr, data_addr, crc;
+
+    if ((addr = ckpt_find_latest(&hdr)) == FAILED_ADDR) {
+        return false;
     }
+    /* check the ENV area layout */
+    if (hdr.env_start_addr != env_start_addr || hdr.env_area_size != ENV_AREA_SIZE) {
+        return false;
+    }
+    data_addr = addr + CKPT_HDR_DATA_SIZE;
+    crc = efd_calc_crc32(0, &hdr.env_start_addr,
+                         sizeof(struct ckpt_hdr_data) - CKPT_CRC_OFFSET);
+
+#ifdef EFD_ENV_USING_CACHE
+    if (hdr.sector_num != EFD_SECTOR_CACHE_TABLE_SIZE) {
+        return false;
+    }
+    efd_port_read(data_addr, (uint32_t*)sector_cache_table,
+                  sizeof(sector_cache_table));
+    data_addr += sizeof(sector_cache_table);
+    crc = efd_calc_crc32(crc, sector_cache_table, sizeof(sector_cache_table));
+#else
+    if (hdr.sector_num != 0) {
+        return false;
+    }
+#endif /* EFD_ENV_USING_CACHE */
+
+#ifdef EFD_ENV_USING_KEY_DIR
+    key_dir_reset();
+    if (hdr.key_num != CKPT_KEY_DIR_NOT_READY) {
+        struct key_dir_node node;
+        size_t i;
+
+        if (hdr.key_num > KEY_DIR_LOAD_MAX) {
+            goto __failed;
+        }
+        for (i = 0; i < hdr.key_num; i++) {
+            efd_port_read(data_addr, (uint32_t*)&node, sizeof(node));
+            data_addr += sizeof(node);
+            crc = efd_calc_crc32(crc, &node, sizeof(node));
+            key_dir_insert(node.name_crc, node.addr);
+        }
+    }
+#else
+    if (hdr.key_num != CKPT_KEY_DIR_NOT_READY) {
+        return false;
+    }
+#endif /* EFD_ENV_USING_KEY_DIR */
+
+    if (crc != hdr.crc32) {
+        goto __failed;
+    }
+
+#ifdef EFD_ENV_USING_KEY_DIR
+    if (hdr.key_num != CKPT_KEY_DIR_NOT_READY) {
+        key_dir_ready = true;
+    } else {
+        key_dir_build();
+    }
+#endif /* EFD_ENV_USING_KEY_DIR */
+
+    ckpt_valid_addr = addr;
+
+    return true;
+
+__failed:
+#ifdef EFD_ENV_USING_CACHE
+    {
+        size_t i;
+
+        for (i = 0; i < EFD_SECTOR_CACHE_TABLE_SIZE; i++) {
+            sector_cache_table[i].addr = FAILED_ADDR;
+        }
+    }
+#endif /* EFD_ENV_USING_CACHE */
 
     return false;
 }
 
+static EfErrCode ckpt_save(void) {
+    EfErrCode result = EFD_NO_ERR;
+    struct ckpt_hdr_data hdr;
+    uint32_t addr, data_addr;
+    size_t i;
+
+    if (ckpt_valid_addr != FAILED_ADDR) {
+        /* the checkpoint is up to date */
+        return EFD_NO_ERR;
+    }
+
+    memset(&hdr, 0xFF, sizeof(struct ckpt_hdr_data));
+    hdr.magic = CKPT_MAGIC_WORD;
+    hdr.generation = ckpt_generation + 1;
+    hdr.env_start_addr = env_start_addr;
+    hdr.env_area_size = ENV_AREA_SIZE;
+    hdr.len = CKPT_HDR_DATA_SIZE;
+#ifdef EFD_ENV_USING_CACHE
+    hdr.sector_num = EFD_SECTOR_CACHE_TABLE_SIZE;
+    hdr.len += sizeof(sector_cache_table);
+#else
+    hdr.sector_num = 0;
+#endif /* EFD_ENV_USING_CACHE */
+    hdr.key_num = CKPT_KEY_DIR_NOT_READY;
+#ifdef EFD_ENV_USING_KEY_DIR
+    if (key_dir_ready) {
+        hdr.key_num = 0;
+        for (i = 0; i < EFD_KEY_DIR_TABLE_SIZE; i++) {
+            if (key_dir_table[i].addr != KEY_DIR_EMPTY
+                && key_dir_table[i].addr != KEY_DIR_DELETED) {
+                hdr.key_num++;
+            }
+        }
+        hdr.len += hdr.key_num * sizeof(struct key_dir_node);
+    }
+#endif /* EFD_ENV_USING_KEY_DIR */
+    hdr.len = EFD_WG_ALIGN(hdr.len);
+    hdr.crc32 = ckpt_calc_crc32(&hdr);
+
+    if (hdr.len > EFD_CKPT_AREA_SIZE) {
+        return EFD_ENV_FULL;
+    }
+    /* erase the checkpoint area when it's full */
+    if (ckpt_next_addr == FAILED_ADDR
+        || ckpt_next_addr + hdr.len > EFD_CKPT_START_ADDR + EFD_CKPT_AREA_SIZE) {
+        for (addr = EFD_CKPT_START_ADDR;
+             addr < EFD_CKPT_START_ADDR + EFD_CKPT_AREA_SIZE;
+             addr += EFD_ERASE_MIN_SIZE) {
+            result = efd_port_erase(addr, EFD_ERASE_MIN_SIZE);
+            if (result != EFD_NO_ERR) {
+                ckpt_next_addr = FAILED_ADDR;
+                return result;
+            }
+        }
+        ckpt_next_addr = EFD_CKPT_START_ADDR;
+    }
+    addr = ckpt_next_addr;
+    ckpt_next_addr += hdr.len;
+
+    /* write the header, the status is CKPT_PRE_WRITE */
+    result = write_status(addr, hdr.status_table, CKPT_STATUS_NUM,
+                          CKPT_PRE_WRITE);
+    if (result == EFD_NO_ERR) {
+        result = efd_port_write(addr + CKPT_MAGIC_OFFSET, &hdr.magic,
+                                sizeof(struct ckpt_hdr_data) - CKPT_MAGIC_OFFSET);
+    }
+    data_addr = addr + CKPT_HDR_DATA_SIZE;
+#ifdef EFD_ENV_USING_CACHE
+    if (result == EFD_NO_ERR) {
+        result = align_write(data_addr, (uint32_t*)sector_cache_table,
+                             sizeof(sector_cache_table));
+        data_addr += sizeof(sector_cache_table);
+    }
+#endif /* EFD_ENV_USING_CACHE */
+#ifdef EFD_ENV_USING_KEY_DIR
+    if (hdr.key_num != CKPT_KEY_DIR_NOT_READY) {
+        for (i = 0; i < EFD_KEY_DIR_TABLE_SIZE && result == EFD_NO_ERR; i++) {
+            if (key_dir_table[i].addr != KEY_DIR_EMPTY
+                && key_dir_table[i].addr != KEY_DIR_DELETED) {
+                result = align_write(data_addr, (uint32_t*)&key_dir_table[i],
+                                     sizeof(struct key_dir_node));
+                data_addr += sizeof(struct key_dir_node);
+            }
+        }
+    }
+#endif /* EFD_ENV_USING_KEY_DIR */
+    (void)i;
+    /* the checkpoint is valid now */
+    if (result == EFD_NO_ERR) {
+        result = write_status(addr, hdr.status_table, CKPT_STATUS_NUM,
+                              CKPT_VALID);
+    }
+    if (result == EFD_NO_ERR) {
+        ckpt_generation = hdr.generation;
+        ckpt_valid_addr = addr;
+    }
+
+    return result;
+}
+
+/**
+ * Save the ENV index (sector cache and key directory) checkpoint to flash.
+ * The next boot will restore the index from it without scanning all ENV,
+ * until the ENV area is changed.
+ *
+ * @return result
+ */
+EfErrCode efd_env_checkpoint(void) {
+    EfErrCode result = EFD_NO_ERR;
+
+    if (!init_ok) {
+        return EFD_ENV_INIT_FAILED;
+    }
+
+    /* lock the ENV cache */
+    efd_port_env_lock();
+
+    result = ckpt_save();
+
+    /* unlock the ENV cache */
+    efd_port_env_unlock();
+
+    return result;
+}
+#endif /* EFD_ENV_USING_CHECKPOINT */
+
+/**
+ * Get the boot statistics of the last efd_load_env.
+ *
+ * @param stats the statistics buffer
+ */
+void efd_get_boot_stats(efd_boot_stats_t* stats) {
+    EFD_ASSERT(stats);
+
+    *stats = boot_stats;
+}
+
 /**
  * Check and load the flash ENV meta data.
  *
@@ -1803,8 +2767,16 @@ EfErrCode efd_load_env(void) {
     struct env_node_obj env;
     struct sector_meta_data sector;
     size_t check_failed_count = 0;
+    uint32_t start_ms = efd_port_get_ms(), start_read_count = env_read_count;
 
+    memset(&boot_stats, 0, sizeof(boot_stats));
     in_recovery_check = true;
+
+#ifdef EFD_ENV_USING_KEY_DIR
+    /* using the flash scan until the recovery is finished */
+    key_dir_ready = false;
+#endif /* EFD_ENV_USING_KEY_DIR */
+
     /* check all sector header */
     sector_iterator(&sector, SECTOR_STORE_UNUSED, &check_failed_count, NULL,
                     check_sec_hdr_cb, false);
@@ -1816,6 +2788,18 @@ EfErrCode efd_load_env(void) {
 
     /* lock the ENV cache */
     efd_port_env_lock();
+
+#ifdef EFD_ENV_USING_CHECKPOINT
+    /* the valid checkpoint means there is NOT any interrupted ENV operation */
+    if (ckpt_restore()) {
+        boot_stats.from_checkpoint = true;
+        in_recovery_check = false;
+        goto __exit;
+    }
+#endif /* EFD_ENV_USING_CHECKPOINT */
+
+    /* finish the committed batch before GC, the batch records must keep contiguous */
+    env_iterator(&env, NULL, NULL, check_and_recovery_batch_cb);
     /* check all sector header for recovery GC */
     sector_iterator(&sector, SECTOR_STORE_UNUSED, NULL, NULL,
                     check_and_recovery_gc_cb, false);
@@ -1830,6 +2814,19 @@ __retry:
 
     in_recovery_check = false;
 
+#ifdef EFD_ENV_USING_KEY_DIR
+    key_dir_build();
+#endif /* EFD_ENV_USING_KEY_DIR */
+
+#ifdef EFD_ENV_USING_CHECKPOINT
+    /* save the checkpoint for next boot */
+    ckpt_save();
+
+__exit:
+#endif /* EFD_ENV_USING_CHECKPOINT */
+    boot_stats.env_scanned = env_read_count - start_read_count;
+    boot_stats.ms = efd_port_get_ms() - start_ms;
+
     /* unlock the ENV cache */
     efd_port_env_unlock();
 
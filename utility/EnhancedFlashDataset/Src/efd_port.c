@@ -1,4 +1,7 @@
 #include <EnhancedFlashDataset.h>
+
+#ifndef EFD_USING_PORT_SIM
+
 #include <FreeRTOS.h>
 #include <semphr.h>
 #include <stdarg.h>
@@ -10,6 +13,76 @@
 
 static uint8_t mpcache_buf[0x100] __attribute__((aligned(4)));
 
+/* flash access statistics */
+static efd_port_stats_t port_stats;
+
+#define READ_CACHE_PAGE_SIZE  0x100
+#define READ_CACHE_INVALID    0xFFFFFFFF
+
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+struct read_cache_page {
+    uint8_t buf[READ_CACHE_PAGE_SIZE]; /**< page data, must be the first member for alignment */
+    uint32_t addr;          /**< page start address, READ_CACHE_INVALID: not used */
+    uint32_t active;        /**< the last access sequence, for LRU */
+};
+
+/* read cache, it's invalidated by efd_port_write and efd_port_erase */
+static struct read_cache_page read_cache[EFD_PORT_READ_CACHE_PAGES] __attribute__((aligned(4)));
+static uint32_t read_cache_seq = 0;
+
+static void read_cache_init(void) {
+    size_t i;
+
+    for (i = 0; i < EFD_PORT_READ_CACHE_PAGES; i++) {
+        read_cache[i].addr = READ_CACHE_INVALID;
+        read_cache[i].active = 0;
+    }
+}
+
+/*
+ * Get the page from cache, read the page to the least recently used cache when miss.
+ */
+static const uint8_t* read_cache_get(uint32_t page_addr) {
+    size_t i, victim = 0;
+
+    for (i = 0; i < EFD_PORT_READ_CACHE_PAGES; i++) {
+        if (read_cache[i].addr == page_addr) {
+            port_stats.cache_hit++;
+            read_cache[i].active = ++read_cache_seq;
+            return read_cache[i].buf;
+        }
+        if (read_cache[i].active < read_cache[victim].active) {
+            victim = i;
+        }
+    }
+
+    port_stats.cache_miss++;
+    port_stats.page_read++;
+    while (flash_check_busy())
+        ;
+    flash_read_page((uint32_t)read_cache[victim].buf, page_addr);
+    while (flash_check_busy())
+        ;
+    read_cache[victim].addr = page_addr;
+    read_cache[victim].active = ++read_cache_seq;
+
+    return read_cache[victim].buf;
+}
+
+static void read_cache_invalidate(uint32_t addr, size_t size) {
+    size_t i;
+
+    for (i = 0; i < EFD_PORT_READ_CACHE_PAGES; i++) {
+        if (read_cache[i].addr != READ_CACHE_INVALID
+            && read_cache[i].addr + READ_CACHE_PAGE_SIZE > addr
+            && read_cache[i].addr < addr + size) {
+            read_cache[i].addr = READ_CACHE_INVALID;
+            read_cache[i].active = 0;
+        }
+    }
+}
+#endif /* EFD_PORT_READ_CACHE_PAGES > 0 */
+
 /* default environment variables set for user */
 static const efd_env default_env_set[] = {{"boot_times", "3", 1}};
 
@@ -24,6 +97,10 @@ static const efd_env default_env_set[] = {{"boot_times", "3", 1}};
 EfErrCode efd_port_init(efd_env const** default_env, size_t* default_env_size) {
     EfErrCode result = EFD_NO_ERR;
 
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+    read_cache_init();
+#endif
+
     *default_env = default_env_set;
     *default_env_size = sizeof(default_env_set) / sizeof(default_env_set[0]);
 
@@ -48,11 +125,35 @@ EfErrCode efd_port_read(uint32_t addr, uint32_t* buf, size_t size) {
     uint8_t start_pos = 0;
     size_t r_size = 0, r_pos = 0, tmp = size;
 
+    port_stats.read_count++;
+    port_stats.read_bytes += size;
+
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+    /* read by page through the read cache */
+    start_pos = (addr % READ_CACHE_PAGE_SIZE);
+    addr -= start_pos;
+
+    while (tmp > 0) {
+        if ((tmp + start_pos) < READ_CACHE_PAGE_SIZE) {
+            r_size = tmp;
+        } else {
+            r_size = READ_CACHE_PAGE_SIZE - start_pos;
+        }
+
+        memcpy(&ptr[r_pos], read_cache_get(addr) + start_pos, r_size);
+
+        tmp -= r_size;
+        r_pos += r_size;
+        start_pos = 0;
+        addr += READ_CACHE_PAGE_SIZE;
+    }
+#else
     start_pos = (addr % 0x100);
 
     do {
         /* code */
         if (tmp == 1) {
+            port_stats.page_read++;
             while (flash_check_busy())
                 ;
             ptr[r_pos] = flash_read_byte(addr);
@@ -69,6 +170,7 @@ EfErrCode efd_port_read(uint32_t addr, uint32_t* buf, size_t size) {
             r_size = 0x100 - start_pos;
         }
 
+        port_stats.page_read++;
         while (flash_check_busy())
             ;
         flash_read_page((uint32_t)mpcache_buf, addr);
@@ -84,6 +186,7 @@ EfErrCode efd_port_read(uint32_t addr, uint32_t* buf, size_t size) {
         addr += 0x100;
 
     } while (tmp > 0);
+#endif /* EFD_PORT_READ_CACHE_PAGES > 0 */
 
     return result;
 }
@@ -106,6 +209,10 @@ EfErrCode efd_port_erase(uint32_t addr, size_t size) {
     EFD_ASSERT(addr % EFD_ERASE_MIN_SIZE == 0);
 
     /* You can add your code under here. */
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+    read_cache_invalidate(addr, EFD_ERASE_MIN_SIZE);
+#endif
+    port_stats.erase_count++;
     flash_erase(FLASH_ERASE_SECTOR, addr);
     while (flash_check_busy())
         ;
@@ -132,6 +239,13 @@ EfErrCode efd_port_write(uint32_t addr, const uint32_t* buf, size_t size) {
     uint8_t start_pos = 0;
     size_t w_size = 0, w_pos = 0, tmp = size;
 
+    port_stats.write_count++;
+    port_stats.write_bytes += size;
+
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+    read_cache_invalidate(addr, size);
+#endif
+
     start_pos = (addr % 0x100);
 
     do {
@@ -189,6 +303,33 @@ void efd_port_env_unlock(void) {
     xTaskResumeAll();
 }
 
+/**
+ * Get a millisecond time stamp for the benchmark and statistics.
+ *
+ * @return current time in milliseconds
+ */
+uint32_t efd_port_get_ms(void) {
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+/**
+ * Get the flash access statistics.
+ *
+ * @param stats the statistics buffer
+ */
+void efd_port_get_stats(efd_port_stats_t* stats) {
+    EFD_ASSERT(stats);
+
+    *stats = port_stats;
+}
+
+/**
+ * Reset the flash access statistics.
+ */
+void efd_port_reset_stats(void) {
+    memset(&port_stats, 0, sizeof(port_stats));
+}
+
 /**
  * This function is print flash debug info.
  *
@@ -255,3 +396,5 @@ void efd_print(const char* format, ...) {
     va_end(args);
 #endif
 }
+
+#endif /* EFD_USING_PORT_SIM */
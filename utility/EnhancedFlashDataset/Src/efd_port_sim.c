@@ -0,0 +1,406 @@
+#include <EnhancedFlashDataset.h>
+
+#ifdef EFD_USING_PORT_SIM
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * NOR flash simulator for the ENV area.
+ *
+ * The area [EFD_START_ADDR, EFD_START_ADDR + EFD_PORT_SIM_SIZE) is backed by a
+ * RAM buffer, or by a mmap'd file after efd_port_sim_open(). It behaves like
+ * a NOR flash:
+ * 1. erase sets the whole sector to 0xFF
+ * 2. write can only clear bits (new = old & data)
+ * 3. when EFD_WRITE_GRAN is larger than 8 bits, a write granule must be
+ *    aligned and can only be programmed once after erase
+ */
+
+#define SIM_GRAN_SIZE ((EFD_WRITE_GRAN + 7) / 8)
+
+/* the simulated flash size from EFD_START_ADDR, it can be larger than ENV area for the checkpoint area */
+#ifndef EFD_PORT_SIM_SIZE
+#define EFD_PORT_SIM_SIZE ENV_AREA_SIZE
+#endif
+
+/* the RAM backend of the simulated flash */
+static uint8_t sim_ram[EFD_PORT_SIM_SIZE];
+/* the current simulated flash memory, RAM or mmap'd file */
+static uint8_t* sim_flash = sim_ram;
+/* the mmap'd file descriptor, -1: using RAM backend */
+static int sim_fd = -1;
+/* flash access statistics */
+static efd_port_stats_t port_stats;
+/* the program and erase operations left before the power cut, 0: no power cut */
+static uint32_t sim_cut_ops;
+
+/* the page of the flash read, the read cache page size in efd_port.c */
+#define SIM_PAGE_SIZE      0x100
+#define SIM_PAGE_INVALID   0xFFFFFFFF
+
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+/* the read cache of efd_port.c, only the page addresses, the data is read from the simulated flash */
+static struct {
+    uint32_t addr;   /**< page start address, SIM_PAGE_INVALID: not used */
+    uint32_t active; /**< the last access sequence, for LRU */
+} sim_cache[EFD_PORT_READ_CACHE_PAGES];
+static uint32_t sim_cache_seq = 0;
+#endif
+
+/* default environment variables set for user */
+static const efd_env default_env_set[] = {{"boot_times", "3", 1}};
+
+static uint8_t* sim_addr(uint32_t addr, size_t size) {
+    /* unsigned, an address below EFD_START_ADDR wraps to a large offset */
+    EFD_ASSERT(size <= EFD_PORT_SIM_SIZE);
+    EFD_ASSERT(addr - EFD_START_ADDR <= EFD_PORT_SIM_SIZE - size);
+
+    return &sim_flash[addr - EFD_START_ADDR];
+}
+
+/**
+ * Back the simulated flash by a file, so the ENV survives between runs.
+ * A new file is created and erased to 0xFF.
+ *
+ * @note it must be called before enhanced_flash_dataset_init
+ *
+ * @param path file path
+ *
+ * @return result
+ */
+EfErrCode efd_port_sim_open(const char* path) {
+    struct stat st;
+    void* map;
+    int fd;
+
+    EFD_ASSERT(path);
+
+    efd_port_sim_close();
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        goto __err;
+    }
+    if (st.st_size != EFD_PORT_SIM_SIZE) {
+        if (ftruncate(fd, EFD_PORT_SIM_SIZE) != 0) {
+            goto __err;
+        }
+    }
+    map = mmap(NULL, EFD_PORT_SIM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        goto __err;
+    }
+    sim_fd = fd;
+    sim_flash = map;
+    /* new file is an erased flash */
+    if (st.st_size != EFD_PORT_SIM_SIZE) {
+        memset(sim_flash, 0xFF, EFD_PORT_SIM_SIZE);
+    }
+
+    return EFD_NO_ERR;
+
+__err:
+    if (fd >= 0) {
+        close(fd);
+    }
+    return EFD_ENV_INIT_FAILED;
+}
+
+/**
+ * Unmap the file backend and fall back to the RAM backend.
+ */
+void efd_port_sim_close(void) {
+    if (sim_fd >= 0) {
+        msync(sim_flash, EFD_PORT_SIM_SIZE, MS_SYNC);
+        munmap(sim_flash, EFD_PORT_SIM_SIZE);
+        close(sim_fd);
+        sim_fd = -1;
+        sim_flash = sim_ram;
+    }
+}
+
+/**
+ * Cut the power after a number of program and erase operations. The last
+ * write programs only its first half, the last erase is not done, then the
+ * process exits with status 0 as the power is off. Run it in a child process
+ * of a file backed flash, the next process recovers the ENV from the file.
+ *
+ * @param op_num the program and erase operations before the cut, 0: no cut
+ */
+void efd_port_sim_power_cut(uint32_t op_num) {
+    sim_cut_ops = op_num;
+}
+
+/* count an operation, true: the power is cut at it */
+static bool sim_cut_op(void) {
+    return sim_cut_ops != 0 && --sim_cut_ops == 0;
+}
+
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+/* count the page read as the read cache of efd_port.c does */
+static void sim_cache_get(uint32_t page_addr) {
+    size_t i, victim = 0;
+
+    for (i = 0; i < EFD_PORT_READ_CACHE_PAGES; i++) {
+        if (sim_cache[i].addr == page_addr) {
+            port_stats.cache_hit++;
+            sim_cache[i].active = ++sim_cache_seq;
+            return;
+        }
+        if (sim_cache[i].active < sim_cache[victim].active) {
+            victim = i;
+        }
+    }
+
+    port_stats.cache_miss++;
+    port_stats.page_read++;
+    sim_cache[victim].addr = page_addr;
+    sim_cache[victim].active = ++sim_cache_seq;
+}
+
+static void sim_cache_invalidate(uint32_t addr, size_t size) {
+    size_t i;
+
+    for (i = 0; i < EFD_PORT_READ_CACHE_PAGES; i++) {
+        if (sim_cache[i].addr != SIM_PAGE_INVALID && sim_cache[i].addr + SIM_PAGE_SIZE > addr
+            && sim_cache[i].addr < addr + size) {
+            sim_cache[i].addr = SIM_PAGE_INVALID;
+            sim_cache[i].active = 0;
+        }
+    }
+}
+#endif /* EFD_PORT_READ_CACHE_PAGES > 0 */
+
+/**
+ * Flash port for hardware initialize.
+ *
+ * @param default_env default ENV set for user
+ * @param default_env_size default ENV size
+ *
+ * @return result
+ */
+EfErrCode efd_port_init(efd_env const** default_env, size_t* default_env_size) {
+    static bool ram_erased = false;
+
+    /* the RAM backend starts as an erased flash */
+    if (!ram_erased) {
+        memset(sim_ram, 0xFF, sizeof(sim_ram));
+        ram_erased = true;
+    }
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+    /* the flash file may be changed by another process */
+    sim_cache_invalidate(EFD_START_ADDR, EFD_PORT_SIM_SIZE);
+#endif
+
+    *default_env = default_env_set;
+    *default_env_size = sizeof(default_env_set) / sizeof(default_env_set[0]);
+
+    return EFD_NO_ERR;
+}
+
+/**
+ * Read data from flash.
+ *
+ * @param addr flash address
+ * @param buf buffer to store read data
+ * @param size read bytes size
+ *
+ * @return result
+ */
+EfErrCode efd_port_read(uint32_t addr, uint32_t* buf, size_t size) {
+    uint32_t page;
+
+    port_stats.read_count++;
+    port_stats.read_bytes += size;
+
+    memcpy(buf, sim_addr(addr, size), size);
+
+    /* count the page reads of efd_port.c, a single byte read is one too */
+    for (page = addr - addr % SIM_PAGE_SIZE; page < addr + size; page += SIM_PAGE_SIZE) {
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+        sim_cache_get(page);
+#else
+        port_stats.page_read++;
+#endif
+    }
+
+    return EFD_NO_ERR;
+}
+
+/**
+ * Erase data on flash.
+ *
+ * @param addr flash address
+ * @param size erase bytes size
+ *
+ * @return result
+ */
+EfErrCode efd_port_erase(uint32_t addr, size_t size) {
+    /* make sure the start address is a multiple of EFD_ERASE_MIN_SIZE */
+    EFD_ASSERT(addr % EFD_ERASE_MIN_SIZE == 0);
+
+    size = EFD_ERASE_MIN_SIZE * ((size + EFD_ERASE_MIN_SIZE - 1) / EFD_ERASE_MIN_SIZE);
+    port_stats.erase_count += size / EFD_ERASE_MIN_SIZE;
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+    sim_cache_invalidate(addr, size);
+#endif
+    if (sim_cut_op()) {
+        _exit(0);
+    }
+
+    memset(sim_addr(addr, size), 0xFF, size);
+
+    return EFD_NO_ERR;
+}
+
+/**
+ * Write data to flash. The bits can only be changed from 1 to 0.
+ *
+ * @param addr flash address
+ * @param buf the write data buffer
+ * @param size write bytes size
+ *
+ * @return result
+ */
+EfErrCode efd_port_write(uint32_t addr, const uint32_t* buf, size_t size) {
+    const uint8_t* src = (const uint8_t*)buf;
+    uint8_t* dst = sim_addr(addr, size);
+    size_t i;
+
+    port_stats.write_count++;
+    port_stats.write_bytes += size;
+#if (EFD_PORT_READ_CACHE_PAGES > 0)
+    sim_cache_invalidate(addr, size);
+#endif
+
+#if (EFD_WRITE_GRAN > 8)
+    /* the granule must be aligned and only programmed once after erase */
+    if ((addr % SIM_GRAN_SIZE) || (size % SIM_GRAN_SIZE)) {
+        return EFD_WRITE_ERR;
+    }
+    for (i = 0; i < size; i++) {
+        if (dst[i] != 0xFF) {
+            return EFD_WRITE_ERR;
+        }
+    }
+#endif
+
+    if (sim_cut_op()) {
+        /* the first half of the granules */
+        size = (size / SIM_GRAN_SIZE + 1) / 2 * SIM_GRAN_SIZE;
+        for (i = 0; i < size; i++) {
+            dst[i] &= src[i];
+        }
+        _exit(0);
+    }
+    for (i = 0; i < size; i++) {
+        dst[i] &= src[i];
+    }
+
+    return EFD_NO_ERR;
+}
+
+/**
+ * lock the ENV ram cache
+ *
+ * @note the simulator is single thread, so nothing to do
+ */
+void efd_port_env_lock(void) {}
+
+/**
+ * unlock the ENV ram cache
+ */
+void efd_port_env_unlock(void) {}
+
+/**
+ * Get a millisecond time stamp for the benchmark and statistics.
+ *
+ * @return current time in milliseconds
+ */
+uint32_t efd_port_get_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/**
+ * Get the flash access statistics.
+ *
+ * @param stats the statistics buffer
+ */
+void efd_port_get_stats(efd_port_stats_t* stats) {
+    EFD_ASSERT(stats);
+
+    *stats = port_stats;
+}
+
+/**
+ * Reset the flash access statistics.
+ */
+void efd_port_reset_stats(void) {
+    memset(&port_stats, 0, sizeof(port_stats));
+}
+
+/**
+ * This function is print flash debug info.
+ *
+ * @param file the file which has call this function
+ * @param line the line number which has call this function
+ * @param format output format
+ * @param ... args
+ *
+ */
+void efd_log_debug(const char* file, const long line, const char* format, ...) {
+#ifdef PRINT_DEBUG
+    va_list args;
+
+    va_start(args, format);
+    printf("[efd](%s:%ld) ", file, line);
+    vprintf(format, args);
+    va_end(args);
+#else
+    (void)file;
+    (void)line;
+    (void)format;
+#endif
+}
+
+/**
+ * This function is print flash routine info.
+ *
+ * @param format output format
+ * @param ... args
+ */
+void efd_log_info(const char* format, ...) {
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/**
+ * This function is print flash non-package info.
+ *
+ * @param format output format
+ * @param ... args
+ */
+void efd_print(const char* format, ...) {
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+#endif /* EFD_USING_PORT_SIM */
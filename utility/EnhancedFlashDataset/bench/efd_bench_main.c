@@ -0,0 +1,67 @@
+/*
+ * The host build of the EFD ENV benchmark on the NOR flash simulator.
+ *
+ *   cc -O2 -DEFD_USING_PORT_SIM -DEFD_USING_BENCH -DEFD_START_ADDR=0
+ *      -Iutility/EnhancedFlashDataset/bench/host
+ *      -Iutility/EnhancedFlashDataset/Inc -Iutility/utility/Inc
+ *      utility/EnhancedFlashDataset/Src/efd_*.c
+ *      utility/EnhancedFlashDataset/Src/EnhancedFlashDataset.c
+ *      utility/utility/util_crc32.c
+ *      utility/EnhancedFlashDataset/bench/efd_bench_main.c
+ *      -o efd_bench
+ *   efd_bench [-k keys] [-v value length] [-r rounds] [-f flash file]
+ *
+ * The ENV options of efd_cfg.h are given by -D too, e.g.
+ * -DEFD_ENV_USING_KEY_DIR. The exit status is not 0 if the benchmark fails.
+ */
+
+#include <EnhancedFlashDataset.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void bench_usage(const char* name) {
+    printf("usage: %s [-k keys] [-v value length] [-r rounds] [-f flash file]\n", name);
+}
+
+int main(int argc, char** argv) {
+    size_t key_num = 64, value_len = 32, rounds = 16;
+    const char* path = NULL;
+    EfErrCode result;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-k") == 0) {
+            key_num = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            value_len = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0) {
+            rounds = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0) {
+            path = argv[++i];
+        } else {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (key_num == 0 || rounds == 0) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    if (path != NULL && efd_port_sim_open(path) != EFD_NO_ERR) {
+        printf("open %s failed\n", path);
+        return 1;
+    }
+    result = enhanced_flash_dataset_init();
+    if (result == EFD_NO_ERR) {
+        result = efd_bench_run(key_num, value_len, rounds);
+    }
+    efd_port_sim_close();
+
+    return (result == EFD_NO_ERR) ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+/*
+ * The boot test of the EFD ENV load on the NOR flash simulator.
+ *
+ *   cc -O2 -DEFD_USING_PORT_SIM -DEFD_START_ADDR=0
+ *      -Iutility/EnhancedFlashDataset/bench/host
+ *      -Iutility/EnhancedFlashDataset/Inc -Iutility/utility/Inc
+ *      utility/EnhancedFlashDataset/Src/efd_*.c
+ *      utility/EnhancedFlashDataset/Src/EnhancedFlashDataset.c
+ *      utility/utility/util_crc32.c
+ *      utility/EnhancedFlashDataset/bench/efd_boot_main.c
+ *      -o efd_boot
+ *   efd_boot [-k keys] [-v value length] [-b boots]
+ *
+ * Build it with and without -DEFD_ENV_USING_CHECKPOINT
+ * -DEFD_CKPT_START_ADDR=ENV_AREA_SIZE -DEFD_PORT_SIM_SIZE=0x9000 to compare
+ * the boot cost. Each boot is a child process on a file backed flash:
+ * 1. the ENV is set to default and the keys are set, then the process exits
+ *    after efd_save_env, it saves the checkpoint if it is used
+ * 2. the next boots load the ENV, report the load cost and check the keys
+ * 3. the ENV area is erased, the checkpoint area is kept. The boot must set
+ *    the ENV to default, not restore the checkpoint, and lose the keys
+ * 4. a key is set on the new ENV and the next boot must find it
+ * The exit status is not 0 if a check fails.
+ */
+
+#include <EnhancedFlashDataset.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define KEY_LEN         16
+#define VALUE_MAX       128
+#define NEW_KEY         "ot-new"
+
+/* the boot steps */
+enum boot_step {
+    BOOT_SETUP,  /**< set the ENV to default and set the keys */
+    BOOT_KEYS,   /**< check the keys */
+    BOOT_ERASED, /**< the ENV area is erased, set the new key */
+    BOOT_NEW,    /**< check the new key */
+};
+
+static size_t key_num = 64, value_len = 32;
+
+static void make_key(char* key, size_t index) {
+    snprintf(key, KEY_LEN, "ot-%x-%x", (unsigned)(index >> 4), (unsigned)(index & 0x0F));
+}
+
+static void make_value(uint8_t* value, size_t index) {
+    size_t i;
+
+    for (i = 0; i < value_len; i++) {
+        value[i] = (uint8_t)(index * 7 + i);
+    }
+}
+
+static int key_check(const char* key, size_t index) {
+    uint8_t value[VALUE_MAX], expect[VALUE_MAX];
+    size_t saved_len = 0;
+
+    make_value(expect, index);
+    if (efd_get_env_blob(key, value, value_len, &saved_len) != value_len || saved_len != value_len
+        || memcmp(value, expect, value_len)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/* the child of a boot, the ENV is loaded by the init */
+static int boot_run(enum boot_step step, int num) {
+    uint8_t value[VALUE_MAX];
+    char key[KEY_LEN];
+    efd_boot_stats_t boot;
+    efd_port_stats_t stats;
+    size_t i, saved_len = 0;
+
+    /* only the test reports, to stderr */
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return 2;
+    }
+    if (enhanced_flash_dataset_init() != EFD_NO_ERR) {
+        fprintf(stderr, "init failed\n");
+        return 2;
+    }
+    efd_get_boot_stats(&boot);
+    efd_port_get_stats(&stats);
+    fprintf(stderr,
+            "boot %d: %s, %lu ENV scanned, %lu ms, read %lu B in %lu calls, %lu page reads\n", num,
+            boot.from_checkpoint ? "checkpoint" : "scan", (unsigned long)boot.env_scanned,
+            (unsigned long)boot.ms, (unsigned long)stats.read_bytes,
+            (unsigned long)stats.read_count, (unsigned long)stats.page_read);
+
+    switch (step) {
+        case BOOT_SETUP:
+            if (efd_env_set_default() != EFD_NO_ERR) {
+                return 2;
+            }
+            for (i = 0; i < key_num; i++) {
+                make_key(key, i);
+                make_value(value, i);
+                if (efd_set_env_blob(key, value, value_len) != EFD_NO_ERR) {
+                    fprintf(stderr, "set %s failed\n", key);
+                    return 2;
+                }
+            }
+            break;
+        case BOOT_KEYS:
+            for (i = 0; i < key_num; i++) {
+                make_key(key, i);
+                if (key_check(key, i)) {
+                    fprintf(stderr, "%s: wrong value\n", key);
+                    return 1;
+                }
+            }
+            break;
+        case BOOT_ERASED:
+            if (boot.from_checkpoint) {
+                fprintf(stderr, "the stale checkpoint is restored\n");
+                return 1;
+            }
+            make_key(key, 0);
+            if (efd_get_env_blob(key, value, value_len, &saved_len) != 0) {
+                fprintf(stderr, "%s: found on the erased ENV\n", key);
+                return 1;
+            }
+            make_value(value, 0);
+            if (efd_set_env_blob(NEW_KEY, value, value_len) != EFD_NO_ERR) {
+                return 2;
+            }
+            break;
+        case BOOT_NEW:
+            if (key_check(NEW_KEY, 0)) {
+                fprintf(stderr, "%s: wrong value\n", NEW_KEY);
+                return 1;
+            }
+            make_key(key, 0);
+            if (efd_get_env_blob(key, value, value_len, &saved_len) != 0) {
+                fprintf(stderr, "%s: found on the erased ENV\n", key);
+                return 1;
+            }
+            break;
+    }
+
+    return efd_save_env() == EFD_NO_ERR ? 0 : 2;
+}
+
+static int boot_fork(enum boot_step step, int num) {
+    int status;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        return 2;
+    }
+    if (pid == 0) {
+        _exit(boot_run(step, num));
+    }
+    waitpid(pid, &status, 0);
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 2;
+}
+
+/* erase the ENV area of the flash file, the checkpoint area after it is kept */
+static int env_erase(const char* path) {
+    uint8_t buf[EFD_ERASE_MIN_SIZE];
+    FILE* fp = fopen(path, "r+b");
+    size_t size;
+
+    if (fp == NULL) {
+        return 2;
+    }
+    memset(buf, 0xFF, sizeof(buf));
+    for (size = 0; size < ENV_AREA_SIZE; size += sizeof(buf)) {
+        if (fwrite(buf, sizeof(buf), 1, fp) != 1) {
+            fclose(fp);
+            return 2;
+        }
+    }
+    fclose(fp);
+
+    return 0;
+}
+
+static void test_usage(const char* name) {
+    printf("usage: %s [-k keys] [-v value length] [-b boots]\n", name);
+}
+
+int main(int argc, char** argv) {
+    char path[] = "/tmp/efd_boot_XXXXXX";
+    int i, fd, boots = 3, num = 0, result = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            test_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-k") == 0) {
+            key_num = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            value_len = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-b") == 0) {
+            boots = atoi(argv[++i]);
+        } else {
+            test_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (key_num == 0 || value_len == 0 || value_len > VALUE_MAX || boots < 1) {
+        test_usage(argv[0]);
+        return 1;
+    }
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        printf("create %s failed\n", path);
+        return 1;
+    }
+    close(fd);
+    /* the children share the mapped flash file */
+    if (efd_port_sim_open(path) != EFD_NO_ERR) {
+        printf("open %s failed\n", path);
+        unlink(path);
+        return 1;
+    }
+
+    result = boot_fork(BOOT_SETUP, num++);
+    for (i = 0; i < boots && result == 0; i++) {
+        result = boot_fork(BOOT_KEYS, num++);
+    }
+    if (result == 0) {
+        result = env_erase(path);
+    }
+    if (result == 0) {
+        result = boot_fork(BOOT_ERASED, num++);
+    }
+    if (result == 0) {
+        result = boot_fork(BOOT_NEW, num++);
+    }
+    efd_port_sim_close();
+    unlink(path);
+
+    fprintf(stderr, "EFD boot: %s\n", result ? "failed" : "passed");
+
+    return result ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/*
+ * The power cut test of the EFD batch write on the NOR flash simulator.
+ *
+ *   cc -O2 -DEFD_USING_PORT_SIM -DEFD_START_ADDR=0
+ *      -Iutility/EnhancedFlashDataset/bench/host
+ *      -Iutility/EnhancedFlashDataset/Inc -Iutility/utility/Inc
+ *      utility/EnhancedFlashDataset/Src/efd_*.c
+ *      utility/EnhancedFlashDataset/Src/EnhancedFlashDataset.c
+ *      utility/utility/util_crc32.c
+ *      utility/EnhancedFlashDataset/bench/efd_powercut_main.c
+ *      -o efd_powercut
+ *   efd_powercut [-r rounds] [-o max operations before the cut] [-s seed]
+ *
+ * Each round is a child process on a file backed flash. It loads the ENV, so
+ * the recovery of the last cut runs, and checks it. Then it writes batches of
+ * BATCH_KEY_NUM keys of one generation and a single set of a noise key for
+ * GC traffic, until the power is cut at a random flash operation. The parent
+ * knows the last generations whose efd_set_env_batch() and noise set returned.
+ *
+ * After the recovery all the batch keys must have one generation, the last
+ * returned one or the next one, and the noise key must be from the last
+ * returned noise set to the last returned batch. An
+ * inconsistent round is reported and the ENV is set to default for the next.
+ * The exit status is not 0 if a round is inconsistent.
+ */
+
+#include <EnhancedFlashDataset.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BATCH_KEY_NUM   4
+#define VALUE_LEN       24
+#define NOISE_KEY       "ot-noise"
+/* the acknowledge of a noise generation in the pipe */
+#define NOISE_ACK       0x80000000UL
+
+/* a value of the generation and the key index */
+static void make_value(uint8_t* value, uint32_t gen, size_t index) {
+    size_t i;
+
+    memcpy(value, &gen, sizeof(gen));
+    for (i = sizeof(gen); i < VALUE_LEN; i++) {
+        value[i] = (uint8_t)(gen + index + i);
+    }
+}
+
+/* the generation of a key, -1: missing or bad value */
+static long read_gen(const char* key, size_t index) {
+    uint8_t value[VALUE_LEN], expect[VALUE_LEN];
+    size_t saved_len = 0;
+    uint32_t gen;
+
+    if (efd_get_env_blob(key, value, sizeof(value), &saved_len) != VALUE_LEN
+        || saved_len != VALUE_LEN) {
+        return -1;
+    }
+    memcpy(&gen, value, sizeof(gen));
+    make_value(expect, gen, index);
+
+    return memcmp(value, expect, VALUE_LEN) ? -1 : (long)gen;
+}
+
+static EfErrCode write_batch(uint32_t gen) {
+    static char keys[BATCH_KEY_NUM][8];
+    static uint8_t values[BATCH_KEY_NUM][VALUE_LEN];
+    efd_env envs[BATCH_KEY_NUM];
+    size_t i;
+
+    for (i = 0; i < BATCH_KEY_NUM; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "ot-b%u", (unsigned)i);
+        make_value(values[i], gen, i);
+        envs[i].key = keys[i];
+        envs[i].value = values[i];
+        envs[i].value_len = VALUE_LEN;
+    }
+
+    return efd_set_env_batch(envs, BATCH_KEY_NUM);
+}
+
+static EfErrCode write_noise(uint32_t gen) {
+    uint8_t value[VALUE_LEN];
+
+    make_value(value, gen, BATCH_KEY_NUM);
+
+    return efd_set_env_blob(NOISE_KEY, value, VALUE_LEN);
+}
+
+static int ack(int fd, uint32_t gen) {
+    return write(fd, &gen, sizeof(gen)) == sizeof(gen) ? 0 : 2;
+}
+
+/*
+ * The child of a round: load and check the ENV of the last returned
+ * generations, then write from the next generation until the power cut.
+ * The recovered and the returned generations go to the pipe.
+ */
+static int round_run(uint32_t acked, uint32_t noise_acked, uint32_t cut_ops, int fd, int first) {
+    char key[8];
+    long gen, batch_gen = -1, noise;
+    size_t i;
+    uint32_t next;
+
+    /* only the test reports, to stderr */
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return 2;
+    }
+    if (enhanced_flash_dataset_init() != EFD_NO_ERR) {
+        fprintf(stderr, "init failed\n");
+        return 2;
+    }
+    if (first) {
+        if (efd_env_set_default() != EFD_NO_ERR || write_batch(0) != EFD_NO_ERR
+            || write_noise(0) != EFD_NO_ERR) {
+            fprintf(stderr, "setup failed\n");
+            return 2;
+        }
+    }
+
+    for (i = 0; i < BATCH_KEY_NUM; i++) {
+        snprintf(key, sizeof(key), "ot-b%u", (unsigned)i);
+        gen = read_gen(key, i);
+        if (i == 0) {
+            batch_gen = gen;
+        }
+        if (gen < 0 || gen != batch_gen) {
+            fprintf(stderr, "%s: generation %ld, %s: generation %ld\n", "ot-b0", batch_gen, key, gen);
+            return 1;
+        }
+    }
+    if (batch_gen != (long)acked && batch_gen != (long)acked + 1) {
+        fprintf(stderr, "batch generation %ld, the last returned %u\n", batch_gen, (unsigned)acked);
+        return 1;
+    }
+    noise = read_gen(NOISE_KEY, BATCH_KEY_NUM);
+    if (noise < (long)noise_acked || noise > (long)acked) {
+        fprintf(stderr, "noise generation %ld, the last returned noise %u and batch %u\n", noise,
+                (unsigned)noise_acked, (unsigned)acked);
+        return 1;
+    }
+    /* the recovered state is on flash now */
+    if (ack(fd, (uint32_t)batch_gen) || ack(fd, (uint32_t)noise | NOISE_ACK)) {
+        return 2;
+    }
+
+    efd_port_sim_power_cut(cut_ops);
+    for (next = (uint32_t)batch_gen + 1;; next++) {
+        if (write_batch(next) != EFD_NO_ERR) {
+            fprintf(stderr, "batch %u failed\n", (unsigned)next);
+            return 2;
+        }
+        if (ack(fd, next)) {
+            return 2;
+        }
+        if (write_noise(next) != EFD_NO_ERR) {
+            fprintf(stderr, "noise %u failed\n", (unsigned)next);
+            return 2;
+        }
+        if (ack(fd, next | NOISE_ACK)) {
+            return 2;
+        }
+    }
+}
+
+static void test_usage(const char* name) {
+    printf("usage: %s [-r rounds] [-o max operations before the cut] [-s seed]\n", name);
+}
+
+int main(int argc, char** argv) {
+    char path[] = "/tmp/efd_powercut_XXXXXX";
+    unsigned rounds = 300, max_ops = 400, seed = 1, round, fail = 0;
+    uint32_t acked = 0, noise_acked = 0, gen, cut_ops;
+    int i, fd, pipe_fd[2], status, first = 1;
+    pid_t pid;
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            test_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-r") == 0) {
+            rounds = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0) {
+            max_ops = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            seed = (unsigned)atoi(argv[++i]);
+        } else {
+            test_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (max_ops == 0) {
+        test_usage(argv[0]);
+        return 1;
+    }
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        printf("create %s failed\n", path);
+        return 1;
+    }
+    close(fd);
+    if (efd_port_sim_open(path) != EFD_NO_ERR) {
+        printf("open %s failed\n", path);
+        unlink(path);
+        return 1;
+    }
+    srand(seed);
+    fflush(stdout);
+
+    /* one more round checks the last cut, it is cut at its first operation */
+    for (round = 0; round <= rounds; round++) {
+        cut_ops = (round < rounds) ? 1 + (uint32_t)rand() % max_ops : 1;
+        if (pipe(pipe_fd) != 0 || (pid = fork()) < 0) {
+            fail++;
+            break;
+        }
+        if (pid == 0) {
+            close(pipe_fd[0]);
+            _exit(round_run(acked, noise_acked, cut_ops, pipe_fd[1], first));
+        }
+        close(pipe_fd[1]);
+        while (read(pipe_fd[0], &gen, sizeof(gen)) == sizeof(gen)) {
+            if (gen & NOISE_ACK) {
+                noise_acked = gen & ~NOISE_ACK;
+            } else {
+                acked = gen;
+            }
+        }
+        close(pipe_fd[0]);
+        waitpid(pid, &status, 0);
+        first = 0;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "round %u: status %d\n", round, status);
+            fail++;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 1) {
+                break;
+            }
+            /* set the ENV to default and start again */
+            first = 1;
+            acked = 0;
+            noise_acked = 0;
+        }
+    }
+    efd_port_sim_close();
+    unlink(path);
+
+    fprintf(stderr, "EFD power cut: %u rounds, %u inconsistent\n", rounds, fail);
+
+    return fail ? 1 : 0;
+}
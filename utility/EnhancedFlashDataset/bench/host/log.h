@@ -0,0 +1,18 @@
+/*
+ * The log macros used by EnhancedFlashDataset in a host build.
+ *
+ * Only for the host build of the EFD benchmark with EFD_USING_PORT_SIM, it
+ * replaces utility/log/log.h which needs FreeRTOS and the log backend.
+ */
+
+#ifndef EFD_BENCH_HOST_LOG_H_
+#define EFD_BENCH_HOST_LOG_H_
+
+#include <stdio.h>
+
+#define log_error(...) fprintf(stderr, __VA_ARGS__)
+#define log_warn(...)  fprintf(stderr, __VA_ARGS__)
+#define log_info(...)  printf(__VA_ARGS__)
+#define log_debug(...) ((void)0)
+
+#endif /* EFD_BENCH_HOST_LOG_H_ */
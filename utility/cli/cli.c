@@ -12,6 +12,7 @@
 #include <task.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "mcu.h"
@@ -19,9 +20,13 @@
 
 #include "cli.h"
 #include "shell.h"
+#include "util_frame_ring.h"
 #ifdef CONFIG_BUILD_COMPONENT_SW_TIMER
 #include "sw_timer.h"
 #endif // CONFIG_BUILD_COMPONENT_SW_TIMER
+#ifdef CONFIG_BUILD_COMPONENT_SYSLOG
+#include "syslog.h"
+#endif // CONFIG_BUILD_COMPONENT_SYSLOG
 
 #define SYS_CLI_TASK_STACK_SIZE 2048
 #define SYS_CLI_TASK_PRIORITY   (28)
@@ -134,6 +139,63 @@ static int _cli_cmd_swtimer(int argc, char** argv, cb_shell_out_t log_out,
     return 0;
 }
 #endif // CONFIG_BUILD_COMPONENT_SW_TIMER
+#ifdef CONFIG_BUILD_COMPONENT_SYSLOG
+static void _cli_syslog_dump_out(const uint8_t* p_data, uint32_t len,
+                                 void* p_arg) {
+    cb_shell_out_t log_out = (cb_shell_out_t)p_arg;
+    uint32_t i;
+
+    // 16 bytes per line, the host decoder reads the hex of every line
+    for (i = 0; i < len; i++) {
+        log_out("%02x", p_data[i]);
+        if (((i & 0xF) == 0xF) || (i == len - 1))
+            log_out("\r\n");
+    }
+}
+
+static int _cli_cmd_syslog(int argc, char** argv, cb_shell_out_t log_out,
+                           void* pExtra) {
+    syslog_module_t t_module = SYSLOG_MODULE_ALL;
+    uint8_t u8_type = 0xFF;
+
+    if ((argc > 1) && (strcmp(argv[1], "dump") == 0)) {
+        log_out(SYSLOG_DUMP_BEGIN "\r\n");
+        syslog_dump(_cli_syslog_dump_out, (void*)log_out);
+        log_out(SYSLOG_DUMP_END "\r\n");
+    } else if ((argc > 1) && (strcmp(argv[1], "clear") == 0)) {
+        syslog_clear();
+    } else if ((argc > 1) && (strcmp(argv[1], "print") == 0)) {
+        if (argc > 2)
+            t_module = (syslog_module_t)strtoul(argv[2], NULL, 0);
+        if (argc > 3)
+            u8_type = (uint8_t)strtoul(argv[3], NULL, 0);
+        if (t_module > SYSLOG_MODULE_ALL)
+            t_module = SYSLOG_MODULE_ALL;
+        syslog_print(t_module, u8_type);
+    } else {
+        log_out("syslog print [module] [type] | dump | clear\r\n");
+    }
+    return 0;
+}
+#endif // CONFIG_BUILD_COMPONENT_SYSLOG
+static int _cli_cmd_framering(int argc, char** argv, cb_shell_out_t log_out,
+                              void* pExtra) {
+    util_frame_ring_t* p_ring;
+    util_frame_ring_stats_t t_stats;
+    bool b_reset = (argc > 1) && (strcmp(argv[1], "reset") == 0);
+
+    log_out("%-12s %5s %5s %5s %10s %10s\r\n", "name", "depth", "used",
+            "max", "put", "drop");
+    for (p_ring = util_frame_ring_list(); p_ring; p_ring = p_ring->p_next) {
+        util_frame_ring_stats_get(p_ring, &t_stats);
+        log_out("%-12s %5u %5u %5u %10u %10u\r\n", p_ring->p_name,
+                t_stats.depth, t_stats.used, t_stats.high_water,
+                t_stats.put_num, t_stats.drop_num);
+        if (b_reset)
+            util_frame_ring_stats_reset(p_ring);
+    }
+    return 0;
+}
 int cli_init(void) {
     xTaskCreate(cli_task, (char*)"console-thread",
                 SYS_CLI_TASK_STACK_SIZE / sizeof(StackType_t), NULL,
@@ -149,6 +211,18 @@ const sh_cmd_t g_cli_cmd_swtimer STATIC_CLI_CMD_ATTRIBUTE = {
     .cmd_exec = _cli_cmd_swtimer,
 };
 #endif
+#ifdef CONFIG_BUILD_COMPONENT_SYSLOG
+const sh_cmd_t g_cli_cmd_syslog STATIC_CLI_CMD_ATTRIBUTE = {
+    .pCmd_name = "syslog",
+    .pDescription = "Print, dump (binary hex) or clear the system log",
+    .cmd_exec = _cli_cmd_syslog,
+};
+#endif
+const sh_cmd_t g_cli_cmd_framering STATIC_CLI_CMD_ATTRIBUTE = {
+    .pCmd_name = "framering",
+    .pDescription = "Show the frame ring usage and drops, [reset] clears them",
+    .cmd_exec = _cli_cmd_framering,
+};
 const sh_cmd_t g_cli_cmd_ps STATIC_CLI_CMD_ATTRIBUTE = {
     .pCmd_name = "ps",
     .pDescription = "Show task and memory usage",
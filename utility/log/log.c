@@ -1,5 +1,6 @@
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -104,4 +105,359 @@ void log_hexdump_out(const char* name, uint8_t width, const uint8_t* buf,
     /* unlock output */
 }
 
-void log_set_level(int level) { log_set.level = level; }
\ No newline at end of file
+void log_set_level(int level) { log_set.level = level; }
+
+#if CONFIG_LOG_DEFERRED
+
+#ifndef CONFIG_LOG_DEFERRED_ENTRY_SIZE
+#define CONFIG_LOG_DEFERRED_ENTRY_SIZE (64)
+#endif // CONFIG_LOG_DEFERRED_ENTRY_SIZE
+
+/* 32-bit words of the arguments, a 64-bit argument takes two words */
+#ifndef CONFIG_LOG_DEFERRED_ARGS
+#define CONFIG_LOG_DEFERRED_ARGS (6)
+#endif // CONFIG_LOG_DEFERRED_ARGS
+
+/* bytes of the %s strings of a log, including the terminators */
+#ifndef CONFIG_LOG_DEFERRED_STR_SIZE
+#define CONFIG_LOG_DEFERRED_STR_SIZE (32)
+#endif // CONFIG_LOG_DEFERRED_STR_SIZE
+
+/* the '*' width and precision of a conversion */
+#define LOG_DEFERRED_STARS_MAX (2)
+
+#ifndef CONFIG_LOG_DEFERRED_TASK_PRIORITY
+#define CONFIG_LOG_DEFERRED_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif // CONFIG_LOG_DEFERRED_TASK_PRIORITY
+
+#ifndef CONFIG_LOG_DEFERRED_TASK_STACK_SIZE
+#define CONFIG_LOG_DEFERRED_TASK_STACK_SIZE (1024)
+#endif // CONFIG_LOG_DEFERRED_TASK_STACK_SIZE
+
+#ifndef CONFIG_LOG_DEFERRED_PERIOD_MS
+#define CONFIG_LOG_DEFERRED_PERIOD_MS (10)
+#endif // CONFIG_LOG_DEFERRED_PERIOD_MS
+
+typedef enum {
+    LOG_ARG_NONE = 0, /* "%%", "%n" or the end of the format */
+    LOG_ARG_INT,
+    LOG_ARG_LONG_LONG,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_STR, /* the offset of the string copy in the record */
+    LOG_ARG_PTR,
+} log_arg_t;
+
+typedef struct {
+    const log_site_t* site; /* NULL: the entry is not ready */
+    uint32_t tick;
+    uint32_t args[CONFIG_LOG_DEFERRED_ARGS];
+    char str[CONFIG_LOG_DEFERRED_STR_SIZE];
+} log_record_t;
+
+/*
+ * Multiple writers (task and ISR) and one reader.
+ * A writer reserves an entry by a compare and swap of the head, and
+ * commits it by writing the site at last. The reader outputs the ready
+ * entries from the tail, the logs are dropped and counted if the ring is full.
+ */
+static log_record_t log_ring[CONFIG_LOG_DEFERRED_ENTRY_SIZE];
+static volatile uint32_t log_ring_head = 0;
+static volatile uint32_t log_ring_tail = 0;
+static volatile uint32_t log_ring_dropped = 0;
+
+/*
+ * Finds the next conversion from *p_fmt, the literal text before it is
+ * [*p_fmt, *p_spec), the conversion is [*p_spec, the return pointer).
+ */
+static const char* log_fmt_next(const char* fmt, const char** p_spec,
+                                log_arg_t* p_type, uint8_t* p_stars) {
+    const char* p = fmt;
+    int longs = 0;
+
+    *p_type = LOG_ARG_NONE;
+    *p_stars = 0;
+
+    while (*p && (*p != '%'))
+        p++;
+    *p_spec = p;
+    if (*p == 0)
+        return p;
+
+    p++;
+    while (*p && strchr("-+ #0", *p))
+        p++;
+    for (; *p && (strchr("0123456789.*", *p)); p++) {
+        if (*p == '*')
+            (*p_stars)++;
+    }
+    for (; *p && strchr("hlLqjzt", *p); p++) {
+        if ((*p == 'l') || (*p == 'q') || (*p == 'L'))
+            longs++;
+        if ((*p == 'j') && (sizeof(intmax_t) > sizeof(uint32_t)))
+            longs = 2;
+    }
+
+    switch (*p) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            *p_type = ((longs > 1) || ((longs == 1) && (sizeof(long) > 4)))
+                          ? LOG_ARG_LONG_LONG
+                          : LOG_ARG_INT;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A': *p_type = LOG_ARG_DOUBLE; break;
+        case 's': *p_type = LOG_ARG_STR; break;
+        case 'p': *p_type = LOG_ARG_PTR; break;
+        default: *p_stars = 0; break;
+    }
+
+    return (*p) ? (p + 1) : p;
+}
+
+static uint32_t log_arg_words(log_arg_t type) {
+    if (type == LOG_ARG_PTR)
+        return (sizeof(void*) + 3) / 4;
+    if ((type == LOG_ARG_LONG_LONG) || (type == LOG_ARG_DOUBLE))
+        return 2;
+    return ((type == LOG_ARG_INT) || (type == LOG_ARG_STR)) ? 1 : 0;
+}
+
+/* copies the string after the used bytes of the record, it's truncated if
+ * the record is full, returns the offset of the copy */
+static uint32_t log_str_save(log_record_t* p_rec, uint32_t* p_used,
+                             const char* str) {
+    uint32_t offset = *p_used, len = 0;
+
+    if (offset >= CONFIG_LOG_DEFERRED_STR_SIZE)
+        return CONFIG_LOG_DEFERRED_STR_SIZE - 1; /* the last terminator */
+    if (str == NULL)
+        str = "(null)";
+
+    while ((offset + len < CONFIG_LOG_DEFERRED_STR_SIZE - 1) && str[len]) {
+        p_rec->str[offset + len] = str[len];
+        len++;
+    }
+    p_rec->str[offset + len] = 0;
+    *p_used = offset + len + 1;
+    return offset;
+}
+
+void log_deferred(const log_site_t* site, ...) {
+    const char *fmt = site->fmt, *spec;
+    log_record_t* p_rec;
+    log_arg_t type;
+    uint32_t head, words = 0, str_used = 0;
+    uint8_t stars;
+    va_list ap;
+
+    head = log_ring_head;
+    do {
+        if ((head - log_ring_tail) >= CONFIG_LOG_DEFERRED_ENTRY_SIZE) {
+            __atomic_fetch_add(&log_ring_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&log_ring_head, &head, head + 1,
+                                          false, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+
+    p_rec = &log_ring[head % CONFIG_LOG_DEFERRED_ENTRY_SIZE];
+    p_rec->tick = (xPortIsInsideInterrupt()) ? (xTaskGetTickCountFromISR())
+                                             : (xTaskGetTickCount());
+
+    va_start(ap, site);
+    while (*fmt) {
+        fmt = log_fmt_next(fmt, &spec, &type, &stars);
+        if ((stars > LOG_DEFERRED_STARS_MAX)
+            || (words + stars + log_arg_words(type)
+                > CONFIG_LOG_DEFERRED_ARGS))
+            break;
+        while (stars--)
+            p_rec->args[words++] = (uint32_t)va_arg(ap, int);
+
+        if (type == LOG_ARG_INT) {
+            p_rec->args[words++] = va_arg(ap, uint32_t);
+        } else if (type == LOG_ARG_STR) {
+            p_rec->args[words++] =
+                log_str_save(p_rec, &str_used, va_arg(ap, const char*));
+        } else if (type == LOG_ARG_PTR) {
+            void* ptr = va_arg(ap, void*);
+            memcpy(&p_rec->args[words], &ptr, sizeof(ptr));
+            words += log_arg_words(type);
+        } else if (type == LOG_ARG_LONG_LONG) {
+            unsigned long long val = va_arg(ap, unsigned long long);
+            memcpy(&p_rec->args[words], &val, sizeof(val));
+            words += 2;
+        } else if (type == LOG_ARG_DOUBLE) {
+            double val = va_arg(ap, double);
+            memcpy(&p_rec->args[words], &val, sizeof(val));
+            words += 2;
+        }
+    }
+    va_end(ap);
+
+    __atomic_store_n(&p_rec->site, site, __ATOMIC_RELEASE);
+}
+
+static void log_deferred_emit(const log_record_t* p_rec) {
+    const char *fmt = p_rec->site->fmt, *spec;
+    char conv[24];
+    int star[LOG_DEFERRED_STARS_MAX];
+    log_arg_t type;
+    uint32_t words = 0, len;
+    uint8_t stars, i;
+
+    log_printk("[%10u][%s: %s:%4d] ", p_rec->tick, p_rec->site->name,
+               p_rec->site->file, p_rec->site->line);
+
+    while (*fmt) {
+        const char* next = log_fmt_next(fmt, &spec, &type, &stars);
+
+        if (spec != fmt)
+            log_printk("%.*s", (int)(spec - fmt), fmt);
+
+        len = next - spec;
+        if ((len == 0) || (len >= sizeof(conv))
+            || (stars > LOG_DEFERRED_STARS_MAX)
+            || (words + stars + log_arg_words(type)
+                > CONFIG_LOG_DEFERRED_ARGS)) {
+            /* not saved, output the rest as it is */
+            log_printk("%s", spec);
+            break;
+        }
+        memcpy(conv, spec, len);
+        conv[len] = 0;
+        for (i = 0; i < stars; i++)
+            star[i] = (int)p_rec->args[words++];
+
+        if (type == LOG_ARG_NONE) {
+            if (conv[len - 1] == '%')
+                log_printk("%%");
+        } else if (type == LOG_ARG_INT) {
+            uint32_t val = p_rec->args[words++];
+            if (stars == 2)
+                log_printk(conv, star[0], star[1], val);
+            else if (stars == 1)
+                log_printk(conv, star[0], val);
+            else
+                log_printk(conv, val);
+        } else if (type == LOG_ARG_STR) {
+            uint32_t offset = p_rec->args[words++];
+            const char* val;
+
+            if (offset >= CONFIG_LOG_DEFERRED_STR_SIZE)
+                offset = CONFIG_LOG_DEFERRED_STR_SIZE - 1;
+            val = &p_rec->str[offset];
+            if (stars == 2)
+                log_printk(conv, star[0], star[1], val);
+            else if (stars == 1)
+                log_printk(conv, star[0], val);
+            else
+                log_printk(conv, val);
+        } else if (type == LOG_ARG_PTR) {
+            void* val;
+            memcpy(&val, &p_rec->args[words], sizeof(val));
+            words += log_arg_words(type);
+            if (stars == 2)
+                log_printk(conv, star[0], star[1], val);
+            else if (stars == 1)
+                log_printk(conv, star[0], val);
+            else
+                log_printk(conv, val);
+        } else if (type == LOG_ARG_LONG_LONG) {
+            unsigned long long val;
+            memcpy(&val, &p_rec->args[words], sizeof(val));
+            words += 2;
+            if (stars == 2)
+                log_printk(conv, star[0], star[1], val);
+            else if (stars == 1)
+                log_printk(conv, star[0], val);
+            else
+                log_printk(conv, val);
+        } else {
+            double val;
+            memcpy(&val, &p_rec->args[words], sizeof(val));
+            words += 2;
+            if (stars == 2)
+                log_printk(conv, star[0], star[1], val);
+            else if (stars == 1)
+                log_printk(conv, star[0], val);
+            else
+                log_printk(conv, val);
+        }
+        fmt = next;
+    }
+    log_printk("\r\n");
+}
+
+/* outputs the pending logs, it is called by the log task only, or when the
+ * scheduler is stopped, e.g. the assert handler */
+void log_deferred_flush(void) {
+    static uint32_t dropped = 0;
+    log_record_t* p_rec;
+    log_record_t rec;
+
+    for (;;) {
+        p_rec = &log_ring[log_ring_tail % CONFIG_LOG_DEFERRED_ENTRY_SIZE];
+        rec.site = __atomic_load_n(&p_rec->site, __ATOMIC_ACQUIRE);
+        if (rec.site == NULL)
+            break;
+
+        rec.tick = p_rec->tick;
+        memcpy(rec.args, p_rec->args, sizeof(rec.args));
+        memcpy(rec.str, p_rec->str, sizeof(rec.str));
+        p_rec->site = NULL;
+        __atomic_store_n(&log_ring_tail, log_ring_tail + 1, __ATOMIC_RELEASE);
+
+        log_deferred_emit(&rec);
+    }
+
+    if (dropped != log_ring_dropped) {
+        log_printk("log dropped %u\r\n", log_ring_dropped - dropped);
+        dropped = log_ring_dropped;
+    }
+}
+
+uint32_t log_deferred_dropped(void) { return log_ring_dropped; }
+
+static void log_deferred_task(void* arg) {
+    for (;;) {
+        log_deferred_flush();
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_LOG_DEFERRED_PERIOD_MS));
+    }
+}
+
+int log_deferred_init(void) {
+    static TaskHandle_t log_task = NULL;
+
+    if (log_task)
+        return 0;
+    if (xTaskCreate(log_deferred_task, "log",
+                    CONFIG_LOG_DEFERRED_TASK_STACK_SIZE / sizeof(StackType_t),
+                    NULL, CONFIG_LOG_DEFERRED_TASK_PRIORITY, &log_task)
+        != pdPASS)
+        return -1;
+    return 0;
+}
+
+#else
+
+void log_deferred(const log_site_t* site, ...) { (void)site; }
+
+void log_deferred_flush(void) {}
+
+uint32_t log_deferred_dropped(void) { return 0; }
+
+int log_deferred_init(void) { return 0; }
+
+#endif // CONFIG_LOG_DEFERRED
\ No newline at end of file
@@ -12,20 +12,38 @@ extern "C" {
 #endif
 
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/*
+ * The file name without the path, GCC 12 and clang have the builtin. The
+ * fallback is folded at compile time, but the full __FILE__ string is still
+ * kept in flash.
+ */
 #ifndef __FILE_NAME__
 #define __FILE_NAME__                                                          \
-    (strrchr(__FILE__, '/')                                                    \
-         ? (strrchr(__FILE__, '/') + 1)                                        \
-         : (strrchr(__FILE__, '\\') ? strrchr(__FILE__, '\\') + 1 : __FILE__))
+    (__builtin_strrchr(__FILE__, '/')                                          \
+         ? (__builtin_strrchr(__FILE__, '/') + 1)                              \
+         : (__builtin_strrchr(__FILE__, '\\')                                  \
+                ? __builtin_strrchr(__FILE__, '\\') + 1                        \
+                : __FILE__))
 #endif // __FILE_NAME__
 
 #ifndef CONFIG_LOG_MAX_LEVEL
 #define CONFIG_LOG_MAX_LEVEL LOG_LEVEL_INFO
 #endif // CONFIG_LOG_MAX_LEVEL
 
+/*
+ * CONFIG_LOG_DEFERRED: log_debug/info/warn/error only save the call site, the
+ * tick and the arguments in a RAM ring, a low priority task formats and
+ * outputs them later. The %s strings are copied, up to
+ * CONFIG_LOG_DEFERRED_STR_SIZE bytes of a log including the terminators.
+ */
+#ifndef CONFIG_LOG_DEFERRED
+#define CONFIG_LOG_DEFERRED (0)
+#endif // CONFIG_LOG_DEFERRED
+
 #ifndef CONFIG_LOG_USE_COLOR
 #define CONFIG_LOG_USE_COLOR (1)
 #endif // CONFIG_LOG_USE_COLOR
@@ -72,6 +90,24 @@ typedef struct {
 
 extern log_setting_t log_set;
 
+/* the constant part of a deferred log, one per log call */
+typedef struct {
+    const char* fmt;
+    const char* name;
+    const char* file; /* the file name without the path */
+    int line;
+} log_site_t;
+
+#if CONFIG_LOG_DEFERRED
+#define custom_cflog(lowlevel, N, M, ...)                                      \
+    do {                                                                       \
+        if (lowlevel >= log_set.level) {                                       \
+            static const log_site_t _log_site = {M, N, __FILE_NAME__,          \
+                                                 __LINE__};                    \
+            log_deferred(&_log_site, ##__VA_ARGS__);                           \
+        }                                                                      \
+    } while (0 == 1)
+#else
 #define custom_cflog(lowlevel, N, M, ...)                                      \
     do {                                                                       \
         if (lowlevel >= log_set.level) {                                       \
@@ -82,6 +118,7 @@ extern log_setting_t log_set;
                        N, __FILE_NAME__, __LINE__, ##__VA_ARGS__);             \
         }                                                                      \
     } while (0 == 1)
+#endif // CONFIG_LOG_DEFERRED
 
 #define custom_hexdumplog(name, lowlevel, logo, buf, size)                     \
     do {                                                                       \
@@ -121,6 +158,11 @@ void log_hexdump_out(const char* name, uint8_t width, const uint8_t* buf,
                      uint16_t size);
 
 void log_printk(const char* format, ...);
+
+void log_deferred(const log_site_t* site, ...);
+void log_deferred_flush(void);
+uint32_t log_deferred_dropped(void);
+int log_deferred_init(void);
 #ifdef __cplusplus
 }
 #endif
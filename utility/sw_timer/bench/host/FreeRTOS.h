@@ -0,0 +1,34 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file FreeRTOS.h
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The FreeRTOS types and heap used by sw_timer.c in a host build.
+ *              Only for the host build of the sw_timer benchmark, it runs in
+ *              one thread.
+ */
+#ifndef __SW_TIMER_BENCH_HOST_FREERTOS_H__
+#define __SW_TIMER_BENCH_HOST_FREERTOS_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE       ((BaseType_t)0)
+#define pdTRUE        ((BaseType_t)1)
+#define pdPASS        pdTRUE
+#define errQUEUE_FULL ((BaseType_t)0)
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+#define pvPortMalloc(size) malloc(size)
+#define vPortFree(p)       free(p)
+
+#endif /* __SW_TIMER_BENCH_HOST_FREERTOS_H__ */
@@ -0,0 +1,28 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file log.h
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The log used by sw_timer.c in a host build, the benchmark
+ *              counts the errors and drops the other logs.
+ */
+#ifndef __SW_TIMER_BENCH_HOST_LOG_H__
+#define __SW_TIMER_BENCH_HOST_LOG_H__
+
+#include <stdio.h>
+
+extern unsigned int g_bench_log_error_num;
+
+#define log_error(...)                                                         \
+    do {                                                                       \
+        g_bench_log_error_num++;                                               \
+        fprintf(stderr, __VA_ARGS__);                                          \
+        fprintf(stderr, "\n");                                                 \
+    } while (0)
+#define log_info(...)  ((void)0)
+#define log_debug(...) ((void)0)
+
+#endif /* __SW_TIMER_BENCH_HOST_LOG_H__ */
@@ -0,0 +1,29 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file mcu.h
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The MCU definitions used by sw_timer.c in a host build.
+ */
+#ifndef __SW_TIMER_BENCH_HOST_MCU_H__
+#define __SW_TIMER_BENCH_HOST_MCU_H__
+
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE static inline
+#endif
+
+#define ENABLE 1
+
+typedef int IRQn_Type;
+#define Timer0_IRQn 0
+
+#define NVIC_SetPriority(irq, priority) ((void)(irq), (void)(priority))
+#define NVIC_EnableIRQ(irq)             ((void)(irq))
+
+#define enter_critical_section() ((void)0)
+#define leave_critical_section() ((void)0)
+
+#endif /* __SW_TIMER_BENCH_HOST_MCU_H__ */
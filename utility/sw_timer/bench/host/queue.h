@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file queue.h
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The FreeRTOS queue used by sw_timer.c in a host build, a ring
+ *              of fixed size items. Nothing waits, a send to a full queue and
+ *              a receive from an empty queue fail at once. Only for the host
+ *              build of the sw_timer benchmark, it is one translation unit.
+ */
+#ifndef __SW_TIMER_BENCH_HOST_QUEUE_H__
+#define __SW_TIMER_BENCH_HOST_QUEUE_H__
+
+#include <string.h>
+#include "FreeRTOS.h"
+
+typedef struct
+{
+    uint8_t *p_items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+} host_queue_t;
+
+typedef host_queue_t *QueueHandle_t;
+
+static QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = calloc(1, sizeof(host_queue_t));
+
+    if (queue)
+    {
+        queue->p_items = calloc(length, item_size);
+        queue->length = length;
+        queue->item_size = item_size;
+    }
+    return queue;
+}
+
+static BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *p_item, TickType_t wait)
+{
+    (void)wait;
+    if (queue->count == queue->length)
+    {
+        return errQUEUE_FULL;
+    }
+    memcpy(queue->p_items + ((queue->head + queue->count) % queue->length) * queue->item_size,
+           p_item, queue->item_size);
+    queue->count++;
+    return pdTRUE;
+}
+
+static BaseType_t xQueueSendToBackFromISR(QueueHandle_t queue, const void *p_item, BaseType_t *p_woken)
+{
+    *p_woken = pdFALSE;
+    return xQueueSendToBack(queue, p_item, 0);
+}
+
+static BaseType_t xQueueReceive(QueueHandle_t queue, void *p_item, TickType_t wait)
+{
+    (void)wait;
+    if (queue->count == 0)
+    {
+        return pdFALSE;
+    }
+    memcpy(p_item, queue->p_items + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
+
+static UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+static UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+    return queue->length - queue->count;
+}
+
+#define xQueueSend(queue, p_item, wait) xQueueSendToBack(queue, p_item, wait)
+
+#endif /* __SW_TIMER_BENCH_HOST_QUEUE_H__ */
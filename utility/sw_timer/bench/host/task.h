@@ -0,0 +1,35 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file task.h
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The FreeRTOS tasks used by sw_timer.c in a host build. No task
+ *              is created, the benchmark calls the task bodies itself.
+ */
+#ifndef __SW_TIMER_BENCH_HOST_TASK_H__
+#define __SW_TIMER_BENCH_HOST_TASK_H__
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define E_TASK_PRIORITY_SW_TIMER 10
+
+static BaseType_t xTaskCreate(TaskFunction_t func, const char *name, uint32_t stack, void *param,
+                              UBaseType_t priority, TaskHandle_t *p_handle)
+{
+    (void)func;
+    (void)name;
+    (void)stack;
+    (void)param;
+    (void)priority;
+    *p_handle = (TaskHandle_t)1;
+    return pdPASS;
+}
+#define xTaskGetTickCount() ((TickType_t)0)
+
+#endif /* __SW_TIMER_BENCH_HOST_TASK_H__ */
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file timer.h
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The HW timer driver used by sw_timer.c in a host build, the
+ *              registers are plain memory and the benchmark is the interrupt.
+ *              The benchmark counts the value down in the tickless mode. A
+ *              write of load restarts the count from it, the benchmark takes
+ *              the load and marks it with TIMER_LOAD_TAKEN.
+ */
+#ifndef __SW_TIMER_BENCH_HOST_TIMER_H__
+#define __SW_TIMER_BENCH_HOST_TIMER_H__
+
+#include <stdint.h>
+#include "mcu.h"
+
+typedef struct
+{
+    uint32_t load;
+    uint32_t value;
+    union
+    {
+        struct
+        {
+            uint32_t en         : 1;
+            uint32_t int_status : 1;
+        } bit;
+        uint32_t reg;
+    } control;
+    uint32_t clear;
+} timern_t;
+
+typedef struct
+{
+    uint32_t int_en;
+    uint32_t mode;
+    uint32_t prescale;
+} timer_config_mode_t;
+
+typedef void (*timer_isr_handler_t)(uint32_t timer_id);
+
+#define TIMER_PERIODIC_MODE 1
+#define TIMER_PRESCALE_1    0
+#define TIMER_LOAD_TAKEN    0xFFFFFFFF
+
+extern timern_t g_bench_hw_timer[3];
+#define TIMER0 (&g_bench_hw_timer[0])
+#define TIMER1 (&g_bench_hw_timer[1])
+#define TIMER2 (&g_bench_hw_timer[2])
+
+static uint32_t timer_open(uint32_t timer_id, timer_config_mode_t cfg, timer_isr_handler_t isr)
+{
+    (void)timer_id;
+    (void)cfg;
+    (void)isr;
+    return 0;
+}
+
+static uint32_t timer_start(uint32_t timer_id, uint32_t timeout_ticks)
+{
+    g_bench_hw_timer[timer_id].load = timeout_ticks - 1;
+    g_bench_hw_timer[timer_id].control.bit.en = 1;
+    return 0;
+}
+
+#endif /* __SW_TIMER_BENCH_HOST_TIMER_H__ */
@@ -0,0 +1,443 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file sw_timer_bench.c
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The host check and benchmark of the sw_timer backends. It
+ *              builds sw_timer.c in, runs auto reload timers of random periods
+ *              and priorities, and stops, starts and resets random timers by
+ *              the command queue. The timer task body (the command queue and
+ *              the timer list check) and the running tasks are called after
+ *              each step of current_time, a step of more than 1 ms is a
+ *              skipped check, e.g. a sleep. Each timer must run on the first
+ *              check after its timeout, neither earlier nor later.
+ *
+ *              With CONFIG_SW_TIMER_TICKLESS the HW timer is a mocked down
+ *              counter, its interrupt runs sw_timer_isr() at the end of each
+ *              programmed period. The timer task runs only when its command
+ *              queue is not empty, woken by the interrupt or a timer command,
+ *              the same as it blocks on the queue on the target. With -z the
+ *              idle steps sleep up to the given ms through
+ *              sw_timer_tickless_sleep_enter() and sw_timer_tickless_sleep_exit(),
+ *              the HW timer stops in the sleep. The HW interrupts and the
+ *              sleep wakeups per second are reported against the 1000 per
+ *              second of the periodic tick.
+ *
+ *   cc -O2 -DCONFIG_RT582 [-DCONFIG_SW_TIMER_USING_WHEEL [-DCONFIG_SW_TIMER_TICKLESS]]
+ *      -Iutility/sw_timer/bench/host -Iutility/sw_timer/include
+ *      -Iutility/sw_timer/src -Iutility/utility/Inc
+ *      utility/utility/util_bitmap.c utility/sw_timer/bench/sw_timer_bench.c
+ *      -o sw_timer_bench
+ *   sw_timer_bench [-n timers] [-p min period] [-P max period] [-t ms]
+ *                  [-j step ms] [-o one op per N ms] [-s start ms]
+ *                  [-z max sleep ms, tickless only]
+ *
+ * The list backend shifts current_time after SW_TIMER_SHIFT_THRESHOLD, so the
+ * start and the ms of the run must stay below it. The exit status is not 0 if
+ * a timer runs early, late or not at all, or sw_timer logs an error.
+ */
+
+//=============================================================================
+//                Include
+//=============================================================================
+#include "sw_timer.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//=============================================================================
+//                Private Struct
+//=============================================================================
+typedef struct
+{
+    sw_timer_t *p_timer;
+    uint32_t expect; // the timeout, the timer runs on the first check after it
+    uint32_t run_num;
+    uint8_t active;
+} bench_timer_t;
+
+typedef struct
+{
+    uint32_t timer_num;
+    uint32_t period_min;
+    uint32_t period_max;
+    uint32_t run_ms;
+    uint32_t step_ms;
+    uint32_t op_every;
+    uint32_t start_ms;
+    uint32_t sleep_max;
+} bench_cfg_t;
+
+//=============================================================================
+//                Global Variables
+//=============================================================================
+unsigned int g_bench_log_error_num;
+timern_t g_bench_hw_timer[3];
+
+static bench_cfg_t g_cfg = {256, 10, 60000, 10000000, 1, 100, 0, 0};
+static bench_timer_t *g_bench_timer;
+static uint32_t g_prev_ms, g_now_ms;
+static uint32_t g_err_num, g_run_num, g_op_num;
+#ifdef CONFIG_SW_TIMER_TICKLESS
+static uint32_t g_hw_load; // the taken load, the periodic reload value
+static uint32_t g_hw_irq_num, g_sleep_num, g_task_num, g_time_err_num;
+#endif
+
+//=============================================================================
+//                Private Function Definition
+//=============================================================================
+static double bench_elapsed_sec(struct timespec *p_start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - p_start->tv_sec) + (now.tv_nsec - p_start->tv_nsec) / 1e9;
+}
+
+static void bench_timer_cb(void *p_param)
+{
+    bench_timer_t *p_bench = p_param;
+
+    uint32_t expect = p_bench->expect;
+
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+    // the alarm of VT_MAX_TIMER is delayed one tick, it means no alarm
+    if (expect == VT_MAX_TIMER)
+    {
+        expect = 0;
+    }
+#endif
+    // it is due in this check and it was not due in the last one
+    if (((int32_t)(g_now_ms - expect) <= 0) || ((int32_t)(g_prev_ms - expect) > 0))
+    {
+        if (g_err_num++ < 10)
+        {
+            printf("timer %u: timeout %u, run at %u, last check %u\n", (unsigned)(p_bench - g_bench_timer),
+                   p_bench->expect, g_now_ms, g_prev_ms);
+        }
+    }
+    p_bench->run_num++;
+    g_run_num++;
+    // auto reload from the current time
+    p_bench->expect = g_now_ms + p_bench->p_timer->period;
+}
+
+// the body of timer_running_handler(), the higher priority first
+static void bench_running_tasks(void)
+{
+    sw_timer_t *timer;
+    int32_t priority;
+
+    for (priority = SW_TIMER_PRIORITY_MAX - 1; priority >= 0; priority--)
+    {
+        while (xQueueReceive(g_timer_running_queue[priority], (void *)&timer, 0) == pdTRUE)
+        {
+            timer->cb_function(timer->cb_param);
+            if (timer->wating_for_execution)
+            {
+                timer->wating_for_execution--;
+            }
+        }
+    }
+}
+
+#ifdef CONFIG_SW_TIMER_TICKLESS
+// a write of load restarts the count, take it before the value is counted or read
+static void bench_hw_load_take(void)
+{
+    timern_t *TIMER = g_timer_ctrl.hw_timer;
+
+    if (TIMER->load != TIMER_LOAD_TAKEN)
+    {
+        g_hw_load = TIMER->load;
+        TIMER->value = g_hw_load;
+        TIMER->load = TIMER_LOAD_TAKEN;
+    }
+}
+
+// count the HW timer down for ms, the interrupt runs at once at the end of each period
+static void bench_hw_run(uint32_t ms)
+{
+    timern_t *TIMER = g_timer_ctrl.hw_timer;
+    uint64_t ticks = (uint64_t)ms * SW_TIMER_HW_TICKS_PER_MS;
+
+    while ((ticks > 0) && TIMER->control.bit.en)
+    {
+        if (TIMER->value >= ticks)
+        {
+            TIMER->value -= (uint32_t)ticks;
+            break;
+        }
+        ticks -= (uint64_t)TIMER->value + 1;
+        TIMER->value = g_hw_load;
+        g_hw_irq_num++;
+        sw_timer_isr(0);
+        bench_hw_load_take();
+    }
+}
+
+// the idle steps sleep until the next alarm, up to sleep_max ms, return the ms in the step
+static uint32_t bench_hw_step(uint32_t step_ms)
+{
+    uint32_t idle_ms;
+
+    if (g_cfg.sleep_max && (uxQueueMessagesWaiting(g_timer_cmd_queue) == 0))
+    {
+        idle_ms = sw_timer_tickless_sleep_enter();
+        if (idle_ms > 0)
+        {
+            step_ms = 1 + (uint32_t)rand() % g_cfg.sleep_max;
+            if (step_ms > idle_ms)
+            {
+                step_ms = idle_ms;
+            }
+            g_sleep_num++;
+            sw_timer_tickless_sleep_exit(step_ms);
+            bench_hw_load_take();
+            return step_ms;
+        }
+        sw_timer_tickless_sleep_exit(0);
+        bench_hw_load_take();
+    }
+    bench_hw_run(step_ms);
+    return step_ms;
+}
+#endif
+
+// the body of timer_handler()
+static void bench_timer_task(void)
+{
+#ifdef CONFIG_SW_TIMER_TICKLESS
+    // the task blocks on the command queue
+    if (uxQueueMessagesWaiting(g_timer_cmd_queue) == 0)
+    {
+        return;
+    }
+    g_task_num++;
+    timer_cmd_queue_check();
+    timer_list_check();
+    timer_hw_alarm_update();
+    bench_hw_load_take();
+#else
+    if (uxQueueMessagesWaiting(g_timer_cmd_queue))
+    {
+        timer_cmd_queue_check();
+    }
+    timer_list_check();
+#endif
+}
+
+static void bench_random_op(void)
+{
+    bench_timer_t *p_bench = &g_bench_timer[(uint32_t)rand() % g_cfg.timer_num];
+
+    // the command is handled in this check, at g_now_ms
+    if (!p_bench->active)
+    {
+        sw_timer_start(p_bench->p_timer);
+        p_bench->expect = g_now_ms + p_bench->p_timer->period;
+        p_bench->active = 1;
+    }
+    else if (rand() & 1)
+    {
+        sw_timer_reset(p_bench->p_timer);
+        p_bench->expect = g_now_ms + p_bench->p_timer->period;
+    }
+    else
+    {
+        sw_timer_stop(p_bench->p_timer);
+        p_bench->active = 0;
+    }
+    g_op_num++;
+}
+
+static int bench_timers_create(void)
+{
+    uint32_t i, period;
+
+    g_bench_timer = calloc(g_cfg.timer_num, sizeof(bench_timer_t));
+    if (g_bench_timer == NULL)
+    {
+        return 1;
+    }
+
+    for (i = 0; i < g_cfg.timer_num; i++)
+    {
+        period = g_cfg.period_min + (uint32_t)rand() % (g_cfg.period_max - g_cfg.period_min + 1);
+        g_bench_timer[i].p_timer = sw_timer_create("bench", period, 1, (sw_timer_pri_t)(rand() % SW_TIMER_PRIORITY_MAX),
+                                   SW_TIMER_EXECUTE_ONCE_FOR_EACH_TIMEOUT, &g_bench_timer[i], bench_timer_cb);
+        if (g_bench_timer[i].p_timer == NULL)
+        {
+            return 1;
+        }
+        if (sw_timer_start(g_bench_timer[i].p_timer) != SW_TIMER_PASS)
+        {
+            return 1;
+        }
+        g_bench_timer[i].expect = g_now_ms + period;
+        g_bench_timer[i].active = 1;
+
+        // the command queue is short, let the timer task take them
+        if (uxQueueSpacesAvailable(g_timer_cmd_queue) == 0)
+        {
+            bench_timer_task();
+        }
+    }
+    bench_timer_task();
+    return 0;
+}
+
+static void bench_usage(const char *p_name)
+{
+    printf("usage: %s [-n timers] [-p min period] [-P max period] [-t ms] [-j step ms] [-o one op per N ms] [-s start ms]"
+           " [-z max sleep ms]\n",
+           p_name);
+}
+
+static int bench_args(int argc, char **argv)
+{
+    uint32_t *p_value;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((i + 1 >= argc) || (argv[i][0] != '-') || (strlen(argv[i]) != 2))
+        {
+            return 1;
+        }
+        switch (argv[i][1])
+        {
+        case 'n': p_value = &g_cfg.timer_num; break;
+        case 'p': p_value = &g_cfg.period_min; break;
+        case 'P': p_value = &g_cfg.period_max; break;
+        case 't': p_value = &g_cfg.run_ms; break;
+        case 'j': p_value = &g_cfg.step_ms; break;
+        case 'o': p_value = &g_cfg.op_every; break;
+        case 's': p_value = &g_cfg.start_ms; break;
+        case 'z': p_value = &g_cfg.sleep_max; break;
+        default: return 1;
+        }
+        *p_value = (uint32_t)strtoul(argv[++i], NULL, 0);
+    }
+
+    if ((g_cfg.timer_num == 0) || (g_cfg.period_min == 0) || (g_cfg.period_min > g_cfg.period_max) ||
+            (g_cfg.period_max > SW_TIMER_MAX_PERIOD) || (g_cfg.step_ms == 0))
+    {
+        return 1;
+    }
+#ifndef CONFIG_SW_TIMER_TICKLESS
+    if (g_cfg.sleep_max)
+    {
+        return 1;
+    }
+#endif
+#ifndef CONFIG_SW_TIMER_USING_WHEEL
+    if ((uint64_t)g_cfg.start_ms + g_cfg.run_ms + g_cfg.period_max >= SW_TIMER_SHIFT_THRESHOLD)
+    {
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct timespec start;
+    uint32_t i, elapsed, step_ms, late_num = 0;
+    double sec;
+
+    if (bench_args(argc, argv))
+    {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    if (sw_timer_init(0) != 0)
+    {
+        printf("sw_timer_init fail\n");
+        return 1;
+    }
+    g_timer_ctrl.current_time = g_cfg.start_ms;
+    g_prev_ms = g_now_ms = g_cfg.start_ms;
+#ifdef CONFIG_SW_TIMER_TICKLESS
+    // the timer task starts the HW timer first
+    sw_timer_hw_init(0);
+    bench_hw_load_take();
+#endif
+    if (bench_timers_create())
+    {
+        printf("timer create fail\n");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (elapsed = 0; elapsed < g_cfg.run_ms; elapsed += step_ms)
+    {
+        g_prev_ms = g_now_ms;
+#ifdef CONFIG_SW_TIMER_TICKLESS
+        step_ms = bench_hw_step(g_cfg.step_ms);
+        g_now_ms += step_ms;
+        // the time is rebuilt from the HW timer
+        if (timer_current_time() != g_now_ms)
+        {
+            if (g_time_err_num++ < 10)
+            {
+                printf("time %u, sw_timer time %u\n", g_now_ms, timer_current_time());
+            }
+        }
+#else
+        step_ms = g_cfg.step_ms;
+        g_timer_ctrl.current_time += step_ms;
+        g_now_ms = g_timer_ctrl.current_time;
+#endif
+
+        if (g_cfg.op_every && (((uint32_t)rand() % g_cfg.op_every) < step_ms))
+        {
+            bench_random_op();
+        }
+        bench_timer_task();
+        bench_running_tasks();
+    }
+    sec = bench_elapsed_sec(&start);
+
+    // a timer not run yet must not be due
+    for (i = 0; i < g_cfg.timer_num; i++)
+    {
+        if (g_bench_timer[i].active && ((int32_t)(g_now_ms - g_bench_timer[i].expect) > 0))
+        {
+            late_num++;
+        }
+    }
+
+#if defined(CONFIG_SW_TIMER_TICKLESS)
+    printf("tickless wheel backend: ");
+#elif defined(CONFIG_SW_TIMER_USING_WHEEL)
+    printf("wheel backend: ");
+#else
+    printf("list backend: ");
+#endif
+    printf("%u timers of %u ~ %u ms, %u ms from %u in steps of %u ms, %u ops\n", g_cfg.timer_num,
+           g_cfg.period_min, g_cfg.period_max, g_cfg.run_ms, g_cfg.start_ms, g_cfg.step_ms, g_op_num);
+    printf("%u runs, %u early or late, %u not run, %u errors logged\n", g_run_num, g_err_num, late_num,
+           g_bench_log_error_num);
+#ifdef CONFIG_SW_TIMER_TICKLESS
+    printf("%u time errors, %u sleeps of up to %u ms\n", g_time_err_num, g_sleep_num, g_cfg.sleep_max);
+    printf("wakeups %.1f/s (HW timer %.1f/s, sleep %.1f/s), timer task %.1f/s, periodic tick 1000.0/s\n",
+           (g_hw_irq_num + g_sleep_num) * 1000.0 / g_cfg.run_ms, g_hw_irq_num * 1000.0 / g_cfg.run_ms,
+           g_sleep_num * 1000.0 / g_cfg.run_ms, g_task_num * 1000.0 / g_cfg.run_ms);
+    printf("host time %.1f ns/ms, %.1f ns/run\n", sec * 1e9 / g_cfg.run_ms, g_run_num ? sec * 1e9 / g_run_num : 0.0);
+
+    return (g_err_num || late_num || g_bench_log_error_num || g_time_err_num) ? 1 : 0;
+#else
+    printf("wakeups 1000.0/s, the periodic tick\n");
+    printf("host time %.1f ns/check, %.1f ns/run\n", sec * 1e9 / (g_cfg.run_ms / g_cfg.step_ms),
+           g_run_num ? sec * 1e9 / g_run_num : 0.0);
+
+    return (g_err_num || late_num || g_bench_log_error_num) ? 1 : 0;
+#endif
+}
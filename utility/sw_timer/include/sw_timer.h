@@ -70,7 +70,8 @@ typedef struct SW_TIMER {
     uint32_t execute_mode         : 1; // follow enum sw_timer_execute_mode_e
     uint32_t receive_delete_cmd   : 1;
     uint32_t wating_for_execution : 8;
-    uint32_t reserved             : 19;
+    uint32_t wheel_slot           : 8; // timing wheel level (bit 7:6) and slot (bit 5:0)
+    uint32_t reserved             : 11;
 
     void* cb_param;
     sw_timer_cb cb_function;
@@ -110,6 +111,23 @@ uint32_t sw_timer_hw_init(uint32_t u32_timer_id);
 #ifdef CONFIG_SW_TIMER_ENABLE_DEBUG
 void sw_timer_state_print(void);
 #endif
+#ifdef CONFIG_SW_TIMER_TICKLESS
+/**
+ * Stops the HW timer before sleep, it must be called with interrupts disabled.
+ *
+ * @returns ms to the next sw_timer alarm, 0: do not sleep, VT_MAX_TIMER: no alarm
+ *          or the HW timer is not initialized by the sw_timer task yet.
+ */
+uint32_t sw_timer_tickless_sleep_enter(void);
+
+/**
+ * Adds the sleep time to the sw_timer time and restarts the HW timer after sleep,
+ * it must be called with interrupts disabled.
+ *
+ * @param sleep_ms ms in sleep.
+ */
+void sw_timer_tickless_sleep_exit(uint32_t sleep_ms);
+#endif
 #ifdef __cplusplus
 };
 #endif
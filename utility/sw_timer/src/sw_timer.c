@@ -22,6 +22,9 @@
 #include "mcu.h"
 #include "timer.h"
 #include "util_list.h"
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+#include "util_bitmap.h"
+#endif
 //=============================================================================
 //                Private Definitions of const value
 //=============================================================================
@@ -43,6 +46,42 @@
 
 #define TIMER_ERR_LOG() log_error("SW TIMER ERROR!")
 
+// the HW timer ticks of 1 ms, the timer input is the 32MHz peripheral clock, TIMER_PRESCALE_1
+#ifndef CONFIG_SW_TIMER_HW_TICKS_PER_MS
+#define CONFIG_SW_TIMER_HW_TICKS_PER_MS 32000
+#endif
+#define SW_TIMER_HW_TICKS_PER_MS CONFIG_SW_TIMER_HW_TICKS_PER_MS
+
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+/*
+ * Hierarchical timing wheel, 4 levels of 64 slots cover 2^24 ticks (about 4.6 hours).
+ * The level n slot holds the timers which expire in 64^n ~ 64^(n+1) ticks, and it is
+ * moved to the lower levels (cascade) when the wheel time enters its range.
+ * The longer timers are kept in the farthest slot of the top level and added again on cascade.
+ */
+#define SW_TIMER_WHEEL_BITS         6
+#define SW_TIMER_WHEEL_SIZE         (1UL << SW_TIMER_WHEEL_BITS)
+#define SW_TIMER_WHEEL_MASK         (SW_TIMER_WHEEL_SIZE - 1)
+#define SW_TIMER_WHEEL_LEVELS       4
+#define SW_TIMER_WHEEL_SHIFT(level) ((level) * SW_TIMER_WHEEL_BITS)
+#define SW_TIMER_WHEEL_RANGE                                                   \
+    (1UL << SW_TIMER_WHEEL_SHIFT(SW_TIMER_WHEEL_LEVELS))
+#endif
+
+#ifdef CONFIG_SW_TIMER_TICKLESS
+/*
+ * Tickless mode, the HW timer interrupts at the next alarm instead of every
+ * tick, and current_time is advanced by the programmed period in the ISR.
+ * It needs the free running current_time of the timing wheel.
+ */
+#ifndef CONFIG_SW_TIMER_USING_WHEEL
+#error "CONFIG_SW_TIMER_TICKLESS needs CONFIG_SW_TIMER_USING_WHEEL"
+#endif
+#ifndef CONFIG_SW_TIMER_TICKLESS_MAX_MS
+#define CONFIG_SW_TIMER_TICKLESS_MAX_MS 60000 // the longest HW timer period
+#endif
+#endif
+
 #define SW_TIMER_START(timer) timer_cmd_send(timer, SW_TIMER_CMD_START, 0, 0)
 #define SW_TIMER_STOP(timer)  timer_cmd_send(timer, SW_TIMER_CMD_STOP, 0, 0)
 #define SW_TIMER_RESET(timer) timer_cmd_send(timer, SW_TIMER_CMD_RESET, 0, 0)
@@ -89,9 +128,25 @@ typedef enum SW_TIMER_CMD {
 //                Private Struct
 //=============================================================================
 typedef struct SW_TIMER_CONTROL {
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+    utils_dlist_t wheel[SW_TIMER_WHEEL_LEVELS][SW_TIMER_WHEEL_SIZE];
+    // the non-empty slots of each level
+    uint32_t wheel_bitmap[SW_TIMER_WHEEL_LEVELS]
+                         [UTIL_BITMAP_WORDS(SW_TIMER_WHEEL_SIZE)];
+    uint32_t wheel_time; // the next tick to be processed
+#else
     utils_dlist_t working_list;
+#endif
     uint32_t current_time; // ms
     uint32_t alarm_time;
+#ifdef CONFIG_SW_TIMER_TICKLESS
+    timern_t* hw_timer;
+    uint32_t hw_load;   // the load value of the current HW timer period
+    uint32_t hw_rem;    // the HW timer ticks after current_time when the period starts
+    uint32_t hw_period; // ms added to current_time when the period ends
+    uint32_t hw_alarm;  // the alarm_time of the current HW timer period
+    uint32_t hw_sleep;  // the HW timer is stopped for sleep
+#endif
 } sw_timer_ctrl_t;
 
 /*************************************************************/
@@ -137,12 +192,29 @@ static void debug_timer_cb(void* cb_param) {
     u32_debug_timer = 0;
     log_info("current_time %u, alarm_time %u\n", g_timer_ctrl.current_time,
              g_timer_ctrl.alarm_time);
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+    uint32_t level, slot;
+    log_info("wheel_time %u\n", g_timer_ctrl.wheel_time);
+    for (level = 0; level < SW_TIMER_WHEEL_LEVELS; level++) {
+        for (slot = 0; slot < SW_TIMER_WHEEL_SIZE; slot++) {
+            utils_dlist_for_each_entry(&g_timer_ctrl.wheel[level][slot],
+                                       timer_list, sw_timer_t, list) {
+                log_info("TIMER :%s (TO %u, Pri %u, Period %u, Auto %u, "
+                         "Wheel %u:%u)",
+                         timer_list->name, timer_list->timeout,
+                         timer_list->priority, timer_list->period,
+                         timer_list->auto_reload, level, slot);
+            }
+        }
+    }
+#else
     utils_dlist_for_each_entry(&g_timer_ctrl.working_list, timer_list,
                                sw_timer_t, list) {
         log_info("TIMER :%s (TO %u, Pri %u, Period %u, Auto %u)",
                  timer_list->name, timer_list->timeout, timer_list->priority,
                  timer_list->period, timer_list->auto_reload);
     }
+#endif
 }
 
 static uint32_t debug_timer_init(void) {
@@ -290,8 +362,236 @@ static sw_timer_err_t timer_cmd_send(sw_timer_t* timer, sw_timer_cmd_t cmd_op,
         TIMER_ERR_LOG();
         return SW_TIMER_CMD_SEND_FAIL;
     }
+    return t_result;
+}
+
+#ifdef CONFIG_SW_TIMER_TICKLESS
+// the HW timer ticks of the current period, the caller must lock
+static uint32_t timer_hw_elapsed(void) {
+    return g_timer_ctrl.hw_rem
+           + (g_timer_ctrl.hw_load - g_timer_ctrl.hw_timer->value);
+}
+
+// move the elapsed ms of the current period to current_time, the caller must lock
+static void timer_hw_sync(void) {
+    uint32_t elapsed = timer_hw_elapsed();
+
+    g_timer_ctrl.current_time += elapsed / SW_TIMER_HW_TICKS_PER_MS;
+    g_timer_ctrl.hw_rem = elapsed % SW_TIMER_HW_TICKS_PER_MS;
+    g_timer_ctrl.hw_load = g_timer_ctrl.hw_timer->value;
+}
+
+// program the HW timer to interrupt after alarm_time, the caller must lock
+static void timer_hw_program(void) {
+    timern_t* TIMER = g_timer_ctrl.hw_timer;
+    uint32_t delta;
+
+    // the period is ended, the ISR will program the next one
+    if (TIMER->control.bit.int_status)
+        return;
+
+    timer_hw_sync();
+
+    // the alarm tick is processed after it is passed
+    delta = g_timer_ctrl.alarm_time + 1 - g_timer_ctrl.current_time;
+    if ((g_timer_ctrl.alarm_time == VT_MAX_TIMER) || ((int32_t)delta <= 0)
+        || (delta > CONFIG_SW_TIMER_TICKLESS_MAX_MS))
+        // no alarm, or wait for the timer task, check again later
+        delta = CONFIG_SW_TIMER_TICKLESS_MAX_MS;
+
+    g_timer_ctrl.hw_period = delta;
+    g_timer_ctrl.hw_alarm = g_timer_ctrl.alarm_time;
+    g_timer_ctrl.hw_load = delta * SW_TIMER_HW_TICKS_PER_MS
+                           - g_timer_ctrl.hw_rem - 1;
+
+    TIMER->control.bit.en = 0;
+    TIMER->load = g_timer_ctrl.hw_load;
+    TIMER->control.bit.en = 1;
+}
+
+static void timer_hw_alarm_update(void) {
+    enter_critical_section();
+    if ((g_timer_ctrl.hw_alarm != g_timer_ctrl.alarm_time)
+        && (g_timer_ctrl.hw_sleep == 0))
+        timer_hw_program();
+    leave_critical_section();
+}
+
+static uint32_t timer_current_time(void) {
+    timern_t* TIMER = g_timer_ctrl.hw_timer;
+    uint32_t now, value;
+
+    enter_critical_section();
+    if (g_timer_ctrl.hw_sleep) {
+        now = g_timer_ctrl.current_time;
+    } else {
+        // read the value before the status, so it is in the same period
+        value = TIMER->value;
+        if (TIMER->control.bit.int_status) {
+            // the period is ended but the ISR is not run yet
+            value = TIMER->value;
+            now = g_timer_ctrl.current_time + g_timer_ctrl.hw_period
+                  + (g_timer_ctrl.hw_load - value) / SW_TIMER_HW_TICKS_PER_MS;
+        } else {
+            now = g_timer_ctrl.current_time
+                  + (g_timer_ctrl.hw_rem + g_timer_ctrl.hw_load - value)
+                        / SW_TIMER_HW_TICKS_PER_MS;
+        }
+    }
+    leave_critical_section();
+
+    return now;
+}
+#else
+__STATIC_INLINE uint32_t timer_current_time(void) {
+    return g_timer_ctrl.current_time;
+}
+#endif
+
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+static void wheel_add(sw_timer_t* timer) {
+    uint32_t level, slot, expires = timer->timeout;
+    uint32_t delta = expires - g_timer_ctrl.wheel_time;
+
+    if ((int32_t)delta < 0) {
+        // already expired, run it on the next tick
+        expires = g_timer_ctrl.wheel_time;
+        delta = 0;
+    } else if (delta >= SW_TIMER_WHEEL_RANGE) {
+        // out of the wheel range, it will be added again after cascade
+        delta = SW_TIMER_WHEEL_RANGE - 1;
+        expires = g_timer_ctrl.wheel_time + delta;
+    }
+
+    for (level = 0; level < SW_TIMER_WHEEL_LEVELS - 1; level++) {
+        if (delta < (1UL << SW_TIMER_WHEEL_SHIFT(level + 1)))
+            break;
+    }
+    slot = (expires >> SW_TIMER_WHEEL_SHIFT(level)) & SW_TIMER_WHEEL_MASK;
+
+    utils_dlist_add_tail(&timer->list, &g_timer_ctrl.wheel[level][slot]);
+    util_bitmap_set(g_timer_ctrl.wheel_bitmap[level], slot);
+    timer->wheel_slot = (level << SW_TIMER_WHEEL_BITS) | slot;
+}
+
+static void wheel_del(sw_timer_t* timer) {
+    uint32_t level = timer->wheel_slot >> SW_TIMER_WHEEL_BITS;
+    uint32_t slot = timer->wheel_slot & SW_TIMER_WHEEL_MASK;
+
+    if (utils_dlist_empty(&timer->list))
+        return;
+
+    utils_dlist_del(&timer->list);
+    if (utils_dlist_empty(&g_timer_ctrl.wheel[level][slot]))
+        util_bitmap_clear(g_timer_ctrl.wheel_bitmap[level], slot);
+}
+
+// move all timers of the slot to the list head
+static void wheel_slot_take(uint32_t level, uint32_t slot,
+                            utils_dlist_t* head) {
+    utils_dlist_t* wheel_slot = &g_timer_ctrl.wheel[level][slot];
+
+    INIT_UTILS_DLIST_HEAD(head);
+    if (utils_dlist_empty(wheel_slot))
+        return;
+
+    head->next = wheel_slot->next;
+    head->prev = wheel_slot->prev;
+    head->next->prev = head;
+    head->prev->next = head;
+    INIT_UTILS_DLIST_HEAD(wheel_slot);
+    util_bitmap_clear(g_timer_ctrl.wheel_bitmap[level], slot);
+}
+
+/*
+ * The tick to process the slot, the expire tick of the level 0 or the
+ * cascade tick of the upper levels.
+ */
+static uint32_t wheel_slot_tick(uint32_t level, uint32_t slot) {
+    uint32_t shift = SW_TIMER_WHEEL_SHIFT(level);
+    uint32_t cur = g_timer_ctrl.wheel_time >> shift;
+    uint32_t offset = (slot - cur) & SW_TIMER_WHEEL_MASK;
+
+    // the current slot of the upper level is already cascaded
+    if ((offset == 0) && (g_timer_ctrl.wheel_time & ((1UL << shift) - 1)))
+        offset = SW_TIMER_WHEEL_SIZE;
+
+    return (cur + offset) << shift;
 }
 
+// find the first tick which has work to do, return 0 if the wheel is empty
+static uint32_t wheel_next_event(uint32_t* p_tick) {
+    uint32_t level, shift, from, slot, tick;
+    uint32_t found = 0;
+
+    for (level = 0; level < SW_TIMER_WHEEL_LEVELS; level++) {
+        shift = SW_TIMER_WHEEL_SHIFT(level);
+        from = (g_timer_ctrl.wheel_time >> shift) & SW_TIMER_WHEEL_MASK;
+        if (g_timer_ctrl.wheel_time & ((1UL << shift) - 1))
+            from = (from + 1) & SW_TIMER_WHEEL_MASK;
+
+        slot = util_bitmap_find_next_one(g_timer_ctrl.wheel_bitmap[level],
+                                         SW_TIMER_WHEEL_SIZE, from);
+        if (slot >= SW_TIMER_WHEEL_SIZE)
+            slot = util_bitmap_find_next_one(g_timer_ctrl.wheel_bitmap[level],
+                                             SW_TIMER_WHEEL_SIZE, 0);
+        if (slot >= SW_TIMER_WHEEL_SIZE)
+            continue;
+
+        tick = wheel_slot_tick(level, slot);
+        if (!found || ((int32_t)(tick - *p_tick) < 0)) {
+            *p_tick = tick;
+            found = 1;
+        }
+    }
+    return found;
+}
+
+static void wheel_cascade(void) {
+    uint32_t level, slot;
+    utils_dlist_t head;
+    sw_timer_t* timer;
+
+    for (level = 1; level < SW_TIMER_WHEEL_LEVELS; level++) {
+        if (g_timer_ctrl.wheel_time
+            & ((1UL << SW_TIMER_WHEEL_SHIFT(level)) - 1))
+            break;
+
+        slot = (g_timer_ctrl.wheel_time >> SW_TIMER_WHEEL_SHIFT(level))
+               & SW_TIMER_WHEEL_MASK;
+        wheel_slot_take(level, slot, &head);
+        while (!utils_dlist_empty(&head)) {
+            timer = utils_dlist_first_entry(&head, sw_timer_t, list);
+            utils_dlist_del(&timer->list);
+            wheel_add(timer);
+        }
+    }
+}
+
+static void wheel_alarm_set(uint32_t tick) {
+    // VT_MAX_TIMER means no alarm, delay it one tick
+    g_timer_ctrl.alarm_time = (tick == VT_MAX_TIMER) ? 0 : tick;
+}
+
+static void _timer_start(sw_timer_t* timer) {
+    uint32_t tick;
+
+    wheel_del(timer);
+    // the wheel time is not moved while the wheel is empty
+    if (g_timer_ctrl.alarm_time == VT_MAX_TIMER)
+        g_timer_ctrl.wheel_time = timer_current_time();
+    timer->timeout = timer_current_time() + timer->period;
+    wheel_add(timer);
+
+    tick = wheel_slot_tick(timer->wheel_slot >> SW_TIMER_WHEEL_BITS,
+                           timer->wheel_slot & SW_TIMER_WHEEL_MASK);
+    if ((g_timer_ctrl.alarm_time == VT_MAX_TIMER)
+        || ((int32_t)(tick - g_timer_ctrl.alarm_time) < 0))
+        wheel_alarm_set(tick);
+}
+
+static void _timer_stop(sw_timer_t* timer) { wheel_del(timer); }
+#else
 __STATIC_INLINE void alarm_time_reset(void) {
     sw_timer_t* timer_list = utils_dlist_first_entry(&g_timer_ctrl.working_list,
                                                      sw_timer_t, list);
@@ -325,6 +625,7 @@ static void _timer_start(sw_timer_t* timer) {
 }
 
 static void _timer_stop(sw_timer_t* timer) { utils_dlist_del(&timer->list); }
+#endif
 
 static void _timer_reset(sw_timer_t* timer) {
     if (!utils_dlist_empty(&timer->list))
@@ -354,6 +655,7 @@ static void _timer_delete(sw_timer_t* timer) {
     vPortFree(timer);
 }
 
+#ifndef CONFIG_SW_TIMER_USING_WHEEL
 static void _timer_shift(uint32_t shift_time) {
     sw_timer_t* timer_list;
     g_timer_ctrl.current_time -= shift_time;
@@ -370,6 +672,7 @@ static void _timer_shift(uint32_t shift_time) {
         alarm_time_reset();
     }
 }
+#endif
 
 static void switch_to_running_task(sw_timer_t* timer) {
     if (timer->cb_function == NULL) {
@@ -454,14 +757,73 @@ static void timer_cmd_queue_check(void) {
     } while (uxQueueMessagesWaiting(g_timer_cmd_queue));
 }
 
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+static void wheel_expire(utils_dlist_t* head) {
+    sw_timer_t* timer;
+    utils_dlist_t* n;
+    int32_t priority;
+
+    // the same timeout, the higher priority first
+    for (priority = SW_TIMER_PRIORITY_MAX - 1; priority >= 0; priority--) {
+        utils_dlist_for_each_entry_safe(head, n, timer, sw_timer_t, list) {
+            if (timer->priority != priority)
+                continue;
+
+            utils_dlist_del(&timer->list);
+            if ((int32_t)(timer->timeout - g_timer_ctrl.wheel_time) > 0) {
+                wheel_add(timer);
+                continue;
+            }
+
+            switch_to_running_task(timer);
+            if (timer->auto_reload)
+                _timer_start(timer);
+        }
+    }
+}
+
+static void timer_list_check(void) {
+    uint32_t now = timer_current_time(), tick;
+    utils_dlist_t head;
+
+    if (g_timer_ctrl.alarm_time == VT_MAX_TIMER) {
+        // the wheel is empty
+        g_timer_ctrl.wheel_time = now;
+        return;
+    }
+
+    // the tick is processed after it is passed, the same as the list backend
+    if ((int32_t)(now - g_timer_ctrl.alarm_time) <= 0)
+        return;
+
+    while ((int32_t)(now - g_timer_ctrl.wheel_time) > 0) {
+        // skip the ticks without any timer
+        if (!wheel_next_event(&tick) || ((int32_t)(now - tick) <= 0)) {
+            g_timer_ctrl.wheel_time = now;
+            break;
+        }
+
+        g_timer_ctrl.wheel_time = tick;
+        wheel_cascade();
+        wheel_slot_take(0, tick & SW_TIMER_WHEEL_MASK, &head);
+        wheel_expire(&head);
+        g_timer_ctrl.wheel_time++;
+    }
+
+    if (wheel_next_event(&tick))
+        wheel_alarm_set(tick);
+    else
+        g_timer_ctrl.alarm_time = VT_MAX_TIMER;
+}
+#else
 static void timer_list_check(void) {
     sw_timer_t* timer_list = NULL;
 
     if (g_timer_ctrl.current_time > SW_TIMER_SHIFT_THRESHOLD)
         _timer_shift(SW_TIMER_SHIFT_THRESHOLD);
 
-    // check timer list
-    while (g_timer_ctrl.current_time >= g_timer_ctrl.alarm_time) {
+    // check timer list, a timer runs after its timeout is passed
+    while (g_timer_ctrl.current_time > g_timer_ctrl.alarm_time) {
         timer_list = utils_dlist_first_entry(&g_timer_ctrl.working_list,
                                              sw_timer_t, list);
         if (timer_list) {
@@ -484,12 +846,74 @@ static void timer_list_check(void) {
         alarm_time_reset();
     }
 }
+#endif
 
+#ifdef CONFIG_SW_TIMER_TICKLESS
+static void sw_timer_isr(uint32_t timer_id) {
+    g_timer_ctrl.current_time += g_timer_ctrl.hw_period;
+    g_timer_ctrl.hw_rem = 0;
+
+    if ((g_timer_ctrl.alarm_time != VT_MAX_TIMER)
+        && ((int32_t)(g_timer_ctrl.current_time - g_timer_ctrl.alarm_time)
+            > 0))
+        SW_TIMER_TASK_WAKE_UP_FROM_ISR;
+
+    // the HW timer is reloaded with the same period, program the next alarm
+    timer_hw_program();
+}
+
+uint32_t sw_timer_tickless_sleep_enter(void) {
+    uint32_t delta;
+
+    // the HW timer is not initialized yet, no alarm limits the sleep
+    if (g_timer_ctrl.hw_timer == NULL)
+        return VT_MAX_TIMER;
+
+    // the period is ended, let the ISR run first
+    if (g_timer_ctrl.hw_timer->control.bit.int_status)
+        return 0;
+
+    timer_hw_sync();
+    g_timer_ctrl.hw_timer->control.bit.en = 0;
+    g_timer_ctrl.hw_sleep = 1;
+
+    if (g_timer_ctrl.alarm_time == VT_MAX_TIMER)
+        return VT_MAX_TIMER;
+
+    delta = g_timer_ctrl.alarm_time + 1 - g_timer_ctrl.current_time;
+    return ((int32_t)delta > 0) ? delta : 0;
+}
+
+void sw_timer_tickless_sleep_exit(uint32_t sleep_ms) {
+    if (g_timer_ctrl.hw_sleep == 0)
+        return;
+
+    // the HW timer is stopped, restart the period from current_time
+    g_timer_ctrl.current_time += sleep_ms;
+    g_timer_ctrl.hw_rem = 0;
+    g_timer_ctrl.hw_load = g_timer_ctrl.hw_timer->value;
+    g_timer_ctrl.hw_sleep = 0;
+
+    if ((g_timer_ctrl.alarm_time != VT_MAX_TIMER)
+        && ((int32_t)(g_timer_ctrl.current_time - g_timer_ctrl.alarm_time)
+            > 0))
+        SW_TIMER_TASK_WAKE_UP_FROM_ISR;
+
+    timer_hw_program();
+}
+#else
 static void sw_timer_isr(uint32_t timer_id) {
     static uint32_t last_alarm_time = 0, u32_same_alarm_time = 0;
     g_timer_ctrl.current_time++;
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+    // current_time is free running, compare it with the wrap-around
+    if ((g_timer_ctrl.alarm_time != VT_MAX_TIMER)
+        && ((int32_t)(g_timer_ctrl.current_time - g_timer_ctrl.alarm_time)
+            >= 0)) {
+#else
     if ((g_timer_ctrl.current_time >= g_timer_ctrl.alarm_time)
         || (g_timer_ctrl.current_time > SW_TIMER_SHIFT_THRESHOLD)) {
+#endif
         if (last_alarm_time != g_timer_ctrl.alarm_time) {
             last_alarm_time = g_timer_ctrl.alarm_time;
             u32_same_alarm_time = 0;
@@ -500,6 +924,7 @@ static void sw_timer_isr(uint32_t timer_id) {
         }
     }
 }
+#endif
 
 uint32_t sw_timer_hw_init(uint32_t u32_timer_id) {
 
@@ -515,13 +940,19 @@ uint32_t sw_timer_hw_init(uint32_t u32_timer_id) {
 
     TIMER = Timer_Base[u32_timer_id];
     TIMER->clear = 1; /*clear interrupt*/
+#ifdef CONFIG_SW_TIMER_TICKLESS
+    /* the first period is 1ms, then the ISR programs the next alarm */
+    g_timer_ctrl.hw_timer = TIMER;
+    g_timer_ctrl.hw_load = SW_TIMER_HW_TICKS_PER_MS - 1;
+    g_timer_ctrl.hw_period = 1;
+#endif
 
     timer_open(u32_timer_id, cfg, sw_timer_isr);
     NVIC_SetPriority((IRQn_Type)(Timer0_IRQn + u32_timer_id), 3);
     #if defined(CONFIG_RT581) || defined(CONFIG_RT582) || defined(CONFIG_RT583)
-    timer_start(u32_timer_id, 32000); /*so each tick is 1ms, 1000HZ*/
+    timer_start(u32_timer_id, SW_TIMER_HW_TICKS_PER_MS); /*so each tick is 1ms, 1000HZ*/
     #elif defined(CONFIG_RT584H) || defined(CONFIG_RT584L) || defined(CONFIG_RT584S)
-    timer_start(u32_timer_id, 32000, 32000); /*so each tick is 1ms, 1000HZ*/
+    timer_start(u32_timer_id, SW_TIMER_HW_TICKS_PER_MS, SW_TIMER_HW_TICKS_PER_MS); /*so each tick is 1ms, 1000HZ*/
     #endif
     NVIC_EnableIRQ((IRQn_Type)(Timer0_IRQn + u32_timer_id));
     return t_return;
@@ -540,6 +971,9 @@ static void timer_handler(void* params) {
     while (1) {
         timer_cmd_queue_check();
         timer_list_check();
+#ifdef CONFIG_SW_TIMER_TICKLESS
+        timer_hw_alarm_update();
+#endif
     }
 }
 
@@ -550,7 +984,15 @@ uint32_t sw_timer_init(uint32_t u32_timer_id) {
     do {
         memset(&g_timer_ctrl, 0x0, sizeof(g_timer_ctrl));
         g_timer_ctrl.alarm_time = VT_MAX_TIMER;
+#ifdef CONFIG_SW_TIMER_USING_WHEEL
+        uint32_t level, slot;
+        for (level = 0; level < SW_TIMER_WHEEL_LEVELS; level++) {
+            for (slot = 0; slot < SW_TIMER_WHEEL_SIZE; slot++)
+                INIT_UTILS_DLIST_HEAD(&g_timer_ctrl.wheel[level][slot]);
+        }
+#else
         INIT_UTILS_DLIST_HEAD(&g_timer_ctrl.working_list);
+#endif
 
         g_timer_cmd_queue = xQueueCreate(SW_TIMER_CMD_QUEUE_LENGTH,
                                          SW_TIMER_CMD_QUEUE_ITEM_SIZES);
@@ -8,6 +8,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 
 //=============================================================================
@@ -17,6 +18,10 @@ extern "C" {
 //=============================================================================
 //                Public Definitions of const value
 //=============================================================================
+#define SYSLOG_DUMP_MAGIC   0x474F4C53 // "SLOG"
+#define SYSLOG_DUMP_VERSION 1
+#define SYSLOG_DUMP_BEGIN   "syslog dump begin"
+#define SYSLOG_DUMP_END     "syslog dump end"
 
 //=============================================================================
 //                Public ENUM
@@ -45,7 +50,24 @@ typedef struct SYS_LOG_ENTRY {
     uint32_t msg2;
 } syslog_t;
 
+/*
+ * The binary dump is the header followed by count entries, oldest first.
+ * dropped: the logs inserted while the ring is halted
+ * lost: the logs overwritten by the newer logs
+ */
+typedef struct SYS_LOG_DUMP_HEADER {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t entry_size;
+    uint16_t reserved;
+    uint32_t count;
+    uint32_t dropped;
+    uint32_t lost;
+} syslog_dump_hdr_t;
+
 typedef void (*print_fn)(syslog_t* log);
+typedef void (*syslog_dump_fn)(const uint8_t* p_data, uint32_t len,
+                               void* p_arg);
 
 //=============================================================================
 //                Public Function Declaration
@@ -59,6 +81,14 @@ void syslog_insert_from_isr(syslog_module_t t_module, uint8_t u8_type,
 void syslog_print(syslog_module_t t_module, uint8_t u8_type);
 void syslog_clear(void);
 uint32_t syslog_init(void);
+uint32_t syslog_dump(syslog_dump_fn out_fn, void* p_arg);
+uint32_t syslog_get_dropped(void);
+
+bool syslog_entry_match(const syslog_t* log, syslog_module_t t_module,
+                        uint8_t u8_type);
+void syslog_print_entry(syslog_t* log, uint32_t u32_duration_tick);
+int32_t syslog_decode(const uint8_t* p_buf, uint32_t u32_len,
+                      syslog_module_t t_module, uint8_t u8_type);
 
 #ifdef __cplusplus
 };
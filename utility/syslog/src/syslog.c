@@ -10,10 +10,10 @@
  * @description
  */
 
+#include <stdbool.h>
 #include <string.h>
 
 #include "FreeRTOS.h"
-#include "queue.h"
 #include "syslog.h"
 #include "task.h"
 
@@ -23,129 +23,165 @@
 #define CONFIG_SYSLOG_ENTRY_SIZE 800
 #endif
 
-#define CONFIG_SYSLOG_TASK_PRIORITY (configMAX_PRIORITIES - 2)
-#define CONFIG_SYSLOG_STACK_SIZE    256 // task stack size (number of words)
-
-#define SYSLOG_QUEUE_LENGTH 20
+#define SYSLOG_DUMP_CHUNK_ENTRIES 8
 
+/*
+ * The log ring is written in place by the callers, task or ISR.
+ * A writer reserves an entry by an atomic increment of the head and commits
+ * it by writing the module at last, module 0 means the entry is not valid.
+ * The readers (print, dump and clear) halt the ring and wait for the writers
+ * in progress, the logs inserted while the ring is halted are dropped and
+ * counted.
+ */
 static syslog_t g_sys_log[CONFIG_SYSLOG_ENTRY_SIZE];
-static print_fn g_print_fn[SYSLOG_MODULE_ALL];
-static QueueHandle_t g_syslog_queue = NULL;
 
-static uint32_t current_idx = 0;
+static volatile uint32_t g_syslog_head = 0;    // total reserved entries
+static volatile uint32_t g_syslog_writers = 0; // writers in progress
+static volatile uint32_t g_syslog_dropped = 0; // dropped while halted
 volatile bool halt_log = false;
 
-static void syslog_print_default(syslog_t* log) {
-    printf("[%10u] %u-%u-%u: 0x%08x, 0x%08x\r\n", log->tick, log->module,
-           log->type, log->sub_type, log->msg1, log->msg2);
+static void syslog_write(uint32_t tick, syslog_module_t t_module,
+                         uint8_t u8_type, uint16_t u16_sub_type,
+                         uint32_t msg1, uint32_t msg2) {
+    syslog_t* pt_syslog;
+    uint32_t u32_idx;
+
+    __atomic_fetch_add(&g_syslog_writers, 1, __ATOMIC_SEQ_CST);
+    if (halt_log) {
+        __atomic_fetch_add(&g_syslog_dropped, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_sub(&g_syslog_writers, 1, __ATOMIC_SEQ_CST);
+        return;
+    }
+
+    u32_idx = __atomic_fetch_add(&g_syslog_head, 1, __ATOMIC_RELAXED)
+              % CONFIG_SYSLOG_ENTRY_SIZE;
+    pt_syslog = &g_sys_log[u32_idx];
+
+    pt_syslog->module = SYSLOG_MODULE_NONE;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    pt_syslog->tick = tick;
+    pt_syslog->type = u8_type;
+    pt_syslog->sub_type = u16_sub_type;
+    pt_syslog->msg1 = msg1;
+    pt_syslog->msg2 = msg2;
+    __atomic_store_n(&pt_syslog->module, (uint8_t)t_module, __ATOMIC_RELEASE);
+
+    __atomic_fetch_sub(&g_syslog_writers, 1, __ATOMIC_SEQ_CST);
+}
+
+// stop the writers, the caller is a task
+static void syslog_halt(void) {
+    halt_log = true;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    while (g_syslog_writers) {
+        // let the preempted writer finish
+        vTaskDelay(1);
+    }
+}
+
+static void syslog_resume(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    halt_log = false;
+}
+
+// the oldest entry index and the number of entries in the ring
+static uint32_t syslog_range(uint32_t* pu32_count) {
+    uint32_t u32_head = g_syslog_head;
+
+    if (u32_head < CONFIG_SYSLOG_ENTRY_SIZE) {
+        *pu32_count = u32_head;
+        return 0;
+    }
+    *pu32_count = CONFIG_SYSLOG_ENTRY_SIZE;
+    return u32_head % CONFIG_SYSLOG_ENTRY_SIZE;
 }
 
 void syslog_insert(syslog_module_t t_module, uint8_t u8_type,
                    uint16_t u16_sub_type, uint32_t msg1, uint32_t msg2) {
-    syslog_t t_syslog = {
-        .tick = xTaskGetTickCount(),
-        .module = t_module,
-        .type = u8_type,
-        .sub_type = u16_sub_type,
-        .msg1 = msg1,
-        .msg2 = msg2,
-    };
-    while (xQueueSendToBack(g_syslog_queue, &t_syslog, portMAX_DELAY)
-           != pdTRUE) {}
+    syslog_write(xTaskGetTickCount(), t_module, u8_type, u16_sub_type, msg1,
+                 msg2);
 }
 
 void syslog_insert_from_isr(syslog_module_t t_module, uint8_t u8_type,
                             uint16_t u16_sub_type, uint32_t msg1,
                             uint32_t msg2) {
-    BaseType_t context_switch = pdFALSE;
-    syslog_t t_syslog = {};
-
-    t_syslog.tick = xTaskGetTickCountFromISR();
-    t_syslog.module = t_module;
-    t_syslog.type = u8_type;
-    t_syslog.sub_type = u16_sub_type;
-    t_syslog.msg1 = msg1;
-    t_syslog.msg2 = msg2;
-
-    xQueueSendToBackFromISR(g_syslog_queue, &t_syslog, &context_switch);
-
-    portYIELD_FROM_ISR(context_switch);
+    syslog_write(xTaskGetTickCountFromISR(), t_module, u8_type, u16_sub_type,
+                 msg1, msg2);
 }
 
-void syslog_print_fn_register(syslog_module_t t_module, print_fn fn) {
-    g_print_fn[t_module] = fn;
+void syslog_print(syslog_module_t t_module, uint8_t u8_type) {
+    uint32_t u32_log, u32_idx, u32_count, u32_last_tick = 0;
+    bool b_first = true;
+
+    syslog_halt();
+    u32_idx = syslog_range(&u32_count);
+    for (u32_log = 0; u32_log < u32_count; u32_log++) {
+        if (syslog_entry_match(&g_sys_log[u32_idx], t_module, u8_type)) {
+            syslog_print_entry(&g_sys_log[u32_idx],
+                               b_first ? 0
+                                       : (g_sys_log[u32_idx].tick
+                                          - u32_last_tick));
+            u32_last_tick = g_sys_log[u32_idx].tick;
+            b_first = false;
+        }
+        u32_idx = (u32_idx + 1) % CONFIG_SYSLOG_ENTRY_SIZE;
+    }
+    syslog_resume();
+
+    if (g_syslog_dropped)
+        printf("syslog dropped %u\r\n", g_syslog_dropped);
 }
 
-void syslog_print(syslog_module_t t_module, uint8_t u8_type) {
-    uint32_t u32_log, u32_idx, u32_last_idx = 0xFFFF;
-    uint32_t u32_duration_tick;
+uint32_t syslog_dump(syslog_dump_fn out_fn, void* p_arg) {
+    syslog_t t_chunk[SYSLOG_DUMP_CHUNK_ENTRIES];
+    syslog_dump_hdr_t t_hdr;
+    uint32_t u32_log, u32_idx, u32_count, u32_num = 0;
+
+    syslog_halt();
+    u32_idx = syslog_range(&u32_count);
+
+    t_hdr.magic = SYSLOG_DUMP_MAGIC;
+    t_hdr.version = SYSLOG_DUMP_VERSION;
+    t_hdr.entry_size = sizeof(syslog_t);
+    t_hdr.reserved = 0;
+    t_hdr.count = 0;
+    t_hdr.dropped = g_syslog_dropped;
+    t_hdr.lost = g_syslog_head - u32_count;
+    for (u32_log = 0; u32_log < u32_count; u32_log++) {
+        if (g_sys_log[(u32_idx + u32_log) % CONFIG_SYSLOG_ENTRY_SIZE].module)
+            t_hdr.count++;
+    }
+    out_fn((const uint8_t*)&t_hdr, sizeof(t_hdr), p_arg);
 
-    u32_idx = (current_idx + 1) % CONFIG_SYSLOG_ENTRY_SIZE;
-    for (u32_log = 0; u32_log < CONFIG_SYSLOG_ENTRY_SIZE; u32_log++) {
+    for (u32_log = 0; u32_log < u32_count; u32_log++) {
         if (g_sys_log[u32_idx].module) {
-            if ((t_module == SYSLOG_MODULE_ALL)
-                || ((t_module == g_sys_log[u32_idx].module)
-                    && ((u8_type == g_sys_log[u32_idx].type)
-                        || (u8_type == 0xFF)))) {
-                u32_duration_tick = (u32_last_idx == 0xFFFF)
-                                        ? 0
-                                        : (g_sys_log[u32_idx].tick
-                                           - g_sys_log[u32_last_idx].tick);
-                u32_last_idx = u32_idx;
-                printf("%8d, ", u32_duration_tick);
-                if (g_print_fn[g_sys_log[u32_idx].module])
-                    g_print_fn[g_sys_log[u32_idx].module](&g_sys_log[u32_idx]);
-                else
-                    syslog_print_default(&g_sys_log[u32_idx]);
+            t_chunk[u32_num++] = g_sys_log[u32_idx];
+            if (u32_num == SYSLOG_DUMP_CHUNK_ENTRIES) {
+                out_fn((const uint8_t*)t_chunk, sizeof(t_chunk), p_arg);
+                u32_num = 0;
             }
         }
         u32_idx = (u32_idx + 1) % CONFIG_SYSLOG_ENTRY_SIZE;
     }
-}
+    if (u32_num)
+        out_fn((const uint8_t*)t_chunk, u32_num * sizeof(syslog_t), p_arg);
 
-void syslog_clear(void) {
-    halt_log = true;
-    current_idx = 0;
-    memset((uint8_t*)&g_sys_log, 0x0, sizeof(g_sys_log));
-    halt_log = false;
-}
+    syslog_resume();
 
-static void syslog_save(syslog_t* pt_syslog) {
-    while (halt_log == true) {}
-    halt_log = true;
-    current_idx = (current_idx + 1) % CONFIG_SYSLOG_ENTRY_SIZE;
-    g_sys_log[current_idx].tick = pt_syslog->tick;
-    g_sys_log[current_idx].module = pt_syslog->module;
-    g_sys_log[current_idx].type = pt_syslog->type;
-    g_sys_log[current_idx].sub_type = pt_syslog->sub_type;
-    g_sys_log[current_idx].msg1 = pt_syslog->msg1;
-    g_sys_log[current_idx].msg2 = pt_syslog->msg2;
-    halt_log = false;
+    return t_hdr.count;
 }
 
-static void syslog_handler(void* params) {
-    while (1) {
-        syslog_t t_syslog;
-        if (xQueueReceive(g_syslog_queue, &t_syslog, portMAX_DELAY) == pdTRUE) {
-            // error
-            syslog_save(&t_syslog);
-        }
-    }
+uint32_t syslog_get_dropped(void) { return g_syslog_dropped; }
+
+void syslog_clear(void) {
+    syslog_halt();
+    memset((uint8_t*)&g_sys_log, 0x0, sizeof(g_sys_log));
+    g_syslog_head = 0;
+    g_syslog_dropped = 0;
+    syslog_resume();
 }
 
 uint32_t syslog_init(void) {
-    TaskHandle_t t_thread = NULL;
-    g_syslog_queue = xQueueCreate(SYSLOG_QUEUE_LENGTH, sizeof(syslog_t));
-    if (g_syslog_queue == NULL) {
-        log_error("syslog queue create fail\n");
-        return 1;
-    }
-
-    xTaskCreate(syslog_handler, "syslog", CONFIG_SYSLOG_STACK_SIZE, NULL,
-                CONFIG_SYSLOG_TASK_PRIORITY, &t_thread);
-    if (t_thread == NULL) {
-        log_error("syslog task create fail\n");
-        return 1;
-    }
+    // the ring needs no task or queue, keep it for the compatibility
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2024 Rex Huang, All Rights Reserved.
+ */
+/** @file syslog_decode.c
+ *
+ * @author Rex Huang
+ * @version 0.1
+ * @date 2024/08/14
+ * @license
+ * @description The syslog formats and the binary dump decoder, it has no
+ *              RTOS dependency so it can be built on host with the module
+ *              print functions:
+ *
+ *              cc -DSYSLOG_DECODE_MAIN -Iinclude src/syslog_decode.c print_fns.c
+ *              syslog_decode < console.txt
+ *
+ *              print_fns.c defines syslog_decode_init() to register the
+ *              module print functions by syslog_print_fn_register().
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "syslog.h"
+
+static print_fn g_print_fn[SYSLOG_MODULE_ALL];
+
+static void syslog_print_default(syslog_t* log) {
+    printf("[%10u] %u-%u-%u: 0x%08x, 0x%08x\r\n", log->tick, log->module,
+           log->type, log->sub_type, log->msg1, log->msg2);
+}
+
+void syslog_print_fn_register(syslog_module_t t_module, print_fn fn) {
+    g_print_fn[t_module] = fn;
+}
+
+bool syslog_entry_match(const syslog_t* log, syslog_module_t t_module,
+                        uint8_t u8_type) {
+    if ((log->module == SYSLOG_MODULE_NONE)
+        || (log->module >= SYSLOG_MODULE_ALL))
+        return false;
+
+    return (t_module == SYSLOG_MODULE_ALL)
+           || ((t_module == log->module)
+               && ((u8_type == log->type) || (u8_type == 0xFF)));
+}
+
+void syslog_print_entry(syslog_t* log, uint32_t u32_duration_tick) {
+    printf("%8d, ", u32_duration_tick);
+    if (g_print_fn[log->module])
+        g_print_fn[log->module](log);
+    else
+        syslog_print_default(log);
+}
+
+int32_t syslog_decode(const uint8_t* p_buf, uint32_t u32_len,
+                      syslog_module_t t_module, uint8_t u8_type) {
+    syslog_dump_hdr_t t_hdr;
+    syslog_t t_syslog;
+    uint32_t u32_log, u32_last_tick = 0;
+    int32_t i32_num = 0;
+
+    if (u32_len < sizeof(t_hdr))
+        return -1;
+
+    memcpy(&t_hdr, p_buf, sizeof(t_hdr));
+    if ((t_hdr.magic != SYSLOG_DUMP_MAGIC)
+        || (t_hdr.version != SYSLOG_DUMP_VERSION)
+        || (t_hdr.entry_size != sizeof(syslog_t))
+        || (u32_len < sizeof(t_hdr) + t_hdr.count * sizeof(syslog_t)))
+        return -1;
+
+    p_buf += sizeof(t_hdr);
+    for (u32_log = 0; u32_log < t_hdr.count; u32_log++) {
+        memcpy(&t_syslog, p_buf, sizeof(t_syslog));
+        p_buf += sizeof(t_syslog);
+        if (!syslog_entry_match(&t_syslog, t_module, u8_type))
+            continue;
+
+        syslog_print_entry(&t_syslog, i32_num ? (t_syslog.tick - u32_last_tick)
+                                              : 0);
+        u32_last_tick = t_syslog.tick;
+        i32_num++;
+    }
+
+    if (t_hdr.dropped || t_hdr.lost)
+        printf("syslog dropped %u, lost %u\r\n", t_hdr.dropped, t_hdr.lost);
+
+    return i32_num;
+}
+
+#ifdef SYSLOG_DECODE_MAIN
+#include <stdlib.h>
+
+void __attribute__((weak)) syslog_decode_init(void) {}
+
+/*
+ * Read the console output of the "syslog dump" command, the hex lines between
+ * SYSLOG_DUMP_BEGIN and SYSLOG_DUMP_END are decoded, the other lines are skipped.
+ */
+int main(int argc, char** argv) {
+    static uint8_t buf[0x100000];
+    char line[256], *p;
+    uint32_t u32_len = 0;
+    int in_dump = 0;
+    unsigned int u8_byte;
+
+    syslog_decode_init();
+
+    while (fgets(line, sizeof(line), stdin)) {
+        if (strstr(line, SYSLOG_DUMP_BEGIN)) {
+            in_dump = 1;
+            u32_len = 0;
+            continue;
+        }
+        if (strstr(line, SYSLOG_DUMP_END)) {
+            in_dump = 0;
+            if (syslog_decode(buf, u32_len, SYSLOG_MODULE_ALL, 0xFF) < 0)
+                printf("syslog dump decode fail\r\n");
+            continue;
+        }
+        if (!in_dump)
+            continue;
+
+        for (p = line; (u32_len < sizeof(buf)) && (sscanf(p, "%2x", &u8_byte) == 1);
+             p += 2)
+            buf[u32_len++] = (uint8_t)u8_byte;
+    }
+    return 0;
+}
+#endif
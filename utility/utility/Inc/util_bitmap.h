@@ -0,0 +1,127 @@
+/**
+ * @file util_bitmap.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/**
+* @defgroup Bitmap Bitmap API Definition
+* Define word based bitmap functions. The bit n is stored in word n / 32, bit n % 32.
+* @ingroup Utility
+* @{
+*/
+#ifndef __UTIL_BITMAP_H__
+#define __UTIL_BITMAP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//=============================================================================
+//                Include (Better to prevent)
+//=============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Number of 32-bit words for a bitmap of @p bits. */
+#define UTIL_BITMAP_WORDS(bits) (((bits) + 31) >> 5)
+
+/**
+ * @brief A range of continuous zero bits, [start, start + len).
+ */
+typedef struct
+{
+    uint32_t start; /**< The first zero bit of the range. */
+    uint32_t len;   /**< The number of zero bits in the range. */
+} util_bitmap_range_t;
+
+/**
+ * Sets one bit of the bitmap.
+ *
+ * @param[in,out] p_bitmap Bitmap instance.
+ * @param[in] index Bit index.
+ */
+void util_bitmap_set(uint32_t *p_bitmap, uint32_t index);
+
+/**
+ * Clears one bit of the bitmap.
+ *
+ * @param[in,out] p_bitmap Bitmap instance.
+ * @param[in] index Bit index.
+ */
+void util_bitmap_clear(uint32_t *p_bitmap, uint32_t index);
+
+/**
+ * Gets one bit of the bitmap.
+ *
+ * @param[in] p_bitmap Bitmap instance.
+ * @param[in] index Bit index.
+ *
+ * @returns true if the bit is set.
+ */
+bool util_bitmap_get(const uint32_t *p_bitmap, uint32_t index);
+
+/**
+ * Sets the first @p bits bits of the bitmap.
+ *
+ * @param[in,out] p_bitmap Bitmap instance.
+ * @param[in] bits Number of bits to set.
+ */
+void util_bitmap_set_all(uint32_t *p_bitmap, uint32_t bits);
+
+/**
+ * Counts the zero bits in the first @p bits bits of the bitmap.
+ *
+ * @param[in] p_bitmap Bitmap instance.
+ * @param[in] bits Number of bits of the bitmap.
+ *
+ * @returns The number of zero bits.
+ */
+uint32_t util_bitmap_count_zero(const uint32_t *p_bitmap, uint32_t bits);
+
+/**
+ * Finds the next zero bit from @p start.
+ *
+ * @param[in] p_bitmap Bitmap instance.
+ * @param[in] bits Number of bits of the bitmap.
+ * @param[in] start The first bit index to check.
+ *
+ * @returns The index of the zero bit, or @p bits if there is no zero bit.
+ */
+uint32_t util_bitmap_find_next_zero(const uint32_t *p_bitmap, uint32_t bits, uint32_t start);
+
+/**
+ * Finds the next set bit from @p start.
+ *
+ * @param[in] p_bitmap Bitmap instance.
+ * @param[in] bits Number of bits of the bitmap.
+ * @param[in] start The first bit index to check.
+ *
+ * @returns The index of the set bit, or @p bits if there is no set bit.
+ */
+uint32_t util_bitmap_find_next_one(const uint32_t *p_bitmap, uint32_t bits, uint32_t start);
+
+/**
+ * Encodes the zero bits from @p start as ranges of continuous zero bits.
+ *
+ * @param[in] p_bitmap Bitmap instance.
+ * @param[in] bits Number of bits of the bitmap.
+ * @param[in] start The first bit index to check.
+ * @param[out] p_ranges Ranges buffer.
+ * @param[in] max_ranges Number of ranges in @p p_ranges.
+ *
+ * @returns The number of ranges saved in @p p_ranges.
+ */
+uint32_t util_bitmap_zero_ranges(const uint32_t *p_bitmap, uint32_t bits, uint32_t start,
+                                 util_bitmap_range_t *p_ranges, uint32_t max_ranges);
+
+/** @} */
+#ifdef __cplusplus
+};
+#endif
+
+#endif /* __UTIL_BITMAP_H__ */
@@ -0,0 +1,76 @@
+/**
+ * @file util_crc32.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/**
+* @defgroup CRC32 CRC32 API Definition
+* Define CRC32 (IEEE 802.3, reflected polynomial 0xEDB88320) functions.
+* @ingroup Utility
+* @{
+*/
+#ifndef __UTIL_CRC32_H__
+#define __UTIL_CRC32_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//=============================================================================
+//                Include (Better to prevent)
+//=============================================================================
+#include <stdint.h>
+
+/**
+ * @brief Callback between two chunks of @ref util_crc32_chunked, e.g. taskYIELD or feed the watchdog.
+ */
+typedef void (*util_crc32_yield_cb_t)(void);
+
+/**
+ * Calculates the CRC32 of a buffer, same as zlib crc32().
+ *
+ * @param[in] crc Accumulated CRC32 value, must be 0 on first call.
+ * @param[in] p_buf Buffer to calculate CRC32 value for.
+ * @param[in] len Bytes in buffer.
+ *
+ * @returns The CRC32 value, it can be used as @p crc to continue with the next buffer.
+ */
+uint32_t util_crc32_update(uint32_t crc, const void *p_buf, uint32_t len);
+
+/**
+ * Calculates the CRC32 of a buffer.
+ *
+ * @param[in] p_buf Buffer to calculate CRC32 value for.
+ * @param[in] len Bytes in buffer.
+ *
+ * @returns The CRC32 value.
+ */
+uint32_t util_crc32(const void *p_buf, uint32_t len);
+
+/**
+ * Calculates the CRC32 of a large buffer (e.g. a firmware image in flash) chunk by chunk,
+ * and calls @p yield_cb between two chunks, so the caller does not block other tasks for the
+ * whole buffer.
+ *
+ * @param[in] crc Accumulated CRC32 value, must be 0 on first call.
+ * @param[in] p_buf Buffer to calculate CRC32 value for.
+ * @param[in] len Bytes in buffer.
+ * @param[in] chunk_size Bytes calculated between two @p yield_cb, 0: no chunk.
+ * @param[in] yield_cb Callback between two chunks, it can be NULL.
+ *
+ * @returns The CRC32 value.
+ */
+uint32_t util_crc32_chunked(uint32_t crc, const void *p_buf, uint32_t len,
+                            uint32_t chunk_size, util_crc32_yield_cb_t yield_cb);
+
+/** @} */
+#ifdef __cplusplus
+};
+#endif
+
+#endif /* __UTIL_CRC32_H__ */
@@ -0,0 +1,149 @@
+/**
+ * @file util_frame_ring.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/**
+* @defgroup FrameRing Frame Ring API Definition
+* Define a lock-free single producer, single consumer ring of fixed size frame slots, e.g. the radio
+* RX callback fills the frames and the stack task takes them. The producer reserves a slot, fills it
+* in place and commits it, the consumer peeks the oldest slot and releases it after use. Only the
+* producer calls the put functions and only the consumer calls the get functions.
+* @ingroup Utility
+* @{
+*/
+#ifndef __UTIL_FRAME_RING_H__
+#define __UTIL_FRAME_RING_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//=============================================================================
+//                Include (Better to prevent)
+//=============================================================================
+#include <stdint.h>
+
+/** Bytes of a slot for a frame of @p size bytes, the slots are 8 bytes aligned. */
+#define UTIL_FRAME_RING_SLOT_SIZE(size) (((size) + 7) & ~7UL)
+
+/** Bytes of the ring buffer of @p depth frames of @p size bytes. */
+#define UTIL_FRAME_RING_BUF_SIZE(size, depth) (UTIL_FRAME_RING_SLOT_SIZE(size) * (depth))
+
+/**
+ * @brief Frame ring statistics.
+ */
+typedef struct
+{
+    uint32_t put_num;       /**< Frames committed by the producer. */
+    uint32_t drop_num;      /**< Reserves failed by a full ring. */
+    uint16_t depth;         /**< Slots of the ring. */
+    uint16_t used;          /**< Frames in the ring. */
+    uint16_t high_water;    /**< The max frames in the ring. */
+} util_frame_ring_stats_t;
+
+/**
+ * @brief Frame ring instance. All manipulation of struct internals should be left to the frame ring module.
+ */
+typedef struct util_frame_ring
+{
+    const char *p_name;
+    uint8_t *p_buf;
+    uint16_t slot_size;
+    uint16_t depth;
+    volatile uint16_t head;         /**< Written by the producer, [0, 2 * depth). */
+    volatile uint16_t tail;         /**< Written by the consumer, [0, 2 * depth). */
+    volatile uint16_t high_water;
+    volatile uint32_t put_num;
+    volatile uint32_t drop_num;
+    struct util_frame_ring *p_next; /**< The next registered ring. */
+} util_frame_ring_t;
+
+/**
+ * Initializes a frame ring and registers it for @ref util_frame_ring_list.
+ *
+ * @param[out] p_ring Frame ring instance, it must not be freed after the init.
+ * @param[in] p_name Name shown by the CLI.
+ * @param[in] p_buf Buffer of @ref UTIL_FRAME_RING_BUF_SIZE bytes, 8 bytes aligned.
+ * @param[in] frame_size Bytes of a frame.
+ * @param[in] depth Number of frames, 1 ~ 0x7FFF.
+ */
+void util_frame_ring_init(util_frame_ring_t *p_ring, const char *p_name, void *p_buf,
+                          uint32_t frame_size, uint16_t depth);
+
+/**
+ * Reserves the next free slot, producer only. The drop counter is increased if the ring is full.
+ *
+ * @param[in,out] p_ring Frame ring instance.
+ *
+ * @returns The slot to fill, or NULL if the ring is full. A slot reserved again without commit is
+ *          the same slot.
+ */
+void *util_frame_ring_put_reserve(util_frame_ring_t *p_ring);
+
+/**
+ * Commits the reserved slot to the consumer, producer only.
+ *
+ * @param[in,out] p_ring Frame ring instance.
+ */
+void util_frame_ring_put_commit(util_frame_ring_t *p_ring);
+
+/**
+ * Gets the oldest committed slot without removing it, consumer only.
+ *
+ * @param[in] p_ring Frame ring instance.
+ *
+ * @returns The oldest slot, or NULL if the ring is empty.
+ */
+void *util_frame_ring_get_peek(util_frame_ring_t *p_ring);
+
+/**
+ * Releases the oldest slot back to the producer, consumer only.
+ *
+ * @param[in,out] p_ring Frame ring instance.
+ */
+void util_frame_ring_get_release(util_frame_ring_t *p_ring);
+
+/**
+ * Gets the number of frames in the ring.
+ *
+ * @param[in] p_ring Frame ring instance.
+ *
+ * @returns The number of committed frames not released.
+ */
+uint32_t util_frame_ring_count(const util_frame_ring_t *p_ring);
+
+/**
+ * Gets the statistics of a frame ring.
+ *
+ * @param[in] p_ring Frame ring instance.
+ * @param[out] p_stats Statistics.
+ */
+void util_frame_ring_stats_get(const util_frame_ring_t *p_ring, util_frame_ring_stats_t *p_stats);
+
+/**
+ * Clears the counters and sets the high water to the frames in the ring. A frame put at the same
+ * time may be counted before the reset.
+ *
+ * @param[in,out] p_ring Frame ring instance.
+ */
+void util_frame_ring_stats_reset(util_frame_ring_t *p_ring);
+
+/**
+ * Gets the registered frame rings.
+ *
+ * @returns The first ring, the others are linked by @c p_next.
+ */
+util_frame_ring_t *util_frame_ring_list(void);
+
+/** @} */
+#ifdef __cplusplus
+};
+#endif
+
+#endif /* __UTIL_FRAME_RING_H__ */
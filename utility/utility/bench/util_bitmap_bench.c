@@ -0,0 +1,252 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file util_bitmap_bench.c
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The host check and benchmark of util_bitmap. Random set and
+ *              clear operations are checked against a byte per bit bitmap,
+ *              then an OTA download of random segments is measured, the
+ *              remaining segments are counted after each segment as
+ *              ota_bitmap_get_remain() does, by util_bitmap_count_zero and by
+ *              the bit by bit loop it replaced.
+ *
+ *   cc -O2 -Iutility/utility/Inc utility/utility/util_bitmap.c
+ *      utility/utility/bench/util_bitmap_bench.c -o util_bitmap_bench
+ *   util_bitmap_bench [-n segments]
+ *
+ * The exit status is not 0 if a result differs from the byte per bit bitmap.
+ */
+
+//=============================================================================
+//                Include
+//=============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "util_bitmap.h"
+
+//=============================================================================
+//                Private Definitions of const value
+//=============================================================================
+#define BENCH_CHECK_BITS_MAX    (300)
+#define BENCH_CHECK_ROUNDS      (200)
+#define BENCH_RANGES_MAX        (8)
+
+//=============================================================================
+//                Private Function Definition
+//=============================================================================
+static double bench_elapsed_sec(struct timespec *p_start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - p_start->tv_sec) + (now.tv_nsec - p_start->tv_nsec) / 1e9;
+}
+
+/* the zero bits counted bit by bit */
+static uint32_t bench_count_zero_bitwise(const uint32_t *p_bitmap, uint32_t bits)
+{
+    uint32_t i, zero = 0;
+
+    for (i = 0; i < bits; i++)
+    {
+        if ((p_bitmap[i >> 5] & (0x1UL << (i & 0x1F))) == 0)
+        {
+            zero++;
+        }
+    }
+    return zero;
+}
+
+static uint32_t bench_ref_next(const uint8_t *p_ref, uint32_t bits, uint32_t start, uint8_t value)
+{
+    while (start < bits && p_ref[start] != value)
+    {
+        start++;
+    }
+    return (start < bits) ? start : bits;
+}
+
+static int bench_check_state(const uint32_t *p_bitmap, const uint8_t *p_ref, uint32_t bits)
+{
+    util_bitmap_range_t ranges[BENCH_RANGES_MAX];
+    uint32_t i, num, zero = 0, start, pos;
+
+    for (i = 0; i < bits; i++)
+    {
+        if (util_bitmap_get(p_bitmap, i) != (p_ref[i] != 0))
+        {
+            printf("get fail, bits %u index %u\n", bits, i);
+            return 1;
+        }
+        zero += (p_ref[i] == 0);
+    }
+    if (util_bitmap_count_zero(p_bitmap, bits) != zero)
+    {
+        printf("count zero fail, bits %u\n", bits);
+        return 1;
+    }
+
+    start = bits ? (uint32_t)rand() % (bits + 1) : 0;
+    if ((util_bitmap_find_next_zero(p_bitmap, bits, start) != bench_ref_next(p_ref, bits, start, 0)) ||
+            (util_bitmap_find_next_one(p_bitmap, bits, start) != bench_ref_next(p_ref, bits, start, 1)))
+    {
+        printf("find next fail, bits %u start %u\n", bits, start);
+        return 1;
+    }
+
+    /* the ranges are the zero runs from start */
+    num = util_bitmap_zero_ranges(p_bitmap, bits, start, ranges, BENCH_RANGES_MAX);
+    pos = start;
+    for (i = 0; i < num; i++)
+    {
+        pos = bench_ref_next(p_ref, bits, pos, 0);
+        if ((ranges[i].start != pos) || (ranges[i].len == 0) ||
+                (bench_ref_next(p_ref, bits, pos, 1) != pos + ranges[i].len))
+        {
+            printf("zero ranges fail, bits %u start %u range %u\n", bits, start, i);
+            return 1;
+        }
+        pos += ranges[i].len;
+    }
+    if ((num < BENCH_RANGES_MAX) && (bench_ref_next(p_ref, bits, pos, 0) != bits))
+    {
+        printf("zero ranges miss, bits %u start %u\n", bits, start);
+        return 1;
+    }
+    return 0;
+}
+
+static int bench_check(void)
+{
+    uint32_t bitmap[UTIL_BITMAP_WORDS(BENCH_CHECK_BITS_MAX)];
+    uint8_t ref[BENCH_CHECK_BITS_MAX];
+    uint32_t round, op, bits, index;
+
+    for (round = 0; round < BENCH_CHECK_ROUNDS; round++)
+    {
+        bits = (uint32_t)rand() % (BENCH_CHECK_BITS_MAX + 1);
+        memset(bitmap, 0, sizeof(bitmap));
+        memset(ref, 0, sizeof(ref));
+
+        for (op = 0; op < 2 * bits; op++)
+        {
+            index = (uint32_t)rand() % bits;
+            if (rand() & 1)
+            {
+                util_bitmap_set(bitmap, index);
+                ref[index] = 1;
+            }
+            else
+            {
+                util_bitmap_clear(bitmap, index);
+                ref[index] = 0;
+            }
+            if (bench_check_state(bitmap, ref, bits))
+            {
+                return 1;
+            }
+        }
+
+        util_bitmap_set_all(bitmap, bits);
+        memset(ref, 1, bits);
+        if (bench_check_state(bitmap, ref, bits))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void bench_usage(const char *p_name)
+{
+    printf("usage: %s [-n segments]\n", p_name);
+}
+
+int main(int argc, char **argv)
+{
+    struct timespec start;
+    uint32_t *p_bitmap, *p_order;
+    uint32_t seg_num = 4096, i, j, tmp, remain = 0, remain_bitwise = 0;
+    double sec, sec_bitwise;
+    int err;
+
+    for (i = 1; i < (uint32_t)argc; i++)
+    {
+        if (i + 1 >= (uint32_t)argc)
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-n") == 0)
+        {
+            seg_num = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (seg_num == 0)
+    {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    err = bench_check();
+
+    p_bitmap = calloc(UTIL_BITMAP_WORDS(seg_num), sizeof(uint32_t));
+    p_order = malloc(seg_num * sizeof(uint32_t));
+    if ((p_bitmap == NULL) || (p_order == NULL))
+    {
+        return 1;
+    }
+    /* the segments arrive in a random order */
+    for (i = 0; i < seg_num; i++)
+    {
+        p_order[i] = i;
+    }
+    for (i = seg_num - 1; i > 0; i--)
+    {
+        j = (uint32_t)rand() % (i + 1);
+        tmp = p_order[i];
+        p_order[i] = p_order[j];
+        p_order[j] = tmp;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < seg_num; i++)
+    {
+        util_bitmap_set(p_bitmap, p_order[i]);
+        remain += util_bitmap_count_zero(p_bitmap, seg_num);
+    }
+    sec = bench_elapsed_sec(&start);
+
+    memset(p_bitmap, 0, UTIL_BITMAP_WORDS(seg_num) * sizeof(uint32_t));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < seg_num; i++)
+    {
+        util_bitmap_set(p_bitmap, p_order[i]);
+        remain_bitwise += bench_count_zero_bitwise(p_bitmap, seg_num);
+    }
+    sec_bitwise = bench_elapsed_sec(&start);
+
+    if (remain != remain_bitwise)
+    {
+        printf("remain fail %u %u\n", remain, remain_bitwise);
+        err = 1;
+    }
+    printf("%u segments, remain counted per segment\n", seg_num);
+    printf("util_bitmap_count_zero: %.1f ns/segment\n", sec * 1e9 / seg_num);
+    printf("bit by bit            : %.1f ns/segment\n", sec_bitwise * 1e9 / seg_num);
+
+    free(p_order);
+    free(p_bitmap);
+    return err;
+}
@@ -0,0 +1,194 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file util_crc32_bench.c
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description The host check and benchmark of util_crc32. The CRC of random
+ *              buffers of every alignment is checked against the bitwise
+ *              CRC32, util_crc32_chunked against util_crc32, then the speed of
+ *              both is measured on an image of the OTA bank size.
+ *
+ *   cc -O2 -Iutility/utility/Inc utility/utility/util_crc32.c
+ *      utility/utility/bench/util_crc32_bench.c -o util_crc32_bench
+ *   util_crc32_bench [-s image KB] [-c chunk size]
+ *
+ * Add -DUTIL_CRC32_SIZE_OPTIMIZE=1 for the byte table. The exit status is not
+ * 0 if a CRC is wrong.
+ */
+
+//=============================================================================
+//                Include
+//=============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "util_crc32.h"
+
+//=============================================================================
+//                Private Definitions of const value
+//=============================================================================
+#define BENCH_CHECK_LEN_MAX     (300)
+#define BENCH_CHECK_ROUNDS      (2000)
+
+//=============================================================================
+//                Private Global Variables
+//=============================================================================
+static uint32_t g_yield_num;
+
+//=============================================================================
+//                Private Function Definition
+//=============================================================================
+/* the bitwise CRC32, the reference of the table driven one */
+static uint32_t bench_crc32_bitwise(const uint8_t *p_buf, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    int i;
+
+    while (len--)
+    {
+        crc ^= *p_buf++;
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+static void bench_yield(void)
+{
+    g_yield_num++;
+}
+
+static double bench_elapsed_sec(struct timespec *p_start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - p_start->tv_sec) + (now.tv_nsec - p_start->tv_nsec) / 1e9;
+}
+
+static int bench_check(void)
+{
+    static uint8_t buf[BENCH_CHECK_LEN_MAX + 8];
+    uint32_t i, len, offset, split, crc;
+    int err = 0;
+
+    if (util_crc32("123456789", 9) != 0xCBF43926)
+    {
+        printf("check value fail %08X\n", util_crc32("123456789", 9));
+        err = 1;
+    }
+
+    for (i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t)rand();
+    }
+    for (i = 0; i < BENCH_CHECK_ROUNDS && !err; i++)
+    {
+        len = (uint32_t)rand() % (BENCH_CHECK_LEN_MAX + 1);
+        offset = (uint32_t)rand() % 8;
+        split = len ? (uint32_t)rand() % len : 0;
+
+        crc = bench_crc32_bitwise(buf + offset, len);
+        if (util_crc32(buf + offset, len) != crc)
+        {
+            printf("crc fail, len %u offset %u\n", len, offset);
+            err = 1;
+        }
+        if (util_crc32_update(util_crc32_update(0, buf + offset, split), buf + offset + split, len - split) != crc)
+        {
+            printf("update fail, len %u offset %u split %u\n", len, offset, split);
+            err = 1;
+        }
+        if (util_crc32_chunked(0, buf + offset, len, split, bench_yield) != crc)
+        {
+            printf("chunked fail, len %u offset %u chunk %u\n", len, offset, split);
+            err = 1;
+        }
+    }
+    return err;
+}
+
+static void bench_usage(const char *p_name)
+{
+    printf("usage: %s [-s image KB] [-c chunk size]\n", p_name);
+}
+
+int main(int argc, char **argv)
+{
+    struct timespec start;
+    uint8_t *p_image;
+    uint32_t image_len = 1024 * 1024, chunk_size = 64, i, crc, crc_chunked;
+    double sec, sec_chunked, sec_bitwise;
+    int err;
+
+    for (i = 1; i < (uint32_t)argc; i++)
+    {
+        if (i + 1 >= (uint32_t)argc)
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-s") == 0)
+        {
+            image_len = (uint32_t)strtoul(argv[++i], NULL, 0) * 1024;
+        }
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            chunk_size = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (image_len == 0)
+    {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    err = bench_check();
+
+    p_image = malloc(image_len);
+    if (p_image == NULL)
+    {
+        return 1;
+    }
+    for (i = 0; i < image_len; i++)
+    {
+        p_image[i] = (uint8_t)rand();
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    crc = util_crc32(p_image, image_len);
+    sec = bench_elapsed_sec(&start);
+
+    g_yield_num = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    crc_chunked = util_crc32_chunked(0, p_image, image_len, chunk_size, bench_yield);
+    sec_chunked = bench_elapsed_sec(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (bench_crc32_bitwise(p_image, image_len) != crc || crc_chunked != crc)
+    {
+        printf("image crc fail\n");
+        err = 1;
+    }
+    sec_bitwise = bench_elapsed_sec(&start);
+
+    printf("image %u KB, crc %08X\n", image_len / 1024, crc);
+    printf("util_crc32        : %.1f MB/s\n", image_len / sec / 1e6);
+    printf("util_crc32_chunked: %.1f MB/s, chunk %u, %u yields\n", image_len / sec_chunked / 1e6, chunk_size, g_yield_num);
+    printf("bitwise           : %.1f MB/s\n", image_len / sec_bitwise / 1e6);
+
+    free(p_image);
+    return err;
+}
@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file util_bitmap.c
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description Word based bitmap, the count and search functions check 32 bits per loop.
+ */
+
+//=============================================================================
+//                Include
+//=============================================================================
+#include "util_bitmap.h"
+
+//=============================================================================
+//                Private Function Definition
+//=============================================================================
+/* the valid bits mask of the last word */
+static uint32_t bitmap_last_mask(uint32_t bits)
+{
+    return (bits & 0x1F) ? ((0x1UL << (bits & 0x1F)) - 1) : 0xFFFFFFFFUL;
+}
+
+//=============================================================================
+//                Public Function Definition
+//=============================================================================
+void util_bitmap_set(uint32_t *p_bitmap, uint32_t index)
+{
+    p_bitmap[index >> 5] |= 0x1UL << (index & 0x1F);
+}
+
+void util_bitmap_clear(uint32_t *p_bitmap, uint32_t index)
+{
+    p_bitmap[index >> 5] &= ~(0x1UL << (index & 0x1F));
+}
+
+bool util_bitmap_get(const uint32_t *p_bitmap, uint32_t index)
+{
+    return (p_bitmap[index >> 5] & (0x1UL << (index & 0x1F))) != 0;
+}
+
+uint32_t util_bitmap_find_next_one(const uint32_t *p_bitmap, uint32_t bits, uint32_t start)
+{
+    uint32_t word, idx = start >> 5, words = UTIL_BITMAP_WORDS(bits);
+
+    if (start >= bits)
+    {
+        return bits;
+    }
+
+    word = p_bitmap[idx] & ~((0x1UL << (start & 0x1F)) - 1);
+    while (word == 0)
+    {
+        if (++idx >= words)
+        {
+            return bits;
+        }
+        word = p_bitmap[idx];
+    }
+
+    start = (idx << 5) + __builtin_ctz(word);
+    return (start < bits) ? start : bits;
+}
+
+void util_bitmap_set_all(uint32_t *p_bitmap, uint32_t bits)
+{
+    uint32_t i, words = UTIL_BITMAP_WORDS(bits);
+
+    if (words == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < words - 1; i++)
+    {
+        p_bitmap[i] = 0xFFFFFFFFUL;
+    }
+    p_bitmap[words - 1] |= bitmap_last_mask(bits);
+}
+
+uint32_t util_bitmap_count_zero(const uint32_t *p_bitmap, uint32_t bits)
+{
+    uint32_t i, ones = 0, words = UTIL_BITMAP_WORDS(bits);
+
+    if (words == 0)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < words - 1; i++)
+    {
+        ones += __builtin_popcount(p_bitmap[i]);
+    }
+    ones += __builtin_popcount(p_bitmap[words - 1] & bitmap_last_mask(bits));
+
+    return bits - ones;
+}
+
+uint32_t util_bitmap_find_next_zero(const uint32_t *p_bitmap, uint32_t bits, uint32_t start)
+{
+    uint32_t word, idx = start >> 5, words = UTIL_BITMAP_WORDS(bits);
+
+    if (start >= bits)
+    {
+        return bits;
+    }
+
+    /* the bits before start are treated as set */
+    word = ~p_bitmap[idx] & ~((0x1UL << (start & 0x1F)) - 1);
+    while (word == 0)
+    {
+        if (++idx >= words)
+        {
+            return bits;
+        }
+        word = ~p_bitmap[idx];
+    }
+
+    start = (idx << 5) + __builtin_ctz(word);
+    return (start < bits) ? start : bits;
+}
+
+uint32_t util_bitmap_zero_ranges(const uint32_t *p_bitmap, uint32_t bits, uint32_t start,
+                                 util_bitmap_range_t *p_ranges, uint32_t max_ranges)
+{
+    uint32_t num = 0, end;
+
+    while (num < max_ranges)
+    {
+        start = util_bitmap_find_next_zero(p_bitmap, bits, start);
+        if (start >= bits)
+        {
+            break;
+        }
+        end = util_bitmap_find_next_one(p_bitmap, bits, start);
+        p_ranges[num].start = start;
+        p_ranges[num].len = end - start;
+        num++;
+        start = end;
+    }
+
+    return num;
+}
@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2026  All Rights Reserved.
+ */
+/** @file util_frame_ring.c
+ *
+ * @version 0.1
+ * @date 2026/10/18
+ * @license
+ * @description Lock-free single producer, single consumer frame ring. The head and the tail run in
+ *              [0, 2 * depth), so a full ring and an empty ring are told apart with all slots used.
+ */
+
+//=============================================================================
+//                Include
+//=============================================================================
+#include <stddef.h>
+
+#include "util_frame_ring.h"
+
+//=============================================================================
+//                Private Global Variables
+//=============================================================================
+static util_frame_ring_t *g_frame_ring_list = NULL;
+
+//=============================================================================
+//                Private Function Definition
+//=============================================================================
+static uint32_t frame_ring_used(const util_frame_ring_t *p_ring, uint32_t head, uint32_t tail)
+{
+    return (head + 2 * p_ring->depth - tail) % (2 * p_ring->depth);
+}
+
+static uint16_t frame_ring_next(const util_frame_ring_t *p_ring, uint32_t idx)
+{
+    return (uint16_t)((idx + 1 == 2 * (uint32_t)p_ring->depth) ? 0 : idx + 1);
+}
+
+static void *frame_ring_slot(const util_frame_ring_t *p_ring, uint32_t idx)
+{
+    if (idx >= p_ring->depth)
+    {
+        idx -= p_ring->depth;
+    }
+    return p_ring->p_buf + idx * p_ring->slot_size;
+}
+
+//=============================================================================
+//                Public Function Definition
+//=============================================================================
+void util_frame_ring_init(util_frame_ring_t *p_ring, const char *p_name, void *p_buf,
+                          uint32_t frame_size, uint16_t depth)
+{
+    util_frame_ring_t *p_iter;
+
+    p_ring->p_name = p_name;
+    p_ring->p_buf = (uint8_t *)p_buf;
+    p_ring->slot_size = (uint16_t)UTIL_FRAME_RING_SLOT_SIZE(frame_size);
+    p_ring->depth = depth;
+    p_ring->head = 0;
+    p_ring->tail = 0;
+    p_ring->high_water = 0;
+    p_ring->put_num = 0;
+    p_ring->drop_num = 0;
+
+    /* the ring may be initialized again by a stack restart */
+    for (p_iter = g_frame_ring_list; p_iter; p_iter = p_iter->p_next)
+    {
+        if (p_iter == p_ring)
+        {
+            return;
+        }
+    }
+    p_ring->p_next = g_frame_ring_list;
+    g_frame_ring_list = p_ring;
+}
+
+void *util_frame_ring_put_reserve(util_frame_ring_t *p_ring)
+{
+    uint32_t head = p_ring->head;
+
+    if (frame_ring_used(p_ring, head, __atomic_load_n(&p_ring->tail, __ATOMIC_ACQUIRE))
+            >= p_ring->depth)
+    {
+        p_ring->drop_num++;
+        return NULL;
+    }
+    return frame_ring_slot(p_ring, head);
+}
+
+void util_frame_ring_put_commit(util_frame_ring_t *p_ring)
+{
+    uint16_t head = frame_ring_next(p_ring, p_ring->head);
+    uint32_t used;
+
+    /* the slot is written before the consumer sees the head */
+    __atomic_store_n(&p_ring->head, head, __ATOMIC_RELEASE);
+    p_ring->put_num++;
+
+    used = frame_ring_used(p_ring, head, p_ring->tail);
+    if (used > p_ring->high_water)
+    {
+        p_ring->high_water = (uint16_t)used;
+    }
+}
+
+void *util_frame_ring_get_peek(util_frame_ring_t *p_ring)
+{
+    uint32_t tail = p_ring->tail;
+
+    if (__atomic_load_n(&p_ring->head, __ATOMIC_ACQUIRE) == tail)
+    {
+        return NULL;
+    }
+    return frame_ring_slot(p_ring, tail);
+}
+
+void util_frame_ring_get_release(util_frame_ring_t *p_ring)
+{
+    uint32_t tail = p_ring->tail;
+
+    if (p_ring->head == tail)
+    {
+        return;
+    }
+    /* the slot is read before the producer reuses it */
+    __atomic_store_n(&p_ring->tail, frame_ring_next(p_ring, tail), __ATOMIC_RELEASE);
+}
+
+uint32_t util_frame_ring_count(const util_frame_ring_t *p_ring)
+{
+    return frame_ring_used(p_ring, p_ring->head, p_ring->tail);
+}
+
+void util_frame_ring_stats_get(const util_frame_ring_t *p_ring, util_frame_ring_stats_t *p_stats)
+{
+    p_stats->put_num = p_ring->put_num;
+    p_stats->drop_num = p_ring->drop_num;
+    p_stats->depth = p_ring->depth;
+    p_stats->used = (uint16_t)util_frame_ring_count(p_ring);
+    p_stats->high_water = p_ring->high_water;
+}
+
+void util_frame_ring_stats_reset(util_frame_ring_t *p_ring)
+{
+    p_ring->put_num = 0;
+    p_ring->drop_num = 0;
+    p_ring->high_water = (uint16_t)util_frame_ring_count(p_ring);
+}
+
+util_frame_ring_t *util_frame_ring_list(void)
+{
+    return g_frame_ring_list;
+}